@@ -0,0 +1,232 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "sintatico_v3.tab.h"
+#include "lexico_simd.h"
+
+// Vazão do léxico: o do flex (formatSource + lexico_c_v2.l) contra o de
+// lexico_simd.c em cada modo, sobre um fonte grande. Antes de medir, confere
+// que todos entregam exatamente os mesmos tokens
+//   ./bench_lexico.exe [fonte.txt] [--size=MB] [--repeat=N]
+// Sem fonte, gera um programa sintético com o tamanho pedido (padrão 8 MB)
+
+int flexLex(YYSTYPE* yylval_param, yyscan_t yyscanner);
+int yylex_init_extra(ParserContext* extra, yyscan_t* scanner);
+int yylex_destroy(yyscan_t scanner);
+struct yy_buffer_state* yy_scan_bytes(const char* bytes, int length, yyscan_t scanner);
+
+typedef struct {
+    int token;
+    char *text;         // Só nos tokens com valor (ID, números, strings, operadores)
+} Token;
+
+typedef struct {
+    Token *tokens;
+    long count;
+    long capacity;
+} TokenList;
+
+static int token_has_text(int token) {
+    return token == INT || token == FLOAT || token == ID || token == STRING || token == CHAR || token == OPERADOR;
+}
+
+static void add_token(TokenList *list, int token, char *text) {
+    if (!list) {
+        free(text);
+        return;
+    }
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? list->capacity * 2 : 4096;
+        list->tokens = realloc(list->tokens, list->capacity * sizeof(Token));
+    }
+    list->tokens[list->count].token = token;
+    list->tokens[list->count].text = text;
+    list->count++;
+}
+
+static void free_tokens(TokenList *list) {
+    for (long i = 0; i < list->count; i++) free(list->tokens[i].text);
+    free(list->tokens);
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Todo o caminho do flex, como em parseSource: formatar e tirar os tokens
+long scan_with_flex(ParserContext *ctx, const char *text, size_t length, TokenList *list) {
+    FILE *input = fmemopen((void *)text, length ? length : 1, "r");
+    size_t source_length = 0;
+    char *source = formatSource(input, &source_length);
+    fclose(input);
+
+    yyscan_t scanner;
+    yylex_init_extra(ctx, &scanner);
+    yy_scan_bytes(source, (int)source_length, scanner);
+    long count = 0;
+    YYSTYPE value;
+    int token;
+    while ((token = flexLex(&value, scanner)) != 0) {
+        add_token(list, token, token_has_text(token) ? value.str : NULL);
+        count++;
+    }
+    yylex_destroy(scanner);
+    free(source);
+    return count;
+}
+
+long scan_with_simd(ParserContext *ctx, const char *text, size_t length, ScannerMode mode, TokenList *list) {
+    SimdScanner *scanner = simd_scanner_create(ctx, text, length, mode);
+    long count = 0;
+    YYSTYPE value;
+    int token;
+    while ((token = simd_scanner_next(scanner, &value)) != 0) {
+        add_token(list, token, token_has_text(token) ? value.str : NULL);
+        count++;
+    }
+    simd_scanner_destroy(scanner);
+    return count;
+}
+
+// Programa sintético no estilo dos gerados: declarações, comentários,
+// expressões, if/while e printf, com indentação
+char* generate_source(size_t target, size_t *length) {
+    static const char *const statements[] = {
+        "    // atualiza o acumulador da iteracao corrente\n",
+        "    acumulador_total = acumulador_total + valor_%d * (indice_%d - 42);\n",
+        "    /* bloco de comentario gerado\n       com mais de uma linha */\n",
+        "    if (indice_%d >= 1000) {\n        printf(\"indice %%d\\n\", indice_%d);\n    } else {\n        valor_%d = 2.5e3;\n    }\n",
+        "    while (valor_%d < 100) {\n        valor_%d = valor_%d + 1;\n    }\n",
+        "\tmedia = (acumulador_total / 17) %% 3 + 0.125;\n",
+    };
+    size_t capacity = target + 4096;
+    char *text = malloc(capacity);
+    size_t size = 0;
+    size += sprintf(text + size, "int acumulador_total;\nfloat media;\n");
+    for (int i = 0; i < 100; i++) {
+        size += sprintf(text + size, "int valor_%d, indice_%d;\n", i, i);
+    }
+    size += sprintf(text + size, "{\n");
+    for (int n = 0; size < target; n++) {
+        int v = n % 100;
+        size += sprintf(text + size, statements[n % 6], v, v, v, v, v);
+    }
+    size += sprintf(text + size, "}\n");
+    *length = size;
+    return text;
+}
+
+static int compare_tokens(const TokenList *expected, const TokenList *actual, const char *name) {
+    long count = expected->count < actual->count ? expected->count : actual->count;
+    for (long i = 0; i < count; i++) {
+        const Token *a = &expected->tokens[i];
+        const Token *b = &actual->tokens[i];
+        if (a->token != b->token || (a->text && strcmp(a->text, b->text) != 0)) {
+            fprintf(stderr, "Erro: %s difere do flex no token %ld: %d '%s' x %d '%s'\n", name, i,
+                    a->token, a->text ? a->text : "", b->token, b->text ? b->text : "");
+            return 1;
+        }
+    }
+    if (expected->count != actual->count) {
+        fprintf(stderr, "Erro: %s entrega %ld tokens, o flex %ld\n", name, actual->count, expected->count);
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    const char *source_path = NULL;
+    size_t target = 8 << 20;
+    int repeat = 5;
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--size=", 7) == 0) {
+            target = (size_t)(atof(argv[i] + 7) * 1024 * 1024);
+        } else if (strncmp(argv[i], "--repeat=", 9) == 0) {
+            repeat = atoi(argv[i] + 9);
+        } else if (argv[i][0] != '-' && !source_path) {
+            source_path = argv[i];
+        } else {
+            printf("Uso: %s [fonte.txt] [--size=MB] [--repeat=N]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (repeat < 1) repeat = 1;
+
+    size_t length = 0;
+    char *text;
+    if (source_path) {
+        FILE *input = fopen(source_path, "rb");
+        if (!input) {
+            fprintf(stderr, "Erro ao abrir %s\n", source_path);
+            return 1;
+        }
+        fseek(input, 0, SEEK_END);
+        length = (size_t)ftell(input);
+        rewind(input);
+        text = malloc(length + 1);
+        if (fread(text, 1, length, input) != length) length = 0;
+        fclose(input);
+    } else {
+        text = generate_source(target, &length);
+    }
+
+    // Os ":-(" de caracteres desconhecidos não interessam aqui
+    FILE *discard = fopen("/dev/null", "w");
+    ParserContext ctx;
+    initParserContext(&ctx, discard);
+
+    static const ScannerMode modes[] = { SCANNER_SCALAR, SCANNER_SSE2, SCANNER_AVX2 };
+    int mode_count = sizeof(modes) / sizeof(modes[0]);
+
+    TokenList expected = { NULL, 0, 0 };
+    scan_with_flex(&ctx, text, length, &expected);
+    int status = 0;
+    for (int m = 0; m < mode_count; m++) {
+        SimdScanner *probe = simd_scanner_create(&ctx, "", 0, modes[m]);
+        if (!probe) continue;
+        simd_scanner_destroy(probe);
+        TokenList actual = { NULL, 0, 0 };
+        scan_with_simd(&ctx, text, length, modes[m], &actual);
+        status |= compare_tokens(&expected, &actual, scanner_mode_name(modes[m]));
+        free_tokens(&actual);
+    }
+
+    printf("Fonte: %.2f MB, %ld tokens, melhor de %d\n", length / 1048576.0, expected.count, repeat);
+    printf("%-10s %12s %10s\n", "léxico", "tempo (ms)", "MB/s");
+
+    double flex_best = 0;
+    for (int r = 0; r < repeat; r++) {
+        double start = now_seconds();
+        scan_with_flex(&ctx, text, length, NULL);
+        double elapsed = now_seconds() - start;
+        if (r == 0 || elapsed < flex_best) flex_best = elapsed;
+    }
+    printf("%-9s %12.2f %10.1f\n", "flex", flex_best * 1000, length / 1048576.0 / flex_best);
+
+    for (int m = 0; m < mode_count; m++) {
+        SimdScanner *probe = simd_scanner_create(&ctx, "", 0, modes[m]);
+        if (!probe) {
+            printf("%-9s %12s %10s\n", scanner_mode_name(modes[m]), "-", "-");
+            continue;
+        }
+        simd_scanner_destroy(probe);
+        double best = 0;
+        for (int r = 0; r < repeat; r++) {
+            double start = now_seconds();
+            scan_with_simd(&ctx, text, length, modes[m], NULL);
+            double elapsed = now_seconds() - start;
+            if (r == 0 || elapsed < best) best = elapsed;
+        }
+        printf("%-9s %12.2f %10.1f  (%.2fx)\n", scanner_mode_name(modes[m]), best * 1000,
+               length / 1048576.0 / best, flex_best / best);
+    }
+
+    free_tokens(&expected);
+    freeParserContext(&ctx);
+    fclose(discard);
+    free(text);
+    return status;
+}
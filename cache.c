@@ -0,0 +1,336 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "cache.h"
+
+/* ---------- SHA-256 (FIPS 180-4) ---------- */
+
+typedef struct {
+    uint32_t state[8];
+    uint64_t bit_length;
+    unsigned char block[64];
+    size_t block_used;
+} Sha256;
+
+static const uint32_t sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+#define ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+static void sha256_init(Sha256 *sha) {
+    static const uint32_t initial[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+    memcpy(sha->state, initial, sizeof(initial));
+    sha->bit_length = 0;
+    sha->block_used = 0;
+}
+
+static void sha256_block(Sha256 *sha, const unsigned char *block) {
+    uint32_t w[64];
+    for (int i = 0; i < 16; i++) {
+        w[i] = (uint32_t)block[i * 4] << 24 | (uint32_t)block[i * 4 + 1] << 16 |
+               (uint32_t)block[i * 4 + 2] << 8 | (uint32_t)block[i * 4 + 3];
+    }
+    for (int i = 16; i < 64; i++) {
+        uint32_t s0 = ROTR(w[i - 15], 7) ^ ROTR(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = ROTR(w[i - 2], 17) ^ ROTR(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = sha->state[0], b = sha->state[1], c = sha->state[2], d = sha->state[3];
+    uint32_t e = sha->state[4], f = sha->state[5], g = sha->state[6], h = sha->state[7];
+    for (int i = 0; i < 64; i++) {
+        uint32_t t1 = h + (ROTR(e, 6) ^ ROTR(e, 11) ^ ROTR(e, 25)) + ((e & f) ^ (~e & g)) + sha256_k[i] + w[i];
+        uint32_t t2 = (ROTR(a, 2) ^ ROTR(a, 13) ^ ROTR(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+
+    sha->state[0] += a; sha->state[1] += b; sha->state[2] += c; sha->state[3] += d;
+    sha->state[4] += e; sha->state[5] += f; sha->state[6] += g; sha->state[7] += h;
+}
+
+static void sha256_update(Sha256 *sha, const void *data, size_t length) {
+    const unsigned char *bytes = data;
+    sha->bit_length += (uint64_t)length * 8;
+
+    while (length > 0) {
+        size_t take = 64 - sha->block_used;
+        if (take > length) take = length;
+        memcpy(sha->block + sha->block_used, bytes, take);
+        sha->block_used += take;
+        bytes += take;
+        length -= take;
+
+        if (sha->block_used == 64) {
+            sha256_block(sha, sha->block);
+            sha->block_used = 0;
+        }
+    }
+}
+
+static void sha256_final(Sha256 *sha, unsigned char digest[32]) {
+    uint64_t bit_length = sha->bit_length;
+    unsigned char padding = 0x80;
+    sha256_update(sha, &padding, 1);
+    padding = 0;
+    while (sha->block_used != 56) {
+        sha256_update(sha, &padding, 1);
+    }
+
+    unsigned char length_bytes[8];
+    for (int i = 0; i < 8; i++) {
+        length_bytes[i] = (unsigned char)(bit_length >> (56 - i * 8));
+    }
+    sha256_update(sha, length_bytes, 8);
+
+    for (int i = 0; i < 8; i++) {
+        digest[i * 4] = (unsigned char)(sha->state[i] >> 24);
+        digest[i * 4 + 1] = (unsigned char)(sha->state[i] >> 16);
+        digest[i * 4 + 2] = (unsigned char)(sha->state[i] >> 8);
+        digest[i * 4 + 3] = (unsigned char)sha->state[i];
+    }
+}
+
+/* ---------- Cache ---------- */
+
+int cache_open(Cache *cache, const char *dir, long limit) {
+    if (mkdir(dir, 0777) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Erro ao criar diretório do cache %s: %s\n", dir, strerror(errno));
+        return 1;
+    }
+    cache->dir = strdup(dir);
+    cache->limit = limit > 0 ? limit : CACHE_DEFAULT_LIMIT;
+    pthread_mutex_init(&cache->lock, NULL);
+    cache->hits = cache->misses = cache->stores = cache->evictions = 0;
+    cache->size = 0;
+    cache->evicting = 0;
+    // Mede o cache (e já o reduz, se passou do limite) para as gravações
+    // seguintes saberem quando remover
+    cache_evict(cache);
+    return 0;
+}
+
+void cache_close(Cache *cache) {
+    pthread_mutex_destroy(&cache->lock);
+    free(cache->dir);
+    cache->dir = NULL;
+}
+
+// Chave = SHA-256(versão \0 opções \0 fonte)
+void cache_key(char key[CACHE_KEY_LENGTH + 1], const char *version, const char *options,
+               const char *source, size_t length) {
+    Sha256 sha;
+    unsigned char digest[32];
+
+    sha256_init(&sha);
+    sha256_update(&sha, version, strlen(version) + 1);
+    sha256_update(&sha, options, strlen(options) + 1);
+    sha256_update(&sha, source, length);
+    sha256_final(&sha, digest);
+
+    for (int i = 0; i < 32; i++) {
+        snprintf(key + i * 2, 3, "%02x", digest[i]);
+    }
+}
+
+// As entradas ficam em DIR/ab/cdef....s, dois níveis para não lotar um diretório só
+static void entry_path(Cache *cache, const char *key, char *path, size_t size) {
+    snprintf(path, size, "%s/%.2s/%s.s", cache->dir, key, key + 2);
+}
+
+static void count(Cache *cache, long *counter, long amount) {
+    pthread_mutex_lock(&cache->lock);
+    *counter += amount;
+    pthread_mutex_unlock(&cache->lock);
+}
+
+// Devolve o .s guardado (malloc) ou NULL; um acerto renova a data de acesso
+// da entrada, que é o que a remoção LRU usa
+char* cache_lookup(Cache *cache, const char *key, size_t *length) {
+    char path[4096];
+    entry_path(cache, key, path, sizeof(path));
+
+    int fd = open(path, O_RDONLY);
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) != 0) {
+        if (fd >= 0) close(fd);
+        count(cache, &cache->misses, 1);
+        return NULL;
+    }
+
+    char *data = malloc(info.st_size + 1);
+    ssize_t got = 0;
+    while (got < info.st_size) {
+        ssize_t n = read(fd, data + got, info.st_size - got);
+        if (n <= 0) break;
+        got += n;
+    }
+    if (got != info.st_size) {
+        close(fd);
+        free(data);
+        count(cache, &cache->misses, 1);
+        return NULL;
+    }
+
+    futimens(fd, NULL);
+    close(fd);
+
+    data[got] = '\0';
+    *length = got;
+    count(cache, &cache->hits, 1);
+    return data;
+}
+
+// Grava em um arquivo temporário e renomeia: quem lê nunca vê uma entrada pela metade
+int cache_store(Cache *cache, const char *key, const char *data, size_t length) {
+    char path[4096], dir[4096], temp[8192];
+    static int temp_counter = 0;
+
+    snprintf(dir, sizeof(dir), "%s/%.2s", cache->dir, key);
+    if (mkdir(dir, 0777) != 0 && errno != EEXIST) return 1;
+    entry_path(cache, key, path, sizeof(path));
+
+    pthread_mutex_lock(&cache->lock);
+    int unique = temp_counter++;
+    pthread_mutex_unlock(&cache->lock);
+    snprintf(temp, sizeof(temp), "%s/.tmp.%ld.%d", dir, (long)getpid(), unique);
+
+    int fd = open(temp, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (fd < 0) return 1;
+
+    size_t written = 0;
+    while (written < length) {
+        ssize_t n = write(fd, data + written, length - written);
+        if (n <= 0) break;
+        written += n;
+    }
+    if (close(fd) != 0 || written != length || rename(temp, path) != 0) {
+        unlink(temp);
+        return 1;
+    }
+
+    // Passou do limite: remove na hora, não só no fim (o --server não termina)
+    pthread_mutex_lock(&cache->lock);
+    cache->stores++;
+    cache->size += length;
+    int evict = cache->size > cache->limit && !cache->evicting;
+    if (evict) cache->evicting = 1;
+    pthread_mutex_unlock(&cache->lock);
+
+    if (evict) {
+        cache_evict(cache);
+        pthread_mutex_lock(&cache->lock);
+        cache->evicting = 0;
+        pthread_mutex_unlock(&cache->lock);
+    }
+    return 0;
+}
+
+typedef struct {
+    char *path;
+    long size;
+    struct timespec last_use;
+} CacheEntry;
+
+static int compare_entry_age(const void *a, const void *b) {
+    const CacheEntry *x = a, *y = b;
+    if (x->last_use.tv_sec != y->last_use.tv_sec) {
+        return (x->last_use.tv_sec > y->last_use.tv_sec) - (x->last_use.tv_sec < y->last_use.tv_sec);
+    }
+    return (x->last_use.tv_nsec > y->last_use.tv_nsec) - (x->last_use.tv_nsec < y->last_use.tv_nsec);
+}
+
+// Remove as entradas usadas há mais tempo até o cache caber em 90% do limite,
+// e os temporários de gravações que não terminaram (processo morto no meio)
+void cache_evict(Cache *cache) {
+    CacheEntry *entries = NULL;
+    int entry_count = 0, entry_capacity = 0;
+    long total = 0;
+
+    DIR *top = opendir(cache->dir);
+    if (!top) return;
+
+    struct dirent *sub;
+    while ((sub = readdir(top))) {
+        if (sub->d_name[0] == '.') continue;
+
+        char sub_path[4096];
+        snprintf(sub_path, sizeof(sub_path), "%s/%s", cache->dir, sub->d_name);
+        DIR *bucket = opendir(sub_path);
+        if (!bucket) continue;
+
+        struct dirent *file;
+        while ((file = readdir(bucket))) {
+            int is_temp = strncmp(file->d_name, ".tmp.", 5) == 0;
+            if (file->d_name[0] == '.' && !is_temp) continue;
+
+            char file_path[8192];
+            struct stat info;
+            snprintf(file_path, sizeof(file_path), "%s/%s", sub_path, file->d_name);
+            if (stat(file_path, &info) != 0) continue;
+
+            // Um temporário recente pode ser de uma gravação em andamento
+            if (is_temp) {
+                if (time(NULL) - info.st_mtime > CACHE_TEMP_MAX_AGE) unlink(file_path);
+                continue;
+            }
+
+            if (entry_count == entry_capacity) {
+                entry_capacity = entry_capacity ? entry_capacity * 2 : 256;
+                entries = realloc(entries, entry_capacity * sizeof(CacheEntry));
+            }
+            // A data de modificação é renovada a cada acerto (futimens)
+            entries[entry_count].path = strdup(file_path);
+            entries[entry_count].size = info.st_size;
+            entries[entry_count].last_use = info.st_mtim;
+            entry_count++;
+            total += info.st_size;
+        }
+        closedir(bucket);
+    }
+    closedir(top);
+
+    if (total > cache->limit) {
+        qsort(entries, entry_count, sizeof(CacheEntry), compare_entry_age);
+        long target = cache->limit / 10 * 9;
+        for (int i = 0; i < entry_count && total > target; i++) {
+            if (unlink(entries[i].path) == 0) {
+                total -= entries[i].size;
+                count(cache, &cache->evictions, 1);
+            }
+        }
+    }
+
+    pthread_mutex_lock(&cache->lock);
+    cache->size = total;
+    pthread_mutex_unlock(&cache->lock);
+
+    for (int i = 0; i < entry_count; i++) {
+        free(entries[i].path);
+    }
+    free(entries);
+}
+
+void cache_print_stats(Cache *cache, FILE *out) {
+    long lookups = cache->hits + cache->misses;
+    fprintf(out, "Cache: %ld acerto(s), %ld falta(s) (%.1f%% de acerto), %ld gravado(s), %ld removido(s)\n",
+            cache->hits, cache->misses, lookups ? 100.0 * cache->hits / lookups : 0.0,
+            cache->stores, cache->evictions);
+}
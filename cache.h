@@ -0,0 +1,36 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#define CACHE_KEY_LENGTH 64                     // SHA-256 em hexadecimal
+#define CACHE_DEFAULT_LIMIT (256L * 1024 * 1024) // 256 MB
+#define CACHE_TEMP_MAX_AGE 3600                 // Segundos até um .tmp.* órfão ser apagado
+
+// Cache de compilação em disco, endereçado pelo conteúdo: a chave é o hash
+// do fonte, da versão do compilador e das opções, e o valor é o .s final
+typedef struct {
+    char *dir;
+    long limit;             // Tamanho máximo em bytes antes de remover entradas
+    long size;              // Bytes no cache: medido em cada remoção, somado a cada gravação
+    int evicting;           // Uma remoção em andamento (as outras threads não repetem)
+    pthread_mutex_t lock;   // Protege o tamanho e as estatísticas (--batch e --server)
+    long hits;
+    long misses;
+    long stores;
+    long evictions;
+} Cache;
+
+int cache_open(Cache *cache, const char *dir, long limit);
+void cache_close(Cache *cache);
+
+void cache_key(char key[CACHE_KEY_LENGTH + 1], const char *version, const char *options,
+               const char *source, size_t length);
+char* cache_lookup(Cache *cache, const char *key, size_t *length);
+int cache_store(Cache *cache, const char *key, const char *data, size_t length);
+void cache_evict(Cache *cache);
+void cache_print_stats(Cache *cache, FILE *out);
+
+#endif
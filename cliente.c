@@ -0,0 +1,114 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include "protocolo.h"
+
+// Cliente do servidor de compilação: substitui o pipeline
+// sintatico.exe | riscv_gen.exe por um pedido ao compilador residente
+//   ./cliente.exe fonte.txt saida.s [--socket=caminho]
+
+#define CONNECT_ATTEMPTS 50     // 50 x 20 ms: dá tempo de um servidor recém-iniciado subir
+
+char* read_source(const char *path, size_t *length) {
+    FILE *input = fopen(path, "rb");
+    if (!input) {
+        fprintf(stderr, "Erro ao abrir arquivo de entrada %s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+
+    char *data = NULL;
+    size_t size = 0, capacity = 0, n;
+    do {
+        if (size + 65536 > capacity) {
+            capacity = capacity ? capacity * 2 : 65536;
+            data = realloc(data, capacity);
+        }
+        n = fread(data + size, 1, capacity - size, input);
+        size += n;
+    } while (n > 0);
+
+    fclose(input);
+    *length = size;
+    return data;
+}
+
+int connect_to_server(const char *socket_path) {
+    struct timespec pause = { 0, 20 * 1000 * 1000 };
+    for (int attempt = 0; attempt < CONNECT_ATTEMPTS; attempt++) {
+        int fd = protocol_connect(socket_path);
+        if (fd >= 0) return fd;
+        if (errno != ENOENT && errno != ECONNREFUSED) break;
+        nanosleep(&pause, NULL);
+    }
+    fprintf(stderr, "Não foi possível conectar ao servidor em %s: %s\n", socket_path, strerror(errno));
+    fprintf(stderr, "Inicie o servidor com: ./compilador.exe --server=%s &\n", socket_path);
+    return -1;
+}
+
+int main(int argc, char **argv) {
+    const char *input_path = NULL;
+    const char *output_path = NULL;
+    const char *socket_path = protocol_default_socket();
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--socket=", 9) == 0) {
+            socket_path = argv[i] + 9;
+        } else if (!input_path) {
+            input_path = argv[i];
+        } else if (!output_path) {
+            output_path = argv[i];
+        } else {
+            input_path = NULL;
+            break;
+        }
+    }
+
+    if (!input_path || !output_path) {
+        printf("Uso: %s fonte.txt saida.s [--socket=caminho]\n", argv[0]);
+        return 1;
+    }
+
+    size_t source_length = 0;
+    char *source = read_source(input_path, &source_length);
+    if (!source) return 1;
+
+    int fd = connect_to_server(socket_path);
+    if (fd < 0) {
+        free(source);
+        return 1;
+    }
+
+    ProtocolResponse response;
+    if (protocol_write_request(fd, input_path, source, source_length) != 0 ||
+        protocol_read_response(fd, &response) != 0) {
+        fprintf(stderr, "Erro na comunicação com o servidor de compilação\n");
+        close(fd);
+        free(source);
+        return 1;
+    }
+    close(fd);
+    free(source);
+
+    fwrite(response.diagnostics, 1, response.diagnostics_length, stderr);
+
+    int status = response.status;
+    if (status == 0) {
+        FILE *output = fopen(output_path, "w");
+        if (!output) {
+            fprintf(stderr, "Erro ao criar arquivo de saída %s: %s\n", output_path, strerror(errno));
+            status = 1;
+        } else {
+            fwrite(response.assembly, 1, response.assembly_length, output);
+            if (fclose(output) != 0) status = 1;
+        }
+    }
+
+    protocol_free_response(&response);
+    if (status == 0) {
+        printf("Código RISC-V gerado em %s\n", output_path);
+    }
+    return status ? 1 : 0;
+}
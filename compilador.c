@@ -0,0 +1,457 @@
+#define _GNU_SOURCE     // fopencookie
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <signal.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include "sintatico_v3.tab.h"
+#include "riscv_gen3.h"
+#include "cache.h"
+#include "protocolo.h"
+
+// Identifica o compilador na chave do cache; o makefile passa um hash dos
+// fontes do compilador, então qualquer mudança nele invalida as entradas
+#ifndef COMPILER_BUILD_ID
+#define COMPILER_BUILD_ID __DATE__ " " __TIME__
+#endif
+
+Cache *compile_cache = NULL;        // NULL = sem cache
+GenOptions gen_options = { FORMAT_ASM };
+int use_simd_scanner = 0;           // --scanner=simd: léxico de lexico_simd.c no lugar do flex
+
+// Mensagens de erro/aviso que o sintático escreve junto com a saída para o gerador
+int is_diagnostic_line(const char *line, size_t length) {
+    return (length >= 5 && strncmp(line, "ERROR", 5) == 0) ||
+           (length >= 7 && strncmp(line, "WARNING", 7) == 0) ||
+           (length >= 8 && strncmp(line, "Problema", 8) == 0) ||
+           (length >= 3 && strncmp(line, ":-(", 3) == 0);
+}
+
+// Repassa para stderr as mensagens de diagnóstico do texto do sintático;
+// retorna quantas foram encontradas
+int report_diagnostics(FILE *out, const char *source_path, const char *intermediate, size_t length) {
+    int diagnostics = 0;
+    const char *line = intermediate;
+    const char *end = intermediate + length;
+
+    while (line < end) {
+        const char *next = memchr(line, '\n', end - line);
+        size_t line_length = next ? (size_t)(next - line) : (size_t)(end - line);
+
+        if (is_diagnostic_line(line, line_length)) {
+            fprintf(out, "%s: %.*s\n", source_path, (int)line_length, line);
+            diagnostics++;
+        }
+
+        line = next ? next + 1 : end;
+    }
+    return diagnostics;
+}
+
+// Repassa as mensagens de erro do gerador, com o nome do fonte na frente
+// como nas do sintático
+void report_generator_errors(FILE *out, const char *source_path, const char *text, size_t length) {
+    const char *line = text;
+    const char *end = text + length;
+    while (line < end) {
+        const char *next = memchr(line, '\n', end - line);
+        size_t line_length = next ? (size_t)(next - line) : (size_t)(end - line);
+        fprintf(out, "%s: %.*s\n", source_path, (int)line_length, line);
+        line = next ? next + 1 : end;
+    }
+}
+
+// Lê o arquivo inteiro para a memória (o cache precisa dos bytes exatos)
+char* read_whole_file(const char *path, size_t *length) {
+    FILE *input = fopen(path, "rb");
+    if (!input) {
+        fprintf(stderr, "Erro ao abrir arquivo de entrada %s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+
+    char *data = NULL;
+    size_t size = 0, capacity = 0, n;
+    do {
+        if (size + 65536 > capacity) {
+            capacity = capacity ? capacity * 2 : 65536;
+            data = realloc(data, capacity + 1);
+        }
+        n = fread(data + size, 1, capacity - size, input);
+        size += n;
+    } while (n > 0);
+
+    fclose(input);
+    data[size] = '\0';
+    *length = size;
+    return data;
+}
+
+int write_whole_file(const char *path, const char *data, size_t length) {
+    FILE *output = fopen(path, "wb");
+    if (!output) {
+        fprintf(stderr, "Erro ao criar arquivo de saída %s: %s\n", path, strerror(errno));
+        return 1;
+    }
+    size_t written = fwrite(data, 1, length, output);
+    if (fclose(output) != 0 || written != length) {
+        fprintf(stderr, "Erro ao escrever %s\n", path);
+        return 1;
+    }
+    return 0;
+}
+
+// Saída do sintático: cada linha segue na hora, por um pipe, para o gerador
+// (que roda em outra thread) e só as de diagnóstico ficam guardadas, então o
+// texto intermediário nunca fica inteiro na memória. Não é uma compilação em
+// memória constante: o fonte é lido inteiro e o IR do gerador cresce com o
+// programa (ver generate_riscv_code); o que fica limitado é a pilha do bison
+typedef struct {
+    FILE *generator;        // Ponta de escrita do pipe
+    FILE *diagnostics;      // Linhas de diagnóstico (open_memstream)
+    char *line;             // Linha corrente, até o '\n'
+    size_t line_length;
+    size_t line_capacity;
+} ParserStream;
+
+static void parser_stream_end_line(ParserStream *stream) {
+    if (is_diagnostic_line(stream->line, stream->line_length)) {
+        fwrite(stream->line, 1, stream->line_length, stream->diagnostics);
+        fputc('\n', stream->diagnostics);
+    }
+    stream->line_length = 0;
+}
+
+static ssize_t parser_stream_write(void *cookie, const char *data, size_t size) {
+    ParserStream *stream = cookie;
+    for (size_t i = 0; i < size; i++) {
+        if (data[i] == '\n') {
+            parser_stream_end_line(stream);
+            continue;
+        }
+        if (stream->line_length == stream->line_capacity) {
+            stream->line_capacity = stream->line_capacity ? stream->line_capacity * 2 : 256;
+            stream->line = realloc(stream->line, stream->line_capacity);
+        }
+        stream->line[stream->line_length++] = data[i];
+    }
+    return fwrite(data, 1, size, stream->generator) == size ? (ssize_t)size : -1;
+}
+
+static int parser_stream_close(void *cookie) {
+    ParserStream *stream = cookie;
+    if (stream->line_length) parser_stream_end_line(stream);
+    free(stream->line);
+    return fclose(stream->generator);
+}
+
+typedef struct {
+    FILE *input;            // Ponta de leitura do pipe
+    char **assembly;
+    size_t *assembly_length;
+    FILE *diagnostics;      // Erros do gerador (open_memstream)
+    int status;
+} GeneratorJob;
+
+static void* generator_thread(void *arg) {
+    GeneratorJob *job = arg;
+    FILE *output = open_memstream(job->assembly, job->assembly_length);
+    if (!output) {
+        perror("Erro ao criar a saída do gerador");
+        job->status = 1;
+    } else {
+        job->status = generate_riscv_stream(job->input, output, job->diagnostics, &gen_options);
+        fclose(output);
+    }
+    // Consome o resto para o sintático nunca ficar bloqueado no pipe
+    while (fgetc(job->input) != EOF) {}
+    fclose(job->input);
+    return NULL;
+}
+
+// Compila um programa-fonte até o .s dentro do processo: o gerador consome
+// os comandos à medida que o sintático os reduz, sem arquivos intermediários
+int compile_source_text(const char *source_path, const char *text, size_t text_length,
+                        char **assembly, size_t *assembly_length, FILE *diagnostics_out, int *diagnostics) {
+    // O léxico de lexico_simd.c lê o texto como está; o do flex precisa dele formatado
+    size_t source_length = 0;
+    char *source = NULL;
+    if (!use_simd_scanner) {
+        FILE *input = fmemopen((void *)text, text_length ? text_length : 1, "r");
+        if (!input) {
+            perror("Erro ao ler o fonte");
+            return 1;
+        }
+        source = text_length ? formatSource(input, &source_length) : strdup("");
+        fclose(input);
+        if (!source) return 1;
+    }
+
+    char *diagnostic_text = NULL, *generator_text = NULL;
+    size_t diagnostic_length = 0, generator_length = 0;
+    ParserStream stream = { NULL, open_memstream(&diagnostic_text, &diagnostic_length), NULL, 0, 0 };
+    GeneratorJob job = { NULL, assembly, assembly_length, open_memstream(&generator_text, &generator_length), 0 };
+    *assembly = NULL;
+    *assembly_length = 0;
+
+    int fds[2];
+    if (!stream.diagnostics || !job.diagnostics || pipe(fds) != 0) {
+        perror("Erro ao criar a saída do sintático");
+        if (stream.diagnostics) fclose(stream.diagnostics);
+        if (job.diagnostics) fclose(job.diagnostics);
+        free(diagnostic_text);
+        free(generator_text);
+        free(source);
+        return 1;
+    }
+    stream.generator = fdopen(fds[1], "w");
+    job.input = fdopen(fds[0], "r");
+    cookie_io_functions_t functions = { NULL, parser_stream_write, NULL, parser_stream_close };
+    FILE *parser_output = fopencookie(&stream, "w", functions);
+    pthread_t thread;
+    pthread_create(&thread, NULL, generator_thread, &job);
+
+    ParserContext parser;
+    initParserContext(&parser, parser_output);
+    int status = use_simd_scanner ? parseRawSource(&parser, text, text_length)
+                                  : parseSource(&parser, source, source_length);
+    print_table(&parser, &parser.ST);
+    fclose(parser_output);
+    pthread_join(thread, NULL);
+    fclose(stream.diagnostics);
+    fclose(job.diagnostics);
+
+    // Os erros do gerador vão na mesma saída (no servidor, a resposta ao
+    // cliente), e o status dele reprova o programa como os do sintático
+    *diagnostics = report_diagnostics(diagnostics_out, source_path, diagnostic_text, diagnostic_length);
+    report_generator_errors(diagnostics_out, source_path, generator_text, generator_length);
+    if (parser.semanticError1 || parser.semanticError2) {
+        status = 1;
+    }
+    freeParserContext(&parser);
+    free(source);
+    free(diagnostic_text);
+    free(generator_text);
+
+    // O gerador já rodou junto com o sintático; com erro, o .s é descartado
+    if (status == 0) status = job.status;
+    if (status != 0) {
+        free(*assembly);
+        *assembly = NULL;
+        *assembly_length = 0;
+    }
+    return status;
+}
+
+// Compila um fonte já em memória passando pelo cache (quando ativo)
+int compile_text_cached(const char *source_path, const char *text, size_t text_length,
+                        char **assembly, size_t *assembly_length, FILE *diagnostics_out) {
+    // Acerto no cache: o .s guardado é devolvido direto, sem sintático nem gerador.
+    // As opções são descritas a cada pedido: o hash do --profile-use acompanha
+    // o arquivo, que pode mudar enquanto o servidor está no ar
+    char key[CACHE_KEY_LENGTH + 1];
+    char options[1024];
+    if (compile_cache) {
+        describe_gen_options(&gen_options, options, sizeof(options));
+        cache_key(key, COMPILER_BUILD_ID, options, text, text_length);
+        *assembly = cache_lookup(compile_cache, key, assembly_length);
+        if (*assembly) return 0;
+    }
+
+    int diagnostics = 0;
+    int status = compile_source_text(source_path, text, text_length, assembly, assembly_length,
+                                     diagnostics_out, &diagnostics);
+
+    // Programas com avisos não são guardados, para o aviso não sumir num acerto.
+    // Nem os compilados com um perfil que mudou no meio: o .s não é o da chave
+    if (status == 0 && compile_cache && diagnostics == 0) {
+        char options_after[1024];
+        describe_gen_options(&gen_options, options_after, sizeof(options_after));
+        if (strcmp(options, options_after) == 0) {
+            cache_store(compile_cache, key, *assembly, *assembly_length);
+        }
+    }
+    return status;
+}
+
+int compile_source(const char *source_path, const char *output_path) {
+    size_t text_length = 0;
+    char *text = read_whole_file(source_path, &text_length);
+    if (!text) return 1;
+
+    char *assembly = NULL;
+    size_t assembly_length = 0;
+    int status = compile_text_cached(source_path, text, text_length, &assembly, &assembly_length, stderr);
+    free(text);
+
+    if (status == 0) {
+        status = write_whole_file(output_path, assembly, assembly_length);
+    }
+
+    free(assembly);
+    return status;
+}
+
+int compile_source_job(BatchJob *job) {
+    return compile_source(job->input_path, job->output_path);
+}
+
+/* ---------- Modo --server: compilador residente em um socket UNIX ---------- */
+
+volatile sig_atomic_t server_running = 1;
+
+void stop_server(int signal_number) {
+    (void)signal_number;
+    server_running = 0;
+}
+
+// Atende um cliente: cada pedido traz um fonte e recebe o .s e as mensagens
+void* serve_client(void *arg) {
+    int fd = (int)(long)arg;
+    ProtocolRequest request;
+
+    while (protocol_read_request(fd, &request) == 0) {
+        char *diagnostics = NULL;
+        size_t diagnostics_length = 0;
+        FILE *diagnostics_out = open_memstream(&diagnostics, &diagnostics_length);
+
+        char *assembly = NULL;
+        size_t assembly_length = 0;
+        int status = compile_text_cached(request.name, request.source, request.source_length,
+                                         &assembly, &assembly_length, diagnostics_out);
+        fclose(diagnostics_out);
+
+        int sent = protocol_write_response(fd, status, assembly, status == 0 ? assembly_length : 0,
+                                           diagnostics, diagnostics_length);
+        free(assembly);
+        free(diagnostics);
+        protocol_free_request(&request);
+        if (sent != 0) break;
+    }
+
+    close(fd);
+    return NULL;
+}
+
+int run_server(const char *socket_path) {
+    int listen_fd = protocol_listen(socket_path);
+    if (listen_fd < 0) return 1;
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = stop_server;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    fprintf(stderr, "Servidor de compilação ouvindo em %s\n", socket_path);
+
+    // Uma thread por cliente; o processo (tabelas, alocador, cache) fica quente
+    while (server_running) {
+        int client_fd = accept(listen_fd, NULL, NULL);
+        if (client_fd < 0) {
+            if (errno == EINTR) continue;
+            perror("Erro no accept");
+            break;
+        }
+
+        // As threads dos clientes não recebem SIGINT/SIGTERM: o sinal tem que
+        // interromper o accept da thread principal
+        sigset_t blocked, previous;
+        sigemptyset(&blocked);
+        sigaddset(&blocked, SIGINT);
+        sigaddset(&blocked, SIGTERM);
+        pthread_sigmask(SIG_BLOCK, &blocked, &previous);
+
+        pthread_t thread;
+        int created = pthread_create(&thread, NULL, serve_client, (void *)(long)client_fd);
+        pthread_sigmask(SIG_SETMASK, &previous, NULL);
+        if (created != 0) {
+            close(client_fd);
+            continue;
+        }
+        pthread_detach(thread);
+    }
+
+    close(listen_fd);
+    unlink(socket_path);
+    fprintf(stderr, "Servidor de compilação encerrado\n");
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    const char *input_path = NULL;
+    const char *output_path = NULL;
+    const char *batch_path = NULL;
+    const char *server_path = NULL;
+    const char *cache_dir = getenv("COMPILADOR_CACHE");
+    long cache_limit = CACHE_DEFAULT_LIMIT;
+    int show_cache_stats = 0;
+    int jobs = (int)sysconf(_SC_NPROCESSORS_ONLN);
+
+    for (int i = 1; i < argc; i++) {
+        int gen_option = parse_gen_option(argv[i], &gen_options);
+        if (gen_option < 0) return 1;
+        if (gen_option > 0) continue;
+
+        if (strncmp(argv[i], "--batch=", 8) == 0) {
+            batch_path = argv[i] + 8;
+        } else if (strncmp(argv[i], "--jobs=", 7) == 0) {
+            jobs = atoi(argv[i] + 7);
+        } else if (strcmp(argv[i], "--server") == 0) {
+            server_path = protocol_default_socket();
+        } else if (strncmp(argv[i], "--server=", 9) == 0) {
+            server_path = argv[i] + 9;
+        } else if (strncmp(argv[i], "--cache=", 8) == 0) {
+            cache_dir = argv[i] + 8;
+        } else if (strncmp(argv[i], "--cache-size=", 13) == 0) {
+            cache_limit = (long)(atof(argv[i] + 13) * 1024 * 1024);
+        } else if (strcmp(argv[i], "--cache-stats") == 0) {
+            show_cache_stats = 1;
+        } else if (strcmp(argv[i], "--scanner=simd") == 0) {
+            use_simd_scanner = 1;
+        } else if (!input_path) {
+            input_path = argv[i];
+        } else if (!output_path) {
+            output_path = argv[i];
+        } else {
+            input_path = NULL;
+            break;
+        }
+    }
+
+    if (!batch_path && !server_path && (!input_path || !output_path)) {
+        printf("Uso: %s fonte.txt saida.s [opções]\n", argv[0]);
+        printf("     %s --batch=lista.txt [--jobs=N] [opções]\n", argv[0]);
+        printf("     %s --server[=socket] [opções]\n", argv[0]);
+        printf("Opções: --format=asm|elf, --target=rv32|rv64, --rvc, --size-stats, --schedule[=rocket|u74], --sched-stats, -O0|-O1|-O2, --time-passes, --enable-pass=P, --disable-pass=P, --print-after=P, --no-sccp, --sccp-stats, --eval-budget=N, --eval-stats, --profile-generate, --profile-use=ARQ, --cycle-counters, --buffered-output, --buffered-input, --cache=DIR (ou $COMPILADOR_CACHE), --cache-size=MB, --cache-stats, --scanner=simd\n");
+        return 1;
+    }
+    Cache cache;
+    if (cache_dir && *cache_dir) {
+        if (cache_open(&cache, cache_dir, cache_limit) != 0) return 1;
+        compile_cache = &cache;
+    }
+
+    int status;
+    if (server_path) {
+        status = run_server(server_path);
+    } else if (batch_path) {
+        status = run_batch(batch_path, gen_output_extension(&gen_options), jobs, compile_source_job);
+    } else {
+        status = compile_source(input_path, output_path);
+        if (status == 0) {
+            printf("%s RISC-V gerado em %s\n", gen_options.format == FORMAT_ELF ? "Objeto" : "Código", output_path);
+        }
+    }
+
+    if (compile_cache) {
+        if (show_cache_stats) {
+            cache_print_stats(compile_cache, stderr);
+        }
+        cache_close(compile_cache);
+    }
+    return status;
+}
@@ -0,0 +1,419 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "lexico_simd.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SCANNER_X86 1
+#include <immintrin.h>
+#endif
+
+// Bytes de folga depois do fonte: as leituras em bloco podem passar do fim,
+// mas param no primeiro '\0' da folga
+#define SCANNER_PADDING 64
+
+// Primitivas de varredura; todas devolvem o primeiro byte que não pertence
+// à classe (span_*) ou que está no conjunto (find_any). O '\0' nunca pertence
+// a uma classe e sempre está no conjunto, então a folga encerra a busca
+typedef struct {
+    const char* (*span_space)(const char *p);
+    const char* (*span_ident)(const char *p);
+    const char* (*span_digits)(const char *p);
+    const char* (*find_any)(const char *p, char a, char b, char c);    // a, b, c ou '\0'
+} ScanKernels;
+
+struct SimdScanner {
+    ParserContext *ctx;
+    char *buffer;
+    const char *p;
+    const char *end;
+    const char *token;          // Início do último token
+    const char *counted;        // Até onde as quebras de linha já foram contadas
+    int line;                   // Linha de counted
+    ScannerMode mode;
+    const ScanKernels *kernels;
+};
+
+/* ---------- Versão escalar ---------- */
+
+enum {
+    CLASS_SPACE = 1,
+    CLASS_DIGIT = 2,
+    CLASS_IDENT = 4     // Letras, dígitos e '_'
+};
+
+static unsigned char char_class[256];
+
+static void init_char_class(void) {
+    if (char_class['_']) return;
+    char_class[' '] = char_class['\t'] = char_class['\n'] = char_class['\r'] = CLASS_SPACE;
+    for (int c = '0'; c <= '9'; c++) char_class[c] = CLASS_DIGIT | CLASS_IDENT;
+    for (int c = 'a'; c <= 'z'; c++) char_class[c] = char_class[c - 'a' + 'A'] = CLASS_IDENT;
+    char_class['_'] = CLASS_IDENT;
+}
+
+static const char* span_class_scalar(const char *p, unsigned char class) {
+    while (char_class[(unsigned char)*p] & class) p++;
+    return p;
+}
+
+static const char* span_space_scalar(const char *p) { return span_class_scalar(p, CLASS_SPACE); }
+static const char* span_ident_scalar(const char *p) { return span_class_scalar(p, CLASS_IDENT); }
+static const char* span_digits_scalar(const char *p) { return span_class_scalar(p, CLASS_DIGIT); }
+
+static const char* find_any_scalar(const char *p, char a, char b, char c) {
+    while (*p != a && *p != b && *p != c && *p != '\0') p++;
+    return p;
+}
+
+static const ScanKernels scalar_kernels = {
+    span_space_scalar, span_ident_scalar, span_digits_scalar, find_any_scalar
+};
+
+#ifdef SCANNER_X86
+/* ---------- SSE2: blocos de 16 bytes ---------- */
+
+// Bytes em [lo, hi]: (x - lo) com saturação em hi - lo dá zero só dentro da faixa
+#define IN_RANGE_128(x, lo, hi) \
+    _mm_cmpeq_epi8(_mm_subs_epu8(_mm_sub_epi8((x), _mm_set1_epi8(lo)), _mm_set1_epi8((hi) - (lo))), \
+                   _mm_setzero_si128())
+
+__attribute__((target("sse2")))
+static const char* span_space_sse2(const char *p) {
+    for (;; p += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i *)p);
+        __m128i space = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8(' ')),
+                                                  _mm_cmpeq_epi8(x, _mm_set1_epi8('\t'))),
+                                     _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8('\n')),
+                                                  _mm_cmpeq_epi8(x, _mm_set1_epi8('\r'))));
+        unsigned mask = ~_mm_movemask_epi8(space) & 0xffff;
+        if (mask) return p + __builtin_ctz(mask);
+    }
+}
+
+__attribute__((target("sse2")))
+static const char* span_ident_sse2(const char *p) {
+    for (;; p += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i *)p);
+        __m128i lower = _mm_or_si128(x, _mm_set1_epi8(0x20));
+        __m128i ident = _mm_or_si128(_mm_or_si128(IN_RANGE_128(lower, 'a', 'z'), IN_RANGE_128(x, '0', '9')),
+                                     _mm_cmpeq_epi8(x, _mm_set1_epi8('_')));
+        unsigned mask = ~_mm_movemask_epi8(ident) & 0xffff;
+        if (mask) return p + __builtin_ctz(mask);
+    }
+}
+
+__attribute__((target("sse2")))
+static const char* span_digits_sse2(const char *p) {
+    for (;; p += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i *)p);
+        unsigned mask = ~_mm_movemask_epi8(IN_RANGE_128(x, '0', '9')) & 0xffff;
+        if (mask) return p + __builtin_ctz(mask);
+    }
+}
+
+__attribute__((target("sse2")))
+static const char* find_any_sse2(const char *p, char a, char b, char c) {
+    __m128i va = _mm_set1_epi8(a), vb = _mm_set1_epi8(b), vc = _mm_set1_epi8(c);
+    for (;; p += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i *)p);
+        __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(x, va), _mm_cmpeq_epi8(x, vb)),
+                                   _mm_or_si128(_mm_cmpeq_epi8(x, vc), _mm_cmpeq_epi8(x, _mm_setzero_si128())));
+        unsigned mask = _mm_movemask_epi8(hit);
+        if (mask) return p + __builtin_ctz(mask);
+    }
+}
+
+static const ScanKernels sse2_kernels = {
+    span_space_sse2, span_ident_sse2, span_digits_sse2, find_any_sse2
+};
+
+/* ---------- AVX2: blocos de 32 bytes ---------- */
+
+#define IN_RANGE_256(x, lo, hi) \
+    _mm256_cmpeq_epi8(_mm256_subs_epu8(_mm256_sub_epi8((x), _mm256_set1_epi8(lo)), _mm256_set1_epi8((hi) - (lo))), \
+                      _mm256_setzero_si256())
+
+__attribute__((target("avx2")))
+static const char* span_space_avx2(const char *p) {
+    for (;; p += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)p);
+        __m256i space = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8(' ')),
+                                                        _mm256_cmpeq_epi8(x, _mm256_set1_epi8('\t'))),
+                                        _mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8('\n')),
+                                                        _mm256_cmpeq_epi8(x, _mm256_set1_epi8('\r'))));
+        unsigned mask = ~(unsigned)_mm256_movemask_epi8(space);
+        if (mask) return p + __builtin_ctz(mask);
+    }
+}
+
+__attribute__((target("avx2")))
+static const char* span_ident_avx2(const char *p) {
+    for (;; p += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)p);
+        __m256i lower = _mm256_or_si256(x, _mm256_set1_epi8(0x20));
+        __m256i ident = _mm256_or_si256(_mm256_or_si256(IN_RANGE_256(lower, 'a', 'z'), IN_RANGE_256(x, '0', '9')),
+                                        _mm256_cmpeq_epi8(x, _mm256_set1_epi8('_')));
+        unsigned mask = ~(unsigned)_mm256_movemask_epi8(ident);
+        if (mask) return p + __builtin_ctz(mask);
+    }
+}
+
+__attribute__((target("avx2")))
+static const char* span_digits_avx2(const char *p) {
+    for (;; p += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)p);
+        unsigned mask = ~(unsigned)_mm256_movemask_epi8(IN_RANGE_256(x, '0', '9'));
+        if (mask) return p + __builtin_ctz(mask);
+    }
+}
+
+__attribute__((target("avx2")))
+static const char* find_any_avx2(const char *p, char a, char b, char c) {
+    __m256i va = _mm256_set1_epi8(a), vb = _mm256_set1_epi8(b), vc = _mm256_set1_epi8(c);
+    for (;; p += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)p);
+        __m256i hit = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(x, va), _mm256_cmpeq_epi8(x, vb)),
+                                      _mm256_or_si256(_mm256_cmpeq_epi8(x, vc),
+                                                      _mm256_cmpeq_epi8(x, _mm256_setzero_si256())));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(hit);
+        if (mask) return p + __builtin_ctz(mask);
+    }
+}
+
+static const ScanKernels avx2_kernels = {
+    span_space_avx2, span_ident_avx2, span_digits_avx2, find_any_avx2
+};
+#endif
+
+/* ---------- Escolha do modo ---------- */
+
+const char* scanner_mode_name(ScannerMode mode) {
+    switch (mode) {
+        case SCANNER_SCALAR: return "escalar";
+        case SCANNER_SSE2: return "sse2";
+        case SCANNER_AVX2: return "avx2";
+        default: return "auto";
+    }
+}
+
+static const ScanKernels* kernels_for(ScannerMode *mode) {
+#ifdef SCANNER_X86
+    __builtin_cpu_init();
+    bool has_avx2 = __builtin_cpu_supports("avx2");
+    bool has_sse2 = __builtin_cpu_supports("sse2");
+    if (*mode == SCANNER_AUTO) {
+        *mode = has_avx2 ? SCANNER_AVX2 : has_sse2 ? SCANNER_SSE2 : SCANNER_SCALAR;
+    }
+    if (*mode == SCANNER_AVX2) return has_avx2 ? &avx2_kernels : NULL;
+    if (*mode == SCANNER_SSE2) return has_sse2 ? &sse2_kernels : NULL;
+#else
+    if (*mode == SCANNER_AUTO) *mode = SCANNER_SCALAR;
+    if (*mode != SCANNER_SCALAR) return NULL;
+#endif
+    return &scalar_kernels;
+}
+
+SimdScanner* simd_scanner_create(ParserContext *ctx, const char *source, size_t length, ScannerMode mode) {
+    const ScanKernels *kernels = kernels_for(&mode);
+    if (!kernels) return NULL;
+    init_char_class();
+
+    SimdScanner *scanner = malloc(sizeof(SimdScanner));
+    char *buffer = calloc(length + SCANNER_PADDING, 1);
+    if (!scanner || !buffer) {
+        perror("Erro ao criar o analisador lexico");
+        exit(1);
+    }
+    memcpy(buffer, source, length);
+    scanner->buffer = buffer;
+    scanner->ctx = ctx;
+    scanner->p = scanner->buffer;
+    scanner->end = scanner->buffer + length;
+    scanner->token = scanner->buffer;
+    scanner->counted = scanner->buffer;
+    scanner->line = 1;
+    scanner->mode = mode;
+    scanner->kernels = kernels;
+    return scanner;
+}
+
+void simd_scanner_destroy(SimdScanner *scanner) {
+    if (!scanner) return;
+    free(scanner->buffer);
+    free(scanner);
+}
+
+ScannerMode simd_scanner_mode(const SimdScanner *scanner) {
+    return scanner->mode;
+}
+
+/* ---------- Tokens ---------- */
+
+typedef struct {
+    const char *name;
+    int token;
+} Keyword;
+
+// As mesmas palavras reservadas de lexico_c_v2.l
+static const Keyword keywords[] = {
+    { "auto", AUTO_KW }, { "break", BREAK_KW }, { "case", CASE_KW }, { "char", CHAR_KW },
+    { "const", CONST_KW }, { "continue", CONTINUE_KW }, { "default", DEFAULT_KW }, { "do", DO_KW },
+    { "double", DOUBLE_KW }, { "else", ELSE_KW }, { "enum", ENUM_KW }, { "extern", EXTERN_KW },
+    { "float", FLOAT_KW }, { "for", FOR_KW }, { "goto", GOTO_KW }, { "if", IF_KW },
+    { "inline", INLINE_KW }, { "int", INT_KW }, { "long", LONG_KW }, { "register", REGISTER_KW },
+    { "restrict", RESTRICT_KW }, { "return", RETURN_KW }, { "short", SHORT_KW }, { "signed", SIGNED_KW },
+    { "sizeof", SIZEOF_KW }, { "static", STATIC_KW }, { "struct", STRUCT_KW }, { "switch", SWITCH_KW },
+    { "typedef", TYPEDEF_KW }, { "union", UNION_KW }, { "unsigned", UNSIGNED_KW }, { "void", VOID_KW },
+    { "volatile", VOLATILE_KW }, { "while", WHILE_KW }, { "_Bool", BOOL_KW }, { "_Complex", COMPLEX_KW },
+    { "_Imaginary", IMAGINARY_KW }, { "printf", PRINT_KW }, { "scanf", SCAN_KW },
+};
+
+static int keyword_token(const char *text, size_t length) {
+    if (length < 2 || length > 10) return 0;
+    for (size_t i = 0; i < sizeof(keywords) / sizeof(keywords[0]); i++) {
+        const char *name = keywords[i].name;
+        if (name[0] == text[0] && strlen(name) == length && memcmp(name, text, length) == 0) {
+            return keywords[i].token;
+        }
+    }
+    return 0;
+}
+
+static int token_with_text(YYSTYPE *value, const char *start, const char *end, int token) {
+    value->str = strndup(start, end - start);
+    return token;
+}
+
+// FLOAT: [0-9]+\.[0-9]*([eE][-+]?[0-9]+)? | [0-9]+[eE][-+]?[0-9]+ ; INT: [0-9]+
+static int scan_number(SimdScanner *scanner, YYSTYPE *value, const char *start) {
+    const ScanKernels *k = scanner->kernels;
+    const char *p = k->span_digits(start);
+    bool is_float = false;
+    if (*p == '.') {
+        p = k->span_digits(p + 1);
+        is_float = true;
+    }
+    if (*p == 'e' || *p == 'E') {
+        const char *exponent = p + 1;
+        if (*exponent == '+' || *exponent == '-') exponent++;
+        if (*exponent >= '0' && *exponent <= '9') {
+            p = k->span_digits(exponent);
+            is_float = true;
+        }
+    }
+    scanner->p = p;
+    return token_with_text(value, start, p, is_float ? FLOAT : INT);
+}
+
+// STRING/CHAR: aspas, caracteres ou escapes (\x) sem quebra de linha, aspas.
+// Sem o fechamento, a aspa vira um caractere desconhecido, como no flex
+static int scan_quoted(SimdScanner *scanner, YYSTYPE *value, const char *start) {
+    const char *p = start + 1;
+    for (;;) {
+        p = scanner->kernels->find_any(p, *start, '\\', '\n');
+        if (*p == *start) {
+            scanner->p = p + 1;
+            return token_with_text(value, start, p + 1, *start == '"' ? STRING : CHAR);
+        }
+        if (*p == '\\' && p[1] != '\n' && p + 1 < scanner->end) {
+            p += 2;
+        } else if (*p == '\0' && p < scanner->end) {
+            p++;
+        } else {
+            return -1;
+        }
+    }
+}
+
+// Pula o comentário /* ... */ que começa em p; false se não termina
+static bool skip_block_comment(SimdScanner *scanner, const char *p) {
+    for (p += 2; ; p++) {
+        p = scanner->kernels->find_any(p, '*', '*', '*');
+        if (p >= scanner->end) return false;
+        if (p[0] == '*' && p[1] == '/') {
+            scanner->p = p + 2;
+            return true;
+        }
+    }
+}
+
+int simd_scanner_next(SimdScanner *scanner, YYSTYPE *value) {
+    const ScanKernels *k = scanner->kernels;
+    for (;;) {
+        const char *p = k->span_space(scanner->p);
+        if (p >= scanner->end) {
+            scanner->p = scanner->end;
+            scanner->token = scanner->end;
+            return 0;
+        }
+        scanner->token = p;
+        unsigned char c = *p;
+
+        if (char_class[c] & CLASS_DIGIT) return scan_number(scanner, value, p);
+        if (char_class[c] & CLASS_IDENT) {
+            const char *end = k->span_ident(p);
+            scanner->p = end;
+            int token = keyword_token(p, end - p);
+            return token ? token : token_with_text(value, p, end, ID);
+        }
+
+        scanner->p = p + 1;
+        switch (c) {
+            case '/':
+                if (p[1] == '/') {
+                    // Comentário de linha: até o '\n' (um '\0' no meio do fonte não encerra)
+                    const char *q = p + 2;
+                    while ((q = k->find_any(q, '\n', '\n', '\n')) < scanner->end && *q == '\0') q++;
+                    scanner->p = q;
+                    continue;
+                }
+                if (p[1] == '*') {
+                    if (skip_block_comment(scanner, p)) continue;
+                    fprintf(stderr, "Erro léxico: comentário de múltiplas linhas não terminado\n");
+                    scanner->ctx->lexicalError = 1;
+                    scanner->p = scanner->end;
+                    return 0;
+                }
+                return '/';
+            case '"':
+            case '\'': {
+                int token = scan_quoted(scanner, value, p);
+                if (token >= 0) return token;
+                break;
+            }
+            case '<':
+            case '>':
+                scanner->p = p + (p[1] == '=' ? 2 : 1);
+                return token_with_text(value, p, scanner->p, OPERADOR);
+            case '=':
+            case '!':
+                if (p[1] != '=') return c;
+                scanner->p = p + 2;
+                return token_with_text(value, p, scanner->p, OPERADOR);
+            case '&':
+            case '|':
+                if (p[1] != c) return c;
+                scanner->p = p + 2;
+                return c == '&' ? E_LOGICO : OU_LOGICO;
+            case '+': case '-': case '*': case '%': case '^': case '~':
+            case '?': case ':': case ';': case ',': case '.': case '(': case ')': case '{':
+            case '}': case '[': case ']':
+                return c;
+        }
+        fprintf(scanner->ctx->out, ":-(\n");
+    }
+}
+
+// As linhas são contadas só quando pedidas, do ponto da última contagem até
+// o token, com o memchr; o laço de tokens não olha para as quebras de linha
+int simd_scanner_line(SimdScanner *scanner) {
+    const char *p = scanner->counted;
+    while ((p = memchr(p, '\n', scanner->token - p)) != NULL) {
+        scanner->line++;
+        p++;
+    }
+    scanner->counted = scanner->token;
+    return scanner->line;
+}
@@ -0,0 +1,34 @@
+#ifndef LEXICO_SIMD_H
+#define LEXICO_SIMD_H
+
+#include <stddef.h>
+#include "sintatico_v3.tab.h"
+
+// Léxico escrito à mão, alternativo ao do flex (lexico_c_v2.l): lê o fonte
+// como está no arquivo, sem passar por formatSource, e pula espaços e
+// comentários e acha o fim de identificadores e números em blocos de 16
+// (SSE2) ou 32 (AVX2) bytes. Entrega ao bison os mesmos tokens do flex
+
+typedef enum {
+    SCANNER_AUTO,       // O melhor que a CPU suporta
+    SCANNER_SCALAR,     // Um byte por vez, em qualquer arquitetura
+    SCANNER_SSE2,
+    SCANNER_AVX2
+} ScannerMode;
+
+typedef struct SimdScanner SimdScanner;
+
+// Copia o fonte (com folga para as leituras em bloco); NULL se o modo pedido
+// não é suportado nesta CPU
+SimdScanner* simd_scanner_create(ParserContext *ctx, const char *source, size_t length, ScannerMode mode);
+void simd_scanner_destroy(SimdScanner *scanner);
+
+// Próximo token, como o yylex do flex (0 no fim da entrada)
+int simd_scanner_next(SimdScanner *scanner, YYSTYPE *value);
+// Linha do fonte (a partir de 1) do último token devolvido
+int simd_scanner_line(SimdScanner *scanner);
+
+ScannerMode simd_scanner_mode(const SimdScanner *scanner);
+const char* scanner_mode_name(ScannerMode mode);
+
+#endif
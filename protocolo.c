@@ -0,0 +1,208 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include "protocolo.h"
+
+// $COMPILADOR_SOCKET ou /tmp/compilador-<uid>.sock
+const char* protocol_default_socket(void) {
+    static char path[108];
+    const char *env = getenv("COMPILADOR_SOCKET");
+    if (env && *env) return env;
+    snprintf(path, sizeof(path), "/tmp/compilador-%ld.sock", (long)getuid());
+    return path;
+}
+
+static int fill_address(struct sockaddr_un *address, const char *socket_path) {
+    memset(address, 0, sizeof(*address));
+    address->sun_family = AF_UNIX;
+    if (strlen(socket_path) >= sizeof(address->sun_path)) {
+        fprintf(stderr, "Caminho do socket muito longo: %s\n", socket_path);
+        return 1;
+    }
+    strcpy(address->sun_path, socket_path);
+    return 0;
+}
+
+int protocol_listen(const char *socket_path) {
+    struct sockaddr_un address;
+    if (fill_address(&address, socket_path) != 0) return -1;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("Erro ao criar o socket");
+        return -1;
+    }
+
+    // Remove um socket antigo que tenha sobrado de um servidor encerrado,
+    // mas nunca um arquivo comum que por engano esteja no caminho
+    struct stat info;
+    if (lstat(socket_path, &info) == 0) {
+        if (!S_ISSOCK(info.st_mode)) {
+            fprintf(stderr, "%s existe e não é um socket; não será removido\n", socket_path);
+            close(fd);
+            return -1;
+        }
+        unlink(socket_path);
+    } else if (errno != ENOENT) {
+        fprintf(stderr, "Erro ao verificar %s: %s\n", socket_path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    if (bind(fd, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(fd, 64) != 0) {
+        fprintf(stderr, "Erro ao abrir o socket %s: %s\n", socket_path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int protocol_connect(const char *socket_path) {
+    struct sockaddr_un address;
+    if (fill_address(&address, socket_path) != 0) return -1;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, (struct sockaddr *)&address, sizeof(address)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int read_exact(int fd, void *buffer, size_t length) {
+    char *bytes = buffer;
+    while (length > 0) {
+        ssize_t n = recv(fd, bytes, length, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return 1;
+        bytes += n;
+        length -= n;
+    }
+    return 0;
+}
+
+static int write_exact(int fd, const void *buffer, size_t length) {
+    const char *bytes = buffer;
+    while (length > 0) {
+        ssize_t n = send(fd, bytes, length, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return 1;
+        bytes += n;
+        length -= n;
+    }
+    return 0;
+}
+
+// Lê a linha de cabeçalho: espia o socket até achar o '\n' e consome só a linha
+static int read_header(int fd, char *header) {
+    for (;;) {
+        ssize_t n = recv(fd, header, PROTOCOL_HEADER_MAX - 1, MSG_PEEK);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return 1;
+
+        char *newline = memchr(header, '\n', n);
+        if (newline) {
+            size_t line_length = newline - header + 1;
+            if (read_exact(fd, header, line_length) != 0) return 1;
+            header[line_length - 1] = '\0';
+            return 0;
+        }
+        if (n == PROTOCOL_HEADER_MAX - 1) return 1;  // cabeçalho grande demais
+
+        // Linha ainda incompleta: espera chegar mais dados
+        char byte;
+        if (read_exact(fd, &byte, 1) != 0) return 1;
+        header[0] = byte;
+        size_t used = 1;
+        while (byte != '\n' && used < PROTOCOL_HEADER_MAX - 1) {
+            if (read_exact(fd, &byte, 1) != 0) return 1;
+            header[used++] = byte;
+        }
+        if (byte != '\n') return 1;
+        header[used - 1] = '\0';
+        return 0;
+    }
+}
+
+static char* read_payload(int fd, size_t length) {
+    // Recusa o tamanho antes de alocar: um cabeçalho malicioso não força um malloc gigante
+    if (length > PROTOCOL_PAYLOAD_MAX) {
+        fprintf(stderr, "Tamanho de dados recusado: %zu bytes (máximo %u)\n",
+                length, PROTOCOL_PAYLOAD_MAX);
+        return NULL;
+    }
+    char *data = malloc(length + 1);
+    if (!data) return NULL;
+    if (read_exact(fd, data, length) != 0) {
+        free(data);
+        return NULL;
+    }
+    data[length] = '\0';
+    return data;
+}
+
+int protocol_read_request(int fd, ProtocolRequest *request) {
+    char header[PROTOCOL_HEADER_MAX];
+    size_t length;
+    int name_start = 0;
+
+    if (read_header(fd, header) != 0) return 1;
+    if (sscanf(header, "COMPILAR %zu %n", &length, &name_start) != 1 || name_start == 0) return 1;
+
+    snprintf(request->name, sizeof(request->name), "%s", header + name_start);
+    request->source_length = length;
+    request->source = read_payload(fd, length);
+    return request->source ? 0 : 1;
+}
+
+int protocol_write_request(int fd, const char *name, const char *source, size_t length) {
+    char header[PROTOCOL_HEADER_MAX];
+    if (length > PROTOCOL_PAYLOAD_MAX) {
+        fprintf(stderr, "Fonte grande demais para o servidor: %zu bytes (máximo %u)\n",
+                length, PROTOCOL_PAYLOAD_MAX);
+        return 1;
+    }
+    int header_length = snprintf(header, sizeof(header), "COMPILAR %zu %s\n", length, name);
+    if (header_length < 0 || header_length >= (int)sizeof(header)) return 1;
+    return write_exact(fd, header, header_length) || write_exact(fd, source, length);
+}
+
+void protocol_free_request(ProtocolRequest *request) {
+    free(request->source);
+    request->source = NULL;
+}
+
+int protocol_read_response(int fd, ProtocolResponse *response) {
+    char header[PROTOCOL_HEADER_MAX];
+    memset(response, 0, sizeof(*response));
+
+    if (read_header(fd, header) != 0) return 1;
+    if (sscanf(header, "RESULTADO %d %zu %zu", &response->status,
+               &response->assembly_length, &response->diagnostics_length) != 3) return 1;
+
+    response->assembly = read_payload(fd, response->assembly_length);
+    response->diagnostics = read_payload(fd, response->diagnostics_length);
+    return response->assembly && response->diagnostics ? 0 : 1;
+}
+
+int protocol_write_response(int fd, int status, const char *assembly, size_t assembly_length,
+                            const char *diagnostics, size_t diagnostics_length) {
+    char header[128];
+    int header_length = snprintf(header, sizeof(header), "RESULTADO %d %zu %zu\n",
+                                 status, assembly_length, diagnostics_length);
+    return write_exact(fd, header, header_length) ||
+           write_exact(fd, assembly, assembly_length) ||
+           write_exact(fd, diagnostics, diagnostics_length);
+}
+
+void protocol_free_response(ProtocolResponse *response) {
+    free(response->assembly);
+    free(response->diagnostics);
+    response->assembly = NULL;
+    response->diagnostics = NULL;
+}
@@ -0,0 +1,41 @@
+#ifndef PROTOCOLO_H
+#define PROTOCOLO_H
+
+#include <stddef.h>
+
+// Protocolo entre cliente.exe e compilador.exe --server (socket UNIX):
+//   pedido:   "COMPILAR <tamanho> <nome>\n" seguido dos bytes do fonte
+//   resposta: "RESULTADO <status> <tamanho .s> <tamanho mensagens>\n"
+//             seguido do .s e das mensagens do compilador
+#define PROTOCOL_HEADER_MAX 4096
+// Maior fonte/.s/mensagem aceito: o tamanho vem do outro lado do socket
+#define PROTOCOL_PAYLOAD_MAX (64u * 1024 * 1024)
+
+typedef struct {
+    char name[PROTOCOL_HEADER_MAX];
+    char *source;
+    size_t source_length;
+} ProtocolRequest;
+
+typedef struct {
+    int status;
+    char *assembly;
+    size_t assembly_length;
+    char *diagnostics;
+    size_t diagnostics_length;
+} ProtocolResponse;
+
+const char* protocol_default_socket(void);
+int protocol_listen(const char *socket_path);
+int protocol_connect(const char *socket_path);
+
+int protocol_read_request(int fd, ProtocolRequest *request);
+int protocol_write_request(int fd, const char *name, const char *source, size_t length);
+void protocol_free_request(ProtocolRequest *request);
+
+int protocol_read_response(int fd, ProtocolResponse *response);
+int protocol_write_response(int fd, int status, const char *assembly, size_t assembly_length,
+                            const char *diagnostics, size_t diagnostics_length);
+void protocol_free_response(ProtocolResponse *response);
+
+#endif
@@ -0,0 +1,384 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "riscv_sim.h"
+
+// Suíte de regressão: executa no simulador o .s de cada programa de testes/
+// e compara saída, instruções executadas e acessos à memória com a linha de
+// base gravada. Falha se algum programa ficou errado ou mais lento.
+//   ./regressao.exe --dir=DIR [--baseline=testes/regressao.base] [--update] programa...
+// Cada programa é um nome relativo a testes/ sem o .txt (ex.: gerador/aritmetica);
+// o gerador atual está em DIR/<programa>.s e o riscv_gen2_otimizado.c, se houver,
+// em DIR/<programa>.gen2.s. A linha de base tem uma linha por programa:
+//   <programa> <instruções> <loads> <stores> "<entrada>" "<saída esperada>"
+// A entrada de um programa novo começa vazia; pode ser editada à mão e o
+// --update a preserva. Cada --variante=NOME confere também a saída de
+// DIR/<programa>.NOME.s (o mesmo programa gerado com outras opções, como -O0
+// ou -O2) contra a saída esperada, sem comparar o custo
+
+#define DEFAULT_BASELINE "testes/regressao.base"
+#define MAX_VARIANTS 16
+
+typedef struct {
+    char *name;
+    long instructions;
+    long loads;
+    long stores;
+    char *input;
+    char *output;
+} BaselineEntry;
+
+typedef struct {
+    BaselineEntry *entries;
+    int count;
+    int capacity;
+} Baseline;
+
+typedef enum {
+    RUN_OK,
+    RUN_MISSING,        // Não há o .s
+    RUN_FAILED          // Erro de montagem ou de execução
+} RunStatus;
+
+typedef struct {
+    RunStatus status;
+    SimStats stats;
+    char *output;
+    char error[256];
+} RunResult;
+
+/* ---------- Linha de base ---------- */
+
+static void write_escaped(FILE *out, const char *text) {
+    fputc('"', out);
+    for (const unsigned char *p = (const unsigned char *)text; *p; p++) {
+        switch (*p) {
+            case '\n': fputs("\\n", out); break;
+            case '\t': fputs("\\t", out); break;
+            case '"': fputs("\\\"", out); break;
+            case '\\': fputs("\\\\", out); break;
+            default:
+                if (*p < ' ') fprintf(out, "\\x%02x", *p);
+                else fputc(*p, out);
+        }
+    }
+    fputc('"', out);
+}
+
+// Lê uma string entre aspas com escapes; NULL se mal formada
+static char* read_escaped(const char **cursor) {
+    const char *p = *cursor;
+    while (*p == ' ' || *p == '\t') p++;
+    if (*p++ != '"') return NULL;
+
+    char *text = malloc(strlen(p) + 1);
+    size_t length = 0;
+    for (; *p && *p != '"'; p++) {
+        if (*p != '\\') {
+            text[length++] = *p;
+            continue;
+        }
+        p++;
+        switch (*p) {
+            case 'n': text[length++] = '\n'; break;
+            case 't': text[length++] = '\t'; break;
+            case 'x': {
+                unsigned value;
+                if (sscanf(p + 1, "%2x", &value) != 1) {
+                    free(text);
+                    return NULL;
+                }
+                text[length++] = (char)value;
+                p += 2;
+                break;
+            }
+            case '"':
+            case '\\': text[length++] = *p; break;
+            default:
+                free(text);
+                return NULL;
+        }
+    }
+    if (*p != '"') {
+        free(text);
+        return NULL;
+    }
+    text[length] = '\0';
+    *cursor = p + 1;
+    return text;
+}
+
+static BaselineEntry* baseline_find(Baseline *baseline, const char *name) {
+    for (int i = 0; i < baseline->count; i++) {
+        if (strcmp(baseline->entries[i].name, name) == 0) return &baseline->entries[i];
+    }
+    return NULL;
+}
+
+static BaselineEntry* baseline_add(Baseline *baseline, const char *name) {
+    if (baseline->count == baseline->capacity) {
+        baseline->capacity = baseline->capacity ? baseline->capacity * 2 : 32;
+        baseline->entries = realloc(baseline->entries, baseline->capacity * sizeof(BaselineEntry));
+    }
+    BaselineEntry *entry = &baseline->entries[baseline->count++];
+    memset(entry, 0, sizeof(BaselineEntry));
+    entry->name = strdup(name);
+    entry->input = strdup("");
+    entry->output = strdup("");
+    return entry;
+}
+
+// Um arquivo que ainda não existe é uma linha de base vazia
+int baseline_load(Baseline *baseline, const char *path) {
+    memset(baseline, 0, sizeof(Baseline));
+    size_t length;
+    char *data = sim_read_file(path, &length);
+    if (!data) return 0;
+
+    int line_number = 0;
+    for (char *line = data; *line; ) {
+        char *end = strchr(line, '\n');
+        if (end) *end = '\0';
+        line_number++;
+
+        char name[256];
+        long instructions, loads, stores;
+        int consumed;
+        if (line[0] != '#' && line[0] != '\0') {
+            if (sscanf(line, "%255s %ld %ld %ld%n", name, &instructions, &loads, &stores, &consumed) != 4) {
+                fprintf(stderr, "Erro: %s:%d: linha de base mal formada\n", path, line_number);
+                free(data);
+                return 1;
+            }
+            const char *cursor = line + consumed;
+            char *input = read_escaped(&cursor);
+            char *output = input ? read_escaped(&cursor) : NULL;
+            if (!output) {
+                fprintf(stderr, "Erro: %s:%d: entrada ou saída mal formada\n", path, line_number);
+                free(input);
+                free(data);
+                return 1;
+            }
+            BaselineEntry *entry = baseline_add(baseline, name);
+            entry->instructions = instructions;
+            entry->loads = loads;
+            entry->stores = stores;
+            free(entry->input);
+            free(entry->output);
+            entry->input = input;
+            entry->output = output;
+        }
+        if (!end) break;
+        line = end + 1;
+    }
+    free(data);
+    return 0;
+}
+
+int baseline_save(const Baseline *baseline, const char *path) {
+    FILE *out = fopen(path, "w");
+    if (!out) {
+        fprintf(stderr, "Erro ao criar %s\n", path);
+        return 1;
+    }
+    fprintf(out, "# Linha de base da suíte de regressão (make regressao; make regressao REGRESSAO_FLAGS=--update)\n");
+    fprintf(out, "# <programa> <instruções> <loads> <stores> \"<entrada>\" \"<saída esperada>\"\n");
+    for (int i = 0; i < baseline->count; i++) {
+        const BaselineEntry *entry = &baseline->entries[i];
+        fprintf(out, "%s %ld %ld %ld ", entry->name, entry->instructions, entry->loads, entry->stores);
+        write_escaped(out, entry->input);
+        fputc(' ', out);
+        write_escaped(out, entry->output);
+        fputc('\n', out);
+    }
+    fclose(out);
+    return 0;
+}
+
+void baseline_free(Baseline *baseline) {
+    for (int i = 0; i < baseline->count; i++) {
+        free(baseline->entries[i].name);
+        free(baseline->entries[i].input);
+        free(baseline->entries[i].output);
+    }
+    free(baseline->entries);
+}
+
+/* ---------- Execução ---------- */
+
+RunResult run_program(const char *path, const char *input) {
+    RunResult result;
+    memset(&result, 0, sizeof(result));
+
+    size_t length;
+    char *text = sim_read_file(path, &length);
+    if (!text) {
+        result.status = RUN_MISSING;
+        snprintf(result.error, sizeof(result.error), "%s não encontrado", path);
+        return result;
+    }
+
+    SimMachine machine;
+    sim_init(&machine, input, strlen(input));
+    int status = sim_load_assembly(&machine, text, length);
+    if (status == 0) status = sim_run(&machine);
+
+    result.status = status == 0 ? RUN_OK : RUN_FAILED;
+    result.stats = machine.stats;
+    result.output = strdup(machine.output ? machine.output : "");
+    snprintf(result.error, sizeof(result.error), "%s", machine.error);
+    sim_free(&machine);
+    free(text);
+    return result;
+}
+
+static const char* output_status(const RunResult *result, const char *expected) {
+    if (result->status == RUN_MISSING) return "-";
+    if (result->status == RUN_FAILED) return "erro";
+    return strcmp(result->output, expected) == 0 ? "ok" : "errada";
+}
+
+int main(int argc, char **argv) {
+    const char *baseline_path = DEFAULT_BASELINE;
+    const char *dir = NULL;
+    bool update = false;
+    int first_program = argc;
+    const char *variants[MAX_VARIANTS];
+    int variant_count = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--baseline=", 11) == 0) {
+            baseline_path = argv[i] + 11;
+        } else if (strncmp(argv[i], "--dir=", 6) == 0) {
+            dir = argv[i] + 6;
+        } else if (strcmp(argv[i], "--update") == 0) {
+            update = true;
+        } else if (strncmp(argv[i], "--variante=", 11) == 0 && variant_count < MAX_VARIANTS) {
+            variants[variant_count++] = argv[i] + 11;
+        } else if (argv[i][0] == '-') {
+            fprintf(stderr, "Opção desconhecida: %s\n", argv[i]);
+            return 1;
+        } else {
+            first_program = i;
+            break;
+        }
+    }
+    if (!dir || first_program == argc) {
+        printf("Uso: %s --dir=DIR [--baseline=%s] [--update] [--variante=NOME]... programa...\n",
+               argv[0], DEFAULT_BASELINE);
+        return 1;
+    }
+
+    Baseline baseline;
+    if (baseline_load(&baseline, baseline_path) != 0) return 1;
+
+    printf("%-26s | %-27s | %-27s | %s\n", "", "riscv_gen3.c", "riscv_gen2_otimizado.c", "");
+    printf("%-26s | %9s %9s %-8s | %9s %9s %-8s | %s\n", "programa",
+           "instr", "mem", "saída", "instr", "mem", "saída", "situação");
+
+    long totals[4] = { 0, 0, 0, 0 };    // instruções e acessos do gen3 e do gen2
+    int failures = 0;
+    char path[1024];
+
+    for (int i = first_program; i < argc; i++) {
+        const char *name = argv[i];
+        BaselineEntry *entry = baseline_find(&baseline, name);
+        bool is_new = entry == NULL;
+        if (is_new) entry = baseline_add(&baseline, name);
+
+        snprintf(path, sizeof(path), "%s/%s.s", dir, name);
+        RunResult current = run_program(path, entry->input);
+        snprintf(path, sizeof(path), "%s/%s.gen2.s", dir, name);
+        RunResult legacy = run_program(path, entry->input);
+
+        long memory = current.stats.loads + current.stats.stores;
+        long legacy_memory = legacy.stats.loads + legacy.stats.stores;
+        long baseline_memory = entry->loads + entry->stores;
+        const char *situation;
+        bool failed = false;
+
+        if (current.status != RUN_OK) {
+            situation = current.error;
+            failed = true;
+        } else if (update) {
+            situation = is_new ? "novo" : "atualizado";
+            entry->instructions = current.stats.instructions;
+            entry->loads = current.stats.loads;
+            entry->stores = current.stats.stores;
+            free(entry->output);
+            entry->output = strdup(current.output);
+        } else if (is_new) {
+            situation = "sem linha de base (use --update)";
+        } else if (strcmp(current.output, entry->output) != 0) {
+            situation = "SAÍDA ERRADA";
+            failed = true;
+        } else if (current.stats.instructions > entry->instructions) {
+            situation = "MAIS LENTO";
+            failed = true;
+        } else if (memory > baseline_memory) {
+            situation = "MAIS ACESSOS À MEMÓRIA";
+            failed = true;
+        } else if (current.stats.instructions < entry->instructions || memory < baseline_memory) {
+            situation = "melhor";
+        } else {
+            situation = "ok";
+        }
+        // Variantes: só a saída conta, e ela tem que ser a mesma do gerador padrão
+        char variant_failures[256] = "";
+        for (int v = 0; v < variant_count && current.status == RUN_OK; v++) {
+            snprintf(path, sizeof(path), "%s/%s.%s.s", dir, name, variants[v]);
+            RunResult variant = run_program(path, entry->input);
+            const char *expected = update || is_new ? current.output : entry->output;
+            if (variant.status != RUN_OK || strcmp(variant.output, expected) != 0) {
+                size_t used = strlen(variant_failures);
+                snprintf(variant_failures + used, sizeof(variant_failures) - used, " %s", variants[v]);
+            }
+            free(variant.output);
+        }
+        if (variant_failures[0] && !failed) {
+            situation = "SAÍDA ERRADA NA VARIANTE";
+            failed = true;
+        }
+        if (failed) failures++;
+
+        char legacy_instructions[24] = "-", legacy_accesses[24] = "-";
+        if (legacy.status == RUN_OK) {
+            snprintf(legacy_instructions, sizeof(legacy_instructions), "%ld", legacy.stats.instructions);
+            snprintf(legacy_accesses, sizeof(legacy_accesses), "%ld", legacy_memory);
+            totals[2] += legacy.stats.instructions;
+            totals[3] += legacy_memory;
+        }
+        totals[0] += current.stats.instructions;
+        totals[1] += memory;
+
+        printf("%-26s | %9ld %9ld %-7s | %9s %9s %-7s | ", name, current.stats.instructions, memory,
+               output_status(&current, entry->output), legacy_instructions, legacy_accesses,
+               output_status(&legacy, entry->output));
+        if (variant_failures[0]) {
+            printf("%s:%s\n", situation, variant_failures);
+        } else if (!failed || current.status != RUN_OK) {
+            printf("%s\n", situation);
+        } else {
+            printf("%s (linha de base: %ld instr, %ld mem)\n", situation, entry->instructions, baseline_memory);
+        }
+
+        free(current.output);
+        free(legacy.output);
+    }
+
+    printf("%-26s | %9ld %9ld %-7s | %9ld %9ld %-7s |\n", "total", totals[0], totals[1], "",
+           totals[2], totals[3], "");
+
+    int status = 0;
+    if (update) {
+        status = baseline_save(&baseline, baseline_path);
+        if (status == 0) printf("Linha de base gravada em %s\n", baseline_path);
+    }
+    if (failures) {
+        printf("%d programa(s) com regressão\n", failures);
+        status = 1;
+    }
+    baseline_free(&baseline);
+    return status;
+}
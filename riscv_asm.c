@@ -0,0 +1,1488 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdarg.h>
+#include <pthread.h>
+#include <elf.h>
+#include "riscv_asm.h"
+
+#define MAX_OPERANDS 4
+#define SYMBOL_INITIAL_BUCKETS 256      // Potência de 2; cresce sob demanda
+#define MNEMONIC_BUCKETS 256
+
+const char *const asm_section_names[SECTION_COUNT] = { ".text", ".rodata", ".data", ".bss" };
+
+typedef enum {
+    FMT_R,          // rd, rs1, rs2
+    FMT_I,          // rd, rs1, imm12
+    FMT_SHIFT,      // rd, rs1, shamt
+    FMT_LOAD,       // rd, imm(rs1)
+    FMT_STORE,      // rs2, imm(rs1)
+    FMT_BRANCH,     // rs1, rs2, rótulo
+    FMT_U,          // rd, imm20
+    FMT_JAL,        // rd, rótulo
+    FMT_JALR,       // rd, imm(rs1)
+    FMT_FIXED,      // ecall/ebreak: a palavra inteira está em "opcode"
+    FMT_CSR,        // rd, csr, rs1
+    FMT_FP,         // fd, fs1, fs2 [, rm]
+    FMT_FP_UNARY,   // fcvt/fmv/fsqrt: fd, fs1 [, rm]; o campo rs2 vem de "extra"
+    PSEUDO_LI,
+    PSEUDO_LA,
+    PSEUDO_CALL,
+    PSEUDO_TAIL,
+    PSEUDO_ALIAS    // Reescrita 1:1 para uma instrução real (mv, beqz, ret, ...)
+} Format;
+
+// Operandos esperados: r = registrador inteiro, f = registrador FP,
+// i = imediato, l = rótulo, m = imm(reg), c = CSR, R = arredondamento (opcional).
+// Nos aliases, "real" é a instrução de destino e "layout" diz de onde vem cada
+// operando dela: '0'..'2' = operando do alias, z = x0, a = ra, k = "extra",
+// p = 0(operando 0), q = 0(ra)
+typedef struct {
+    const char *name;
+    Format format;
+    const char *operands;
+    uint32_t opcode;
+    int funct3;             // -1 nas instruções FP = modo de arredondamento
+    int funct7;
+    int extra;
+    const char *real;
+    const char *layout;
+} Mnemonic;
+
+static const Mnemonic mnemonics[] = {
+    // RV32I
+    { "add",    FMT_R,     "rrr", 0x33, 0, 0x00 },
+    { "sub",    FMT_R,     "rrr", 0x33, 0, 0x20 },
+    { "sll",    FMT_R,     "rrr", 0x33, 1, 0x00 },
+    { "slt",    FMT_R,     "rrr", 0x33, 2, 0x00 },
+    { "sltu",   FMT_R,     "rrr", 0x33, 3, 0x00 },
+    { "xor",    FMT_R,     "rrr", 0x33, 4, 0x00 },
+    { "srl",    FMT_R,     "rrr", 0x33, 5, 0x00 },
+    { "sra",    FMT_R,     "rrr", 0x33, 5, 0x20 },
+    { "or",     FMT_R,     "rrr", 0x33, 6, 0x00 },
+    { "and",    FMT_R,     "rrr", 0x33, 7, 0x00 },
+    { "addi",   FMT_I,     "rri", 0x13, 0 },
+    { "slti",   FMT_I,     "rri", 0x13, 2 },
+    { "sltiu",  FMT_I,     "rri", 0x13, 3 },
+    { "xori",   FMT_I,     "rri", 0x13, 4 },
+    { "ori",    FMT_I,     "rri", 0x13, 6 },
+    { "andi",   FMT_I,     "rri", 0x13, 7 },
+    { "slli",   FMT_SHIFT, "rri", 0x13, 1, 0x00 },
+    { "srli",   FMT_SHIFT, "rri", 0x13, 5, 0x00 },
+    { "srai",   FMT_SHIFT, "rri", 0x13, 5, 0x20 },
+    { "lb",     FMT_LOAD,  "rm",  0x03, 0 },
+    { "lh",     FMT_LOAD,  "rm",  0x03, 1 },
+    { "lw",     FMT_LOAD,  "rm",  0x03, 2 },
+    { "lbu",    FMT_LOAD,  "rm",  0x03, 4 },
+    { "lhu",    FMT_LOAD,  "rm",  0x03, 5 },
+    { "sb",     FMT_STORE, "rm",  0x23, 0 },
+    { "sh",     FMT_STORE, "rm",  0x23, 1 },
+    { "sw",     FMT_STORE, "rm",  0x23, 2 },
+    { "beq",    FMT_BRANCH, "rrl", 0x63, 0 },
+    { "bne",    FMT_BRANCH, "rrl", 0x63, 1 },
+    { "blt",    FMT_BRANCH, "rrl", 0x63, 4 },
+    { "bge",    FMT_BRANCH, "rrl", 0x63, 5 },
+    { "bltu",   FMT_BRANCH, "rrl", 0x63, 6 },
+    { "bgeu",   FMT_BRANCH, "rrl", 0x63, 7 },
+    { "lui",    FMT_U,     "ri",  0x37 },
+    { "auipc",  FMT_U,     "ri",  0x17 },
+    { "jal",    FMT_JAL,   "rl",  0x6F },
+    { "jalr",   FMT_JALR,  "rm",  0x67, 0 },
+    { "ecall",  FMT_FIXED, "",    0x00000073 },
+    { "ebreak", FMT_FIXED, "",    0x00100073 },
+    { "csrrw",  FMT_CSR,   "rcr", 0x73, 1 },
+    { "csrrs",  FMT_CSR,   "rcr", 0x73, 2 },
+    { "csrrc",  FMT_CSR,   "rcr", 0x73, 3 },
+
+    // M
+    { "mul",    FMT_R,     "rrr", 0x33, 0, 0x01 },
+    { "mulh",   FMT_R,     "rrr", 0x33, 1, 0x01 },
+    { "mulhsu", FMT_R,     "rrr", 0x33, 2, 0x01 },
+    { "mulhu",  FMT_R,     "rrr", 0x33, 3, 0x01 },
+    { "div",    FMT_R,     "rrr", 0x33, 4, 0x01 },
+    { "divu",   FMT_R,     "rrr", 0x33, 5, 0x01 },
+    { "rem",    FMT_R,     "rrr", 0x33, 6, 0x01 },
+    { "remu",   FMT_R,     "rrr", 0x33, 7, 0x01 },
+
+    // RV64I e RV64M: só com xlen 64 (ver rv64_only)
+    { "addw",   FMT_R,     "rrr", 0x3b, 0, 0x00 },
+    { "subw",   FMT_R,     "rrr", 0x3b, 0, 0x20 },
+    { "sllw",   FMT_R,     "rrr", 0x3b, 1, 0x00 },
+    { "srlw",   FMT_R,     "rrr", 0x3b, 5, 0x00 },
+    { "sraw",   FMT_R,     "rrr", 0x3b, 5, 0x20 },
+    { "mulw",   FMT_R,     "rrr", 0x3b, 0, 0x01 },
+    { "divw",   FMT_R,     "rrr", 0x3b, 4, 0x01 },
+    { "divuw",  FMT_R,     "rrr", 0x3b, 5, 0x01 },
+    { "remw",   FMT_R,     "rrr", 0x3b, 6, 0x01 },
+    { "remuw",  FMT_R,     "rrr", 0x3b, 7, 0x01 },
+    { "addiw",  FMT_I,     "rri", 0x1b, 0 },
+    { "slliw",  FMT_SHIFT, "rri", 0x1b, 1, 0x00 },
+    { "srliw",  FMT_SHIFT, "rri", 0x1b, 5, 0x00 },
+    { "sraiw",  FMT_SHIFT, "rri", 0x1b, 5, 0x20 },
+    { "ld",     FMT_LOAD,  "rm",  0x03, 3 },
+    { "lwu",    FMT_LOAD,  "rm",  0x03, 6 },
+    { "sd",     FMT_STORE, "rm",  0x23, 3 },
+
+    // F e D
+    { "flw",       FMT_LOAD,     "fm",   0x07, 2 },
+    { "fld",       FMT_LOAD,     "fm",   0x07, 3 },
+    { "fsw",       FMT_STORE,    "fm",   0x27, 2 },
+    { "fsd",       FMT_STORE,    "fm",   0x27, 3 },
+    { "fadd.s",    FMT_FP,       "fffR", 0x53, -1, 0x00 },
+    { "fsub.s",    FMT_FP,       "fffR", 0x53, -1, 0x04 },
+    { "fmul.s",    FMT_FP,       "fffR", 0x53, -1, 0x08 },
+    { "fdiv.s",    FMT_FP,       "fffR", 0x53, -1, 0x0C },
+    { "fsgnj.s",   FMT_FP,       "fff",  0x53, 0, 0x10 },
+    { "fsgnjn.s",  FMT_FP,       "fff",  0x53, 1, 0x10 },
+    { "fsgnjx.s",  FMT_FP,       "fff",  0x53, 2, 0x10 },
+    { "fmin.s",    FMT_FP,       "fff",  0x53, 0, 0x14 },
+    { "fmax.s",    FMT_FP,       "fff",  0x53, 1, 0x14 },
+    { "feq.s",     FMT_FP,       "rff",  0x53, 2, 0x50 },
+    { "flt.s",     FMT_FP,       "rff",  0x53, 1, 0x50 },
+    { "fle.s",     FMT_FP,       "rff",  0x53, 0, 0x50 },
+    { "fsqrt.s",   FMT_FP_UNARY, "ffR",  0x53, -1, 0x2C, 0 },
+    { "fcvt.w.s",  FMT_FP_UNARY, "rfR",  0x53, -1, 0x60, 0 },
+    { "fcvt.wu.s", FMT_FP_UNARY, "rfR",  0x53, -1, 0x60, 1 },
+    { "fcvt.s.w",  FMT_FP_UNARY, "frR",  0x53, -1, 0x68, 0 },
+    { "fcvt.s.wu", FMT_FP_UNARY, "frR",  0x53, -1, 0x68, 1 },
+    { "fcvt.l.s",  FMT_FP_UNARY, "rfR",  0x53, -1, 0x60, 2 },
+    { "fcvt.lu.s", FMT_FP_UNARY, "rfR",  0x53, -1, 0x60, 3 },
+    { "fcvt.s.l",  FMT_FP_UNARY, "frR",  0x53, -1, 0x68, 2 },
+    { "fcvt.s.lu", FMT_FP_UNARY, "frR",  0x53, -1, 0x68, 3 },
+    { "fmv.x.w",   FMT_FP_UNARY, "rf",   0x53, 0, 0x70, 0 },
+    { "fmv.x.s",   FMT_FP_UNARY, "rf",   0x53, 0, 0x70, 0 },
+    { "fclass.s",  FMT_FP_UNARY, "rf",   0x53, 1, 0x70, 0 },
+    { "fmv.w.x",   FMT_FP_UNARY, "fr",   0x53, 0, 0x78, 0 },
+    { "fmv.s.x",   FMT_FP_UNARY, "fr",   0x53, 0, 0x78, 0 },
+    { "fadd.d",    FMT_FP,       "fffR", 0x53, -1, 0x01 },
+    { "fsub.d",    FMT_FP,       "fffR", 0x53, -1, 0x05 },
+    { "fmul.d",    FMT_FP,       "fffR", 0x53, -1, 0x09 },
+    { "fdiv.d",    FMT_FP,       "fffR", 0x53, -1, 0x0D },
+    { "fsgnj.d",   FMT_FP,       "fff",  0x53, 0, 0x11 },
+    { "fsgnjn.d",  FMT_FP,       "fff",  0x53, 1, 0x11 },
+    { "fsgnjx.d",  FMT_FP,       "fff",  0x53, 2, 0x11 },
+    { "fmin.d",    FMT_FP,       "fff",  0x53, 0, 0x15 },
+    { "fmax.d",    FMT_FP,       "fff",  0x53, 1, 0x15 },
+    { "feq.d",     FMT_FP,       "rff",  0x53, 2, 0x51 },
+    { "flt.d",     FMT_FP,       "rff",  0x53, 1, 0x51 },
+    { "fle.d",     FMT_FP,       "rff",  0x53, 0, 0x51 },
+    { "fsqrt.d",   FMT_FP_UNARY, "ffR",  0x53, -1, 0x2D, 0 },
+    { "fcvt.s.d",  FMT_FP_UNARY, "ffR",  0x53, -1, 0x20, 1 },
+    { "fcvt.d.s",  FMT_FP_UNARY, "ffR",  0x53, -1, 0x21, 0 },
+    { "fcvt.w.d",  FMT_FP_UNARY, "rfR",  0x53, -1, 0x61, 0 },
+    { "fcvt.wu.d", FMT_FP_UNARY, "rfR",  0x53, -1, 0x61, 1 },
+    { "fcvt.d.w",  FMT_FP_UNARY, "frR",  0x53, -1, 0x69, 0 },
+    { "fcvt.d.wu", FMT_FP_UNARY, "frR",  0x53, -1, 0x69, 1 },
+
+    // Pseudo-instruções com mais de uma instrução
+    { "li",     PSEUDO_LI,   "ri" },
+    { "la",     PSEUDO_LA,   "rl" },
+    { "call",   PSEUDO_CALL, "l" },
+    { "tail",   PSEUDO_TAIL, "l" },
+
+    // Aliases
+    { "nop",    PSEUDO_ALIAS, "",    0, 0, 0, 0,  "addi",  "zzk" },
+    { "mv",     PSEUDO_ALIAS, "rr",  0, 0, 0, 0,  "addi",  "01k" },
+    { "not",    PSEUDO_ALIAS, "rr",  0, 0, 0, -1, "xori",  "01k" },
+    { "neg",    PSEUDO_ALIAS, "rr",  0, 0, 0, 0,  "sub",   "0z1" },
+    { "negw",   PSEUDO_ALIAS, "rr",  0, 0, 0, 0,  "subw",  "0z1" },
+    { "sext.w", PSEUDO_ALIAS, "rr",  0, 0, 0, 0,  "addiw", "01k" },
+    { "seqz",   PSEUDO_ALIAS, "rr",  0, 0, 0, 1,  "sltiu", "01k" },
+    { "snez",   PSEUDO_ALIAS, "rr",  0, 0, 0, 0,  "sltu",  "0z1" },
+    { "sltz",   PSEUDO_ALIAS, "rr",  0, 0, 0, 0,  "slt",   "01z" },
+    { "sgtz",   PSEUDO_ALIAS, "rr",  0, 0, 0, 0,  "slt",   "0z1" },
+    { "sgt",    PSEUDO_ALIAS, "rrr", 0, 0, 0, 0,  "slt",   "021" },
+    { "sgtu",   PSEUDO_ALIAS, "rrr", 0, 0, 0, 0,  "sltu",  "021" },
+    { "beqz",   PSEUDO_ALIAS, "rl",  0, 0, 0, 0,  "beq",   "0z1" },
+    { "bnez",   PSEUDO_ALIAS, "rl",  0, 0, 0, 0,  "bne",   "0z1" },
+    { "blez",   PSEUDO_ALIAS, "rl",  0, 0, 0, 0,  "bge",   "z01" },
+    { "bgez",   PSEUDO_ALIAS, "rl",  0, 0, 0, 0,  "bge",   "0z1" },
+    { "bltz",   PSEUDO_ALIAS, "rl",  0, 0, 0, 0,  "blt",   "0z1" },
+    { "bgtz",   PSEUDO_ALIAS, "rl",  0, 0, 0, 0,  "blt",   "z01" },
+    { "bgt",    PSEUDO_ALIAS, "rrl", 0, 0, 0, 0,  "blt",   "102" },
+    { "ble",    PSEUDO_ALIAS, "rrl", 0, 0, 0, 0,  "bge",   "102" },
+    { "bgtu",   PSEUDO_ALIAS, "rrl", 0, 0, 0, 0,  "bltu",  "102" },
+    { "bleu",   PSEUDO_ALIAS, "rrl", 0, 0, 0, 0,  "bgeu",  "102" },
+    { "j",      PSEUDO_ALIAS, "l",   0, 0, 0, 0,  "jal",   "z0" },
+    { "jal",    PSEUDO_ALIAS, "l",   0, 0, 0, 0,  "jal",   "a0" },
+    { "jr",     PSEUDO_ALIAS, "r",   0, 0, 0, 0,  "jalr",  "zp" },
+    { "jalr",   PSEUDO_ALIAS, "r",   0, 0, 0, 0,  "jalr",  "ap" },
+    { "ret",    PSEUDO_ALIAS, "",    0, 0, 0, 0,  "jalr",  "zq" },
+    { "fmv.s",  PSEUDO_ALIAS, "ff",  0, 0, 0, 0,  "fsgnj.s",  "011" },
+    { "fneg.s", PSEUDO_ALIAS, "ff",  0, 0, 0, 0,  "fsgnjn.s", "011" },
+    { "fabs.s", PSEUDO_ALIAS, "ff",  0, 0, 0, 0,  "fsgnjx.s", "011" },
+    { "fmv.d",  PSEUDO_ALIAS, "ff",  0, 0, 0, 0,  "fsgnj.d",  "011" },
+    { "fneg.d", PSEUDO_ALIAS, "ff",  0, 0, 0, 0,  "fsgnjn.d", "011" },
+    { "fabs.d", PSEUDO_ALIAS, "ff",  0, 0, 0, 0,  "fsgnjx.d", "011" },
+    { "csrr",   PSEUDO_ALIAS, "rc",  0, 0, 0, 0,  "csrrs", "01z" },
+    { "rdcycle",    PSEUDO_ALIAS, "r", 0, 0, 0, 0xC00, "csrrs", "0kz" },
+    { "rdtime",     PSEUDO_ALIAS, "r", 0, 0, 0, 0xC01, "csrrs", "0kz" },
+    { "rdinstret",  PSEUDO_ALIAS, "r", 0, 0, 0, 0xC02, "csrrs", "0kz" },
+    { "rdcycleh",   PSEUDO_ALIAS, "r", 0, 0, 0, 0xC80, "csrrs", "0kz" },
+    { "rdtimeh",    PSEUDO_ALIAS, "r", 0, 0, 0, 0xC81, "csrrs", "0kz" },
+    { "rdinstreth", PSEUDO_ALIAS, "r", 0, 0, 0, 0xC82, "csrrs", "0kz" },
+};
+
+#define MNEMONIC_COUNT ((int)(sizeof(mnemonics) / sizeof(mnemonics[0])))
+
+static const char *const int_register_names[32] = {
+    "zero", "ra", "sp", "gp", "tp", "t0", "t1", "t2",
+    "s0", "s1", "a0", "a1", "a2", "a3", "a4", "a5",
+    "a6", "a7", "s2", "s3", "s4", "s5", "s6", "s7",
+    "s8", "s9", "s10", "s11", "t3", "t4", "t5", "t6"
+};
+
+static const char *const fp_register_names[32] = {
+    "ft0", "ft1", "ft2", "ft3", "ft4", "ft5", "ft6", "ft7",
+    "fs0", "fs1", "fa0", "fa1", "fa2", "fa3", "fa4", "fa5",
+    "fa6", "fa7", "fs2", "fs3", "fs4", "fs5", "fs6", "fs7",
+    "fs8", "fs9", "fs10", "fs11", "ft8", "ft9", "ft10", "ft11"
+};
+
+typedef enum {
+    OPERAND_REG,
+    OPERAND_IMM,
+    OPERAND_SYMBOL,
+    OPERAND_MEMORY
+} OperandKind;
+
+typedef struct {
+    OperandKind kind;
+    int reg;                // Registrador, ou base de OPERAND_MEMORY
+    int32_t imm;            // Imediato, deslocamento ou addend do símbolo
+    int symbol;
+} Operand;
+
+typedef enum {
+    ITEM_INSTRUCTION,
+    ITEM_DATA,              // Bytes literais (.string, .ascii)
+    ITEM_VALUE,             // .byte/.half/.word, possivelmente com símbolo
+    ITEM_ALIGN,
+    ITEM_SPACE,
+    ITEM_LABEL
+} ItemKind;
+
+typedef struct {
+    ItemKind kind;
+    int section;
+    int line;
+    uint32_t offset;
+    uint32_t size;
+    const Mnemonic *mnemonic;
+    Operand operands[MAX_OPERANDS];
+    int operand_count;
+    unsigned char *bytes;
+    uint32_t amount;        // ALIGN: alinhamento; SPACE: bytes; VALUE: largura
+    int symbol;             // LABEL: símbolo definido aqui
+} AsmItem;
+
+typedef struct {
+    AsmProgram *program;
+    AsmItem *items;
+    int item_count;
+    int item_capacity;
+    int section;
+    int line;
+    int pcrel_count;        // Rótulos .Lpcrel_hiN criados para o la
+    bool compress;
+    bool rv64;
+} Assembler;
+
+/* ---------- Tabela de mnemônicos ---------- */
+
+static int mnemonic_buckets[MNEMONIC_BUCKETS];
+static int mnemonic_next[MNEMONIC_COUNT];
+static pthread_once_t mnemonic_once = PTHREAD_ONCE_INIT;
+
+static unsigned int hash_text(const char *text) {
+    unsigned int hash = 2166136261u;
+    while (*text) {
+        hash ^= (unsigned char)*text++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Índice montado uma vez por processo (várias threads no modo --batch)
+static void build_mnemonic_index(void) {
+    for (int i = 0; i < MNEMONIC_BUCKETS; i++) mnemonic_buckets[i] = -1;
+    // Inserção de trás para frente: a cadeia fica na ordem da tabela
+    for (int i = MNEMONIC_COUNT - 1; i >= 0; i--) {
+        int bucket = hash_text(mnemonics[i].name) & (MNEMONIC_BUCKETS - 1);
+        mnemonic_next[i] = mnemonic_buckets[bucket];
+        mnemonic_buckets[bucket] = i;
+    }
+}
+
+// Instruções que não existem no RV32: OP-32/OP-IMM-32, ld/lwu/sd e as
+// conversões entre float e inteiro de 64 bits
+static bool rv64_only(const Mnemonic *mnemonic) {
+    if (mnemonic->opcode == 0x3b || mnemonic->opcode == 0x1b) return true;
+    if (mnemonic->opcode == 0x03) return mnemonic->funct3 == 3 || mnemonic->funct3 == 6;
+    if (mnemonic->opcode == 0x23) return mnemonic->funct3 == 3;
+    if (mnemonic->format == FMT_FP_UNARY && (mnemonic->funct7 & 0x76) == 0x60) return mnemonic->extra >= 2;
+    return false;
+}
+
+static int required_operands(const Mnemonic *mnemonic) {
+    int count = strlen(mnemonic->operands);
+    if (count > 0 && mnemonic->operands[count - 1] == 'R') count--;
+    return count;
+}
+
+// Procura a forma do mnemônico que aceita essa quantidade de operandos;
+// *known indica se o nome existe (para a mensagem de erro)
+static const Mnemonic* find_mnemonic(const char *name, int operand_count, bool *known) {
+    pthread_once(&mnemonic_once, build_mnemonic_index);
+    *known = false;
+    int index = mnemonic_buckets[hash_text(name) & (MNEMONIC_BUCKETS - 1)];
+    while (index != -1) {
+        const Mnemonic *mnemonic = &mnemonics[index];
+        if (strcmp(mnemonic->name, name) == 0) {
+            *known = true;
+            int required = required_operands(mnemonic);
+            int maximum = strlen(mnemonic->operands);
+            if (operand_count >= required && operand_count <= maximum) return mnemonic;
+        }
+        index = mnemonic_next[index];
+    }
+    return NULL;
+}
+
+/* ---------- Símbolos ---------- */
+
+static int asm_error(Assembler *as, const char *format, ...) {
+    if (as->program->error[0] == '\0') {
+        int length = snprintf(as->program->error, sizeof(as->program->error), "linha %d: ", as->line);
+        va_list args;
+        va_start(args, format);
+        vsnprintf(as->program->error + length, sizeof(as->program->error) - length, format, args);
+        va_end(args);
+    }
+    return 1;
+}
+
+static int find_symbol(AsmProgram *program, const char *name) {
+    if (program->symbol_bucket_count == 0) return -1;
+    int index = program->symbol_buckets[hash_text(name) & (program->symbol_bucket_count - 1)];
+    while (index != -1) {
+        if (strcmp(program->symbols[index].name, name) == 0) return index;
+        index = program->symbols[index].next;
+    }
+    return -1;
+}
+
+static void grow_symbol_buckets(AsmProgram *program) {
+    int new_count = program->symbol_bucket_count ? program->symbol_bucket_count * 2 : SYMBOL_INITIAL_BUCKETS;
+    int *buckets = malloc(new_count * sizeof(int));
+    if (!buckets) {
+        fprintf(stderr, "Erro: memória insuficiente para a tabela de símbolos\n");
+        exit(1);
+    }
+    for (int i = 0; i < new_count; i++) buckets[i] = -1;
+    for (int i = 0; i < program->symbol_count; i++) {
+        int bucket = hash_text(program->symbols[i].name) & (new_count - 1);
+        program->symbols[i].next = buckets[bucket];
+        buckets[bucket] = i;
+    }
+    free(program->symbol_buckets);
+    program->symbol_buckets = buckets;
+    program->symbol_bucket_count = new_count;
+}
+
+// Devolve o símbolo com esse nome, criando-o (indefinido) na primeira referência
+static int intern_symbol(AsmProgram *program, const char *name) {
+    int index = find_symbol(program, name);
+    if (index != -1) return index;
+
+    if (program->symbol_count == program->symbol_capacity) {
+        program->symbol_capacity = program->symbol_capacity ? program->symbol_capacity * 2 : SYMBOL_INITIAL_BUCKETS / 2;
+        program->symbols = realloc(program->symbols, program->symbol_capacity * sizeof(AsmSymbol));
+        if (!program->symbols) {
+            fprintf(stderr, "Erro: memória insuficiente para a tabela de símbolos\n");
+            exit(1);
+        }
+    }
+    if ((program->symbol_count + 1) * 2 > program->symbol_bucket_count) {
+        grow_symbol_buckets(program);
+    }
+
+    AsmSymbol *symbol = &program->symbols[program->symbol_count];
+    symbol->name = strdup(name);
+    symbol->section = -1;
+    symbol->value = 0;
+    symbol->global = false;
+
+    int bucket = hash_text(name) & (program->symbol_bucket_count - 1);
+    symbol->next = program->symbol_buckets[bucket];
+    program->symbol_buckets[bucket] = program->symbol_count;
+    return program->symbol_count++;
+}
+
+/* ---------- Leitura do texto ---------- */
+
+static AsmItem* new_item(Assembler *as, ItemKind kind, uint32_t size) {
+    if (as->item_count == as->item_capacity) {
+        as->item_capacity = as->item_capacity ? as->item_capacity * 2 : 1024;
+        as->items = realloc(as->items, as->item_capacity * sizeof(AsmItem));
+        if (!as->items) {
+            fprintf(stderr, "Erro: memória insuficiente para a montagem\n");
+            exit(1);
+        }
+    }
+    AsmItem *item = &as->items[as->item_count++];
+    memset(item, 0, sizeof(*item));
+    item->kind = kind;
+    item->section = as->section;
+    item->line = as->line;
+    item->size = size;
+    return item;
+}
+
+static bool is_symbol_char(char c) {
+    return isalnum((unsigned char)c) || c == '_' || c == '.' || c == '$';
+}
+
+static char* trim(char *text) {
+    while (isspace((unsigned char)*text)) text++;
+    char *end = text + strlen(text);
+    while (end > text && isspace((unsigned char)end[-1])) end--;
+    *end = '\0';
+    return text;
+}
+
+// Remove o comentário ('#' fora de aspas)
+static void strip_comment(char *text) {
+    bool in_string = false;
+    for (char *p = text; *p; p++) {
+        if (in_string && *p == '\\' && p[1]) {
+            p++;
+        } else if (*p == '"') {
+            in_string = !in_string;
+        } else if (!in_string && *p == '#') {
+            *p = '\0';
+            return;
+        }
+    }
+}
+
+// Separa os operandos por vírgula (fora de parênteses e aspas)
+static int split_operands(char *text, char **operands, int max_operands) {
+    int count = 0;
+    int depth = 0;
+    bool in_string = false;
+    char *start = text;
+
+    if (*trim(text) == '\0') return 0;
+    for (char *p = text; ; p++) {
+        if (in_string && *p == '\\' && p[1]) {
+            p++;
+            continue;
+        }
+        if (*p == '"') in_string = !in_string;
+        else if (!in_string && *p == '(') depth++;
+        else if (!in_string && *p == ')') depth--;
+
+        if (*p == '\0' || (*p == ',' && depth == 0 && !in_string)) {
+            bool last = *p == '\0';
+            *p = '\0';
+            if (count == max_operands) return -1;
+            operands[count++] = trim(start);
+            if (last) break;
+            start = p + 1;
+        }
+    }
+    return count;
+}
+
+static int parse_register(const char *text, bool fp) {
+    const char *const *names = fp ? fp_register_names : int_register_names;
+    for (int i = 0; i < 32; i++) {
+        if (strcmp(text, names[i]) == 0) return i;
+    }
+    if (!fp && strcmp(text, "fp") == 0) return 8;
+
+    // Forma numérica: x0..x31 ou f0..f31
+    if (text[0] == (fp ? 'f' : 'x') && isdigit((unsigned char)text[1])) {
+        char *end;
+        long number = strtol(text + 1, &end, 10);
+        if (*end == '\0' && number >= 0 && number < 32) return (int)number;
+    }
+    return -1;
+}
+
+static bool parse_integer(const char *text, int32_t *value) {
+    if (text[0] == '\'' && text[1] && text[2] == '\'' && text[3] == '\0') {
+        *value = (unsigned char)text[1];
+        return true;
+    }
+    char *end;
+    long long number = strtoll(text, &end, 0);
+    if (end == text || *end != '\0') return false;
+    if (number < -2147483648LL || number > 4294967295LL) return false;
+    *value = (int32_t)(uint32_t)number;
+    return true;
+}
+
+static bool parse_csr(const char *text, int32_t *value) {
+    static const struct { const char *name; int number; } csrs[] = {
+        { "fflags", 0x001 }, { "frm", 0x002 }, { "fcsr", 0x003 },
+        { "cycle", 0xC00 }, { "time", 0xC01 }, { "instret", 0xC02 },
+        { "cycleh", 0xC80 }, { "timeh", 0xC81 }, { "instreth", 0xC82 },
+    };
+    for (size_t i = 0; i < sizeof(csrs) / sizeof(csrs[0]); i++) {
+        if (strcmp(text, csrs[i].name) == 0) {
+            *value = csrs[i].number;
+            return true;
+        }
+    }
+    return parse_integer(text, value) && *value >= 0 && *value < 4096;
+}
+
+static bool parse_rounding_mode(const char *text, int32_t *value) {
+    static const char *const modes[] = { "rne", "rtz", "rdn", "rup", "rmm", NULL, NULL, "dyn" };
+    for (int i = 0; i < 8; i++) {
+        if (modes[i] && strcmp(text, modes[i]) == 0) {
+            *value = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+// "sym", "sym+4" ou "sym-4"
+static bool parse_symbol_reference(Assembler *as, const char *text, Operand *operand) {
+    char name[256];
+    size_t length = 0;
+    while (is_symbol_char(text[length]) && length < sizeof(name) - 1) length++;
+    if (length == 0 || isdigit((unsigned char)text[0]) || length == sizeof(name) - 1) return false;
+    memcpy(name, text, length);
+    name[length] = '\0';
+
+    operand->kind = OPERAND_SYMBOL;
+    operand->imm = 0;
+    if (text[length] != '\0') {
+        if ((text[length] != '+' && text[length] != '-') ||
+            !parse_integer(text + length + (text[length] == '+'), &operand->imm)) return false;
+    }
+    operand->symbol = intern_symbol(as->program, name);
+    return true;
+}
+
+static int parse_operand(Assembler *as, char kind, char *text, Operand *operand) {
+    memset(operand, 0, sizeof(*operand));
+    switch (kind) {
+        case 'r':
+        case 'f':
+            operand->kind = OPERAND_REG;
+            operand->reg = parse_register(text, kind == 'f');
+            if (operand->reg < 0) return asm_error(as, "registrador inválido '%s'", text);
+            return 0;
+        case 'i':
+            operand->kind = OPERAND_IMM;
+            if (!parse_integer(text, &operand->imm)) return asm_error(as, "imediato inválido '%s'", text);
+            return 0;
+        case 'c':
+            operand->kind = OPERAND_IMM;
+            if (!parse_csr(text, &operand->imm)) return asm_error(as, "CSR inválido '%s'", text);
+            return 0;
+        case 'R':
+            operand->kind = OPERAND_IMM;
+            if (!parse_rounding_mode(text, &operand->imm)) return asm_error(as, "modo de arredondamento inválido '%s'", text);
+            return 0;
+        case 'l':
+            if (!parse_symbol_reference(as, text, operand)) return asm_error(as, "rótulo inválido '%s'", text);
+            return 0;
+        case 'm': {
+            // imm(reg), com o imediato opcional
+            char *open = strchr(text, '(');
+            char *close = open ? strchr(open, ')') : NULL;
+            if (!open || !close || *trim(close + 1) != '\0') return asm_error(as, "endereço inválido '%s'", text);
+            *open = '\0';
+            *close = '\0';
+            operand->kind = OPERAND_MEMORY;
+            operand->reg = parse_register(trim(open + 1), false);
+            if (operand->reg < 0) return asm_error(as, "registrador base inválido em '%s'", text);
+            char *offset = trim(text);
+            if (*offset && !parse_integer(offset, &operand->imm)) return asm_error(as, "deslocamento inválido '%s'", offset);
+            return 0;
+        }
+    }
+    return asm_error(as, "operando inválido '%s'", text);
+}
+
+// Reescreve um alias (mv, beqz, ret, ...) na instrução real correspondente
+static int expand_alias(Assembler *as, AsmItem *item) {
+    const Mnemonic *alias = item->mnemonic;
+    Operand source[MAX_OPERANDS];
+    memcpy(source, item->operands, sizeof(source));
+
+    int count = strlen(alias->layout);
+    for (int i = 0; i < count; i++) {
+        Operand *operand = &item->operands[i];
+        memset(operand, 0, sizeof(*operand));
+        switch (alias->layout[i]) {
+            case 'z': operand->kind = OPERAND_REG; operand->reg = 0; break;
+            case 'a': operand->kind = OPERAND_REG; operand->reg = 1; break;
+            case 'k': operand->kind = OPERAND_IMM; operand->imm = alias->extra; break;
+            case 'p': operand->kind = OPERAND_MEMORY; operand->reg = source[0].reg; break;
+            case 'q': operand->kind = OPERAND_MEMORY; operand->reg = 1; break;
+            default:  *operand = source[alias->layout[i] - '0']; break;
+        }
+    }
+
+    bool known;
+    item->mnemonic = find_mnemonic(alias->real, count, &known);
+    item->operand_count = count;
+    if (!item->mnemonic || item->mnemonic->format == PSEUDO_ALIAS) {
+        return asm_error(as, "alias '%s' mal definido", alias->name);
+    }
+    return 0;
+}
+
+static bool fits_signed(int32_t value, int bits) {
+    int32_t limit = 1 << (bits - 1);
+    return value >= -limit && value < limit;
+}
+
+// Divide um deslocamento em %hi/%lo (o %lo é somado com sinal)
+static void split_offset(int32_t value, uint32_t *hi, int32_t *lo) {
+    *hi = (((uint32_t)value + 0x800) >> 12) & 0xFFFFF;
+    *lo = (int32_t)((uint32_t)value - (*hi << 12));
+}
+
+/* ---------- Extensão C (instruções de 16 bits) ---------- */
+
+// Registradores x8-x15, os únicos dos campos de 3 bits (rd', rs1', rs2')
+static bool is_compact_reg(int reg) {
+    return reg >= 8 && reg <= 15;
+}
+
+// c.lui: imediato de 20 bits que, com extensão de sinal, cabe em 6 bits
+static bool fits_c_lui(int rd, uint32_t hi) {
+    int32_t value = (int32_t)(hi << 12) >> 12;
+    return rd != 0 && rd != 2 && value != 0 && fits_signed(value, 6);
+}
+
+static bool fits_c_addi(int rd, int32_t imm) {
+    return rd != 0 && imm != 0 && fits_signed(imm, 6);
+}
+
+// li que não cabe em 12 bits vira lui + addi (lui + addiw no RV64, que
+// refaz a extensão de sinal dos 32 bits); com RVC cada metade pode ter 16
+// bits. Os de 12 bits (e o lui sozinho) ficam com compress_instruction
+static uint32_t li_size(int32_t value, int rd, bool compress) {
+    if (fits_signed(value, 12) || (value & 0xFFF) == 0) return 4;
+    uint32_t hi;
+    int32_t lo;
+    split_offset(value, &hi, &lo);
+    if (!compress) return 8;
+    return (fits_c_lui(rd, hi) ? 2 : 4) + (fits_c_addi(rd, lo) ? 2 : 4);
+}
+
+static uint16_t encode_ci(int funct3, int rd, int32_t imm, int quadrant) {
+    return funct3 << 13 | ((imm >> 5) & 1) << 12 | rd << 7 | (imm & 0x1F) << 2 | quadrant;
+}
+
+static uint16_t encode_cr(int funct4, int rd, int rs2) {
+    return funct4 << 12 | rd << 7 | rs2 << 2 | 2;
+}
+
+// Imediato dos saltos c.j/c.jal: offset[11|4|9:8|10|6|7|3:1|5]
+static uint16_t encode_cj(int funct3, int32_t offset) {
+    return funct3 << 13 | ((offset >> 11) & 1) << 12 | ((offset >> 4) & 1) << 11 |
+           ((offset >> 8) & 3) << 9 | ((offset >> 10) & 1) << 8 | ((offset >> 6) & 1) << 7 |
+           ((offset >> 7) & 1) << 6 | ((offset >> 1) & 7) << 3 | ((offset >> 5) & 1) << 2 | 1;
+}
+
+// Acesso a sp: c.lwsp/c.flwsp (funct3 2/3) e c.swsp/c.fswsp (6/7); com
+// width 8, c.ldsp/c.sdsp do RV64 (3/7), com o deslocamento em dobro
+static bool compress_sp_access(bool store, int funct3, int width, int reg, int32_t offset, uint16_t *half) {
+    if (offset < 0 || offset > 63 * width || offset % width != 0) return false;
+    if (width == 8) {
+        if (store) {
+            *half = funct3 << 13 | ((offset >> 3) & 7) << 10 | ((offset >> 6) & 7) << 7 | reg << 2 | 2;
+        } else {
+            *half = funct3 << 13 | ((offset >> 5) & 1) << 12 | reg << 7 | ((offset >> 3) & 3) << 5 |
+                    ((offset >> 6) & 7) << 2 | 2;
+        }
+    } else if (store) {
+        *half = funct3 << 13 | ((offset >> 2) & 0xF) << 9 | ((offset >> 6) & 3) << 7 | reg << 2 | 2;
+    } else {
+        *half = funct3 << 13 | ((offset >> 5) & 1) << 12 | reg << 7 | ((offset >> 2) & 7) << 4 |
+                ((offset >> 6) & 3) << 2 | 2;
+    }
+    return true;
+}
+
+// Acesso com base x8-x15: c.lw/c.flw (funct3 2/3) e c.sw/c.fsw (6/7); com
+// width 8, c.ld/c.sd do RV64 (3/7)
+static bool compress_compact_access(int funct3, int width, int reg, int base, int32_t offset, uint16_t *half) {
+    if (!is_compact_reg(reg) || !is_compact_reg(base) || offset < 0 || offset > 31 * width || offset % width != 0) return false;
+    int low = width == 8 ? ((offset >> 6) & 3) : (((offset >> 2) & 1) << 1 | ((offset >> 6) & 1));
+    *half = funct3 << 13 | ((offset >> 3) & 7) << 10 | (base - 8) << 7 | low << 5 | (reg - 8) << 2;
+    return true;
+}
+
+// Forma de 16 bits da instrução, se houver. "distance" é o deslocamento até
+// o alvo dos desvios e saltos. A mesma função decide o tamanho no layout e
+// gera a codificação, então as duas passadas nunca discordam. No RV64 os
+// códigos do c.jal e do c.flw/c.fsw são de c.addiw e c.ld/c.sd
+static bool compress_instruction(const AsmItem *item, bool rv64, int32_t distance, uint16_t *half) {
+    const Mnemonic *m = item->mnemonic;
+    const Operand *op = item->operands;
+
+    switch (m->format) {
+        case PSEUDO_LI: {
+            int32_t value = op[1].imm;
+            if ((value & 0xFFF) == 0 && !fits_signed(value, 12)) {
+                if (!fits_c_lui(op[0].reg, (uint32_t)value >> 12)) return false;
+                *half = encode_ci(3, op[0].reg, value >> 12, 1);            // c.lui
+                return true;
+            }
+            if (op[0].reg == 0 || !fits_signed(value, 6)) return false;
+            *half = encode_ci(2, op[0].reg, value, 1);                      // c.li
+            return true;
+        }
+
+        case FMT_I: {
+            int rd = op[0].reg, rs1 = op[1].reg;
+            int32_t imm = op[2].imm;
+            if (m->opcode == 0x1b) {                                        // addiw
+                if (rd != rs1 || rd == 0 || !fits_signed(imm, 6)) return false;
+                *half = encode_ci(1, rd, imm, 1);                           // c.addiw
+                return true;
+            }
+            if (m->funct3 == 7) {                                           // andi
+                if (rd != rs1 || !is_compact_reg(rd) || !fits_signed(imm, 6)) return false;
+                *half = 4 << 13 | ((imm >> 5) & 1) << 12 | 2 << 10 | (rd - 8) << 7 | (imm & 0x1F) << 2 | 1;
+                return true;
+            }
+            if (m->funct3 != 0) return false;                               // só addi
+            if (rd == 0 && rs1 == 0 && imm == 0) {
+                *half = 0x0001;                                             // c.nop
+                return true;
+            }
+            if (rd == 0) return false;
+            if (rd == rs1 && imm != 0 && fits_signed(imm, 6)) {
+                *half = encode_ci(0, rd, imm, 1);                           // c.addi
+                return true;
+            }
+            if (rd == 2 && rs1 == 2 && imm != 0 && imm % 16 == 0 && imm >= -512 && imm <= 496) {
+                *half = 3 << 13 | ((imm >> 9) & 1) << 12 | 2 << 7 | ((imm >> 4) & 1) << 6 |
+                        ((imm >> 6) & 1) << 5 | ((imm >> 7) & 3) << 3 | ((imm >> 5) & 1) << 2 | 1;   // c.addi16sp
+                return true;
+            }
+            if (rs1 == 2 && is_compact_reg(rd) && imm > 0 && imm < 1024 && imm % 4 == 0) {
+                *half = ((imm >> 4) & 3) << 11 | ((imm >> 6) & 0xF) << 7 | ((imm >> 2) & 1) << 6 |
+                        ((imm >> 3) & 1) << 5 | (rd - 8) << 2;              // c.addi4spn
+                return true;
+            }
+            if (imm == 0 && rs1 != 0) {
+                *half = encode_cr(8, rd, rs1);                              // c.mv
+                return true;
+            }
+            if (rs1 == 0 && fits_signed(imm, 6)) {
+                *half = encode_ci(2, rd, imm, 1);                           // c.li
+                return true;
+            }
+            return false;
+        }
+
+        case FMT_SHIFT: {
+            int rd = op[0].reg;
+            int32_t shamt = op[2].imm;
+            if (m->opcode != 0x13 || rd != op[1].reg || rd == 0 || shamt < 1 || shamt > (rv64 ? 63 : 31)) return false;
+            if (m->funct3 == 1) {
+                *half = encode_ci(0, rd, shamt, 2);                         // c.slli
+                return true;
+            }
+            if (!is_compact_reg(rd)) return false;
+            *half = 4 << 13 | ((shamt >> 5) & 1) << 12 | (m->funct7 ? 1 : 0) << 10 | (rd - 8) << 7 |
+                    (shamt & 0x1F) << 2 | 1;                                // c.srli/c.srai
+            return true;
+        }
+
+        case FMT_R: {
+            int rd = op[0].reg, rs1 = op[1].reg, rs2 = op[2].reg;
+            if (m->funct7 == 0x01) return false;                            // extensão M
+            if (m->opcode == 0x3b) {
+                // addw/subw: c.addw/c.subw, com os mesmos registradores do c.and
+                if (m->funct3 != 0) return false;
+                if (rd != rs1) {
+                    if (m->funct7 != 0 || rd != rs2) return false;
+                    rs2 = rs1;
+                }
+                if (!is_compact_reg(rd) || !is_compact_reg(rs2)) return false;
+                *half = 4 << 13 | 1 << 12 | 3 << 10 | (rd - 8) << 7 | (m->funct7 ? 0 : 1) << 5 | (rs2 - 8) << 2 | 1;
+                return true;
+            }
+            if (m->funct3 == 0 && m->funct7 == 0) {                         // add
+                if (rd == 0) return false;
+                if (rd == rs1 && rs2 != 0) { *half = encode_cr(9, rd, rs2); return true; }    // c.add
+                if (rd == rs2 && rs1 != 0) { *half = encode_cr(9, rd, rs1); return true; }
+                if (rs1 == 0 && rs2 != 0) { *half = encode_cr(8, rd, rs2); return true; }     // c.mv
+                return false;
+            }
+            int funct2;
+            bool commutative = true;
+            if (m->funct3 == 0 && m->funct7 == 0x20) { funct2 = 0; commutative = false; }  // sub
+            else if (m->funct3 == 4) funct2 = 1;                            // xor
+            else if (m->funct3 == 6) funct2 = 2;                            // or
+            else if (m->funct3 == 7) funct2 = 3;                            // and
+            else return false;
+            if (rd != rs1) {
+                if (!commutative || rd != rs2) return false;
+                rs2 = rs1;
+            }
+            if (!is_compact_reg(rd) || !is_compact_reg(rs2)) return false;
+            *half = 4 << 13 | 3 << 10 | (rd - 8) << 7 | funct2 << 5 | (rs2 - 8) << 2 | 1;
+            return true;
+        }
+
+        case FMT_LOAD:
+        case FMT_STORE: {
+            // Só lw/sw e flw/fsw (funct3 2) têm forma comprimida em RV32;
+            // no RV64 são lw/sw e ld/sd
+            bool store = m->format == FMT_STORE;
+            bool fp = m->opcode == 0x07 || m->opcode == 0x27;
+            int width = m->funct3 == 3 ? 8 : 4;
+            if (m->funct3 != 2 && !(rv64 && !fp && m->funct3 == 3)) return false;
+            if (rv64 && fp) return false;
+            int funct3 = (store ? 6 : 2) + (fp || width == 8 ? 1 : 0);
+            if (op[1].reg == 2 && (store || fp || op[0].reg != 0) &&
+                compress_sp_access(store, funct3, width, op[0].reg, op[1].imm, half)) return true;
+            return compress_compact_access(funct3, width, op[0].reg, op[1].reg, op[1].imm, half);
+        }
+
+        case FMT_BRANCH:
+            // beq/bne contra zero com registrador x8-x15: c.beqz/c.bnez
+            if (m->funct3 > 1 || op[1].reg != 0 || !is_compact_reg(op[0].reg) || !fits_signed(distance, 9)) return false;
+            *half = (6 + m->funct3) << 13 | ((distance >> 8) & 1) << 12 | ((distance >> 3) & 3) << 10 |
+                    (op[0].reg - 8) << 7 | ((distance >> 6) & 3) << 5 | ((distance >> 1) & 3) << 3 |
+                    ((distance >> 5) & 1) << 2 | 1;
+            return true;
+
+        case FMT_JAL:
+            if (op[0].reg > (rv64 ? 0 : 1) || !fits_signed(distance, 12)) return false;
+            *half = encode_cj(op[0].reg == 0 ? 5 : 1, distance);            // c.j / c.jal
+            return true;
+
+        case FMT_JALR:
+            if (op[0].reg > 1 || op[1].reg == 0 || op[1].imm != 0) return false;
+            *half = encode_cr(op[0].reg == 0 ? 8 : 9, op[1].reg, 0);        // c.jr / c.jalr
+            return true;
+
+        case FMT_FIXED:
+            if (m->opcode != 0x00100073) return false;
+            *half = 0x9002;                                                 // c.ebreak
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+// Desvios e saltos dependem da distância até o alvo, conhecida só no layout
+static bool is_relative_jump(const AsmItem *item) {
+    return item->kind == ITEM_INSTRUCTION &&
+           (item->mnemonic->format == FMT_BRANCH || item->mnemonic->format == FMT_JAL);
+}
+
+static int parse_instruction(Assembler *as, char *text) {
+    char *name = text;
+    while (*text && !isspace((unsigned char)*text)) {
+        *text = tolower((unsigned char)*text);
+        text++;
+    }
+    if (*text) *text++ = '\0';
+
+    char *operands[MAX_OPERANDS + 1];
+    int count = split_operands(text, operands, MAX_OPERANDS + 1);
+
+    bool known;
+    const Mnemonic *mnemonic = count < 0 ? NULL : find_mnemonic(name, count, &known);
+    if (!mnemonic) {
+        if (count >= 0 && !known) return asm_error(as, "instrução desconhecida '%s'", name);
+        return asm_error(as, "número de operandos inválido para '%s'", name);
+    }
+    if (as->section == SECTION_BSS) return asm_error(as, "instrução na seção .bss");
+    if (!as->rv64 && rv64_only(mnemonic)) return asm_error(as, "'%s' só existe no RV64", name);
+
+    AsmItem *item = new_item(as, ITEM_INSTRUCTION, 4);
+    item->mnemonic = mnemonic;
+    item->operand_count = count;
+    for (int i = 0; i < count; i++) {
+        if (parse_operand(as, mnemonic->operands[i], operands[i], &item->operands[i]) != 0) return 1;
+    }
+
+    switch (mnemonic->format) {
+        case PSEUDO_ALIAS:
+            if (expand_alias(as, item) != 0) return 1;
+            if (!as->rv64 && rv64_only(item->mnemonic)) return asm_error(as, "'%s' só existe no RV64", name);
+            break;
+        case PSEUDO_LI:
+            item->size = li_size(item->operands[1].imm, item->operands[0].reg, as->compress);
+            break;
+        case PSEUDO_LA:
+        case PSEUDO_CALL:
+        case PSEUDO_TAIL:
+            item->size = 8;
+            break;
+        default:
+            break;
+    }
+
+    // Desvios começam otimistas (distância zero); o layout aumenta o
+    // tamanho dos que não alcançarem o alvo
+    uint16_t half;
+    if (as->compress && compress_instruction(item, as->rv64, 0, &half)) {
+        item->size = 2;
+    }
+    return 0;
+}
+
+/* ---------- Diretivas ---------- */
+
+static int parse_string_literal(Assembler *as, const char *text, AsmItem *item, bool terminate) {
+    if (*text != '"') return asm_error(as, "string esperada");
+    size_t capacity = strlen(text) + 1;
+    unsigned char *bytes = malloc(capacity);
+    size_t length = 0;
+    const char *p = text + 1;
+
+    while (*p && *p != '"') {
+        if (*p != '\\') {
+            bytes[length++] = *p++;
+            continue;
+        }
+        p++;
+        switch (*p) {
+            case 'n': bytes[length++] = '\n'; p++; break;
+            case 't': bytes[length++] = '\t'; p++; break;
+            case 'r': bytes[length++] = '\r'; p++; break;
+            case 'b': bytes[length++] = '\b'; p++; break;
+            case 'f': bytes[length++] = '\f'; p++; break;
+            case 'x': {
+                int value = 0;
+                p++;
+                while (isxdigit((unsigned char)*p)) {
+                    value = value * 16 + (isdigit((unsigned char)*p) ? *p - '0' : tolower((unsigned char)*p) - 'a' + 10);
+                    p++;
+                }
+                bytes[length++] = (unsigned char)value;
+                break;
+            }
+            default:
+                if (*p >= '0' && *p <= '7') {
+                    int value = 0;
+                    for (int digits = 0; digits < 3 && *p >= '0' && *p <= '7'; digits++) {
+                        value = value * 8 + (*p++ - '0');
+                    }
+                    bytes[length++] = (unsigned char)value;
+                } else if (*p) {
+                    bytes[length++] = *p++;
+                }
+                break;
+        }
+    }
+    if (*p != '"') {
+        free(bytes);
+        return asm_error(as, "string sem aspas de fechamento");
+    }
+    if (*trim((char *)p + 1) != '\0') {
+        free(bytes);
+        return asm_error(as, "texto extra depois da string");
+    }
+    if (terminate) bytes[length++] = '\0';
+
+    item->bytes = bytes;
+    item->size = length;
+    return 0;
+}
+
+static int section_from_name(const char *name) {
+    for (int i = 0; i < SECTION_COUNT; i++) {
+        size_t length = strlen(asm_section_names[i]);
+        if (strncmp(name, asm_section_names[i], length) == 0 &&
+            (name[length] == '\0' || name[length] == '.')) return i;
+    }
+    return -1;
+}
+
+static int parse_directive(Assembler *as, char *text) {
+    char *name = text;
+    while (*text && !isspace((unsigned char)*text)) text++;
+    if (*text) *text++ = '\0';
+    char *args = trim(text);
+
+    if (strcmp(name, ".text") == 0 || strcmp(name, ".data") == 0 ||
+        strcmp(name, ".rodata") == 0 || strcmp(name, ".bss") == 0) {
+        as->section = section_from_name(name);
+        return 0;
+    }
+    if (strcmp(name, ".section") == 0) {
+        char *comma = strchr(args, ',');
+        if (comma) *comma = '\0';
+        int section = section_from_name(trim(args));
+        if (section < 0) return asm_error(as, "seção não suportada '%s'", args);
+        as->section = section;
+        return 0;
+    }
+    if (strcmp(name, ".globl") == 0 || strcmp(name, ".global") == 0) {
+        int symbol = intern_symbol(as->program, args);
+        as->program->symbols[symbol].global = true;
+        return 0;
+    }
+    if (strcmp(name, ".type") == 0 || strcmp(name, ".size") == 0 || strcmp(name, ".file") == 0 ||
+        strcmp(name, ".ident") == 0 || strcmp(name, ".option") == 0 || strcmp(name, ".local") == 0 ||
+        strcmp(name, ".attribute") == 0) {
+        return 0;  // Metadados sem efeito no objeto gerado
+    }
+
+    if (strcmp(name, ".align") == 0 || strcmp(name, ".p2align") == 0 || strcmp(name, ".balign") == 0) {
+        int32_t value;
+        if (!parse_integer(args, &value) || value < 0 || value > 4096) return asm_error(as, "alinhamento inválido '%s'", args);
+        uint32_t align = name[1] == 'b' ? (uint32_t)value : 1u << (value > 12 ? 12 : value);
+        if (align == 0 || (align & (align - 1)) != 0) return asm_error(as, "alinhamento inválido '%s'", args);
+        new_item(as, ITEM_ALIGN, 0)->amount = align;
+        if (align > as->program->sections[as->section].align) as->program->sections[as->section].align = align;
+        return 0;
+    }
+    if (strcmp(name, ".zero") == 0 || strcmp(name, ".space") == 0 || strcmp(name, ".skip") == 0) {
+        int32_t value;
+        if (!parse_integer(args, &value) || value < 0) return asm_error(as, "tamanho inválido '%s'", args);
+        new_item(as, ITEM_SPACE, value)->amount = value;
+        return 0;
+    }
+
+    if (as->section == SECTION_BSS) return asm_error(as, "dados iniciados na seção .bss");
+
+    if (strcmp(name, ".string") == 0 || strcmp(name, ".asciz") == 0 || strcmp(name, ".ascii") == 0) {
+        AsmItem *item = new_item(as, ITEM_DATA, 0);
+        return parse_string_literal(as, args, item, name[3] != 'c');
+    }
+
+    uint32_t width = 0;
+    if (strcmp(name, ".byte") == 0) width = 1;
+    else if (strcmp(name, ".half") == 0 || strcmp(name, ".short") == 0 || strcmp(name, ".2byte") == 0) width = 2;
+    else if (strcmp(name, ".word") == 0 || strcmp(name, ".long") == 0 || strcmp(name, ".4byte") == 0) width = 4;
+    if (width) {
+        char *values[64];
+        int count = split_operands(args, values, 64);
+        if (count <= 0) return asm_error(as, "valores inválidos em %s", name);
+        for (int i = 0; i < count; i++) {
+            AsmItem *item = new_item(as, ITEM_VALUE, width);
+            item->amount = width;
+            item->operand_count = 1;
+            if (parse_integer(values[i], &item->operands[0].imm)) {
+                item->operands[0].kind = OPERAND_IMM;
+            } else if (width != 4 || !parse_symbol_reference(as, values[i], &item->operands[0])) {
+                return asm_error(as, "valor inválido '%s'", values[i]);
+            }
+        }
+        return 0;
+    }
+
+    return asm_error(as, "diretiva desconhecida '%s'", name);
+}
+
+static int assemble_line(Assembler *as, char *text) {
+    strip_comment(text);
+    text = trim(text);
+
+    // Rótulos no começo da linha ("nome:"), possivelmente seguidos de código
+    for (;;) {
+        char *end = text;
+        while (is_symbol_char(*end)) end++;
+        if (end == text || *end != ':' || isdigit((unsigned char)*text)) break;
+        *end = '\0';
+
+        int symbol = intern_symbol(as->program, text);
+        AsmSymbol *entry = &as->program->symbols[symbol];
+        if (entry->section != -1) return asm_error(as, "rótulo '%s' definido mais de uma vez", text);
+        entry->section = as->section;
+        new_item(as, ITEM_LABEL, 0)->symbol = symbol;
+        text = trim(end + 1);
+    }
+
+    if (*text == '\0') return 0;
+    if (*text == '.') {
+        char *end = text + 1;
+        while (is_symbol_char(*end)) end++;
+        if (*end == '\0' || isspace((unsigned char)*end)) return parse_directive(as, text);
+    }
+    return parse_instruction(as, text);
+}
+
+/* ---------- Layout e codificação ---------- */
+
+// Distância até o rótulo, se ele estiver na mesma seção da instrução
+static bool local_distance(Assembler *as, const AsmItem *item, const Operand *operand, int32_t *distance) {
+    const AsmSymbol *symbol = &as->program->symbols[operand->symbol];
+    if (symbol->section != item->section) return false;
+    *distance = (int32_t)(symbol->value + operand->imm - item->offset);
+    return true;
+}
+
+// Atribui as posições; desvios condicionais fora do alcance (±4 KiB) viram
+// desvio invertido + jal, e com RVC os c.beqz/c.j que não alcançam o alvo
+// voltam a ter 4 bytes. Isso pode empurrar outros rótulos, então repete até
+// estabilizar (os tamanhos só crescem, então termina)
+static void layout_items(Assembler *as) {
+    for (;;) {
+        uint32_t offsets[SECTION_COUNT] = { 0 };
+        for (int i = 0; i < as->item_count; i++) {
+            AsmItem *item = &as->items[i];
+            uint32_t *offset = &offsets[item->section];
+            if (item->kind == ITEM_ALIGN) {
+                item->size = (item->amount - *offset % item->amount) % item->amount;
+            }
+            item->offset = *offset;
+            *offset += item->size;
+            if (item->kind == ITEM_LABEL) {
+                as->program->symbols[item->symbol].value = item->offset;
+            }
+        }
+        for (int s = 0; s < SECTION_COUNT; s++) {
+            as->program->sections[s].size = offsets[s];
+        }
+
+        bool changed = false;
+        for (int i = 0; i < as->item_count; i++) {
+            AsmItem *item = &as->items[i];
+            if (!is_relative_jump(item)) continue;
+
+            const Operand *target = &item->operands[item->mnemonic->format == FMT_BRANCH ? 2 : 1];
+            int32_t distance;
+            bool local = local_distance(as, item, target, &distance);
+            uint16_t half;
+            if (item->size == 2 && (!local || !compress_instruction(item, as->rv64, distance, &half))) {
+                item->size = 4;
+                changed = true;
+            }
+            if (item->size == 4 && local && item->mnemonic->format == FMT_BRANCH && !fits_signed(distance, 13)) {
+                item->size = 8;
+                changed = true;
+            }
+        }
+        if (!changed) break;
+    }
+}
+
+static void add_reloc(AsmSection *section, uint32_t offset, uint32_t type, int symbol, int32_t addend) {
+    if (section->reloc_count == section->reloc_capacity) {
+        section->reloc_capacity = section->reloc_capacity ? section->reloc_capacity * 2 : 64;
+        section->relocs = realloc(section->relocs, section->reloc_capacity * sizeof(AsmReloc));
+        if (!section->relocs) {
+            fprintf(stderr, "Erro: memória insuficiente para as relocações\n");
+            exit(1);
+        }
+    }
+    section->relocs[section->reloc_count++] = (AsmReloc){ offset, type, symbol, addend };
+}
+
+static void put_bytes(unsigned char *data, uint32_t value, int width) {
+    for (int i = 0; i < width; i++) {
+        data[i] = (unsigned char)(value >> (8 * i));
+    }
+}
+
+static uint32_t encode_r(uint32_t opcode, int rd, int funct3, int rs1, int rs2, int funct7) {
+    return (uint32_t)funct7 << 25 | (uint32_t)rs2 << 20 | (uint32_t)rs1 << 15 |
+           (uint32_t)funct3 << 12 | (uint32_t)rd << 7 | opcode;
+}
+
+static uint32_t encode_i(uint32_t opcode, int rd, int funct3, int rs1, int32_t imm) {
+    return ((uint32_t)imm & 0xFFF) << 20 | (uint32_t)rs1 << 15 | (uint32_t)funct3 << 12 |
+           (uint32_t)rd << 7 | opcode;
+}
+
+static uint32_t encode_s(uint32_t opcode, int funct3, int rs1, int rs2, int32_t imm) {
+    uint32_t u = (uint32_t)imm;
+    return ((u >> 5) & 0x7F) << 25 | (uint32_t)rs2 << 20 | (uint32_t)rs1 << 15 |
+           (uint32_t)funct3 << 12 | (u & 0x1F) << 7 | opcode;
+}
+
+static uint32_t encode_b(int funct3, int rs1, int rs2, int32_t imm) {
+    uint32_t u = (uint32_t)imm;
+    return ((u >> 12) & 1) << 31 | ((u >> 5) & 0x3F) << 25 | (uint32_t)rs2 << 20 | (uint32_t)rs1 << 15 |
+           (uint32_t)funct3 << 12 | ((u >> 1) & 0xF) << 8 | ((u >> 11) & 1) << 7 | 0x63;
+}
+
+static uint32_t encode_u(uint32_t opcode, int rd, uint32_t imm20) {
+    return (imm20 & 0xFFFFF) << 12 | (uint32_t)rd << 7 | opcode;
+}
+
+static uint32_t encode_j(int rd, int32_t imm) {
+    uint32_t u = (uint32_t)imm;
+    return ((u >> 20) & 1) << 31 | ((u >> 1) & 0x3FF) << 21 | ((u >> 11) & 1) << 20 |
+           ((u >> 12) & 0xFF) << 12 | (uint32_t)rd << 7 | 0x6F;
+}
+
+// Rótulo local .Lpcrel_hiN no auipc, referenciado pela relocação %pcrel_lo
+static int pcrel_label(Assembler *as, const AsmItem *item) {
+    char name[32];
+    snprintf(name, sizeof(name), ".Lpcrel_hi%d", as->pcrel_count++);
+    int symbol = intern_symbol(as->program, name);
+    as->program->symbols[symbol].section = item->section;
+    as->program->symbols[symbol].value = item->offset;
+    return symbol;
+}
+
+static int encode_instruction(Assembler *as, AsmItem *item) {
+    AsmSection *section = &as->program->sections[item->section];
+    unsigned char *data = section->data + item->offset;
+    const Mnemonic *m = item->mnemonic;
+    const Operand *op = item->operands;
+    uint32_t word = 0;
+    int32_t distance = 0;
+    as->line = item->line;
+
+    if (item->size == 2) {
+        uint16_t half;
+        if (is_relative_jump(item)) {
+            local_distance(as, item, &op[m->format == FMT_BRANCH ? 2 : 1], &distance);
+        }
+        if (!compress_instruction(item, as->rv64, distance, &half)) {
+            return asm_error(as, "forma comprimida inválida para '%s'", m->name);
+        }
+        put_bytes(data, half, 2);
+        return 0;
+    }
+
+    switch (m->format) {
+        case FMT_R:
+            word = encode_r(m->opcode, op[0].reg, m->funct3, op[1].reg, op[2].reg, m->funct7);
+            break;
+        case FMT_I:
+            if (!fits_signed(op[2].imm, 12)) return asm_error(as, "imediato fora do alcance em '%s'", m->name);
+            word = encode_i(m->opcode, op[0].reg, m->funct3, op[1].reg, op[2].imm);
+            break;
+        case FMT_SHIFT:
+            if (op[2].imm < 0 || op[2].imm > (as->rv64 && m->opcode == 0x13 ? 63 : 31)) return asm_error(as, "deslocamento fora do alcance em '%s'", m->name);
+            word = encode_i(m->opcode, op[0].reg, m->funct3, op[1].reg, op[2].imm | m->funct7 << 5);
+            break;
+        case FMT_LOAD:
+            if (!fits_signed(op[1].imm, 12)) return asm_error(as, "deslocamento fora do alcance em '%s'", m->name);
+            word = encode_i(m->opcode, op[0].reg, m->funct3, op[1].reg, op[1].imm);
+            break;
+        case FMT_STORE:
+            if (!fits_signed(op[1].imm, 12)) return asm_error(as, "deslocamento fora do alcance em '%s'", m->name);
+            word = encode_s(m->opcode, m->funct3, op[1].reg, op[0].reg, op[1].imm);
+            break;
+        case FMT_BRANCH:
+            if (!local_distance(as, item, &op[2], &distance)) {
+                // Rótulo de outra seção ou externo: o ligador resolve
+                add_reloc(section, item->offset, R_RISCV_BRANCH, op[2].symbol, op[2].imm);
+                distance = 0;
+            }
+            if (item->size == 8) {
+                // Forma longa: desvio invertido sobre um jal
+                put_bytes(data, encode_b(m->funct3 ^ 1, op[0].reg, op[1].reg, 8), 4);
+                distance -= 4;
+                if (!fits_signed(distance, 21)) return asm_error(as, "desvio fora do alcance");
+                word = encode_j(0, distance);
+                data += 4;
+            } else {
+                word = encode_b(m->funct3, op[0].reg, op[1].reg, distance);
+            }
+            break;
+        case FMT_U:
+            if (op[1].imm < -524288 || op[1].imm > 1048575) return asm_error(as, "imediato fora do alcance em '%s'", m->name);
+            word = encode_u(m->opcode, op[0].reg, (uint32_t)op[1].imm);
+            break;
+        case FMT_JAL:
+            if (!local_distance(as, item, &op[1], &distance)) {
+                add_reloc(section, item->offset, R_RISCV_JAL, op[1].symbol, op[1].imm);
+                distance = 0;
+            }
+            if (!fits_signed(distance, 21)) return asm_error(as, "salto fora do alcance");
+            word = encode_j(op[0].reg, distance);
+            break;
+        case FMT_JALR:
+            if (!fits_signed(op[1].imm, 12)) return asm_error(as, "deslocamento fora do alcance em '%s'", m->name);
+            word = encode_i(m->opcode, op[0].reg, m->funct3, op[1].reg, op[1].imm);
+            break;
+        case FMT_FIXED:
+            word = m->opcode;
+            break;
+        case FMT_CSR:
+            word = encode_i(m->opcode, op[0].reg, m->funct3, op[2].reg, op[1].imm);
+            break;
+        case FMT_FP:
+        case FMT_FP_UNARY: {
+            int operands = m->format == FMT_FP ? 3 : 2;
+            int rm = m->funct3 >= 0 ? m->funct3 : (item->operand_count > operands ? op[operands].imm : 7);
+            int rs2 = m->format == FMT_FP ? op[2].reg : m->extra;
+            word = encode_r(m->opcode, op[0].reg, rm, op[1].reg, rs2, m->funct7);
+            break;
+        }
+        case PSEUDO_LI: {
+            int32_t value = op[1].imm;
+            if (fits_signed(value, 12)) {
+                word = encode_i(0x13, op[0].reg, 0, 0, value);
+                break;
+            }
+            uint32_t hi;
+            int32_t lo;
+            split_offset(value, &hi, &lo);
+            if (lo == 0) {
+                word = encode_u(0x37, op[0].reg, hi);
+                break;
+            }
+            if (as->compress && fits_c_lui(op[0].reg, hi)) {
+                put_bytes(data, encode_ci(3, op[0].reg, (int32_t)(hi << 12) >> 12, 1), 2);
+                data += 2;
+            } else {
+                put_bytes(data, encode_u(0x37, op[0].reg, hi), 4);
+                data += 4;
+            }
+            if (as->compress && fits_c_addi(op[0].reg, lo)) {
+                put_bytes(data, encode_ci(as->rv64 ? 1 : 0, op[0].reg, lo, 1), 2);     // c.addiw/c.addi
+                return 0;
+            }
+            word = encode_i(as->rv64 ? 0x1b : 0x13, op[0].reg, 0, op[0].reg, lo);
+            break;
+        }
+        case PSEUDO_LA:
+        case PSEUDO_CALL:
+        case PSEUDO_TAIL: {
+            // auipc + addi/jalr; fora da seção, relocações pc-relativas
+            const Operand *target = m->format == PSEUDO_LA ? &op[1] : &op[0];
+            int rd = m->format == PSEUDO_LA ? op[0].reg : (m->format == PSEUDO_CALL ? 1 : 6);
+            int link = m->format == PSEUDO_TAIL ? 0 : rd;
+            uint32_t hi = 0;
+            int32_t lo = 0;
+            if (local_distance(as, item, target, &distance)) {
+                split_offset(distance, &hi, &lo);
+            } else if (m->format == PSEUDO_LA) {
+                add_reloc(section, item->offset, R_RISCV_PCREL_HI20, target->symbol, target->imm);
+                add_reloc(section, item->offset + 4, R_RISCV_PCREL_LO12_I, pcrel_label(as, item), 0);
+            } else {
+                add_reloc(section, item->offset, R_RISCV_CALL_PLT, target->symbol, target->imm);
+            }
+            put_bytes(data, encode_u(0x17, rd, hi), 4);
+            word = m->format == PSEUDO_LA ? encode_i(0x13, rd, 0, rd, lo)
+                                          : encode_i(0x67, link, 0, rd, lo);
+            data += 4;
+            break;
+        }
+        case PSEUDO_ALIAS:
+            return asm_error(as, "alias não expandido '%s'", m->name);
+    }
+
+    put_bytes(data, word, 4);
+    return 0;
+}
+
+static int encode_items(Assembler *as) {
+    for (int s = 0; s < SECTION_COUNT; s++) {
+        AsmSection *section = &as->program->sections[s];
+        if (s != SECTION_BSS) {
+            section->data = calloc(section->size ? section->size : 1, 1);
+            if (!section->data) {
+                fprintf(stderr, "Erro: memória insuficiente para a montagem\n");
+                exit(1);
+            }
+        }
+    }
+
+    for (int i = 0; i < as->item_count; i++) {
+        AsmItem *item = &as->items[i];
+        AsmSection *section = &as->program->sections[item->section];
+        if (item->section == SECTION_BSS || item->size == 0) continue;
+        unsigned char *data = section->data + item->offset;
+
+        switch (item->kind) {
+            case ITEM_INSTRUCTION:
+                if (encode_instruction(as, item) != 0) return 1;
+                break;
+            case ITEM_DATA:
+                memcpy(data, item->bytes, item->size);
+                break;
+            case ITEM_VALUE:
+                if (item->operands[0].kind == OPERAND_SYMBOL) {
+                    add_reloc(section, item->offset, R_RISCV_32, item->operands[0].symbol, item->operands[0].imm);
+                } else {
+                    put_bytes(data, (uint32_t)item->operands[0].imm, item->amount);
+                }
+                break;
+            case ITEM_ALIGN:
+                // Preenche código com nop, dados com zero
+                if (item->section == SECTION_TEXT && item->size % 4 == 0) {
+                    for (uint32_t b = 0; b < item->size; b += 4) put_bytes(data + b, 0x00000013, 4);
+                }
+                break;
+            case ITEM_SPACE:
+            case ITEM_LABEL:
+                break;
+        }
+    }
+    return 0;
+}
+
+int asm_assemble(AsmProgram *program, const char *const *lines, int line_count, const AsmOptions *options) {
+    bool compress = options && options->compress;
+    bool rv64 = options && options->xlen == 64;
+    memset(program, 0, sizeof(*program));
+    program->compressed = compress;
+    program->xlen = rv64 ? 64 : 32;
+    for (int s = 0; s < SECTION_COUNT; s++) {
+        program->sections[s].align = s == SECTION_TEXT ? (compress ? 2 : 4) : 1;
+    }
+
+    Assembler as;
+    memset(&as, 0, sizeof(as));
+    as.program = program;
+    as.section = SECTION_TEXT;
+    as.compress = compress;
+    as.rv64 = rv64;
+
+    char buffer[1024];
+    int status = 0;
+    for (int i = 0; i < line_count && status == 0; i++) {
+        as.line = i + 1;
+        size_t length = strlen(lines[i]);
+        if (length >= sizeof(buffer)) {
+            status = asm_error(&as, "linha longa demais");
+            break;
+        }
+        memcpy(buffer, lines[i], length + 1);
+        status = assemble_line(&as, buffer);
+    }
+
+    if (status == 0) {
+        layout_items(&as);
+        status = encode_items(&as);
+    }
+
+    AsmStats *stats = &program->stats;
+    for (int i = 0; i < as.item_count; i++) {
+        if (as.items[i].kind != ITEM_INSTRUCTION || as.items[i].section != SECTION_TEXT) continue;
+        stats->instructions++;
+        if (as.items[i].size == 2) stats->compressed++;
+    }
+    stats->uncompressed_size = program->sections[SECTION_TEXT].size + 2 * stats->compressed;
+
+    for (int i = 0; i < as.item_count; i++) {
+        free(as.items[i].bytes);
+    }
+    free(as.items);
+    return status;
+}
+
+void asm_free(AsmProgram *program) {
+    for (int s = 0; s < SECTION_COUNT; s++) {
+        free(program->sections[s].data);
+        free(program->sections[s].relocs);
+    }
+    for (int i = 0; i < program->symbol_count; i++) {
+        free(program->symbols[i].name);
+    }
+    free(program->symbols);
+    free(program->symbol_buckets);
+    memset(program, 0, sizeof(*program));
+}
@@ -0,0 +1,79 @@
+#ifndef RISCV_ASM_H
+#define RISCV_ASM_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Montador RV32IMFD embutido: lê o texto que o gerador emite e produz um
+// objeto ELF32 relocável, sem passar por um montador externo. Com xlen 64
+// aceita também as instruções do RV64 (ld/sd, formas *w), mas aí o
+// resultado só serve para o simulador: o escritor de ELF é só de 32 bits
+
+enum {
+    SECTION_TEXT,
+    SECTION_RODATA,
+    SECTION_DATA,
+    SECTION_BSS,
+    SECTION_COUNT
+};
+
+typedef struct {
+    uint32_t offset;        // Posição dentro da seção
+    uint32_t type;          // R_RISCV_*
+    int symbol;             // Índice em AsmProgram.symbols
+    int32_t addend;
+} AsmReloc;
+
+typedef struct {
+    unsigned char *data;    // Conteúdo (não usado em .bss)
+    uint32_t size;
+    uint32_t align;
+    AsmReloc *relocs;
+    int reloc_count;
+    int reloc_capacity;
+} AsmSection;
+
+typedef struct {
+    char *name;
+    int section;            // -1 = indefinido (resolvido na ligação)
+    uint32_t value;
+    bool global;
+    int next;               // Próximo símbolo no mesmo bucket (-1 = fim)
+} AsmSymbol;
+
+typedef struct {
+    bool compress;          // Usa as formas de 16 bits da extensão C quando couberem
+    int xlen;               // 32 ou 64 (0 = 32)
+} AsmOptions;
+
+typedef struct {
+    int instructions;
+    int compressed;
+    uint32_t uncompressed_size;     // Tamanho que o .text teria sem RVC
+} AsmStats;
+
+typedef struct {
+    AsmSection sections[SECTION_COUNT];
+    AsmSymbol *symbols;
+    int symbol_count;
+    int symbol_capacity;
+    int *symbol_buckets;    // Índice hash dos nomes
+    int symbol_bucket_count;
+    bool compressed;        // Objeto usa RVC (EF_RISCV_RVC)
+    int xlen;
+    AsmStats stats;
+    char error[256];        // Primeira mensagem de erro da montagem
+} AsmProgram;
+
+extern const char *const asm_section_names[SECTION_COUNT];
+
+// Monta as linhas (cada uma pode terminar em '\n'); retorna 0 em caso de
+// sucesso e 1 com a mensagem em program->error. options pode ser NULL
+int asm_assemble(AsmProgram *program, const char *const *lines, int line_count, const AsmOptions *options);
+void asm_free(AsmProgram *program);
+
+// Escreve o programa montado como ELF32 RISC-V relocável (ET_REL)
+int elf_write_object(const AsmProgram *program, FILE *output);
+
+#endif
@@ -0,0 +1,231 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <elf.h>
+#include "riscv_asm.h"
+
+// Escritor de objetos ELF32 relocáveis para RISC-V. O layout do arquivo é:
+// cabeçalho, conteúdo das seções, .rela.*, .symtab, .strtab, .shstrtab e,
+// por último, a tabela de cabeçalhos de seção
+
+#define MAX_ELF_SECTIONS (1 + 2 * SECTION_COUNT + 3)
+
+// Tabela de strings (.strtab/.shstrtab) montada em memória
+typedef struct {
+    char *data;
+    size_t size;
+    size_t capacity;
+} StringTable;
+
+static uint32_t add_string(StringTable *table, const char *text) {
+    size_t length = strlen(text) + 1;
+    if (table->size + length > table->capacity) {
+        table->capacity = (table->size + length) * 2;
+        table->data = realloc(table->data, table->capacity);
+        if (!table->data) {
+            fprintf(stderr, "Erro: memória insuficiente para o objeto ELF\n");
+            exit(1);
+        }
+    }
+    memcpy(table->data + table->size, text, length);
+    table->size += length;
+    return (uint32_t)(table->size - length);
+}
+
+static uint32_t align_to(uint32_t value, uint32_t align) {
+    return (value + align - 1) & ~(align - 1);
+}
+
+static void write_padding(FILE *output, uint32_t *position, uint32_t target) {
+    while (*position < target) {
+        fputc(0, output);
+        (*position)++;
+    }
+}
+
+int elf_write_object(const AsmProgram *program, FILE *output) {
+    if (program->xlen == 64) {
+        fprintf(stderr, "Erro: o objeto ELF só é gerado para RV32\n");
+        return 1;
+    }
+    Elf32_Shdr headers[MAX_ELF_SECTIONS];
+    int section_index[SECTION_COUNT];      // Seção do montador -> índice no ELF
+    int rela_index[SECTION_COUNT];
+    int header_count = 1;
+    StringTable section_names = { 0 };
+    StringTable names = { 0 };
+
+    memset(headers, 0, sizeof(headers));
+    add_string(&section_names, "");
+    add_string(&names, "");
+
+    // Seções com conteúdo (.text sempre existe)
+    for (int s = 0; s < SECTION_COUNT; s++) {
+        const AsmSection *section = &program->sections[s];
+        section_index[s] = -1;
+        if (s != SECTION_TEXT && section->size == 0) continue;
+
+        Elf32_Shdr *header = &headers[header_count];
+        header->sh_name = add_string(&section_names, asm_section_names[s]);
+        header->sh_type = s == SECTION_BSS ? SHT_NOBITS : SHT_PROGBITS;
+        header->sh_flags = SHF_ALLOC;
+        if (s == SECTION_TEXT) header->sh_flags |= SHF_EXECINSTR;
+        if (s == SECTION_DATA || s == SECTION_BSS) header->sh_flags |= SHF_WRITE;
+        header->sh_size = section->size;
+        header->sh_addralign = section->align;
+        section_index[s] = header_count++;
+    }
+
+    // Tabela de símbolos: nulo, símbolos de seção, locais e depois globais
+    // (o ELF exige os locais primeiro; sh_info aponta o primeiro global)
+    int *symbol_index = malloc((program->symbol_count ? program->symbol_count : 1) * sizeof(int));
+    Elf32_Sym *symbols = calloc(1 + SECTION_COUNT + program->symbol_count, sizeof(Elf32_Sym));
+    int symbol_count = 1;
+    int first_global = 1;
+
+    for (int s = 0; s < SECTION_COUNT; s++) {
+        if (section_index[s] < 0) continue;
+        symbols[symbol_count].st_info = ELF32_ST_INFO(STB_LOCAL, STT_SECTION);
+        symbols[symbol_count].st_shndx = section_index[s];
+        symbol_count++;
+    }
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < program->symbol_count; i++) {
+            const AsmSymbol *symbol = &program->symbols[i];
+            // Referências sem definição são externas, como no montador do GNU
+            bool global = symbol->global || symbol->section < 0;
+            if (global != (pass == 1)) continue;
+
+            Elf32_Sym *entry = &symbols[symbol_count];
+            entry->st_name = add_string(&names, symbol->name);
+            entry->st_value = symbol->section < 0 ? 0 : symbol->value;
+            entry->st_info = ELF32_ST_INFO(global ? STB_GLOBAL : STB_LOCAL,
+                                           symbol->section == SECTION_TEXT && global ? STT_FUNC : STT_NOTYPE);
+            entry->st_shndx = symbol->section < 0 ? SHN_UNDEF : section_index[symbol->section];
+            symbol_index[i] = symbol_count++;
+        }
+        if (pass == 0) first_global = symbol_count;
+    }
+
+    // Relocações de cada seção em Elf32_Rela
+    // (a .symtab vem logo depois das .rela.*)
+    int symtab = header_count;
+    for (int s = 0; s < SECTION_COUNT; s++) {
+        rela_index[s] = -1;
+        if (section_index[s] >= 0 && program->sections[s].reloc_count > 0) symtab++;
+    }
+    for (int s = 0; s < SECTION_COUNT; s++) {
+        if (section_index[s] < 0 || program->sections[s].reloc_count == 0) continue;
+        char name[32];
+        snprintf(name, sizeof(name), ".rela%s", asm_section_names[s]);
+
+        Elf32_Shdr *header = &headers[header_count];
+        header->sh_name = add_string(&section_names, name);
+        header->sh_type = SHT_RELA;
+        header->sh_flags = SHF_INFO_LINK;
+        header->sh_size = program->sections[s].reloc_count * sizeof(Elf32_Rela);
+        header->sh_link = symtab;
+        header->sh_info = section_index[s];
+        header->sh_addralign = 4;
+        header->sh_entsize = sizeof(Elf32_Rela);
+        rela_index[s] = header_count++;
+    }
+
+    Elf32_Shdr *symtab_header = &headers[header_count++];
+    int strtab = header_count;
+    Elf32_Shdr *strtab_header = &headers[header_count++];
+    int shstrtab = header_count;
+    Elf32_Shdr *shstrtab_header = &headers[header_count++];
+
+    symtab_header->sh_name = add_string(&section_names, ".symtab");
+    symtab_header->sh_type = SHT_SYMTAB;
+    symtab_header->sh_size = symbol_count * sizeof(Elf32_Sym);
+    symtab_header->sh_link = strtab;
+    symtab_header->sh_info = first_global;
+    symtab_header->sh_addralign = 4;
+    symtab_header->sh_entsize = sizeof(Elf32_Sym);
+
+    strtab_header->sh_name = add_string(&section_names, ".strtab");
+    strtab_header->sh_type = SHT_STRTAB;
+    strtab_header->sh_size = names.size;
+    strtab_header->sh_addralign = 1;
+
+    shstrtab_header->sh_name = add_string(&section_names, ".shstrtab");
+    shstrtab_header->sh_type = SHT_STRTAB;
+    shstrtab_header->sh_size = section_names.size;
+    shstrtab_header->sh_addralign = 1;
+
+    // Posição de cada seção no arquivo
+    uint32_t position = sizeof(Elf32_Ehdr);
+    for (int i = 1; i < header_count; i++) {
+        uint32_t align = headers[i].sh_addralign ? headers[i].sh_addralign : 1;
+        position = align_to(position, align);
+        headers[i].sh_offset = position;
+        if (headers[i].sh_type != SHT_NOBITS) position += headers[i].sh_size;
+    }
+    uint32_t header_table = align_to(position, 4);
+
+    Elf32_Ehdr elf_header;
+    memset(&elf_header, 0, sizeof(elf_header));
+    memcpy(elf_header.e_ident, ELFMAG, SELFMAG);
+    elf_header.e_ident[EI_CLASS] = ELFCLASS32;
+    elf_header.e_ident[EI_DATA] = ELFDATA2LSB;
+    elf_header.e_ident[EI_VERSION] = EV_CURRENT;
+    elf_header.e_ident[EI_OSABI] = ELFOSABI_SYSV;
+    elf_header.e_type = ET_REL;
+    elf_header.e_machine = EM_RISCV;
+    elf_header.e_version = EV_CURRENT;
+    elf_header.e_flags = program->compressed ? EF_RISCV_RVC : 0;   // ABI ilp32 (sem float em registradores)
+    elf_header.e_ehsize = sizeof(Elf32_Ehdr);
+    elf_header.e_shoff = header_table;
+    elf_header.e_shentsize = sizeof(Elf32_Shdr);
+    elf_header.e_shnum = header_count;
+    elf_header.e_shstrndx = shstrtab;
+
+    // Escrita, na mesma ordem dos deslocamentos calculados acima
+    position = 0;
+    fwrite(&elf_header, sizeof(elf_header), 1, output);
+    position += sizeof(elf_header);
+
+    for (int s = 0; s < SECTION_COUNT; s++) {
+        if (section_index[s] < 0 || s == SECTION_BSS) continue;
+        const Elf32_Shdr *header = &headers[section_index[s]];
+        write_padding(output, &position, header->sh_offset);
+        fwrite(program->sections[s].data, 1, program->sections[s].size, output);
+        position += program->sections[s].size;
+    }
+    for (int s = 0; s < SECTION_COUNT; s++) {
+        if (rela_index[s] < 0) continue;
+        write_padding(output, &position, headers[rela_index[s]].sh_offset);
+        for (int r = 0; r < program->sections[s].reloc_count; r++) {
+            const AsmReloc *reloc = &program->sections[s].relocs[r];
+            Elf32_Rela entry;
+            entry.r_offset = reloc->offset;
+            entry.r_info = ELF32_R_INFO(symbol_index[reloc->symbol], reloc->type);
+            entry.r_addend = reloc->addend;
+            fwrite(&entry, sizeof(entry), 1, output);
+            position += sizeof(entry);
+        }
+    }
+
+    write_padding(output, &position, symtab_header->sh_offset);
+    fwrite(symbols, sizeof(Elf32_Sym), symbol_count, output);
+    position += symbol_count * sizeof(Elf32_Sym);
+
+    write_padding(output, &position, strtab_header->sh_offset);
+    fwrite(names.data, 1, names.size, output);
+    position += names.size;
+
+    write_padding(output, &position, shstrtab_header->sh_offset);
+    fwrite(section_names.data, 1, section_names.size, output);
+    position += section_names.size;
+
+    write_padding(output, &position, header_table);
+    fwrite(headers, sizeof(Elf32_Shdr), header_count, output);
+
+    free(symbols);
+    free(symbol_index);
+    free(names.data);
+    free(section_names.data);
+    return ferror(output) ? 1 : 0;
+}
@@ -0,0 +1,119 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "riscv_ir.h"
+
+// Avaliador parcial: executa o IR em SSA como o código gerado o executaria,
+// a partir da entrada e com um limite de instruções. As variáveis ficam numa
+// cópia da pilha (um IR_LOAD lê o lugar da variável, com a extensão de sinal
+// do lb/lh, e não a definição que chega), então o resultado é o mesmo do
+// programa compilado depois do SCCP. Os phi não geram código e são ignorados;
+// como em ir_instruction_count, as constantes não contam no limite.
+// O avaliador para na primeira leitura da entrada: o que veio antes dela não
+// depende do usuário e pode ser trocado pelo seu efeito
+
+static void add_print(IrEvalResult *result, char op, int64_t value) {
+    if (result->print_count == result->print_capacity) {
+        result->print_capacity = result->print_capacity ? result->print_capacity * 2 : 64;
+        result->prints = realloc(result->prints, result->print_capacity * sizeof(IrEvalPrint));
+        if (!result->prints) {
+            fprintf(stderr, "Erro: memória insuficiente para a avaliação parcial\n");
+            exit(1);
+        }
+    }
+    result->prints[result->print_count].op = op;
+    result->prints[result->print_count].value = value;
+    result->print_count++;
+}
+
+void ir_evaluate(const IrFunction *fn, const IrEvalVar *vars, int var_count, long budget, IrEvalResult *result) {
+    memset(result, 0, sizeof(IrEvalResult));
+    result->var_values = calloc(var_count ? var_count : 1, sizeof(int64_t));
+    result->var_defined = calloc(var_count ? var_count : 1, sizeof(bool));
+    result->status = EVAL_BUDGET;
+    if (fn->block_count == 0) return;
+
+    int64_t *values = calloc(fn->value_count ? fn->value_count : 1, sizeof(int64_t));
+    int block_id = fn->entry;
+    int index = 0;
+    bool running = true;
+
+    while (running && result->steps < budget) {
+        const IrBlock *block = &fn->blocks[block_id];
+        if (index >= block->inst_count) {
+            // Bloco sem terminador: só acontece num IR mal formado
+            result->status = EVAL_UNDEFINED;
+            break;
+        }
+        const IrInst *inst = &block->insts[index++];
+        if (inst->opcode == IR_PHI) continue;
+        if (inst->opcode != IR_CONST) result->steps++;
+
+        int64_t a = inst->args[0] >= 0 ? values[inst->args[0]] : 0;
+        int64_t b = inst->args[1] >= 0 ? values[inst->args[1]] : 0;
+        int next = -1;
+
+        switch (inst->opcode) {
+            case IR_CONST:
+                values[inst->dest] = inst->imm;
+                break;
+            case IR_LOAD:
+                if (!result->var_defined[inst->var]) {
+                    // O conteúdo da pilha só é conhecido na execução
+                    result->status = EVAL_UNDEFINED;
+                    running = false;
+                } else {
+                    values[inst->dest] = result->var_values[inst->var];
+                }
+                break;
+            case IR_STORE:
+                result->var_values[inst->var] = ir_fold_load(&vars[inst->var], a);
+                result->var_defined[inst->var] = true;
+                break;
+            case IR_READ:
+                result->status = EVAL_INPUT;
+                result->resume_block = block_id;
+                result->resume_index = index - 1;
+                result->steps--;
+                running = false;
+                break;
+            case IR_BINARY:
+                values[inst->dest] = ir_fold_binary(fn->values[inst->args[0]].type, inst->op, a, b);
+                break;
+            case IR_CONVERT:
+                values[inst->dest] = ir_fold_convert(inst->type, fn->values[inst->args[0]].type, a);
+                break;
+            case IR_PRINT:
+                add_print(result, inst->op, a);
+                break;
+            case IR_PRINT_STRING:
+                add_print(result, 's', inst->imm);
+                break;
+            case IR_BRANCH:
+                next = block->succ[ir_fold_binary(inst->type, inst->op, a, b) ? 0 : 1];
+                break;
+            case IR_JUMP:
+                next = block->succ[0];
+                break;
+            case IR_EXIT:
+                result->status = EVAL_FINISHED;
+                running = false;
+                break;
+            default:
+                break;
+        }
+        if (next >= 0) {
+            block_id = next;
+            index = 0;
+        }
+    }
+    free(values);
+}
+
+void ir_eval_free(IrEvalResult *result) {
+    free(result->prints);
+    free(result->var_values);
+    free(result->var_defined);
+    memset(result, 0, sizeof(IrEvalResult));
+}
@@ -4,621 +4,2744 @@
 #include <ctype.h>
 #include <stdbool.h>
 #include <stdarg.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <time.h>
+#include "riscv_gen3.h"
+#include "riscv_asm.h"
+#include "riscv_ir.h"
+#include "riscv_runtime.h"
 
 #define MAX_LINE_LENGTH 256
-#define MAX_VARIABLES 50
+#define VAR_TABLE_INITIAL_BUCKETS 64   // Potência de 2; a tabela cresce sob demanda
 #define MAX_TEMPORARIES 100
-#define TEMP_RESULT_OFFSET 16  
-#define MAX_STRINGS 100  
+#define MAX_PRINT_ARGS 32
+#define CODE_CHUNK_SIZE (64 * 1024)    // Bloco de texto do buffer de código
+#define OUTPUT_BUFFER_SIZE (256 * 1024) // Bloco usado na escrita do .s
+#define EVAL_DEFAULT_BUDGET 1000000     // Instruções do IR que o passo eval interpreta
+#define EVAL_MAX_OUTPUT (64 * 1024)     // Maior saída que vira string da .rodata
+#define PROFILE_BUCKETS 1024            // Potência de 2
+#define IF_STATIC_RATIO 0.5             // Sem perfil: fração das vezes em que o if é verdadeiro
+#define LOOP_STATIC_TRIPS 10.0          // Sem perfil: iterações estimadas de cada while
 
-void write_output_with_line_numbers(FILE *output);
 
 typedef struct {
     int label;
     char* value;
 } StringEntry;
 
+// Tipos conhecidos pelo gerador; o texto vindo do sintático ("INT",
+// "FLOAT_KW", ...) é convertido uma única vez, na declaração
+typedef enum {
+    TYPE_INT,
+    TYPE_CHAR,
+    TYPE_SHORT,
+    TYPE_LONG,
+    TYPE_FLOAT,
+    TYPE_DOUBLE,
+    TYPE_BOOL,
+    TYPE_STRING
+} VarType;
+
 typedef struct {
-    char name[50];
-    char type[20];
+    char *name;
+    VarType type;
     int offset;
-    int size;
+    int size;       // Tamanho e alinhamento ficam em cache na declaração
+    int align;
     bool is_const;
     bool is_static;
+    int next;       // Próxima variável no mesmo bucket (-1 = fim)
 } Variable;
 
-typedef struct {
-    char op;
-    int precedence;
-} Operator;
+// Bloco de memória onde o texto das linhas é armazenado em sequência
+typedef struct CodeChunk {
+    struct CodeChunk *next;
+    size_t used;
+    size_t capacity;
+    char data[];
+} CodeChunk;
 
+// Cada linha aponta para o seu texto dentro de um chunk
 typedef struct {
-    int line_number;
-    char code[MAX_LINE_LENGTH];
+    char *code;
+    int length;
 } CodeLine;
 
-Variable variables[MAX_VARIABLES];
-int var_count = 0;
-int current_offset = 0;
-int temp_count = 0;
-int label_count = 0;
-int current_depth = 0;
+// Contagens de um if/while no perfil. A chave junta o comando, a ocorrência
+// (quantos comandos iguais, com a mesma condição, vieram antes) e a
+// condição, o que resiste a mudanças no resto do fonte
+typedef struct {
+    char *key;          // "if 0 x < 3", "while 1 i < n"
+    long executions;    // Vezes em que o teste rodou (no while, entradas no laço)
+    long taken;         // Vezes em que a condição valeu (no while, iterações)
+    int next;           // Próxima entrada no mesmo bucket (-1 = fim)
+} ProfileEntry;
+
+typedef struct {
+    ProfileEntry *entries;
+    int count;
+    int capacity;
+    int *buckets;       // PROFILE_BUCKETS cabeças, alocadas na primeira inserção
+} ProfileTable;
+
+// Estrutura de controle aberta (if ou while) enquanto o corpo é lido
+typedef enum {
+    CONTROL_IF,
+    CONTROL_WHILE
+} ControlKind;
+
+typedef struct {
+    ControlKind kind;
+    int label;
+    char *condition;    // while: repetida no teste do fim do laço
+    int then_block;     // Bloco verdadeiro (no while, o corpo)
+    int else_block;     // Destino do teste quando falso (senão, ou a saída)
+    int end_block;      // Junção depois do senão (-1 = sem senão)
+    int then_start;     // Posição do bloco verdadeiro no layout
+    int else_start;     // Posição do senão no layout
+    bool else_first;    // O senão vem logo depois do teste no layout
+    const ProfileEntry *profile;    // Contagens do --profile-use (NULL = sem perfil)
+    int counter;        // Primeiro dos dois contadores do --profile-generate (-1 = nenhum)
+    int region;         // Região do --cycle-counters (-1 = nenhuma)
+    int first_line;     // Linha do fonte onde a estrutura começa
+    double outer_weight;    // Frequência do código em volta da estrutura
+    double taken_ratio;     // Blocos verdadeiros por execução do teste
+} ControlEntry;
+
+// Todo o estado de uma compilação; cada arquivo usa o seu próprio contexto,
+// o que permite compilar vários arquivos em paralelo (modo --batch)
+typedef struct {
+    Variable *variables;        // Variáveis na ordem de declaração
+    int var_count;
+    int var_capacity;
+    int *var_buckets;           // Índice hash: cabeça de cada bucket
+    int var_bucket_count;
+    int current_offset;
+    int label_count;
+    StringEntry *strings;       // Strings já postas na .rodata (rótulo str_N)
+    int string_count;
+    int string_capacity;
+    ControlEntry *control;      // Pilha de if/while abertos
+    int control_depth;
+    int control_capacity;
+
+    IrFunction ir;              // Programa lido, em blocos básicos
+    int block;                  // Bloco onde as novas instruções entram
+
+    // Perfil: as frequências estimadas (ou medidas) dos blocos guiam o
+    // layout dos if/else e a escolha das variáveis que ficam em registradores
+    ProfileTable profile;       // Contagens do --profile-use
+    ProfileTable profile_seen;  // Chaves sem a ocorrência; executions conta as já vistas
+    int *profile_keys;          // String (str_N) da chave de cada par de contadores
+    int profile_counters;
+    int profile_key_capacity;
+    double weight;              // Frequência do bloco atual
+    double *block_weights;      // Frequência de cada bloco, gravada em enter_block
+    int block_weight_capacity;
+    const char **var_regs;      // Registrador de cada variável promovida (NULL = pilha)
+
+    // --cycle-counters: uma entrada de __rt_cycle_table por região medida
+    int *cycle_labels;          // String (str_N) com a descrição de cada região
+    int cycle_regions;
+    int cycle_label_capacity;
+    int source_line;            // Linha do fonte, do último marcador "Linha N" do sintático
+    int error_count;            // Erros da geração: o gerador termina com falha
+    FILE *diagnostics;          // Onde as mensagens de erro saem (stderr ou a resposta do servidor)
+
+    // Geração a partir do IR
+    int *use_counts;            // Usos de cada valor
+    int *temp_slots;            // Temporário da pilha de cada valor guardado
+    int temp_used;              // Temporários ocupados no comando atual
+    int pending_value;          // Valor deixado num registrador para a próxima instrução
+    const char *pending_reg;
+    unsigned runtime_parts;     // Rotinas de apoio usadas (RuntimeRoutine)
 
-Operator op_stack[100];
-int op_stack_top = -1;
+    CodeChunk *code_chunks;     // Primeiro chunk (para liberar)
+    CodeChunk *current_chunk;   // Chunk onde as novas linhas são escritas
+    CodeLine *output_code;      // Índice das linhas, cresce sob demanda
+    int code_line_count;
+    int code_line_capacity;
+    CodeLine *data_code;        // Linhas da .rodata, emitidas depois do código
+    int data_line_count;
+    int data_line_capacity;
+    int prologue_line;          // Linha do "addi sp", corrigida no final
+    const GenOptions *options;
+    const RiscvTarget *target;
 
-CodeLine output_code[1000];
-int code_line_count = 0;
+    // Registradores de trabalho: t0-t2 normalmente; no modo --rvc, a2-a4,
+    // que cabem nos campos de 3 bits das instruções comprimidas
+    const char *r0;
+    const char *r1;
+    const char *r2;
+    const char *result;         // Destino das operações (r2, ou r0 no --rvc)
+} GenContext;
 
-void push_op(char op, int precedence) {
-    op_stack[++op_stack_top].op = op;
-    op_stack[op_stack_top].precedence = precedence;
+CodeChunk* new_code_chunk(GenContext *ctx, size_t min_size) {
+    size_t capacity = min_size > CODE_CHUNK_SIZE ? min_size : CODE_CHUNK_SIZE;
+    CodeChunk *chunk = malloc(sizeof(CodeChunk) + capacity);
+    if (!chunk) {
+        fprintf(stderr, "Erro: memória insuficiente para o código gerado\n");
+        exit(1);
+    }
+    chunk->next = NULL;
+    chunk->used = 0;
+    chunk->capacity = capacity;
+
+    if (ctx->current_chunk) {
+        ctx->current_chunk->next = chunk;
+    } else {
+        ctx->code_chunks = chunk;
+    }
+    ctx->current_chunk = chunk;
+    return chunk;
+}
+
+// Formata o texto direto no espaço livre do chunk atual; se não couber,
+// abre um chunk novo (grande o bastante para a linha) e formata de novo
+char* format_into_chunks(GenContext *ctx, int *out_length, const char *format, va_list args) {
+    va_list retry;
+    va_copy(retry, args);
+
+    CodeChunk *chunk = ctx->current_chunk ? ctx->current_chunk : new_code_chunk(ctx, 0);
+    size_t available = chunk->capacity - chunk->used;
+    int length = vsnprintf(chunk->data + chunk->used, available, format, args);
+    if (length >= 0 && (size_t)length >= available) {
+        chunk = new_code_chunk(ctx, length + 1);
+        vsnprintf(chunk->data, chunk->capacity, format, retry);
+    }
+    va_end(retry);
+
+    if (length < 0) return NULL;
+
+    char *code = chunk->data + chunk->used;
+    chunk->used += length + 1;
+    *out_length = length;
+    return code;
 }
 
-Operator pop_op() {
-    return op_stack[op_stack_top--];
+// Acrescenta uma linha já no chunk ao fim de uma lista de linhas
+void append_line(CodeLine **lines, int *count, int *capacity, char *code, int length) {
+    if (*count == *capacity) {
+        *capacity = *capacity ? *capacity * 2 : 1024;
+        *lines = realloc(*lines, *capacity * sizeof(CodeLine));
+        if (!*lines) {
+            fprintf(stderr, "Erro: memória insuficiente para o código gerado\n");
+            exit(1);
+        }
+    }
+    (*lines)[*count].code = code;
+    (*lines)[*count].length = length;
+    (*count)++;
 }
 
-Operator peek_op() {
-    return op_stack[op_stack_top];
+void add_code_line(GenContext *ctx, const char *format,...) {
+    va_list args;
+    va_start(args, format);
+
+    int length;
+    char *code = format_into_chunks(ctx, &length, format, args);
+    if (code) {
+        append_line(&ctx->output_code, &ctx->code_line_count, &ctx->code_line_capacity, code, length);
+    }
+
+    va_end(args);
 }
 
-bool is_op_stack_empty() {
-    return op_stack_top == -1;
+// Linha da seção .rodata; fica separada até o fim para não cair no meio do código
+void add_data_line(GenContext *ctx, const char *format,...) {
+    va_list args;
+    va_start(args, format);
+
+    int length;
+    char *code = format_into_chunks(ctx, &length, format, args);
+    if (code) {
+        append_line(&ctx->data_code, &ctx->data_line_count, &ctx->data_line_capacity, code, length);
+    }
+
+    va_end(args);
 }
 
-void add_code_line(const char *format,...) {
+// Reescreve uma linha já emitida (backpatch); o texto antigo fica no chunk
+void patch_code_line(GenContext *ctx, int index, const char *format, ...) {
     va_list args;
     va_start(args, format);
-    
-    if (code_line_count < 1000) {
-        output_code[code_line_count].line_number = code_line_count + 1;
-        vsnprintf(output_code[code_line_count].code, MAX_LINE_LENGTH, format, args);
-        code_line_count++;
+
+    int length;
+    char *code = format_into_chunks(ctx, &length, format, args);
+    if (code && index >= 0 && index < ctx->code_line_count) {
+        ctx->output_code[index].code = code;
+        ctx->output_code[index].length = length;
     }
-    
+
     va_end(args);
 }
 
-Variable* find_variable(const char *var_name) {
-    for (int i = 0; i < var_count; i++) {
-        if (strcmp(variables[i].name, var_name) == 0) {
-            return &variables[i];
+void free_code_buffer(GenContext *ctx) {
+    while (ctx->code_chunks) {
+        CodeChunk *next = ctx->code_chunks->next;
+        free(ctx->code_chunks);
+        ctx->code_chunks = next;
+    }
+    ctx->current_chunk = NULL;
+    free(ctx->output_code);
+    free(ctx->data_code);
+    ctx->output_code = NULL;
+    ctx->data_code = NULL;
+    ctx->code_line_count = ctx->data_line_count = 0;
+    ctx->code_line_capacity = ctx->data_line_capacity = 0;
+}
+
+// Hash FNV-1a do nome da variável
+unsigned int hash_name(const char *name) {
+    unsigned int hash = 2166136261u;
+    while (*name) {
+        hash ^= (unsigned char)*name++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+Variable* find_variable(GenContext *ctx, const char *var_name) {
+    if (ctx->var_bucket_count == 0) return NULL;
+
+    int index = ctx->var_buckets[hash_name(var_name) & (ctx->var_bucket_count - 1)];
+    while (index != -1) {
+        if (strcmp(ctx->variables[index].name, var_name) == 0) {
+            return &ctx->variables[index];
         }
+        index = ctx->variables[index].next;
     }
     return NULL;
 }
 
-int get_size_from_type(const char *type) {
-    if (strcmp(type, "CHAR") == 0 || strcmp(type, "CHAR_KW") == 0) return 1;
-    if (strcmp(type, "SHORT") == 0 || strcmp(type, "SHORT_KW") == 0) return 2;
-    if (strcmp(type, "INT") == 0 || strcmp(type, "INT_KW") == 0) return 4;
-    if (strcmp(type, "FLOAT") == 0 || strcmp(type, "FLOAT_KW") == 0) return 4;
-    if (strcmp(type, "DOUBLE") == 0 || strcmp(type, "DOUBLE_KW") == 0) return 8;
-    if (strcmp(type, "LONG") == 0 || strcmp(type, "LONG_KW") == 0) return 8;
-    if (strcmp(type, "BOOL_KW") == 0) return 1;
-    if (strcmp(type, "STRING") == 0) return 4; // Ponteiro para string
-    return 4; // padrão
+VarType type_from_name(const char *type) {
+    if (strcmp(type, "CHAR") == 0 || strcmp(type, "CHAR_KW") == 0) return TYPE_CHAR;
+    if (strcmp(type, "SHORT") == 0 || strcmp(type, "SHORT_KW") == 0) return TYPE_SHORT;
+    if (strcmp(type, "INT") == 0 || strcmp(type, "INT_KW") == 0) return TYPE_INT;
+    if (strcmp(type, "FLOAT") == 0 || strcmp(type, "FLOAT_KW") == 0) return TYPE_FLOAT;
+    if (strcmp(type, "DOUBLE") == 0 || strcmp(type, "DOUBLE_KW") == 0) return TYPE_DOUBLE;
+    if (strcmp(type, "LONG") == 0 || strcmp(type, "LONG_KW") == 0) return TYPE_LONG;
+    if (strcmp(type, "BOOL_KW") == 0) return TYPE_BOOL;
+    if (strcmp(type, "STRING") == 0) return TYPE_STRING;
+    return TYPE_INT; // padrão
 }
 
-void add_variable(const char *var_name, const char *var_type, bool is_const, bool is_static) {
-    if (find_variable(var_name)) return;
-    
-    if (var_count < MAX_VARIABLES) {
-        strcpy(variables[var_count].name, var_name);
-        strcpy(variables[var_count].type, var_type);
-        variables[var_count].size = get_size_from_type(var_type);
-        variables[var_count].offset = current_offset;
-        variables[var_count].is_const = is_const;
-        variables[var_count].is_static = is_static;
-        current_offset += variables[var_count].size;
-        var_count++;
+int get_size_from_type(VarType type) {
+    switch (type) {
+        case TYPE_CHAR:
+        case TYPE_BOOL:
+            return 1;
+        case TYPE_SHORT:
+            return 2;
+        case TYPE_DOUBLE:
+        case TYPE_LONG:
+            return 8;
+        case TYPE_STRING:   // Ponteiro para string
+        case TYPE_INT:
+        case TYPE_FLOAT:
+        default:
+            return 4;
+    }
+}
+
+// Redistribui as variáveis quando a tabela passa de metade da ocupação
+void grow_var_buckets(GenContext *ctx) {
+    int new_count = ctx->var_bucket_count ? ctx->var_bucket_count * 2 : VAR_TABLE_INITIAL_BUCKETS;
+    int *buckets = malloc(new_count * sizeof(int));
+    if (!buckets) {
+        fprintf(stderr, "Erro: memória insuficiente para a tabela de variáveis\n");
+        exit(1);
+    }
+    for (int i = 0; i < new_count; i++) buckets[i] = -1;
+
+    for (int i = 0; i < ctx->var_count; i++) {
+        int bucket = hash_name(ctx->variables[i].name) & (new_count - 1);
+        ctx->variables[i].next = buckets[bucket];
+        buckets[bucket] = i;
+    }
+
+    free(ctx->var_buckets);
+    ctx->var_buckets = buckets;
+    ctx->var_bucket_count = new_count;
+}
+
+void add_variable(GenContext *ctx, const char *var_name, const char *var_type, bool is_const, bool is_static) {
+    if (find_variable(ctx, var_name)) return;
+
+    if (ctx->var_count == ctx->var_capacity) {
+        ctx->var_capacity = ctx->var_capacity ? ctx->var_capacity * 2 : VAR_TABLE_INITIAL_BUCKETS / 2;
+        ctx->variables = realloc(ctx->variables, ctx->var_capacity * sizeof(Variable));
+        if (!ctx->variables) {
+            fprintf(stderr, "Erro: memória insuficiente para a tabela de variáveis\n");
+            exit(1);
+        }
+    }
+    if ((ctx->var_count + 1) * 2 > ctx->var_bucket_count) {
+        grow_var_buckets(ctx);
     }
+
+    Variable *var = &ctx->variables[ctx->var_count];
+    var->name = strdup(var_name);
+    var->type = type_from_name(var_type);
+    var->size = get_size_from_type(var->type);
+    var->align = var->size;
+    var->is_const = is_const;
+    var->is_static = is_static;
+
+    // Alinha o deslocamento ao tamanho do tipo
+    ctx->current_offset = (ctx->current_offset + var->align - 1) & ~(var->align - 1);
+    var->offset = ctx->current_offset;
+    ctx->current_offset += var->size;
+
+    int bucket = hash_name(var_name) & (ctx->var_bucket_count - 1);
+    var->next = ctx->var_buckets[bucket];
+    ctx->var_buckets[bucket] = ctx->var_count;
+    ctx->var_count++;
 }
 
-void generate_riscv_header() {
-    add_code_line(".text\n");
-    add_code_line(".globl main\n");
-    add_code_line("main:\n");
-    add_code_line("    addi sp, sp, -%d\n", current_offset + MAX_TEMPORARIES*4);
+void free_variables(GenContext *ctx) {
+    for (int i = 0; i < ctx->var_count; i++) {
+        free(ctx->variables[i].name);
+    }
+    free(ctx->variables);
+    free(ctx->var_buckets);
+    ctx->variables = NULL;
+    ctx->var_buckets = NULL;
+    ctx->var_count = ctx->var_capacity = ctx->var_bucket_count = 0;
 }
 
-void generate_riscv_footer() {
-    add_code_line("    li a7, 10\n");
-    add_code_line("    ecall\n");
+/* ---------- Perfil ---------- */
+
+ProfileEntry* profile_find(ProfileTable *table, const char *key) {
+    if (!table->buckets) return NULL;
+    int index = table->buckets[hash_name(key) & (PROFILE_BUCKETS - 1)];
+    while (index >= 0) {
+        if (strcmp(table->entries[index].key, key) == 0) return &table->entries[index];
+        index = table->entries[index].next;
+    }
+    return NULL;
 }
 
-void generate_load_operand(const char *operand, const char *reg) {
-    if (isdigit(operand[0])) {
-        add_code_line("    li %s, %s\n", reg, operand);
-    } else if (operand[0] == '\'') { // Caractere
-        add_code_line("    li %s, %d\n", reg, operand[1]);
-    } else if (operand[0] == '"') { // String (tratada como ponteiro)
-        add_code_line("    la %s, %s\n", reg, operand);
-    } else {
-        Variable *var = find_variable(operand);
-        if (var) {
-            if (strcmp(var->type, "FLOAT") == 0 || strcmp(var->type, "FLOAT_KW") == 0) {
-                add_code_line("    flw %s, %d(sp)\n", reg, var->offset);
-            } else if (strcmp(var->type, "DOUBLE") == 0 || strcmp(var->type, "DOUBLE_KW") == 0) {
-                add_code_line("    fld %s, %d(sp)\n", reg, var->offset);
-            } else {
-                add_code_line("    lw %s, %d(sp)\n", reg, var->offset);
-            }
-        } else {
-            add_code_line("    # ERRO: Variável '%s' não declarada\n", operand);
+// Entrada nova, com as contagens zeradas
+ProfileEntry* profile_add(ProfileTable *table, const char *key) {
+    if (!table->buckets) {
+        table->buckets = malloc(PROFILE_BUCKETS * sizeof(int));
+        for (int i = 0; i < PROFILE_BUCKETS; i++) table->buckets[i] = -1;
+    }
+    if (table->count == table->capacity) {
+        table->capacity = table->capacity ? table->capacity * 2 : 64;
+        table->entries = realloc(table->entries, table->capacity * sizeof(ProfileEntry));
+        if (!table->entries) {
+            fprintf(stderr, "Erro: memória insuficiente para o perfil\n");
+            exit(1);
+        }
+    }
+    unsigned int bucket = hash_name(key) & (PROFILE_BUCKETS - 1);
+    ProfileEntry *entry = &table->entries[table->count];
+    entry->key = strdup(key);
+    entry->executions = 0;
+    entry->taken = 0;
+    entry->next = table->buckets[bucket];
+    table->buckets[bucket] = table->count++;
+    return entry;
+}
+
+void free_profile(ProfileTable *table) {
+    for (int i = 0; i < table->count; i++) {
+        free(table->entries[i].key);
+    }
+    free(table->entries);
+    free(table->buckets);
+    memset(table, 0, sizeof(ProfileTable));
+}
+
+// Lê o perfil do --profile-use: uma linha "<execuções> <verdadeiras> <chave>"
+// por if/while, como sai de __rt_profile_dump. Chaves repetidas (perfis de
+// várias execuções concatenados) têm as contagens somadas
+int load_profile(GenContext *ctx, const char *path) {
+    FILE *input = fopen(path, "r");
+    if (!input) {
+        fprintf(stderr, "Erro ao abrir o perfil %s\n", path);
+        return 1;
+    }
+    char *line = NULL;
+    size_t line_capacity = 0;
+    int line_number = 0;
+    while (getline(&line, &line_capacity, input) != -1) {
+        line_number++;
+        line[strcspn(line, "\n")] = '\0';
+        if (line[0] == '\0') continue;
+
+        long executions, taken;
+        int offset = 0;
+        if (sscanf(line, "%ld %ld %n", &executions, &taken, &offset) != 2 || offset == 0 || line[offset] == '\0') {
+            fprintf(stderr, "Erro: linha %d do perfil %s inválida\n", line_number, path);
+            free(line);
+            fclose(input);
+            return 1;
+        }
+        ProfileEntry *entry = profile_find(&ctx->profile, line + offset);
+        if (!entry) entry = profile_add(&ctx->profile, line + offset);
+        entry->executions += executions;
+        entry->taken += taken;
+    }
+    free(line);
+    fclose(input);
+    return 0;
+}
+
+// Hash do conteúdo do perfil, para a chave do cache (0 se não abre)
+unsigned int profile_file_hash(const char *path) {
+    FILE *input = fopen(path, "rb");
+    if (!input) return 0;
+    unsigned int hash = 2166136261u;
+    int c;
+    while ((c = fgetc(input)) != EOF) {
+        hash ^= (unsigned char)c;
+        hash *= 16777619u;
+    }
+    fclose(input);
+    return hash;
+}
+
+// Alvos do --target; o primeiro é o padrão
+static const RiscvTarget riscv_targets[] = {
+    { "rv32", 32, "lw", "sw", "",  false },
+    { "rv64", 64, "ld", "sd", "w", true },
+};
+
+const RiscvTarget* gen_find_target(const char *name) {
+    for (size_t i = 0; i < sizeof(riscv_targets) / sizeof(riscv_targets[0]); i++) {
+        if (strcmp(name, riscv_targets[i].name) == 0) return &riscv_targets[i];
+    }
+    return NULL;
+}
+
+const RiscvTarget* gen_target(const GenOptions *options) {
+    return options->target ? options->target : &riscv_targets[0];
+}
+
+// Bytes de um registrador inteiro, que é também o tamanho de cada temporário
+int register_bytes(const GenContext *ctx) {
+    return ctx->target->xlen / 8;
+}
+
+// Área de temporários logo após as variáveis, alinhada ao registrador
+int temp_area_offset(GenContext *ctx) {
+    int align = register_bytes(ctx);
+    return (ctx->current_offset + align - 1) & ~(align - 1);
+}
+
+// Tamanho do quadro, mantendo o sp alinhado a 16 bytes
+int frame_size(GenContext *ctx) {
+    return (temp_area_offset(ctx) + MAX_TEMPORARIES * register_bytes(ctx) + 15) & ~15;
+}
+
+void generate_riscv_header(GenContext *ctx) {
+    add_code_line(ctx, ".text\n");
+    if (ctx->options->rvc) {
+        // Montadores externos também passam a escolher as formas comprimidas
+        add_code_line(ctx, ".option rvc\n");
+    }
+    add_code_line(ctx, ".globl main\n");
+    add_code_line(ctx, "main:\n");
+    // O tamanho do quadro só é conhecido no fim da leitura: a linha é
+    // reservada aqui e corrigida em generate_riscv_prologue_patch
+    ctx->prologue_line = ctx->code_line_count;
+    add_code_line(ctx, "    addi sp, sp, -%d\n", frame_size(ctx));
+}
+
+void generate_riscv_prologue_patch(GenContext *ctx) {
+    patch_code_line(ctx, ctx->prologue_line, "    addi sp, sp, -%d\n", frame_size(ctx));
+}
+
+// Marca uma rotina de apoio (--buffered-output) para ser emitida no fim
+void use_runtime(GenContext *ctx, RuntimeRoutine routine) {
+    ctx->runtime_parts |= routine;
+}
+
+void emit_runtime_line(void *arg, const char *line) {
+    add_code_line((GenContext *)arg, "%s", line);
+}
+
+void generate_riscv_footer(GenContext *ctx) {
+    if (ctx->options->buffered_output) {
+        use_runtime(ctx, RUNTIME_FLUSH);
+        add_code_line(ctx, "    call __rt_flush\n");
+    }
+    if (ctx->options->profile_generate) {
+        use_runtime(ctx, RUNTIME_PROFILE_DUMP);
+        add_code_line(ctx, "    call __rt_profile_dump\n");
+    }
+    if (ctx->options->cycle_counters) {
+        use_runtime(ctx, RUNTIME_CYCLES_DUMP);
+        add_code_line(ctx, "    call __rt_cycles_dump\n");
+    }
+    add_code_line(ctx, "    li a7, 10\n");
+    add_code_line(ctx, "    ecall\n");
+}
+
+int intern_line(GenContext *ctx, const char *line);
+
+// Junta as strings constantes, numa .rodata única, depois de todo o código;
+// o buffer das rotinas de apoio e os contadores do perfil vão para a .bss
+void generate_riscv_data_section(GenContext *ctx) {
+    if (ctx->options->profile_generate) {
+        // Chave de cada par de contadores, na ordem deles, terminada em zero
+        add_data_line(ctx, ".align 2\n");
+        add_data_line(ctx, "__rt_prof_keys:\n");
+        for (int i = 0; i < ctx->profile_counters / 2; i++) {
+            add_data_line(ctx, "    .word str_%d\n", ctx->profile_keys[i]);
+        }
+        add_data_line(ctx, "    .word 0\n");
+    }
+    if (ctx->options->cycle_counters) {
+        // Cabeçalho do resumo e a descrição de cada região, terminados em zero
+        int header = intern_line(ctx, "execuções ciclos instruções região");
+        add_data_line(ctx, ".align 2\n");
+        add_data_line(ctx, "__rt_cycle_labels:\n");
+        add_data_line(ctx, "    .word str_%d\n", header);
+        for (int i = 0; i < ctx->cycle_regions; i++) {
+            add_data_line(ctx, "    .word str_%d\n", ctx->cycle_labels[i]);
         }
+        add_data_line(ctx, "    .word 0\n");
+    }
+    if (ctx->data_line_count > 0) {
+        add_code_line(ctx, ".section .rodata\n");
+        for (int i = 0; i < ctx->data_line_count; i++) {
+            append_line(&ctx->output_code, &ctx->code_line_count, &ctx->code_line_capacity,
+                        ctx->data_code[i].code, ctx->data_code[i].length);
+        }
+    }
+    runtime_generate_bss(ctx->runtime_parts, emit_runtime_line, ctx);
+    if (ctx->options->profile_generate) {
+        add_code_line(ctx, ".section .bss\n");
+        add_code_line(ctx, ".align 2\n");
+        add_code_line(ctx, "__rt_prof_counts: .zero %d\n", (ctx->profile_counters ? ctx->profile_counters : 1) * 4);
+    }
+    if (ctx->options->cycle_counters) {
+        // No RV64 os totais são lidos e escritos com ld/sd
+        add_code_line(ctx, ".section .bss\n");
+        add_code_line(ctx, ".align %d\n", ctx->target->xlen == 64 ? 3 : 2);
+        add_code_line(ctx, "__rt_cycle_table: .zero %d\n", ctx->cycle_regions * RUNTIME_CYCLE_ENTRY_SIZE);
     }
 }
 
-void generate_operation(char op, const char *reg1, const char *reg2, const char *reg_dest) {
+// Padrão de bits IEEE-754 de um literal float, para carregar com li + fmv.w.x
+unsigned int float_literal_bits(const char *literal) {
+    float value = strtof(literal, NULL);
+    unsigned int bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+// Operações float; as comparações deixam 0/1 num registrador inteiro
+void generate_float_operation(GenContext *ctx, char op, const char *reg1, const char *reg2, const char *reg_dest) {
     switch (op) {
         case '+':
-            add_code_line("    add %s, %s, %s\n", reg_dest, reg1, reg2);
+            add_code_line(ctx, "    fadd.s %s, %s, %s\n", reg_dest, reg1, reg2);
             break;
         case '-':
-            add_code_line("    sub %s, %s, %s\n", reg_dest, reg1, reg2);
+            add_code_line(ctx, "    fsub.s %s, %s, %s\n", reg_dest, reg1, reg2);
             break;
         case '*':
-            add_code_line("    mul %s, %s, %s\n", reg_dest, reg1, reg2);
+            add_code_line(ctx, "    fmul.s %s, %s, %s\n", reg_dest, reg1, reg2);
             break;
         case '/':
-            add_code_line("    div %s, %s, %s\n", reg_dest, reg1, reg2);
-            break;
-        case '%':
-            add_code_line("    rem %s, %s, %s\n", reg_dest, reg1, reg2);
-            break;
-        case '&':
-            add_code_line("    and %s, %s, %s\n", reg_dest, reg1, reg2);
+            add_code_line(ctx, "    fdiv.s %s, %s, %s\n", reg_dest, reg1, reg2);
             break;
-        case '|':
-            add_code_line("    or %s, %s, %s\n", reg_dest, reg1, reg2);
-            break;
-        case '^':
-            add_code_line("    xor %s, %s, %s\n", reg_dest, reg1, reg2);
-            break;
-        case '=': // ==
-            add_code_line("    xor %s, %s, %s\n", reg_dest, reg1, reg2);
-            add_code_line("    seqz %s, %s\n", reg_dest, reg_dest);
+        case '=':
+            add_code_line(ctx, "    feq.s %s, %s, %s\n", reg_dest, reg1, reg2);
             break;
-        case '!': // !=
-            add_code_line("    xor %s, %s, %s\n", reg_dest, reg1, reg2);
-            add_code_line("    snez %s, %s\n", reg_dest, reg_dest);
+        case '!':
+            add_code_line(ctx, "    feq.s %s, %s, %s\n", reg_dest, reg1, reg2);
+            add_code_line(ctx, "    xori %s, %s, 1\n", reg_dest, reg_dest);
             break;
         case '<':
-            add_code_line("    slt %s, %s, %s\n", reg_dest, reg1, reg2);
+            add_code_line(ctx, "    flt.s %s, %s, %s\n", reg_dest, reg1, reg2);
             break;
         case '>':
-            add_code_line("    sgt %s, %s, %s\n", reg_dest, reg1, reg2);
+            add_code_line(ctx, "    flt.s %s, %s, %s\n", reg_dest, reg2, reg1);
+            break;
+        case 'L':
+            add_code_line(ctx, "    fle.s %s, %s, %s\n", reg_dest, reg1, reg2);
+            break;
+        case 'G':
+            add_code_line(ctx, "    fle.s %s, %s, %s\n", reg_dest, reg2, reg1);
             break;
     }
 }
 
-void generate_temp_store(int temp_num, const char *reg) {
-    add_code_line("    sw %s, %d(sp)\n", reg, current_offset + temp_num * 4);
+/* ---------- Construção do IR a partir da saída do sintático ---------- */
+
+// O long só tem tipo próprio quando o alvo tem registradores de 64 bits
+IrType ir_type_of(const GenContext *ctx, VarType type) {
+    if (type == TYPE_FLOAT || type == TYPE_DOUBLE) return IR_FLOAT;
+    return type == TYPE_LONG && ctx->target->native_long ? IR_LONG : IR_INT;
 }
 
-void generate_temp_load(int temp_num, const char *reg) {
-    add_code_line("    lw %s, %d(sp)\n", reg, current_offset + temp_num * 4);
+int variable_index(GenContext *ctx, const Variable *var) {
+    return (int)(var - ctx->variables);
 }
 
-int get_precedence(char op) {
-    switch (op) {
-        case '+':
-        case '-':
-            return 1;
-        case '*':
-        case '/':
-        case '%':
-            return 2;
-        case '&':
-        case '|':
-        case '^':
-            return 3;
-        case '=':
-        case '!':
-        case '<':
-        case '>':
-            return 4;
-        case '(':
-            return 0;
-        default:
-            return -1;
-    }
+// Converte o valor para o tipo pedido (int, long ou float), se preciso
+int coerce_value(GenContext *ctx, int value, IrType type) {
+    if (ctx->ir.values[value].type == type) return value;
+    return ir_convert(&ctx->ir, ctx->block, type, value);
 }
 
-void process_expression(const char *expr) {
-    char token[50];
-    int token_pos = 0;
-    int expr_len = strlen(expr);
-    int temp_stack[100];
-    int temp_stack_top = -1;
-    op_stack_top = -1;
-    
-    for (int i = 0; i < expr_len; i++) {
-        if (isspace(expr[i])) continue;
-        
-        if (isalnum(expr[i]) || expr[i] == '_') {
-            token_pos = 0;
-            while (i < expr_len && (isalnum(expr[i]) || expr[i] == '_')) {
-                token[token_pos++] = expr[i++];
-            }
-            token[token_pos] = '\0';
-            i--;
-            
-            temp_stack[++temp_stack_top] = temp_count++;
-            generate_load_operand(token, "t0");
-            generate_temp_store(temp_stack[temp_stack_top], "t0");
-        } else if (expr[i] == '(') {
-            push_op('(', 0);
-        } else if (expr[i] == ')') {
-            while (!is_op_stack_empty() && peek_op().op != '(') {
-                Operator op = pop_op();
-                
-                int op2 = temp_stack[temp_stack_top--];
-                int op1 = temp_stack[temp_stack_top--];
-                int result = temp_count++;
-                
-                generate_temp_load(op1, "t0");
-                generate_temp_load(op2, "t1");
-                generate_operation(op.op, "t0", "t1", "t2");
-                generate_temp_store(result, "t2");
-                
-                temp_stack[++temp_stack_top] = result;
-            }
-            
-            if (!is_op_stack_empty() && peek_op().op == '(') {
-                pop_op();
-            }
-        } else {
-            char current_op = expr[i];
-            int current_prec = get_precedence(current_op);
-            
-            while (!is_op_stack_empty() && peek_op().precedence >= current_prec) {
-                Operator op = pop_op();
-                
-                int op2 = temp_stack[temp_stack_top--];
-                int op1 = temp_stack[temp_stack_top--];
-                int result = temp_count++;
-                
-                generate_temp_load(op1, "t0");
-                generate_temp_load(op2, "t1");
-                generate_operation(op.op, "t0", "t1", "t2");
-                generate_temp_store(result, "t2");
-                
-                temp_stack[++temp_stack_top] = result;
-            }
-            
-            push_op(current_op, current_prec);
-        }
-    }
-    
-    while (!is_op_stack_empty()) {
-        Operator op = pop_op();
-        
-        int op2 = temp_stack[temp_stack_top--];
-        int op1 = temp_stack[temp_stack_top--];
-        int result = temp_count++;
-        
-        generate_temp_load(op1, "t0");
-        generate_temp_load(op2, "t1");
-        generate_operation(op.op, "t0", "t1", "t2");
-        generate_temp_store(result, "t2");
-        
-        temp_stack[++temp_stack_top] = result;
+// Erro no programa: vira comentário no assembly, sai nos diagnósticos
+// (stderr, ou a resposta do servidor) e faz generate_riscv_code falhar
+void gen_error(GenContext *ctx, const char *format, ...) {
+    char text[MAX_LINE_LENGTH];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    ir_set_note(&ctx->ir, "ERRO: %s", text);
+    // As declarações vêm antes do primeiro marcador "Linha N"
+    if (ctx->source_line > 0) {
+        fprintf(ctx->diagnostics, "Erro na linha %d: %s\n", ctx->source_line, text);
+    } else {
+        fprintf(ctx->diagnostics, "Erro: %s\n", text);
     }
-    
-    temp_count = 0;
+    ctx->error_count++;
 }
 
-void generate_if_statement(const char *condition, const char *true_block) {
-    int current_label = label_count++;
-    add_code_line("    # Início do if\n");
-    process_expression(condition);
-    add_code_line("    lw t0, %d(sp)\n", TEMP_RESULT_OFFSET);
-    add_code_line("    beqz t0, L_else_%d\n", current_label);
-    
-    // Gera o bloco verdadeiro (simplificado)
-    add_code_line("    # Bloco if\n");
-    
-    add_code_line("L_else_%d:\n", current_label);
+// Promoção usual: float ganha de long, que ganha de int
+IrType common_type(GenContext *ctx, int left, int right) {
+    IrType a = ctx->ir.values[left].type, b = ctx->ir.values[right].type;
+    if (a == IR_FLOAT || b == IR_FLOAT) return IR_FLOAT;
+    return a == IR_LONG || b == IR_LONG ? IR_LONG : IR_INT;
 }
 
-void generate_while_loop(const char *condition, const char *body) {
-    int current_label = label_count++;
-    add_code_line("    # Início do while\n");
-    add_code_line("L_while_start_%d:\n", current_label);
-    
-    process_expression(condition);
-    add_code_line("    lw t0, %d(sp)\n", TEMP_RESULT_OFFSET);
-    add_code_line("    beqz t0, L_while_end_%d\n", current_label);
-    
-    // Gera o corpo (simplificado)
-    add_code_line("    # Corpo do while\n");
-    
-    add_code_line("    j L_while_start_%d\n", current_label);
-    add_code_line("L_while_end_%d:\n", current_label);
+// Operação binária com os dois lados no tipo comum
+int build_binary(GenContext *ctx, char op, int left, int right) {
+    IrType type = common_type(ctx, left, right);
+    if (type == IR_FLOAT && strchr("%&|^", op)) {
+        gen_error(ctx, "Operador '%c' com operando float", op);
+        type = IR_INT;
+    }
+    left = coerce_value(ctx, left, type);
+    right = coerce_value(ctx, right, type);
+    return ir_binary(&ctx->ir, ctx->block, op, left, right);
 }
 
-void generate_return(const char *expr) {
-    if (expr) {
-        process_expression(expr);
-        add_code_line("    lw a0, %d(sp)  # Valor de retorno\n", TEMP_RESULT_OFFSET);
-    }
-    add_code_line("    j main_end\n");
+// Analisador de expressões por descida recursiva: o texto que veio do
+// sintático vira instruções acrescentadas ao bloco atual
+typedef struct {
+    GenContext *ctx;
+    const char *pos;
+    bool failed;
+} ExprParser;
+
+int parse_expression_level(ExprParser *parser, int level);
+
+void skip_expression_spaces(ExprParser *parser) {
+    while (isspace((unsigned char)*parser->pos)) parser->pos++;
 }
 
-bool is_numeric_constant(const char *str) {
-    if (*str == '-') str++;  // Permite negativos
-    while (*str) {
-        if (!isdigit(*str)) return false;
-        str++;
+// Valor de um literal de caractere ('a', '\n', ...)
+int char_literal_value(const char *text, const char **end) {
+    int value = (unsigned char)text[1];
+    const char *p = text + 2;
+    if (text[1] == '\\') {
+        switch (text[2]) {
+            case 'n': value = '\n'; break;
+            case 't': value = '\t'; break;
+            case 'r': value = '\r'; break;
+            case '0': value = 0; break;
+            default: value = (unsigned char)text[2]; break;
+        }
+        p = text + 3;
     }
-    return true;
+    if (*p == '\'') p++;
+    *end = p;
+    return value;
 }
 
-void generate_riscv_assignment(const char *var_name, const char *expr) {
-    Variable *var = find_variable(var_name);
-    if (!var) {
-        add_code_line("    # ERRO: Variável '%s' não declarada!", var_name);
-        return;
-    }
+int parse_expression_primary(ExprParser *parser) {
+    GenContext *ctx = parser->ctx;
+    skip_expression_spaces(parser);
+    const char *start = parser->pos;
 
-    if (var->is_const) {
-        add_code_line("    # AVISO: Tentativa de modificar constante '%s'!\n", var_name);
-        return;
+    if (*start == '(') {
+        parser->pos++;
+        int value = parse_expression_level(parser, 0);
+        skip_expression_spaces(parser);
+        if (*parser->pos == ')') {
+            parser->pos++;
+        } else {
+            parser->failed = true;
+        }
+        return value;
     }
 
-    // Atribuição simples (constante numérica)
-    if (is_numeric_constant(expr)) {
-        add_code_line("    li t0, %s\n", expr);
-        add_code_line("    sw t0, %d(sp)  # %s = %s\n", var->offset, var_name, expr);
-        return;
+    if (*start == '-') {
+        // Menos unário: 0 - x (-0.0 - x no float, que preserva o sinal do zero)
+        parser->pos++;
+        int operand = parse_expression_primary(parser);
+        IrType type = ctx->ir.values[operand].type;
+        int zero = ir_const(&ctx->ir, ctx->block, type, type == IR_FLOAT ? (int32_t)0x80000000u : 0);
+        return ir_binary(&ctx->ir, ctx->block, '-', zero, operand);
     }
-    
-    // Atribuição de outra variável (cópia direta)
-    Variable *src_var = find_variable(expr);
-    if (src_var) {
-        add_code_line("    lw t0, %d(sp)  # Carrega %s\n", src_var->offset, expr);
-        add_code_line("    sw t0, %d(sp)  # %s = %s\n", var->offset, var_name, expr);
-        return;
+
+    if (*start == '\'') {
+        return ir_const(&ctx->ir, ctx->block, IR_INT, char_literal_value(start, &parser->pos));
     }
 
-    // Expressão aritmética mais complexa
-    add_code_line("    # Calculando %s = %s\n", var_name, expr);
-    process_expression(expr);
-    
-    // Otimização: usar posição temporária fixa para resultados
-    add_code_line("    lw t0, %d(sp)  # Carrega resultado\n", TEMP_RESULT_OFFSET);
-    add_code_line("    sw t0, %d(sp)  # Armazena em %s\n", var->offset, var_name);
-    
-    add_code_line("    sw zero, %d(sp)  # Limpa temporário\n", TEMP_RESULT_OFFSET);
-}
+    if (isdigit((unsigned char)*start) || *start == '.') {
+        // É float quando strtof vai além do que strtol reconhece ("1.5", "2e3")
+        char *int_end, *float_end;
+        long long int_value = strtoll(start, &int_end, 0);
+        strtof(start, &float_end);
 
-void write_output_with_line_numbers(FILE *output) {
-    int max_line_num = code_line_count;
-    int num_digits = 1;
-    while (max_line_num >= 10) {
-        max_line_num /= 10;
-        num_digits++;
-    }
-    
-    for (int i = 0; i < code_line_count; i++) {
-        fprintf(output, "%*d: %s", num_digits, output_code[i].line_number, output_code[i].code);
-    }
-}
-const char* get_expression_type(const char* expr) {
-    // 1. Verifica se é uma constante char ('a')
-    if (expr[0] == '\'') {
-        return "CHAR";
-    }
-    
-    // 2. Verifica se é uma string literal ("texto")
-    if (expr[0] == '"') {
-        return "STRING";
-    }
-    
-    // 3. Verifica se é um número float (contém ponto ou notação científica)
-    const char* p = expr;
-    while (*p) {
-        if (*p == '.' || *p == 'e' || *p == 'E') {
-            return "FLOAT";
-        }
-        p++;
-    }
-    
-    // 4. Verifica se é uma variável declarada
-    Variable* var = find_variable(expr);
-    if (var != NULL) {
-        // Retorna o tipo da variável, removendo sufixo "_KW" se existir
-        if (strstr(var->type, "_KW")) {
-            static char clean_type[20];
-            strncpy(clean_type, var->type, strlen(var->type) - 3);
-            clean_type[strlen(var->type) - 3] = '\0';
-            return clean_type;
-        }
-        return var->type;
-    }
-    
-    // 5. Verifica operações com floats em expressões mais complexas
-    if (strstr(expr, ".") || 
-        strstr(expr, "/") ||  // Divisão pode resultar em float
-        strstr(expr, "*") ||  // Multiplicação entre int e float
-        strstr(expr, "+") ||  // Soma entre int e float
-        strstr(expr, "-")) {   // Subtração entre int e float
-        // Verifica se algum operando é float
-        char* tokens = strdup(expr);
-        char* token = strtok(tokens, " +-*/%");
-        while (token != NULL) {
-            if (strchr(token, '.')) {
-                free(tokens);
-                return "FLOAT";
+        int value;
+        if (float_end > int_end) {
+            value = ir_const(&ctx->ir, ctx->block, IR_FLOAT, (int32_t)float_literal_bits(start));
+            parser->pos = float_end;
+        } else {
+            // Com long de 64 bits, o literal com sufixo L ou que não cabe
+            // num int é long; senão fica com os 32 bits de baixo
+            bool is_long = int_value < INT32_MIN || int_value > INT32_MAX;
+            for (const char *p = int_end; *p && strchr("lLuU", *p); p++) {
+                if (*p == 'l' || *p == 'L') is_long = true;
             }
-            Variable* v = find_variable(token);
-            if (v && (strcmp(v->type, "FLOAT") == 0 || strcmp(v->type, "FLOAT_KW") == 0)) {
-                free(tokens);
-                return "FLOAT";
+            if (is_long && ctx->target->native_long) {
+                value = ir_const(&ctx->ir, ctx->block, IR_LONG, int_value);
+            } else {
+                value = ir_const(&ctx->ir, ctx->block, IR_INT, (int32_t)int_value);
             }
-            token = strtok(NULL, " +-*/%");
+            parser->pos = int_end;
         }
-        free(tokens);
-    }
-    
-    // 6. Padrão: inteiro
-    return "INT";
-}
-
-void process_condition(const char* condition, int label_base, bool is_while) {
-    char left[50], op[3], right[50];
-    char left_type[20], right_type[20];
-    
-    // Extrai os componentes da condição
-    if (sscanf(condition, "%49s %2s %49s", left, op, right) != 3) {
-        add_code_line("    # ERRO: Condição mal formada: %s\n", condition);
-        return;
+        while (*parser->pos && strchr("fFlLuU", *parser->pos)) parser->pos++;
+        return value;
     }
 
-    // Determina os tipos dos operandos
-    strcpy(left_type, get_expression_type(left));
-    strcpy(right_type, get_expression_type(right));
+    if (isalpha((unsigned char)*start) || *start == '_') {
+        // O nome inteiro vira a chave da busca, do tamanho do identificador
+        while (isalnum((unsigned char)*parser->pos) || *parser->pos == '_') parser->pos++;
+        char *name = strndup(start, parser->pos - start);
+        if (!name) {
+            fprintf(stderr, "Erro: memória insuficiente para o código gerado\n");
+            exit(1);
+        }
 
-    // Gera código para carregar os operandos
-    add_code_line("    # Avaliando condição: %s %s %s\n", left, op, right);
-    
-    // Tratamento especial para tipos mistos
-    bool float_comp = (strcmp(left_type, "FLOAT")) == 0 || strcmp(right_type, "FLOAT") == 0;
-    
-    // Carrega operando esquerdo
-    if (strcmp(left_type, "FLOAT") == 0) {
-        if (find_variable(left)) {
-            add_code_line("    flw ft0, %d(sp)  # %s\n", find_variable(left)->offset, left);
+        // "scanf()" como expressão: lê um int da entrada
+        skip_expression_spaces(parser);
+        int value;
+        if (strcmp(name, "scanf") == 0 && parser->pos[0] == '(' && parser->pos[1] == ')') {
+            parser->pos += 2;
+            value = ir_read(&ctx->ir, ctx->block, IR_INT);
         } else {
-            add_code_line("    li t0, %s\n", left);
-            add_code_line("    fmv.w.x ft0, t0\n");
+            Variable *var = find_variable(ctx, name);
+            if (var) {
+                value = ir_load(&ctx->ir, ctx->block, ir_type_of(ctx, var->type), variable_index(ctx, var));
+            } else {
+                gen_error(ctx, "Variável '%s' não declarada", name);
+                value = ir_const(&ctx->ir, ctx->block, IR_INT, 0);
+            }
         }
-    } else {
-        generate_load_operand(left, "t0");
+        free(name);
+        return value;
     }
 
-    // Carrega operando direito
-    if (strcmp(right_type, "FLOAT") == 0) {
-        if (find_variable(right)) {
-            add_code_line("    flw ft1, %d(sp)  # %s\n", find_variable(right)->offset, right);
-        } else {
-            add_code_line("    li t1, %s\n", right);
-            add_code_line("    fmv.w.x ft1, t1\n");
-        }
-    } else {
-        generate_load_operand(right, "t1");
-    }
-
-    // Gera a comparação apropriada
-    if (float_comp) {
-        // Comparação entre floats
-        if (strcmp(op, "==") == 0) {
-            add_code_line("    feq.s t2, ft0, ft1\n");
-            add_code_line("    beqz t2, L_false_%d\n", label_base);
-        } else if (strcmp(op, "!=") == 0) {
-            add_code_line("    feq.s t2, ft0, ft1\n");
-            add_code_line("    bnez t2, L_false_%d\n", label_base);
-        } else if (strcmp(op, "<") == 0) {
-            add_code_line("    flt.s t2, ft0, ft1\n");
-            add_code_line("    beqz t2, L_false_%d\n", label_base);
-        } else if (strcmp(op, ">") == 0) {
-            add_code_line("    flt.s t2, ft1, ft0\n");
-            add_code_line("    beqz t2, L_false_%d\n", label_base);
-        } else if (strcmp(op, "<=") == 0) {
-            add_code_line("    fle.s t2, ft0, ft1\n");
-            add_code_line("    beqz t2, L_false_%d\n", label_base);
-        } else if (strcmp(op, ">=") == 0) {
-            add_code_line("    fle.s t2, ft1, ft0\n");
-            add_code_line("    beqz t2, L_false_%d\n", label_base);
-        }
-    } else {
-        // Comparação entre inteiros
-        if (strcmp(op, "==") == 0) {
-            add_code_line("    bne t0, t1, L_false_%d\n", label_base);
-        } else if (strcmp(op, "!=") == 0) {
-            add_code_line("    beq t0, t1, L_false_%d\n", label_base);
-        } else if (strcmp(op, "<") == 0) {
-            add_code_line("    bge t0, t1, L_false_%d\n", label_base);
-        } else if (strcmp(op, ">") == 0) {
-            add_code_line("    ble t0, t1, L_false_%d\n", label_base);
-        } else if (strcmp(op, "<=") == 0) {
-            add_code_line("    bgt t0, t1, L_false_%d\n", label_base);
-        } else if (strcmp(op, ">=") == 0) {
-            add_code_line("    blt t0, t1, L_false_%d\n", label_base);
-        }
+    parser->failed = true;
+    return ir_const(&ctx->ir, ctx->block, IR_INT, 0);
+}
+
+// Um nível de precedência por chamada, do menos para o mais prioritário
+int parse_expression_level(ExprParser *parser, int level) {
+    static const char *const operators[] = { "|", "^", "&", "+-", "*/%" };
+    if (level == (int)(sizeof(operators) / sizeof(operators[0]))) {
+        return parse_expression_primary(parser);
     }
 
-    // Para loops while, adiciona um jump de volta ao início
-    if (is_while) {
-        add_code_line("    j L_loop_start_%d\n", label_base);
+    int left = parse_expression_level(parser, level + 1);
+    for (;;) {
+        skip_expression_spaces(parser);
+        char op = *parser->pos;
+        if (op == '\0' || !strchr(operators[level], op)) return left;
+        parser->pos++;
+        int right = parse_expression_level(parser, level + 1);
+        left = build_binary(parser->ctx, op, left, right);
     }
+}
 
-    // Label para o caso falso
-    add_code_line("L_false_%d:\n", label_base);
+// Monta a expressão no bloco atual; devolve o valor com o resultado
+int build_expression(GenContext *ctx, const char *text) {
+    ExprParser parser = { ctx, text, false };
+    int value = parse_expression_level(&parser, 0);
+    skip_expression_spaces(&parser);
+    if (parser.failed || *parser.pos != '\0') {
+        gen_error(ctx, "Expressão mal formada: %s", text);
+    }
+    return value;
 }
 
-void generate_riscv_code(FILE *input, FILE *output) {
-    char line[MAX_LINE_LENGTH];
-    char var_name[50];
-    char var_type[20];
-    char expr[100];
-    char format_str[100];
-    int str_label_count = 0;
-    int float_temp_count = 0;
+// Operador relacional fora de parênteses ("(a + 1) <= b"); devolve o
+// código do operador no IR, ou 0 se a condição não tem comparação
+char find_relational(const char *text, int *position, int *length) {
+    int depth = 0;
+    for (int i = 0; text[i]; i++) {
+        char c = text[i];
+        bool equals_next = text[i + 1] == '=';
+        if (c == '(') depth++;
+        if (c == ')') depth--;
+        if (depth != 0) continue;
 
-    // Tabela para armazenar strings já definidas
-    StringEntry string_table[MAX_STRINGS];
-    int string_count = 0;
+        *position = i;
+        *length = equals_next ? 2 : 1;
+        if (c == '=' && equals_next) return '=';
+        if (c == '!' && equals_next) return '!';
+        if (c == '<') return equals_next ? 'L' : '<';
+        if (c == '>') return equals_next ? 'G' : '>';
+    }
+    return 0;
+}
 
-    // Primeira passada: coletar variáveis
-    while (fgets(line, sizeof(line), input)) {
-        if (sscanf(line, "Variavel %s %s criada!", var_type, var_name) == 2) {
-            add_variable(var_name, var_type, false, false);
+// Primeiro && ou || fora de parênteses, procurando antes o ||, que tem a
+// menor precedência; devolve '&' ou '|' (0 se não há) e a posição
+char find_logical(const char *text, int length, int *position) {
+    static const char operators[] = "|&";
+    for (int k = 0; k < 2; k++) {
+        int depth = 0;
+        for (int i = 0; i + 1 < length; i++) {
+            if (text[i] == '(') depth++;
+            if (text[i] == ')') depth--;
+            if (depth == 0 && text[i] == operators[k] && text[i + 1] == operators[k]) {
+                *position = i;
+                return operators[k];
+            }
         }
     }
-    
-    rewind(input);
-    generate_riscv_header();
-    
-    // Adiciona seção de dados para strings constantes
-    add_code_line(".section .rodata\n");
-    
- // Segunda passada: processamento
-    while (fgets(line, sizeof(line), input)) {
-        line[strcspn(line, "\n")] = 0;
-        char *trimmed_line = line;
+    return 0;
+}
+
+// O texto todo está dentro de um único par de parênteses ("(a < b)", mas
+// não "(a + 1) < (b)")?
+bool enclosed_in_parens(const char *text, int length) {
+    if (length < 2 || text[0] != '(' || text[length - 1] != ')') return false;
+    int depth = 0;
+    for (int i = 0; i < length - 1; i++) {
+        if (text[i] == '(') depth++;
+        if (text[i] == ')') depth--;
+        if (depth == 0) return false;
+    }
+    return true;
+}
+
+void enter_block(GenContext *ctx, int block);
+int new_control_block(GenContext *ctx, const char *prefix, int label);
+
+// Avalia a condição no bloco atual e o termina com os desvios. && e || viram
+// uma cadeia de testes, cada um no seu bloco, que vai direto para o destino
+// final assim que o resultado é conhecido; o ! só troca os destinos. Nenhum
+// valor 0/1 é calculado
+void build_condition(GenContext *ctx, const char *condition, int if_true, int if_false) {
+    while (isspace((unsigned char)*condition)) condition++;
+    int text_length = strlen(condition);
+    while (text_length > 0 && isspace((unsigned char)condition[text_length - 1])) text_length--;
+
+    int position, length;
+    char logical = find_logical(condition, text_length, &position);
+    if (logical) {
+        // O lado direito só é testado quando o esquerdo não decide
+        int next = new_control_block(ctx, "L_cond", ctx->label_count++);
+        char *left_text = strndup(condition, position);
+        if (logical == '|') {
+            build_condition(ctx, left_text, if_true, next);
+        } else {
+            build_condition(ctx, left_text, next, if_false);
+        }
+        free(left_text);
+        enter_block(ctx, next);
+        build_condition(ctx, condition + position + 2, if_true, if_false);
+        return;
+    }
+    if (condition[0] == '!' && condition[1] != '=') {
+        build_condition(ctx, condition + 1, if_false, if_true);
+        return;
+    }
+    if (enclosed_in_parens(condition, text_length)) {
+        char *inner = strndup(condition + 1, text_length - 2);
+        build_condition(ctx, inner, if_true, if_false);
+        free(inner);
+        return;
+    }
+
+    char op = find_relational(condition, &position, &length);
+
+    int left, right;
+    if (op) {
+        char *left_text = strndup(condition, position);
+        left = build_expression(ctx, left_text);
+        right = build_expression(ctx, condition + position + length);
+        free(left_text);
+    } else {
+        // Sem comparação: verdadeira quando diferente de zero
+        op = '!';
+        left = build_expression(ctx, condition);
+        right = ir_const(&ctx->ir, ctx->block, ctx->ir.values[left].type, 0);
+    }
+
+    IrType type = common_type(ctx, left, right);
+    left = coerce_value(ctx, left, type);
+    right = coerce_value(ctx, right, type);
+    ir_branch(&ctx->ir, ctx->block, op, left, right, if_true, if_false);
+}
+
+void build_assignment(GenContext *ctx, const char *var_name, const char *expr) {
+    Variable *var = find_variable(ctx, var_name);
+    if (!var) {
+        gen_error(ctx, "Variável '%s' não declarada!", var_name);
+        return;
+    }
+
+    if (var->is_const) {
+        ir_set_note(&ctx->ir, "AVISO: Tentativa de modificar constante '%s'!", var_name);
+        return;
+    }
+
+    while (isspace((unsigned char)*expr)) expr++;
+    ir_set_note(&ctx->ir, "%s = %s", var_name, expr);
+    int value = coerce_value(ctx, build_expression(ctx, expr), ir_type_of(ctx, var->type));
+    ir_store(&ctx->ir, ctx->block, variable_index(ctx, var), value);
+}
+
+// Rótulo da string na .rodata; textos iguais ficam com o mesmo rótulo
+int intern_string(GenContext *ctx, const char *text, int length) {
+    for (int i = 0; i < ctx->string_count; i++) {
+        const char *value = ctx->strings[i].value;
+        if (strncmp(value, text, length) == 0 && value[length] == '\0') return ctx->strings[i].label;
+    }
+
+    if (ctx->string_count == ctx->string_capacity) {
+        ctx->string_capacity = ctx->string_capacity ? ctx->string_capacity * 2 : 16;
+        ctx->strings = realloc(ctx->strings, ctx->string_capacity * sizeof(StringEntry));
+        if (!ctx->strings) {
+            fprintf(stderr, "Erro: memória insuficiente para o código gerado\n");
+            exit(1);
+        }
+    }
+    StringEntry *entry = &ctx->strings[ctx->string_count];
+    entry->label = ctx->string_count++;
+    entry->value = strndup(text, length);
+    add_data_line(ctx, "str_%d: .string \"%s\"\n", entry->label, entry->value);
+    return entry->label;
+}
+
+// Caractere representado pelo trecho ("a", "\n"); -1 se ele tem mais de um
+int single_char_value(const char *text, int length) {
+    if (length == 1 && text[0] != '\\') return (unsigned char)text[0];
+    if (length != 2 || text[0] != '\\') return -1;
+    switch (text[1]) {
+        case 'n': return '\n';
+        case 't': return '\t';
+        case 'r': return '\r';
+        case '\\': return '\\';
+        case '"': return '"';
+        case '\'': return '\'';
+        default: return -1;
+    }
+}
+
+// Trecho literal do formato: um caractere sai com print_char, o resto
+// como string da .rodata
+void build_format_literal(GenContext *ctx, const char *text, int length) {
+    if (length <= 0) return;
+    int c = single_char_value(text, length);
+    if (c >= 0) {
+        ir_print_value(&ctx->ir, ctx->block, ir_const(&ctx->ir, ctx->block, IR_INT, c), 'c');
+    } else {
+        ir_print_string(&ctx->ir, ctx->block, intern_string(ctx, text, length));
+    }
+}
+
+// Um argumento do formato, impresso com a chamada do tipo pedido; o %ld
+// imprime o long inteiro quando ele tem 64 bits
+void build_format_value(GenContext *ctx, char conversion, bool is_long, const char *arg) {
+    int value = build_expression(ctx, arg);
+    switch (conversion) {
+        case 'd':
+        case 'i': {
+            IrType type = is_long && ctx->target->native_long ? IR_LONG : IR_INT;
+            ir_print_value(&ctx->ir, ctx->block, coerce_value(ctx, value, type), 'd');
+            break;
+        }
+        case 'c':
+            ir_print_value(&ctx->ir, ctx->block, coerce_value(ctx, value, IR_INT), 'c');
+            break;
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+            ir_print_value(&ctx->ir, ctx->block, coerce_value(ctx, value, IR_FLOAT), 'f');
+            break;
+        default:
+            gen_error(ctx, "Especificador %%%c não suportado no printf", conversion);
+            break;
+    }
+}
+
+// Separa os argumentos nas vírgulas fora de parênteses e de aspas;
+// devolve quantos foram encontrados (só os max_args primeiros são guardados)
+int split_print_arguments(char *text, char **args, int max_args) {
+    int count = 0, depth = 0;
+    char quote = 0;
+    char *start = text;
+
+    while (isspace(*text)) text++;
+    if (*text == '\0') return 0;
+    for (char *p = text; ; p++) {
+        if (*p == '\0' || (*p == ',' && depth == 0 && !quote)) {
+            bool last = *p == '\0';
+            *p = '\0';
+            while (isspace(*start)) start++;
+            if (count < max_args) args[count] = start;
+            count++;
+            if (last) break;
+            start = p + 1;
+        } else if (quote) {
+            if (*p == '\\' && p[1]) p++;
+            else if (*p == quote) quote = 0;
+        } else if (*p == '\'' || *p == '"') {
+            quote = *p;
+        } else if (*p == '(') {
+            depth++;
+        } else if (*p == ')') {
+            depth--;
+        }
+    }
+    return count;
+}
+
+// printf: o formato é interpretado aqui, em tempo de compilação. Cada
+// trecho literal vai para a .rodata e cada % vira a chamada de impressão do
+// seu tipo, então o programa gerado não percorre o formato
+void build_printf(GenContext *ctx, char *args) {
+    if (args[0] != '"') {
+        ir_set_note(&ctx->ir, "Print de expressão");
+        int value = build_expression(ctx, args);
+        ir_print_value(&ctx->ir, ctx->block, value, ctx->ir.values[value].type == IR_FLOAT ? 'f' : 'd');
+        return;
+    }
+
+    char *format = args + 1;
+    char *end_quote = format;
+    while (*end_quote && *end_quote != '"') {
+        end_quote += end_quote[0] == '\\' && end_quote[1] ? 2 : 1;
+    }
+    if (*end_quote != '"') return;
+    *end_quote = '\0';
+
+    char *rest = end_quote + 1;
+    while (isspace(*rest)) rest++;
+    if (*rest == ',') rest++;
+    char *values[MAX_PRINT_ARGS];
+    int value_count = split_print_arguments(rest, values, MAX_PRINT_ARGS);
+    if (value_count > MAX_PRINT_ARGS) {
+        gen_error(ctx, "Mais de %d argumentos no printf", MAX_PRINT_ARGS);
+        value_count = MAX_PRINT_ARGS;
+    }
+
+    ir_set_note(&ctx->ir, "Chamada printf");
+    const char *chunk = format;
+    int next_value = 0;
+    for (const char *p = format; *p; p++) {
+        if (*p == '\\' && p[1]) {
+            p++;
+            continue;
+        }
+        if (*p != '%') continue;
+
+        // Flags, largura e precisão são aceitas, mas as chamadas do
+        // sistema não as suportam
+        const char *spec = p + 1;
+        while (*spec && strchr("-+ #0123456789.hlLzjt", *spec)) spec++;
+        if (*spec == '\0') break;
+
+        build_format_literal(ctx, chunk, (int)(p - chunk));
+        if (*spec == '%') {
+            chunk = p = spec;   // "%%": o segundo % começa o próximo trecho
+            continue;
+        }
+        // O "l" sozinho é o tamanho do %ld, não uma largura
+        bool is_long = spec == p + 2 && p[1] == 'l';
+        if (spec > p + 1 && !is_long) {
+            ir_set_note(&ctx->ir, "AVISO: Largura e precisão de '%.*s' ignoradas", (int)(spec - p + 1), p);
+        }
+        if (next_value < value_count) {
+            build_format_value(ctx, *spec, is_long, values[next_value++]);
+        } else {
+            gen_error(ctx, "Falta argumento para %%%c no printf", *spec);
+        }
+        chunk = spec + 1;
+        p = spec;
+    }
+    build_format_literal(ctx, chunk, (int)strlen(chunk));
+
+    if (next_value < value_count) {
+        ir_set_note(&ctx->ir, "AVISO: Argumentos a mais no printf ignorados");
+    }
+}
+
+// scanf no formato simplificado: "formato", variável
+void build_scanf(GenContext *ctx, char *args) {
+    char *comma = strchr(args, ',');
+    if (!comma) return;
+    char *var_name = comma + 1;
+    while (isspace(*var_name)) var_name++;
+
+    Variable *var = find_variable(ctx, var_name);
+    if (!var) {
+        gen_error(ctx, "Variável '%s' não declarada", var_name);
+        return;
+    }
+    if (var->type != TYPE_INT && var->type != TYPE_LONG && var->type != TYPE_FLOAT) {
+        gen_error(ctx, "Tipo não suportado no scanf");
+        return;
+    }
+
+    ir_set_note(&ctx->ir, "Chamada scanf");
+    int value = ir_read(&ctx->ir, ctx->block, ir_type_of(ctx, var->type));
+    ir_store(&ctx->ir, ctx->block, variable_index(ctx, var), value);
+}
+
+// Previsão estática: uma igualdade costuma ser falsa, as demais condições
+// ficam com o bloco verdadeiro como caminho provável
+bool condition_likely_false(const char *condition) {
+    int position, length;
+    return find_relational(condition, &position, &length) == '=';
+}
+
+// Frequência estimada de um bloco: 1 para o código fora de if/while; os
+// blocos criados depois da leitura (avaliação parcial) também ficam com 1
+void set_block_weight(GenContext *ctx, int block, double weight) {
+    if (block >= ctx->block_weight_capacity) {
+        int capacity = ctx->block_weight_capacity ? ctx->block_weight_capacity : 64;
+        while (capacity <= block) capacity *= 2;
+        ctx->block_weights = realloc(ctx->block_weights, capacity * sizeof(double));
+        if (!ctx->block_weights) {
+            fprintf(stderr, "Erro: memória insuficiente para o código gerado\n");
+            exit(1);
+        }
+        for (int i = ctx->block_weight_capacity; i < capacity; i++) ctx->block_weights[i] = 1.0;
+        ctx->block_weight_capacity = capacity;
+    }
+    ctx->block_weights[block] = weight;
+}
+
+double block_weight(const GenContext *ctx, int block) {
+    return block < ctx->block_weight_capacity ? ctx->block_weights[block] : 1.0;
+}
+
+// Novas instruções passam a ir para o bloco, posto no fim do layout
+void enter_block(GenContext *ctx, int block) {
+    ir_place_block(&ctx->ir, block);
+    set_block_weight(ctx, block, ctx->weight);
+    ctx->block = block;
+}
+
+int new_control_block(GenContext *ctx, const char *prefix, int label) {
+    char name[32];
+    snprintf(name, sizeof(name), "%s_%d", prefix, label);
+    return ir_new_block(&ctx->ir, name);
+}
+
+// Chave do if/while no perfil ("if 0 x < 3"): a ocorrência conta os
+// comandos iguais que já apareceram no programa. A chave é alocada com o
+// tamanho da condição; quem chama libera
+char* profile_key(GenContext *ctx, ControlKind kind, const char *condition) {
+    const char *kind_name = kind == CONTROL_IF ? "if" : "while";
+    size_t size = strlen(condition) + 32;
+    char *key = malloc(size);
+    if (!key) {
+        fprintf(stderr, "Erro: memória insuficiente para o perfil\n");
+        exit(1);
+    }
+    snprintf(key, size, "%s %s", kind_name, condition);
+    ProfileEntry *seen = profile_find(&ctx->profile_seen, key);
+    if (!seen) seen = profile_add(&ctx->profile_seen, key);
+    snprintf(key, size, "%s %ld %s", kind_name, seen->executions++, condition);
+    return key;
+}
+
+// Texto escrito pelas rotinas de apoio, como string da .rodata terminada em
+// '\n'; aspas e barras do texto ganham o escape do .string
+int intern_line(GenContext *ctx, const char *line) {
+    char *text = malloc(2 * strlen(line) + 3);
+    if (!text) {
+        fprintf(stderr, "Erro: memória insuficiente para o código gerado\n");
+        exit(1);
+    }
+    int length = 0;
+    for (const char *c = line; *c; c++) {
+        if (*c == '\\' || *c == '"') text[length++] = '\\';
+        text[length++] = *c;
+    }
+    text[length++] = '\\';
+    text[length++] = 'n';
+    int label = intern_string(ctx, text, length);
+    free(text);
+    return label;
+}
+
+// Reserva os dois contadores da estrutura (--profile-generate) e guarda a
+// chave para __rt_profile_dump
+int add_profile_counters(GenContext *ctx, const char *key) {
+    if (ctx->profile_counters / 2 == ctx->profile_key_capacity) {
+        ctx->profile_key_capacity = ctx->profile_key_capacity ? ctx->profile_key_capacity * 2 : 16;
+        ctx->profile_keys = realloc(ctx->profile_keys, ctx->profile_key_capacity * sizeof(int));
+        if (!ctx->profile_keys) {
+            fprintf(stderr, "Erro: memória insuficiente para o perfil\n");
+            exit(1);
+        }
+    }
+    ctx->profile_keys[ctx->profile_counters / 2] = intern_line(ctx, key);
+    ctx->profile_counters += 2;
+    return ctx->profile_counters - 2;
+}
+
+// Abre uma região do --cycle-counters no bloco atual: rdcycle e rdinstret
+// são lidos aqui e de novo em end_region. Devolve -1 sem a opção
+int begin_region(GenContext *ctx) {
+    if (!ctx->options->cycle_counters) return -1;
+    if (ctx->cycle_regions == ctx->cycle_label_capacity) {
+        ctx->cycle_label_capacity = ctx->cycle_label_capacity ? ctx->cycle_label_capacity * 2 : 16;
+        ctx->cycle_labels = realloc(ctx->cycle_labels, ctx->cycle_label_capacity * sizeof(int));
+        if (!ctx->cycle_labels) {
+            fprintf(stderr, "Erro: memória insuficiente para o código gerado\n");
+            exit(1);
+        }
+    }
+    int region = ctx->cycle_regions++;
+    ctx->cycle_labels[region] = -1;
+    ir_cycles(&ctx->ir, ctx->block, region, 's');
+    return region;
+}
+
+// Fecha a região no bloco atual; a descrição sai no resumo do fim
+void end_region(GenContext *ctx, int region, const char *format, ...) {
+    if (region < 0) return;
+    char text[2 * MAX_LINE_LENGTH];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    ir_cycles(&ctx->ir, ctx->block, region, 'e');
+    ctx->cycle_labels[region] = intern_line(ctx, text);
+}
+
+// Comando do nível de fora, medido sozinho; dentro de um if/while quem
+// mede é a estrutura
+int begin_statement_region(GenContext *ctx) {
+    return ctx->control_depth == 0 ? begin_region(ctx) : -1;
+}
+
+// Blocos verdadeiros por execução do teste: a fração medida no perfil (no
+// while, as iterações por entrada) ou a estimativa estática
+double profile_ratio(const ProfileEntry *profile, double fallback) {
+    if (!profile) return fallback;
+    return profile->executions > 0 ? (double)profile->taken / profile->executions : 0.0;
+}
+
+ControlEntry* push_control(GenContext *ctx, ControlKind kind, const char *condition) {
+    if (ctx->control_depth == ctx->control_capacity) {
+        ctx->control_capacity = ctx->control_capacity ? ctx->control_capacity * 2 : 16;
+        ctx->control = realloc(ctx->control, ctx->control_capacity * sizeof(ControlEntry));
+        if (!ctx->control) {
+            fprintf(stderr, "Erro: memória insuficiente para o código gerado\n");
+            exit(1);
+        }
+    }
+    ControlEntry *entry = &ctx->control[ctx->control_depth++];
+    entry->kind = kind;
+    entry->label = ctx->label_count++;
+    entry->condition = strdup(condition);
+    entry->then_block = -1;
+    entry->else_block = -1;
+    entry->end_block = -1;
+    entry->then_start = -1;
+    entry->else_start = -1;
+    entry->else_first = false;
+    entry->profile = NULL;
+    entry->counter = -1;
+    entry->region = -1;
+    entry->first_line = ctx->source_line;
+    entry->outer_weight = ctx->weight;
+    entry->taken_ratio = 1.0;
+
+    const GenOptions *options = ctx->options;
+    if (options->profile_generate || options->profile_use) {
+        char *key = profile_key(ctx, kind, condition);
+        if (options->profile_use) entry->profile = profile_find(&ctx->profile, key);
+        if (options->profile_generate) entry->counter = add_profile_counters(ctx, key);
+        free(key);
+    }
+    return entry;
+}
+
+// if: o teste desvia para o senão; o bloco verdadeiro vem em seguida.
+// Com --profile-generate, um contador antes do teste e outro no bloco
+// verdadeiro
+void open_if(GenContext *ctx, const char *condition) {
+    ControlEntry *entry = push_control(ctx, CONTROL_IF, condition);
+    entry->then_block = new_control_block(ctx, "L_then", entry->label);
+    entry->else_block = new_control_block(ctx, "L_else", entry->label);
+    entry->taken_ratio = profile_ratio(entry->profile, IF_STATIC_RATIO);
+    // Sem perfil, o senão segue o teste quando é o caminho provável. Com as
+    // contagens, quando o verdadeiro é o mais frequente: ele fica com o único
+    // desvio tomado e sem o salto para a junção
+    if (entry->profile) {
+        entry->else_first = entry->profile->taken * 2 > entry->profile->executions;
+    } else {
+        entry->else_first = condition_likely_false(condition);
+    }
+
+    entry->region = begin_region(ctx);
+    ir_set_note(&ctx->ir, "Condicional if");
+    if (entry->counter >= 0) ir_count(&ctx->ir, ctx->block, entry->counter);
+    build_condition(ctx, condition, entry->then_block, entry->else_block);
+    entry->then_start = ctx->ir.layout_count;
+    ctx->weight = entry->outer_weight * entry->taken_ratio;
+    enter_block(ctx, entry->then_block);
+    if (entry->counter >= 0) ir_count(&ctx->ir, ctx->block, entry->counter + 1);
+}
+
+void open_else(GenContext *ctx) {
+    if (ctx->control_depth == 0 || ctx->control[ctx->control_depth - 1].kind != CONTROL_IF) return;
+    ControlEntry *entry = &ctx->control[ctx->control_depth - 1];
+
+    entry->end_block = new_control_block(ctx, "L_if_end", entry->label);
+    ir_jump(&ctx->ir, ctx->block, entry->end_block);
+    entry->else_start = ctx->ir.layout_count;
+    ctx->weight = entry->outer_weight * (1.0 - entry->taken_ratio);
+    enter_block(ctx, entry->else_block);
+    ir_set_note(&ctx->ir, "Senão");
+}
+
+// while em forma rotacionada: um teste de guarda na entrada e o teste
+// repetido no fim, com um único desvio condicional para trás por iteração.
+// Os contadores do perfil contam as entradas no laço e as iterações
+void open_while(GenContext *ctx, const char *condition) {
+    ControlEntry *entry = push_control(ctx, CONTROL_WHILE, condition);
+    entry->then_block = new_control_block(ctx, "L_while_start", entry->label);
+    entry->else_block = new_control_block(ctx, "L_while_end", entry->label);
+    entry->taken_ratio = profile_ratio(entry->profile, LOOP_STATIC_TRIPS);
+
+    entry->region = begin_region(ctx);
+    ir_set_note(&ctx->ir, "Loop while");
+    if (entry->counter >= 0) ir_count(&ctx->ir, ctx->block, entry->counter);
+    build_condition(ctx, condition, entry->then_block, entry->else_block);
+    ctx->weight = entry->outer_weight * entry->taken_ratio;
+    enter_block(ctx, entry->then_block);
+    if (entry->counter >= 0) ir_count(&ctx->ir, ctx->block, entry->counter + 1);
+}
+
+void close_control(GenContext *ctx) {
+    if (ctx->control_depth == 0) return;
+    ControlEntry *entry = &ctx->control[--ctx->control_depth];
+
+    ctx->weight = entry->outer_weight;
+    if (entry->kind == CONTROL_WHILE) {
+        ir_set_note(&ctx->ir, "Teste do while");
+        build_condition(ctx, entry->condition, entry->then_block, entry->else_block);
+        enter_block(ctx, entry->else_block);
+    } else if (entry->end_block < 0) {
+        ir_jump(&ctx->ir, ctx->block, entry->else_block);
+        enter_block(ctx, entry->else_block);
+    } else {
+        ir_jump(&ctx->ir, ctx->block, entry->end_block);
+        // O senão passa a seguir o teste, que então desvia para o bloco
+        // verdadeiro quando a condição vale
+        if (entry->else_first) {
+            ir_rotate_layout(&ctx->ir, entry->then_start, entry->else_start, ctx->ir.layout_count);
+        }
+        enter_block(ctx, entry->end_block);
+    }
+    end_region(ctx, entry->region, "linhas %d-%d: %s %s", entry->first_line, ctx->source_line,
+               entry->kind == CONTROL_IF ? "if" : "while", entry->condition);
+    free(entry->condition);
+}
+
+// Passa o programa para SSA (passo "ssa")
+void build_ssa(GenContext *ctx) {
+    IrType *var_types = malloc((ctx->var_count ? ctx->var_count : 1) * sizeof(IrType));
+    for (int i = 0; i < ctx->var_count; i++) {
+        var_types[i] = ir_type_of(ctx, ctx->variables[i].type);
+    }
+    ir_build_ssa(&ctx->ir, var_types, ctx->var_count);
+    free(var_types);
+}
+
+int stack_access_size(const GenContext *ctx, const Variable *var);
+
+// Tipo e tamanho de cada variável na pilha, para o SCCP e a avaliação parcial
+IrEvalVar* stack_vars(const GenContext *ctx) {
+    IrEvalVar *vars = malloc((ctx->var_count ? ctx->var_count : 1) * sizeof(IrEvalVar));
+    for (int i = 0; i < ctx->var_count; i++) {
+        vars[i].type = ir_type_of(ctx, ctx->variables[i].type);
+        vars[i].size = stack_access_size(ctx, &ctx->variables[i]);
+    }
+    return vars;
+}
+
+// Propagação de constantes (passo "sccp")
+void propagate_constants(GenContext *ctx) {
+    SccpStats stats;
+    IrEvalVar *vars = stack_vars(ctx);
+    ir_sccp(&ctx->ir, vars, ctx->var_count, &stats);
+    free(vars);
+    if (ctx->options->sccp_stats) {
+        fprintf(stderr, "SCCP: %d valores constantes, %d desvios resolvidos, %d blocos removidos; "
+                "instruções do IR: %d -> %d\n", stats.constants, stats.branches, stats.blocks,
+                stats.instructions_before, stats.instructions_after);
+    }
+}
+
+void dump_ir(GenContext *ctx, FILE *output) {
+    const char **names = malloc((ctx->var_count ? ctx->var_count : 1) * sizeof(char *));
+    for (int i = 0; i < ctx->var_count; i++) {
+        names[i] = ctx->variables[i].name;
+    }
+    ir_dump(&ctx->ir, names, output);
+    free(names);
+}
+
+/* ---------- Código RISC-V a partir do IR ---------- */
+
+// Constantes e leituras de variáveis não geram código onde aparecem: são
+// refeitas (li, lw) por quem as usa; os phi não geram código algum
+bool emits_code(const IrInst *inst) {
+    return inst->opcode != IR_CONST && inst->opcode != IR_LOAD && inst->opcode != IR_PHI;
+}
+
+const char* load_mnemonic(const GenContext *ctx, const Variable *var) {
+    switch (var->type) {
+        case TYPE_LONG:
+            return ctx->target->load_long;
+        case TYPE_CHAR:
+        case TYPE_BOOL:
+            return "lb";
+        case TYPE_SHORT:
+            return "lh";
+        case TYPE_FLOAT:
+        case TYPE_DOUBLE:
+            return "flw";
+        default:
+            return "lw";
+    }
+}
+
+const char* store_mnemonic(const GenContext *ctx, const Variable *var) {
+    switch (var->type) {
+        case TYPE_LONG:
+            return ctx->target->store_long;
+        case TYPE_CHAR:
+        case TYPE_BOOL:
+            return "sb";
+        case TYPE_SHORT:
+            return "sh";
+        case TYPE_FLOAT:
+        case TYPE_DOUBLE:
+            return "fsw";
+        default:
+            return "sw";
+    }
+}
+
+// Bytes lidos e escritos pelas instruções acima
+int stack_access_size(const GenContext *ctx, const Variable *var) {
+    switch (var->type) {
+        case TYPE_LONG:
+            return ctx->target->native_long ? 8 : 4;
+        case TYPE_CHAR:
+        case TYPE_BOOL:
+            return 1;
+        case TYPE_SHORT:
+            return 2;
+        default:
+            return 4;
+    }
+}
+
+// Os temporários valem só dentro de um comando
+void end_statement(GenContext *ctx) {
+    ctx->temp_used = 0;
+    ctx->pending_value = -1;
+}
+
+// Divide a constante em parte alta e 12 bits de baixo com sinal, como o
+// lui + addi: value = (high << 12) + low
+void split_constant(int64_t value, int64_t *high, int64_t *low) {
+    *low = (int64_t)(((uint64_t)value & 0xFFF) ^ 0x800) - 0x800;
+    *high = (int64_t)((uint64_t)value - (uint64_t)*low) >> 12;
+}
+
+// Constante long que não cabe no li (lui + addiw no RV64): a parte alta é
+// montada antes e deslocada, e os 12 bits de baixo entram com o addi
+void load_long_constant(GenContext *ctx, const char *reg, int64_t value) {
+    if (value >= INT32_MIN && value <= INT32_MAX) {
+        add_code_line(ctx, "    li %s, %d\n", reg, (int)value);
+        return;
+    }
+    int64_t high, low;
+    split_constant(value, &high, &low);
+    load_long_constant(ctx, reg, high);
+    add_code_line(ctx, "    slli %s, %s, 12\n", reg, reg);
+    if (low != 0) add_code_line(ctx, "    addi %s, %s, %d\n", reg, reg, (int)low);
+}
+
+// Instruções que load_long_constant emite: o li de 12 bits é um addi, o de
+// 32 bits o lui + addi do montador (só o lui quando os 12 bits de baixo são
+// zero) e o long maior, a parte alta mais o slli e o addi
+int constant_cost(int64_t value) {
+    if (value == 0) return 0;
+    if (value >= -2048 && value <= 2047) return 1;
+    if (value >= INT32_MIN && value <= INT32_MAX) return (value & 0xFFF) == 0 ? 1 : 2;
+    int64_t high, low;
+    split_constant(value, &high, &low);
+    return constant_cost(high) + 1 + (low != 0);
+}
+
+// Load e store dos temporários da pilha, que têm o tamanho de um registrador
+const char* temp_load_mnemonic(IrType type) {
+    return type == IR_FLOAT ? "flw" : type == IR_LONG ? "ld" : "lw";
+}
+
+const char* temp_store_mnemonic(IrType type) {
+    return type == IR_FLOAT ? "fsw" : type == IR_LONG ? "sd" : "sw";
+}
+
+// Coloca o valor em "reg" e devolve o registrador onde ele ficou, que é
+// outro quando o valor já está num registrador (ou é o zero)
+const char* fetch_value(GenContext *ctx, int value, const char *reg) {
+    if (value == ctx->pending_value) return ctx->pending_reg;
+
+    const IrInst *def = ir_value_def(&ctx->ir, value);
+    if (def->opcode == IR_CONST && def->type != IR_FLOAT) {
+        if (def->imm == 0) return "zero";
+        load_long_constant(ctx, reg, def->imm);
+    } else if (def->opcode == IR_CONST) {
+        if (def->imm == 0) {
+            add_code_line(ctx, "    fmv.w.x %s, zero\n", reg);
+        } else {
+            add_code_line(ctx, "    li %s, 0x%08x\n", ctx->r1, (unsigned int)def->imm);
+            add_code_line(ctx, "    fmv.w.x %s, %s\n", reg, ctx->r1);
+        }
+    } else if (def->opcode == IR_LOAD && ctx->var_regs && ctx->var_regs[def->var]) {
+        return ctx->var_regs[def->var];
+    } else if (def->opcode == IR_LOAD) {
+        const Variable *var = &ctx->variables[def->var];
+        add_code_line(ctx, "    %s %s, %d(sp)\n", load_mnemonic(ctx, var), reg, var->offset);
+    } else {
+        add_code_line(ctx, "    %s %s, %d(sp)\n", temp_load_mnemonic(def->type), reg,
+                      temp_area_offset(ctx) + ctx->temp_slots[value] * register_bytes(ctx));
+    }
+    return reg;
+}
+
+// Carrega os dois operandos sem que um sobrescreva o outro
+void fetch_pair(GenContext *ctx, int first, int second, const char **left, const char **right) {
+    bool is_float = ctx->ir.values[first].type == IR_FLOAT;
+    const char *left_reg = is_float ? "ft0" : ctx->r0;
+    const char *right_reg = is_float ? "ft1" : ctx->r1;
+
+    // No --rvc o resultado pendente fica em r0: o outro operando vai para r1
+    if (second == ctx->pending_value && strcmp(ctx->pending_reg, left_reg) == 0) {
+        *right = ctx->pending_reg;
+        *left = fetch_value(ctx, first, right_reg);
+        return;
+    }
+    *left = fetch_value(ctx, first, left_reg);
+    *right = fetch_value(ctx, second, right_reg);
+}
+
+void fetch_operands(GenContext *ctx, const IrInst *inst, const char **left, const char **right) {
+    fetch_pair(ctx, inst->args[0], inst->args[1], left, right);
+}
+
+// Resultado de uma instrução: fica no registrador quando o único uso é a
+// próxima instrução que gera código; senão vai para um temporário da pilha
+void finish_value(GenContext *ctx, const IrBlock *block, int index, int value, const char *reg) {
+    int uses = ctx->use_counts[value];
+    if (uses == 0) return;
+
+    if (uses == 1) {
+        for (int i = index + 1; i < block->inst_count; i++) {
+            const IrInst *next = &block->insts[i];
+            if (!emits_code(next)) continue;
+            if (next->args[0] == value || next->args[1] == value) {
+                ctx->pending_value = value;
+                ctx->pending_reg = reg;
+                return;
+            }
+            break;
+        }
+    }
+
+    if (ctx->temp_used == MAX_TEMPORARIES) {
+        add_code_line(ctx, "    # ERRO: Temporários esgotados\n");
+        fprintf(ctx->diagnostics, "Erro: temporários esgotados numa expressão\n");
+        ctx->error_count++;
+        ctx->temp_used--;
+    }
+    int slot = ctx->temp_used++;
+    ctx->temp_slots[value] = slot;
+    add_code_line(ctx, "    %s %s, %d(sp)\n", temp_store_mnemonic(ctx->ir.values[value].type), reg,
+                  temp_area_offset(ctx) + slot * register_bytes(ctx));
+}
+
+// Registrador da variável promovida que recebe o valor na instrução
+// seguinte: "x = a + b" calcula direto no registrador de x. NULL se não há
+const char* store_target_reg(GenContext *ctx, const IrBlock *block, int index, int value) {
+    if (!ctx->var_regs || ctx->use_counts[value] != 1) return NULL;
+    for (int i = index + 1; i < block->inst_count; i++) {
+        const IrInst *next = &block->insts[i];
+        if (!emits_code(next)) continue;
+        if (next->opcode == IR_STORE && next->args[0] == value) return ctx->var_regs[next->var];
+        break;
+    }
+    return NULL;
+}
+
+/* ---------- Seleção de instruções ---------- */
+
+// Formas do operando da direita nas regras: um registrador qualquer ou uma
+// constante que vira o imediato da instrução
+typedef enum {
+    OPERAND_REG,
+    OPERAND_ZERO,       // 0
+    OPERAND_IMM,        // Cabe nos 12 bits com sinal
+    OPERAND_IMM_NEG,    // -c cabe nos 12 bits: x - c vira addi
+    OPERAND_IMM_NEXT,   // c + 1 cabe nos 12 bits: x <= c vira x < c + 1
+    OPERAND_POW2        // 2^k: x * 2^k vira slli
+} OperandPattern;
+
+// Regra da árvore "esquerda op direita", com a esquerda num registrador. No
+// texto, $d é o destino, $a e $b os operandos, $i o imediato e $w o sufixo
+// das contas de int do alvo (addiw no RV64); o seqz é o sltiu rd, rs, 1
+typedef struct {
+    char op;
+    OperandPattern right;
+    int cost;               // Instruções emitidas
+    const char *code[2];
+} SelectRule;
+
+static const SelectRule select_rules[] = {
+    { '+', OPERAND_REG,      1, { "add$w $d, $a, $b" } },
+    { '+', OPERAND_IMM,      1, { "addi$w $d, $a, $i" } },
+    { '-', OPERAND_REG,      1, { "sub$w $d, $a, $b" } },
+    { '-', OPERAND_IMM_NEG,  1, { "addi$w $d, $a, $i" } },
+    { '*', OPERAND_REG,      1, { "mul$w $d, $a, $b" } },
+    { '*', OPERAND_POW2,     1, { "slli$w $d, $a, $i" } },
+    { '/', OPERAND_REG,      1, { "div$w $d, $a, $b" } },
+    { '%', OPERAND_REG,      1, { "rem$w $d, $a, $b" } },
+    { '&', OPERAND_REG,      1, { "and $d, $a, $b" } },
+    { '&', OPERAND_IMM,      1, { "andi $d, $a, $i" } },
+    { '|', OPERAND_REG,      1, { "or $d, $a, $b" } },
+    { '|', OPERAND_IMM,      1, { "ori $d, $a, $i" } },
+    { '^', OPERAND_REG,      1, { "xor $d, $a, $b" } },
+    { '^', OPERAND_IMM,      1, { "xori $d, $a, $i" } },
+    { '=', OPERAND_REG,      2, { "xor $d, $a, $b", "seqz $d, $d" } },
+    { '=', OPERAND_ZERO,     1, { "seqz $d, $a" } },
+    { '=', OPERAND_IMM,      2, { "xori $d, $a, $i", "seqz $d, $d" } },
+    { '!', OPERAND_REG,      2, { "xor $d, $a, $b", "snez $d, $d" } },
+    { '!', OPERAND_ZERO,     1, { "snez $d, $a" } },
+    { '!', OPERAND_IMM,      2, { "xori $d, $a, $i", "snez $d, $d" } },
+    { '<', OPERAND_REG,      1, { "slt $d, $a, $b" } },
+    { '<', OPERAND_IMM,      1, { "slti $d, $a, $i" } },
+    { '>', OPERAND_REG,      1, { "sgt $d, $a, $b" } },
+    { 'L', OPERAND_REG,      2, { "sgt $d, $a, $b", "xori $d, $d, 1" } },     // <=
+    { 'L', OPERAND_IMM_NEXT, 1, { "slti $d, $a, $i" } },
+    { 'G', OPERAND_REG,      2, { "slt $d, $a, $b", "xori $d, $d, 1" } },     // >=
+    { 'G', OPERAND_IMM,      2, { "slti $d, $a, $i", "xori $d, $d, 1" } },
+};
+
+// Desvios contra ±1 que viram desvios contra o registrador zero
+typedef struct {
+    char op;
+    int constant;
+    char zero_op;
+} ZeroCompareRule;
+
+static const ZeroCompareRule zero_compare_rules[] = {
+    { '<',  1, 'L' },   // x < 1   -> x <= 0 (blez)
+    { 'G',  1, '>' },   // x >= 1  -> x > 0  (bgtz)
+    { 'L', -1, '<' },   // x <= -1 -> x < 0  (bltz)
+    { '>', -1, 'G' },   // x > -1  -> x >= 0 (bgez)
+};
+
+// Operador com os lados trocados (c < x é x > c); 0 quando não há
+char mirrored_operator(char op) {
+    switch (op) {
+        case '+': case '*': case '&': case '|': case '^': case '=': case '!': return op;
+        case '<': return '>';
+        case '>': return '<';
+        case 'L': return 'G';
+        case 'G': return 'L';
+        default: return 0;
+    }
+}
+
+bool int_constant(const GenContext *ctx, int value, int64_t *constant) {
+    const IrInst *def = ir_value_def(&ctx->ir, value);
+    if (def->opcode != IR_CONST || def->type == IR_FLOAT) return false;
+    *constant = def->imm;
+    return true;
+}
+
+// O valor tem a forma pedida? Em imm fica o imediato que a regra usa
+bool match_operand(const GenContext *ctx, OperandPattern pattern, int value, int64_t *imm) {
+    int64_t c;
+    if (pattern == OPERAND_REG) return true;
+    if (!int_constant(ctx, value, &c)) return false;
+    switch (pattern) {
+        case OPERAND_ZERO:
+            *imm = 0;
+            return c == 0;
+        case OPERAND_IMM:
+            *imm = c;
+            return c >= -2048 && c <= 2047;
+        case OPERAND_IMM_NEG:
+            *imm = -c;
+            return c >= -2047 && c <= 2048;
+        case OPERAND_IMM_NEXT:
+            *imm = c + 1;
+            return c >= -2049 && c <= 2046;
+        case OPERAND_POW2:
+            if (c <= 0 || (c & (c - 1)) != 0) return false;
+            for (*imm = 0; ((int64_t)1 << *imm) != c; (*imm)++);
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Instruções para ter o valor num registrador, como em fetch_value
+int operand_cost(const GenContext *ctx, int value) {
+    if (value == ctx->pending_value) return 0;
+    const IrInst *def = ir_value_def(&ctx->ir, value);
+    if (def->opcode == IR_CONST && def->type != IR_FLOAT) return constant_cost(def->imm);
+    if (def->opcode == IR_LOAD && ctx->var_regs && ctx->var_regs[def->var]) return 0;
+    return 1;
+}
+
+// Regra mais barata para a árvore: o custo da regra mais o de pôr os
+// operandos em registradores. Nas operações comutativas e nas comparações
+// (espelhadas) a constante também pode vir à esquerda; swapped diz se os
+// lados foram trocados
+const SelectRule* select_rule(const GenContext *ctx, char op, int left, int right, bool *swapped, int64_t *imm) {
+    const SelectRule *best = NULL;
+    int best_cost = 0;
+    for (int side = 0; side < 2; side++) {
+        char rule_op = side ? mirrored_operator(op) : op;
+        int a = side ? right : left, b = side ? left : right;
+        if (!rule_op) continue;
+        for (size_t i = 0; i < sizeof(select_rules) / sizeof(select_rules[0]); i++) {
+            const SelectRule *rule = &select_rules[i];
+            int64_t value = 0;
+            if (rule->op != rule_op || !match_operand(ctx, rule->right, b, &value)) continue;
+            int cost = rule->cost + operand_cost(ctx, a) + (rule->right == OPERAND_REG ? operand_cost(ctx, b) : 0);
+            if (!best || cost < best_cost) {
+                best = rule;
+                best_cost = cost;
+                *swapped = side;
+                *imm = value;
+            }
+        }
+    }
+    return best;
+}
+
+void emit_rule(GenContext *ctx, const SelectRule *rule, IrType type, const char *dest,
+               const char *left, const char *right, int64_t imm) {
+    for (int i = 0; i < 2 && rule->code[i]; i++) {
+        char line[MAX_LINE_LENGTH];
+        size_t length = 0;
+        for (const char *p = rule->code[i]; *p && length < sizeof(line) - 1; p++) {
+            if (*p != '$') {
+                line[length++] = *p;
+                continue;
+            }
+            p++;
+            switch (*p) {
+                case 'd': length += snprintf(line + length, sizeof(line) - length, "%s", dest); break;
+                case 'a': length += snprintf(line + length, sizeof(line) - length, "%s", left); break;
+                case 'b': length += snprintf(line + length, sizeof(line) - length, "%s", right); break;
+                case 'i': length += snprintf(line + length, sizeof(line) - length, "%lld", (long long)imm); break;
+                case 'w':
+                    length += snprintf(line + length, sizeof(line) - length, "%s",
+                                       type == IR_INT ? ctx->target->word_suffix : "");
+                    break;
+            }
+        }
+        line[length < sizeof(line) ? length : sizeof(line) - 1] = '\0';
+        add_code_line(ctx, "    %s\n", line);
+    }
+}
+
+// Operação inteira pela regra mais barata da tabela; a constante que vira
+// imediato nunca passa por um registrador
+void generate_int_binary(GenContext *ctx, const IrInst *inst, const char *dest) {
+    bool swapped = false;
+    int64_t imm = 0;
+    const SelectRule *rule = select_rule(ctx, inst->op, inst->args[0], inst->args[1], &swapped, &imm);
+    if (!rule) return;
+
+    int a = inst->args[swapped ? 1 : 0], b = inst->args[swapped ? 0 : 1];
+    const char *left, *right = NULL;
+    if (rule->right == OPERAND_REG) {
+        fetch_pair(ctx, a, b, &left, &right);
+    } else {
+        left = fetch_value(ctx, a, ctx->r0);
+    }
+    emit_rule(ctx, rule, ctx->ir.values[a].type, dest, left, right, imm);
+}
+
+char inverse_compare(char op) {
+    switch (op) {
+        case '=': return '!';
+        case '!': return '=';
+        case '<': return 'G';
+        case '>': return 'L';
+        case 'L': return '>';
+        case 'G': return '<';
+        default: return op;
+    }
+}
+
+const char* branch_mnemonic(char op) {
+    switch (op) {
+        case '=': return "beq";
+        case '!': return "bne";
+        case '<': return "blt";
+        case '>': return "bgt";
+        case 'L': return "ble";
+        default: return "bge";
+    }
+}
+
+// Desvio no fim do bloco: o lado que vem logo em seguida no layout não
+// precisa de salto, então a condição é invertida quando convém
+void generate_branch(GenContext *ctx, const IrInst *inst, const IrBlock *block, int next_block) {
+    const char *left, *right;
+    const char *if_true = ctx->ir.blocks[block->succ[0]].label;
+    const char *if_false = ctx->ir.blocks[block->succ[1]].label;
+    bool fall_true = block->succ[0] == next_block;
+
+    if (ctx->ir.values[inst->args[0]].type == IR_FLOAT) {
+        fetch_operands(ctx, inst, &left, &right);
+        // feq/flt/fle deixam 1 quando a condição vale (no != é o contrário)
+        char op = inst->op == '!' ? '=' : inst->op;
+        bool true_when_set = inst->op != '!';
+        generate_float_operation(ctx, op, left, right, ctx->r2);
+        if (fall_true) {
+            add_code_line(ctx, "    %s %s, %s\n", true_when_set ? "beqz" : "bnez", ctx->r2, if_false);
+        } else {
+            add_code_line(ctx, "    %s %s, %s\n", true_when_set ? "bnez" : "beqz", ctx->r2, if_true);
+        }
+    } else {
+        // A constante fica à direita; contra ±1 o desvio pode usar o zero
+        char op = inst->op;
+        int a = inst->args[0], b = inst->args[1];
+        int64_t constant;
+        if (int_constant(ctx, a, &constant) && !int_constant(ctx, b, &constant)) {
+            a = inst->args[1];
+            b = inst->args[0];
+            op = mirrored_operator(op);
+        }
+        bool against_zero = false;
+        if (int_constant(ctx, b, &constant)) {
+            for (size_t i = 0; i < sizeof(zero_compare_rules) / sizeof(zero_compare_rules[0]); i++) {
+                if (zero_compare_rules[i].op == op && zero_compare_rules[i].constant == constant) {
+                    op = zero_compare_rules[i].zero_op;
+                    against_zero = true;
+                    break;
+                }
+            }
+        }
+        if (against_zero) {
+            left = fetch_value(ctx, a, ctx->r0);
+            right = "zero";
+        } else {
+            fetch_pair(ctx, a, b, &left, &right);
+        }
+        if (fall_true) {
+            add_code_line(ctx, "    %s %s, %s, %s\n", branch_mnemonic(inverse_compare(op)), left, right, if_false);
+        } else {
+            add_code_line(ctx, "    %s %s, %s, %s\n", branch_mnemonic(op), left, right, if_true);
+        }
+    }
+
+    if (!fall_true && block->succ[1] != next_block) {
+        add_code_line(ctx, "    j %s\n", if_false);
+    }
+}
+
+// Põe em reg o endereço de uma tabela da .bss e devolve o deslocamento do
+// campo pedido para o lw/sw; quando o campo mais distante (offset + span)
+// passa dos 12 bits, o deslocamento é somado à base com a ajuda de scratch
+int table_address(GenContext *ctx, const char *table, const char *reg, const char *scratch, int offset, int span) {
+    add_code_line(ctx, "    la %s, %s\n", reg, table);
+    if (offset + span <= 2047) return offset;
+    add_code_line(ctx, "    li %s, %d\n", scratch, offset);
+    add_code_line(ctx, "    add %s, %s, %s\n", reg, reg, scratch);
+    return 0;
+}
+
+// Soma a diferença de um contador (em delta) ao total de 64 bits em
+// offset(base), com o vai-um da parte baixa para a alta. No RV64 a
+// diferença dos 32 bits guardados na entrada fica sem sinal e o total é
+// somado com ld/sd
+void accumulate_cycles(GenContext *ctx, const char *delta, int offset) {
+    if (ctx->target->xlen == 64) {
+        add_code_line(ctx, "    slli %s, %s, 32\n", delta, delta);
+        add_code_line(ctx, "    srli %s, %s, 32\n", delta, delta);
+        add_code_line(ctx, "    ld t3, %d(t0)\n", offset);
+        add_code_line(ctx, "    add t3, t3, %s\n", delta);
+        add_code_line(ctx, "    sd t3, %d(t0)\n", offset);
+        return;
+    }
+    add_code_line(ctx, "    lw t3, %d(t0)\n", offset);
+    add_code_line(ctx, "    add t3, t3, %s\n", delta);
+    add_code_line(ctx, "    sltu t4, t3, %s\n", delta);
+    add_code_line(ctx, "    sw t3, %d(t0)\n", offset);
+    add_code_line(ctx, "    lw t3, %d(t0)\n", offset + 4);
+    add_code_line(ctx, "    add t3, t3, t4\n");
+    add_code_line(ctx, "    sw t3, %d(t0)\n", offset + 4);
+}
+
+// Região do --cycle-counters. Na entrada, rdcycle e rdinstret são as últimas
+// instruções antes do código medido; na saída, as primeiras. O resto (as
+// diferenças e os totais de 64 bits em __rt_cycle_table) fica fora da
+// medida. Usa t0-t4, que não levam valores de um comando para o outro
+void generate_cycles(GenContext *ctx, const IrInst *inst) {
+    int entry = inst->imm * RUNTIME_CYCLE_ENTRY_SIZE;
+    if (inst->op == 's') {
+        int offset = table_address(ctx, "__rt_cycle_table", "t0", "t1", entry, RUNTIME_CYCLE_ENTRY_SIZE);
+        add_code_line(ctx, "    rdinstret t2\n");
+        add_code_line(ctx, "    rdcycle t1\n");
+        add_code_line(ctx, "    sw t1, %d(t0)\n", offset + RUNTIME_CYCLE_START);
+        add_code_line(ctx, "    sw t2, %d(t0)\n", offset + RUNTIME_CYCLE_START + 4);
+        return;
+    }
+    add_code_line(ctx, "    rdcycle t1\n");
+    add_code_line(ctx, "    rdinstret t2\n");
+    int offset = table_address(ctx, "__rt_cycle_table", "t0", "t3", entry, RUNTIME_CYCLE_ENTRY_SIZE);
+    add_code_line(ctx, "    lw t3, %d(t0)\n", offset + RUNTIME_CYCLE_START);
+    add_code_line(ctx, "    sub t1, t1, t3\n");
+    add_code_line(ctx, "    lw t3, %d(t0)\n", offset + RUNTIME_CYCLE_START + 4);
+    add_code_line(ctx, "    sub t2, t2, t3\n");
+    accumulate_cycles(ctx, "t1", offset + RUNTIME_CYCLE_CYCLES);
+    accumulate_cycles(ctx, "t2", offset + RUNTIME_CYCLE_INSTRET);
+    add_code_line(ctx, "    lw t3, %d(t0)\n", offset + RUNTIME_CYCLE_EXECUTIONS);
+    add_code_line(ctx, "    addi t3, t3, 1\n");
+    add_code_line(ctx, "    sw t3, %d(t0)\n", offset + RUNTIME_CYCLE_EXECUTIONS);
+}
+
+void generate_instruction(GenContext *ctx, const IrBlock *block, int index, int next_block) {
+    const IrInst *inst = &block->insts[index];
+    const char *left, *right, *reg;
+
+    switch (inst->opcode) {
+        case IR_CONST:
+        case IR_LOAD:
+        case IR_PHI:
+            break;
+
+        case IR_STORE: {
+            const Variable *var = &ctx->variables[inst->var];
+            bool is_float = ctx->ir.values[inst->args[0]].type == IR_FLOAT;
+            const char *var_reg = ctx->var_regs ? ctx->var_regs[inst->var] : NULL;
+            if (var_reg) {
+                // Variável promovida: o valor vai direto para o registrador dela
+                reg = fetch_value(ctx, inst->args[0], var_reg);
+                if (strcmp(reg, var_reg) != 0) {
+                    add_code_line(ctx, "    %s %s, %s  # %s\n", is_float ? "fmv.s" : "mv", var_reg, reg, var->name);
+                }
+            } else {
+                reg = fetch_value(ctx, inst->args[0], is_float ? "ft0" : ctx->r0);
+                add_code_line(ctx, "    %s %s, %d(sp)  # %s\n", store_mnemonic(ctx, var), reg, var->offset, var->name);
+            }
+            end_statement(ctx);
+            break;
+        }
+
+        case IR_BINARY: {
+            bool is_float = ctx->ir.values[inst->args[0]].type == IR_FLOAT;
+            const char *dest = store_target_reg(ctx, block, index, inst->dest);
+            if (!dest) dest = inst->type == IR_FLOAT ? "ft2" : ctx->result;
+            if (is_float) {
+                fetch_operands(ctx, inst, &left, &right);
+                generate_float_operation(ctx, inst->op, left, right, dest);
+            } else {
+                generate_int_binary(ctx, inst, dest);
+            }
+            finish_value(ctx, block, index, inst->dest, dest);
+            break;
+        }
+
+        case IR_CONVERT: {
+            const char *dest = store_target_reg(ctx, block, index, inst->dest);
+            IrType from = ctx->ir.values[inst->args[0]].type;
+            if (inst->type == IR_FLOAT) {
+                if (!dest) dest = "ft2";
+                reg = fetch_value(ctx, inst->args[0], ctx->r0);
+                add_code_line(ctx, "    fcvt.s.%c %s, %s\n", from == IR_LONG ? 'l' : 'w', dest, reg);
+            } else if (from == IR_FLOAT) {
+                // Conversão do C: trunca em direção a zero
+                if (!dest) dest = ctx->result;
+                reg = fetch_value(ctx, inst->args[0], "ft0");
+                add_code_line(ctx, "    fcvt.%c.s %s, %s, rtz\n", inst->type == IR_LONG ? 'l' : 'w', dest, reg);
+            } else if (inst->type == IR_INT) {
+                // long -> int: os 32 bits de baixo, com o sinal estendido
+                if (!dest) dest = ctx->result;
+                reg = fetch_value(ctx, inst->args[0], ctx->r0);
+                add_code_line(ctx, "    sext.w %s, %s\n", dest, reg);
+            } else {
+                // int -> long: o int já está com o sinal estendido no registrador
+                dest = fetch_value(ctx, inst->args[0], dest ? dest : ctx->result);
+            }
+            finish_value(ctx, block, index, inst->dest, dest);
+            break;
+        }
+
+        case IR_READ:
+            if (ctx->options->buffered_output) {
+                // O que já foi impresso precisa aparecer antes de esperar a entrada
+                use_runtime(ctx, RUNTIME_FLUSH);
+                add_code_line(ctx, "    call __rt_flush\n");
+            }
+            if (ctx->options->buffered_input) {
+                RuntimeRoutine routine = inst->type == IR_FLOAT ? RUNTIME_READ_FLOAT : RUNTIME_READ_INT;
+                use_runtime(ctx, routine);
+                add_code_line(ctx, "    call %s\n", routine == RUNTIME_READ_FLOAT ? "__rt_read_float" : "__rt_read_int");
+            } else {
+                add_code_line(ctx, "    li a7, %d\n", inst->type == IR_FLOAT ? 6 : 5);  // read_float / read_int
+                add_code_line(ctx, "    ecall\n");
+            }
+            if (inst->type == IR_INT && ctx->target->xlen == 64) {
+                // A leitura devolve um long: o int fica com os 32 bits de baixo
+                add_code_line(ctx, "    sext.w a0, a0\n");
+            }
+            finish_value(ctx, block, index, inst->dest, inst->type == IR_FLOAT ? "fa0" : "a0");
+            break;
+
+        case IR_PRINT:
+            if (inst->op == 'f') {
+                reg = fetch_value(ctx, inst->args[0], "fa0");
+                if (strcmp(reg, "fa0") != 0) add_code_line(ctx, "    fmv.s fa0, %s\n", reg);
+            } else {
+                reg = fetch_value(ctx, inst->args[0], "a0");
+                if (strcmp(reg, "a0") != 0) add_code_line(ctx, "    mv a0, %s\n", reg);
+            }
+            if (ctx->options->buffered_output) {
+                RuntimeRoutine routine = inst->op == 'f' ? RUNTIME_PRINT_FLOAT :
+                                         inst->op == 'c' ? RUNTIME_PUTC : RUNTIME_PRINT_INT;
+                use_runtime(ctx, routine);
+                add_code_line(ctx, "    call %s\n", routine == RUNTIME_PRINT_FLOAT ? "__rt_print_float" :
+                                                   routine == RUNTIME_PUTC ? "__rt_putc" : "__rt_print_int");
+            } else {
+                // print_float / print_char / print_int
+                add_code_line(ctx, "    li a7, %d\n", inst->op == 'f' ? 2 : inst->op == 'c' ? 11 : 1);
+                add_code_line(ctx, "    ecall\n");
+            }
+            end_statement(ctx);
+            break;
+
+        case IR_PRINT_STRING:
+            add_code_line(ctx, "    la a0, str_%d\n", inst->imm);
+            if (ctx->options->buffered_output) {
+                use_runtime(ctx, RUNTIME_PUTS);
+                add_code_line(ctx, "    call __rt_puts\n");
+            } else {
+                add_code_line(ctx, "    li a7, 4\n");  // Código do sistema para print string
+                add_code_line(ctx, "    ecall\n");
+            }
+            end_statement(ctx);
+            break;
+
+        case IR_COUNT: {
+            int offset = table_address(ctx, "__rt_prof_counts", ctx->r0, ctx->r1, inst->imm * 4, 0);
+            add_code_line(ctx, "    lw %s, %d(%s)\n", ctx->r1, offset, ctx->r0);
+            add_code_line(ctx, "    addi %s, %s, 1\n", ctx->r1, ctx->r1);
+            add_code_line(ctx, "    sw %s, %d(%s)\n", ctx->r1, offset, ctx->r0);
+            end_statement(ctx);
+            break;
+        }
+
+        case IR_CYCLES:
+            generate_cycles(ctx, inst);
+            end_statement(ctx);
+            break;
+
+        case IR_BRANCH:
+            generate_branch(ctx, inst, block, next_block);
+            end_statement(ctx);
+            break;
+
+        case IR_JUMP:
+            if (block->succ[0] != next_block) {
+                add_code_line(ctx, "    j %s\n", ctx->ir.blocks[block->succ[0]].label);
+            }
+            end_statement(ctx);
+            break;
+
+        case IR_EXIT:
+            generate_riscv_footer(ctx);
+            break;
+    }
+}
+
+// Percorre os blocos alcançáveis na ordem do layout; só recebem rótulo os
+// blocos que são destino de algum desvio ou salto
+void generate_code_from_ir(GenContext *ctx) {
+    IrFunction *fn = &ctx->ir;
+    int *order = malloc((fn->layout_count ? fn->layout_count : 1) * sizeof(int));
+    bool *needs_label = calloc(fn->block_count ? fn->block_count : 1, sizeof(bool));
+    int count = 0;
+    for (int l = 0; l < fn->layout_count; l++) {
+        if (fn->blocks[fn->layout[l]].reachable) order[count++] = fn->layout[l];
+    }
+
+    ctx->use_counts = calloc(fn->value_count ? fn->value_count : 1, sizeof(int));
+    ctx->temp_slots = calloc(fn->value_count ? fn->value_count : 1, sizeof(int));
+    for (int i = 0; i < count; i++) {
+        const IrBlock *block = &fn->blocks[order[i]];
+        int next_block = i + 1 < count ? order[i + 1] : -1;
+        for (int j = 0; j < block->inst_count; j++) {
+            const IrInst *inst = &block->insts[j];
+            if (!emits_code(inst)) continue;
+            for (int k = 0; k < 2; k++) {
+                if (inst->args[k] >= 0) ctx->use_counts[inst->args[k]]++;
+            }
+            if (inst->opcode == IR_BRANCH || inst->opcode == IR_JUMP) {
+                for (int k = 0; k < block->succ_count; k++) {
+                    if (block->succ[k] != next_block) needs_label[block->succ[k]] = true;
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        const IrBlock *block = &fn->blocks[order[i]];
+        int next_block = i + 1 < count ? order[i + 1] : -1;
+        if (needs_label[order[i]]) {
+            add_code_line(ctx, "%s:\n", block->label);
+        }
+
+        end_statement(ctx);
+        for (int j = 0; j < block->inst_count; j++) {
+            const IrInst *inst = &block->insts[j];
+            for (const char *note = inst->note; note; ) {
+                const char *end = strchr(note, '\n');
+                int length = end ? (int)(end - note) : (int)strlen(note);
+                add_code_line(ctx, "    # %.*s\n", length, note);
+                note = end ? end + 1 : NULL;
+            }
+
+            // O valor pendente só vale para a instrução seguinte
+            int consumed = emits_code(inst) ? ctx->pending_value : -1;
+            generate_instruction(ctx, block, j, next_block);
+            if (consumed >= 0 && ctx->pending_value == consumed) ctx->pending_value = -1;
+        }
+    }
+
+    free(order);
+    free(needs_label);
+}
+
+// Modelo do escalonador: o de --schedule=, ou o padrão quando o passo vem do -O2
+const SchedModel* gen_sched_model(const GenOptions *options) {
+    return options->schedule ? options->schedule : sched_find_model(NULL);
+}
+
+// Reordena as instruções de cada bloco básico para esconder latências
+// (passo "sched"); as linhas voltam para o buffer do contexto na nova ordem
+void schedule_generated_code(GenContext *ctx) {
+    int count = ctx->code_line_count;
+    const char **lines = malloc((count ? count : 1) * sizeof(char *));
+    for (int i = 0; i < count; i++) {
+        lines[i] = ctx->output_code[i].code;
+    }
+
+    SchedOptions sched_options = { gen_sched_model(ctx->options), ctx->options->rvc };
+    SchedStats stats;
+    char **scheduled = schedule_code(lines, count, &sched_options, &stats);
+
+    // O texto antigo continua nos chunks até o fim da compilação
+    ctx->code_line_count = 0;
+    for (int i = 0; i < count; i++) {
+        add_code_line(ctx, "%s", scheduled[i]);
+    }
+    schedule_free(scheduled, count);
+    free(lines);
+
+    if (ctx->options->sched_stats) {
+        fprintf(stderr, "Escalonamento (%s): %ld ciclos estimados, antes %ld (%.1f%% menos), %d blocos, %d instruções\n",
+                sched_options.model->name, stats.cycles_after, stats.cycles_before,
+                stats.cycles_before ? 100.0 * (stats.cycles_before - stats.cycles_after) / stats.cycles_before : 0.0,
+                stats.blocks, stats.instructions);
+    }
+}
+
+/* ---------- Passos do gerador ---------- */
+
+// IR -> assembly (passo "codegen"); o --dump-ir lista o IR que chega aqui
+void generate_code(GenContext *ctx) {
+    if (ctx->options->dump_ir) {
+        dump_ir(ctx, stderr);
+    }
+    generate_code_from_ir(ctx);
+    generate_riscv_prologue_patch(ctx);
+}
+
+// Texto impresso pela avaliação parcial, já no formato do .string
+typedef struct {
+    char *text;
+    size_t length;
+    size_t capacity;
+} ResidualText;
+
+void residual_append(ResidualText *residual, const char *text, size_t length) {
+    if (residual->length + length + 1 > residual->capacity) {
+        residual->capacity = (residual->length + length + 1) * 2;
+        residual->text = realloc(residual->text, residual->capacity);
+        if (!residual->text) {
+            fprintf(stderr, "Erro: memória insuficiente para o código gerado\n");
+            exit(1);
+        }
+    }
+    memcpy(residual->text + residual->length, text, length);
+    residual->length += length;
+}
+
+// Um print_char cabe na string se o caractere é visível ou tem escape no .string
+bool residual_char_fits(int c) {
+    return c == '\n' || c == '\t' || (c >= ' ' && c <= '~');
+}
+
+void residual_append_char(ResidualText *residual, int c) {
+    char text[2] = { '\\', (char)c };
+    if (c == '\n' || c == '\t' || c == '"' || c == '\\') {
+        text[1] = c == '\n' ? 'n' : c == '\t' ? 't' : (char)c;
+        residual_append(residual, text, 2);
+    } else {
+        residual_append(residual, text + 1, 1);
+    }
+}
+
+void residual_flush(GenContext *ctx, ResidualText *residual, int block) {
+    if (residual->length == 0) return;
+    ir_print_string(&ctx->ir, block, intern_string(ctx, residual->text, (int)residual->length));
+    residual->length = 0;
+}
+
+// Avaliação parcial (passo "eval"): o programa roda no próprio gerador até o
+// fim ou até o primeiro scanf. Se terminar dentro do limite de instruções, a
+// execução vira um bloco de entrada com o estado final das variáveis e o que
+// foi impresso, juntado numa única string sempre que possível; num programa
+// com scanf, esse bloco salta para a leitura e o resto segue compilado
+void evaluate_program(GenContext *ctx) {
+    const GenOptions *options = ctx->options;
+    long budget = options->eval_budget > 0 ? options->eval_budget : EVAL_DEFAULT_BUDGET;
+    IrEvalVar *vars = stack_vars(ctx);
+
+    IrEvalResult result;
+    ir_evaluate(&ctx->ir, vars, ctx->var_count, budget, &result);
+    free(vars);
+
+    // Custo do resíduo, em instruções: li + sw por variável, três por
+    // chamada de impressão e o salto para o resto do programa
+    int stores = 0, calls = 0;
+    size_t output_length = 0;
+    bool in_text = false;
+    for (int i = 0; i < ctx->var_count; i++) {
+        if (result.var_defined[i]) stores++;
+    }
+    for (int i = 0; i < result.print_count; i++) {
+        const IrEvalPrint *print = &result.prints[i];
+        bool text = print->op == 's' || print->op == 'd' || (print->op == 'c' && residual_char_fits(print->value & 0xff));
+        if (!text || !in_text) calls++;
+        in_text = text;
+        output_length += print->op == 's' ? strlen(ctx->strings[print->value].value) : 12;
+    }
+    long residual_cost = 2L * stores + 3L * calls + 1;
+
+    const char *reason = NULL;
+    char why[96];
+    if (result.status == EVAL_BUDGET) {
+        snprintf(why, sizeof(why), "limite de %ld instruções excedido", budget);
+        reason = why;
+    } else if (result.status == EVAL_UNDEFINED) {
+        reason = "variável lida antes de receber valor";
+    } else if (output_length > EVAL_MAX_OUTPUT) {
+        snprintf(why, sizeof(why), "saída de mais de %d bytes", EVAL_MAX_OUTPUT);
+        reason = why;
+    } else if (residual_cost >= result.steps) {
+        reason = "o resíduo não seria menor";
+    }
+    if (reason) {
+        if (options->eval_stats) {
+            fprintf(stderr, "Avaliação parcial: nada mudou (%s)\n", reason);
+        }
+        ir_eval_free(&result);
+        return;
+    }
+
+    IrFunction *fn = &ctx->ir;
+    int entry = ir_new_block(fn, "L_eval");
+    ir_set_note(fn, "Avaliado em tempo de compilação: %ld instruções do IR%s", result.steps,
+                result.status == EVAL_INPUT ? " até o primeiro scanf" : "");
+    for (int i = 0; i < ctx->var_count; i++) {
+        if (!result.var_defined[i]) continue;
+        IrType type = ir_type_of(ctx, ctx->variables[i].type);
+        ir_store(fn, entry, i, ir_const(fn, entry, type, result.var_values[i]));
+    }
+
+    ResidualText residual = { NULL, 0, 0 };
+    char number[24];
+    for (int i = 0; i < result.print_count; i++) {
+        const IrEvalPrint *print = &result.prints[i];
+        if (print->op == 's') {
+            const char *text = ctx->strings[print->value].value;
+            residual_append(&residual, text, strlen(text));
+            continue;
+        }
+        if (print->op == 'd') {
+            residual_append(&residual, number, snprintf(number, sizeof(number), "%lld", (long long)print->value));
+            continue;
+        }
+        if (print->op == 'c' && residual_char_fits(print->value & 0xff)) {
+            residual_append_char(&residual, print->value & 0xff);
+            continue;
+        }
+
+        // Float (o formato é o da chamada do sistema) e caracteres de controle
+        residual_flush(ctx, &residual, entry);
+        ir_print_value(fn, entry, ir_const(fn, entry, print->op == 'f' ? IR_FLOAT : IR_INT, print->value), print->op);
+    }
+    residual_flush(ctx, &residual, entry);
+    free(residual.text);
+
+    if (result.status == EVAL_FINISHED) {
+        ir_exit(fn, entry);
+    } else {
+        int resume = ir_split_block(fn, result.resume_block, result.resume_index);
+        set_block_weight(ctx, resume, block_weight(ctx, result.resume_block));
+        ir_jump(fn, entry, resume);
+    }
+    ir_replace_entry(fn, entry);
+
+    if (options->eval_stats) {
+        fprintf(stderr, "Avaliação parcial: %s avaliado em %ld instruções do IR; resíduo: %d stores e %d prints "
+                "(instruções do IR agora: %d)\n", result.status == EVAL_FINISHED ? "programa todo" : "trecho até o scanf",
+                result.steps, stores, calls, ir_instruction_count(fn));
+    }
+    ir_eval_free(&result);
+}
+
+// Registradores das variáveis promovidas: o código gerado e as rotinas de
+// apoio nunca usam os s, então o valor sobrevive a chamadas e ecalls
+static const char *const int_var_regs[] = {
+    "s1", "s2", "s3", "s4", "s5", "s6", "s7", "s8", "s9", "s10", "s11"
+};
+static const char *const float_var_regs[] = {
+    "fs0", "fs1", "fs2", "fs3", "fs4", "fs5", "fs6", "fs7", "fs8", "fs9", "fs10", "fs11"
+};
+
+typedef struct {
+    int var;
+    double weight;
+} VarWeight;
+
+static int compare_var_weights(const void *a, const void *b) {
+    const VarWeight *x = a, *y = b;
+    if (x->weight != y->weight) return x->weight < y->weight ? 1 : -1;
+    return x->var - y->var;
+}
+
+// Variáveis em registradores (passo "regalloc"): cada load e store pesa a
+// frequência do seu bloco, medida pelo perfil ou estimada (LOOP_STATIC_TRIPS
+// por while, IF_STATIC_RATIO por lado do if), e as mais pesadas ficam nos s.
+// char, short e bool continuam na pilha, onde o sb/lb faz o truncamento
+void allocate_registers(GenContext *ctx) {
+    IrFunction *fn = &ctx->ir;
+    VarWeight *weights = malloc((ctx->var_count ? ctx->var_count : 1) * sizeof(VarWeight));
+    for (int i = 0; i < ctx->var_count; i++) {
+        weights[i].var = i;
+        weights[i].weight = 0.0;
+    }
+    for (int b = 0; b < fn->block_count; b++) {
+        const IrBlock *block = &fn->blocks[b];
+        if (!block->reachable) continue;
+        double weight = block_weight(ctx, b);
+        for (int i = 0; i < block->inst_count; i++) {
+            const IrInst *inst = &block->insts[i];
+            if (inst->opcode == IR_LOAD || inst->opcode == IR_STORE) weights[inst->var].weight += weight;
+        }
+    }
+    qsort(weights, ctx->var_count, sizeof(VarWeight), compare_var_weights);
+
+    ctx->var_regs = calloc(ctx->var_count ? ctx->var_count : 1, sizeof(char *));
+    int int_used = 0, float_used = 0;
+    int int_count = sizeof(int_var_regs) / sizeof(int_var_regs[0]);
+    int float_count = sizeof(float_var_regs) / sizeof(float_var_regs[0]);
+    for (int i = 0; i < ctx->var_count && weights[i].weight > 0.0; i++) {
+        const Variable *var = &ctx->variables[weights[i].var];
+        const char *reg = NULL;
+        if ((var->type == TYPE_INT || var->type == TYPE_LONG) && int_used < int_count) {
+            reg = int_var_regs[int_used++];
+        } else if ((var->type == TYPE_FLOAT || var->type == TYPE_DOUBLE) && float_used < float_count) {
+            reg = float_var_regs[float_used++];
+        }
+        if (!reg) continue;
+        ctx->var_regs[weights[i].var] = reg;
+        add_code_line(ctx, "    # %s em %s (frequência %.6g)\n", var->name, reg, weights[i].weight);
+    }
+    free(weights);
+}
+
+typedef struct {
+    const char *name;
+    const char *description;
+    int level;          // Menor -O que liga o passo
+    bool required;      // Não pode ser desligado
+    bool on_ir;         // Trabalha no IR (senão, nas linhas de assembly)
+    void (*run)(GenContext *ctx);
+} GenPass;
+
+// Na ordem de GenPassId
+static const GenPass gen_passes[PASS_COUNT] = {
+    { "ssa",      "IR em SSA com dominadores e phi",        0, true,  true,  build_ssa },
+    { "sccp",     "propagação de constantes (SCCP)",        1, false, true,  propagate_constants },
+    { "eval",     "avaliação parcial sem a entrada",        2, false, true,  evaluate_program },
+    { "regalloc", "variáveis mais usadas em registradores", 2, false, true,  allocate_registers },
+    { "codegen",  "geração do assembly a partir do IR",     0, true,  false, generate_code },
+    { "sched",    "escalonamento por bloco básico",         2, false, false, schedule_generated_code },
+};
+
+// Número do passo com esse nome, ou -1
+int gen_find_pass(const char *name) {
+    for (int i = 0; i < PASS_COUNT; i++) {
+        if (strcmp(gen_passes[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+int gen_opt_level(const GenOptions *options) {
+    return options->opt_level_set ? options->opt_level : 1;
+}
+
+// Um passo roda se é obrigatório, se foi ligado à mão ou se o nível -O o
+// inclui e ele não foi desligado; --schedule liga o escalonamento
+bool gen_pass_enabled(const GenOptions *options, int pass) {
+    if (gen_passes[pass].required) return true;
+    if (options->passes_off & (1u << pass)) return false;
+    // A avaliação parcial apagaria os contadores do perfil e as regiões medidas
+    if (pass == PASS_EVAL && (options->profile_generate || options->cycle_counters)) return false;
+    if (options->passes_on & (1u << pass)) return true;
+    if (pass == PASS_SCHED && options->schedule) return true;
+    return gen_opt_level(options) >= gen_passes[pass].level;
+}
+
+double elapsed_ms(const struct timespec *start, const struct timespec *end) {
+    return (end->tv_sec - start->tv_sec) * 1000.0 + (end->tv_nsec - start->tv_nsec) / 1e6;
+}
+
+// Roda os passos ligados, em ordem; com --time-passes informa o tempo de cada
+// um e com --print-after=passo lista o resultado na saída de erro
+void run_gen_passes(GenContext *ctx) {
+    const GenOptions *options = ctx->options;
+    double total = 0.0;
+    for (int i = 0; i < PASS_COUNT; i++) {
+        const GenPass *pass = &gen_passes[i];
+        if (!gen_pass_enabled(options, i)) continue;
+
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        pass->run(ctx);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        if (options->time_passes) {
+            double ms = elapsed_ms(&start, &end);
+            total += ms;
+            fprintf(stderr, "Passo %-8s %9.3f ms  (%s)\n", pass->name, ms, pass->description);
+        }
+        if (options->print_after & (1u << i)) {
+            fprintf(stderr, "# ---- Depois de %s ----\n", pass->name);
+            if (pass->on_ir) {
+                dump_ir(ctx, stderr);
+            } else {
+                for (int j = 0; j < ctx->code_line_count; j++) {
+                    fwrite(ctx->output_code[j].code, 1, ctx->output_code[j].length, stderr);
+                }
+            }
+        }
+    }
+    if (options->time_passes) {
+        fprintf(stderr, "Passos (-O%d): %.3f ms no total\n", gen_opt_level(options), total);
+    }
+}
+
+// Escreve o assembly puro, juntando as linhas em blocos grandes antes do fwrite
+void write_output_raw(GenContext *ctx, FILE *output) {
+    char *buffer = malloc(OUTPUT_BUFFER_SIZE);
+    size_t used = 0;
+
+    for (int i = 0; i < ctx->code_line_count; i++) {
+        const char *code = ctx->output_code[i].code;
+        size_t length = ctx->output_code[i].length;
+
+        if (used + length > OUTPUT_BUFFER_SIZE) {
+            fwrite(buffer, 1, used, output);
+            used = 0;
+        }
+        if (length > OUTPUT_BUFFER_SIZE) {
+            fwrite(code, 1, length, output);
+            continue;
+        }
+        memcpy(buffer + used, code, length);
+        used += length;
+    }
+
+    fwrite(buffer, 1, used, output);
+    free(buffer);
+}
+
+// Monta o código gerado no próprio processo e escreve um objeto ELF
+// relocável (.o), sem passar pelo texto do .s
+int write_output_elf(GenContext *ctx, FILE *output) {
+    const char **lines = malloc((ctx->code_line_count ? ctx->code_line_count : 1) * sizeof(char *));
+    for (int i = 0; i < ctx->code_line_count; i++) {
+        lines[i] = ctx->output_code[i].code;
+    }
+
+    AsmProgram program;
+    AsmOptions asm_options = { ctx->options->rvc, ctx->target->xlen };
+    int status = asm_assemble(&program, lines, ctx->code_line_count, &asm_options);
+    if (status != 0) {
+        fprintf(stderr, "Erro ao montar o código gerado: %s\n", program.error);
+    } else {
+        status = elf_write_object(&program, output);
+    }
+
+    if (status == 0 && ctx->options->size_stats) {
+        const AsmStats *stats = &program.stats;
+        uint32_t size = program.sections[SECTION_TEXT].size;
+        fprintf(stderr, "Tamanho do .text: %u bytes (%u sem RVC, %.1f%% menor), %d de %d instruções comprimidas\n",
+                size, stats->uncompressed_size,
+                stats->uncompressed_size ? 100.0 * (stats->uncompressed_size - size) / stats->uncompressed_size : 0.0,
+                stats->compressed, stats->instructions);
+    }
+
+    asm_free(&program);
+    free(lines);
+    return status;
+}
+
+// Listagem numerada (opcional), útil para depurar o gerador
+void write_output_with_line_numbers(GenContext *ctx, FILE *output) {
+    int max_line_num = ctx->code_line_count;
+    int num_digits = 1;
+    while (max_line_num >= 10) {
+        max_line_num /= 10;
+        num_digits++;
+    }
+    
+    for (int i = 0; i < ctx->code_line_count; i++) {
+        fprintf(output, "%*d: %s", num_digits, i + 1, ctx->output_code[i].code);
+    }
+}
+
+// "Variavel T x criada!": tipo e nome ficam no próprio texto da linha,
+// que é cortado no lugar; sem o formato, a linha fica intacta
+bool parse_declaration(char *text, char **type, char **name) {
+    static const char prefix[] = "Variavel ";
+    static const char suffix[] = " criada!";
+    if (strncmp(text, prefix, sizeof(prefix) - 1) != 0) return false;
+    char *type_start = text + sizeof(prefix) - 1;
+    char *type_end = strchr(type_start, ' ');
+    if (!type_end || type_end == type_start) return false;
+    char *name_start = type_end + 1;
+    char *name_end = strchr(name_start, ' ');
+    if (!name_end || name_end == name_start || strncmp(name_end, suffix, sizeof(suffix) - 1) != 0) return false;
+    *type_end = '\0';
+    *name_end = '\0';
+    *type = type_start;
+    *name = name_start;
+    return true;
+}
+
+int generate_riscv_code(GenContext *ctx, FILE *input, FILE *output) {
+    // A linha cresce com o comando (getline): nomes e expressões não têm
+    // limite de tamanho e são lidos no próprio buffer
+    char *line = NULL;
+    size_t line_capacity = 0;
+
+    if (ctx->options->profile_use && load_profile(ctx, ctx->options->profile_use) != 0) {
+        return 1;
+    }
+    if (ctx->options->format == FORMAT_ELF && ctx->target->xlen != 32) {
+        fprintf(stderr, "Erro: o objeto ELF só é gerado para rv32 (use --format=asm com --target=%s)\n",
+                ctx->target->name);
+        return 1;
+    }
+
+    // Passada única sobre a entrada (que pode ser um pipe): cada comando
+    // vira instruções do IR, e o assembly sai do IR depois das otimizações.
+    // O IR do programa inteiro fica na memória até o fim (o SSA, a avaliação
+    // parcial e a escolha de registradores olham o programa todo), então a
+    // memória do gerador cresce linearmente com o número de comandos
+    generate_riscv_header(ctx);
+    enter_block(ctx, ir_new_block(&ctx->ir, NULL));
+    int program_region = begin_region(ctx);
+    
+    while (getline(&line, &line_capacity, input) != -1) {
+        line[strcspn(line, "\n")] = 0;
+        char *trimmed_line = line;
         while(isspace(*trimmed_line)) trimmed_line++;
 
-        // Processa condicionais
-        if (strstr(line, "Condicional if:")) {
-            char *cond = strchr(line, ':') + 2;
-            add_code_line("    # Condicional if\n");
-            process_condition(cond, label_count, false);
-            add_code_line("L_if_%d:\n", label_count);
-            label_count++;
-            current_depth++;
+        // Linha do fonte dos comandos seguintes, para rotular as regiões
+        if (sscanf(trimmed_line, "Linha %d", &ctx->source_line) == 1) continue;
+
+        // Declarações de variáveis
+        char *var_type, *var_name;
+        if (parse_declaration(trimmed_line, &var_type, &var_name)) {
+            // O gerador não emite a extensão D: no rv32 o double é float por
+            // escolha do alvo (RV32IMFC), mas no rv64 ele seria um double de
+            // precisão simples sem aviso
+            if (ctx->target->xlen == 64 && type_from_name(var_type) == TYPE_DOUBLE) {
+                gen_error(ctx, "double '%s' não é suportado no --target=%s (sem fld/fsd e operações .d); use float",
+                          var_name, ctx->target->name);
+            }
+            add_variable(ctx, var_name, var_type, false, false);
+            continue;
         }
-        
-        if (strstr(line, "Condicional if-else:")) {
-            char *cond = strchr(line, ':') + 2;
-            add_code_line("    # Condicional if-else\n");
-            process_condition(cond, label_count, false);
-            add_code_line("L_else_%d:\n", label_count);
-            label_count++;
-            current_depth++;
+
+        // Estruturas de controle: o cabeçalho vem antes do corpo e os
+        // marcadores de fim fecham a estrutura mais interna
+        if (strstr(line, "Condicional if:")) {
+            open_if(ctx, strchr(line, ':') + 2);
+            continue;
         }
-        
         if (strstr(line, "Loop while:")) {
-            char *cond = strchr(line, ':') + 2;
-            add_code_line("    # Loop while\n");
-            add_code_line("L_while_start_%d:\n", label_count);
-            process_condition(cond, label_count, true);
-            add_code_line("L_while_end_%d:\n", label_count);
-            label_count++;
-            current_depth++;
+            open_while(ctx, strchr(line, ':') + 2);
+            continue;
+        }
+        if (strcmp(trimmed_line, "Senao") == 0) {
+            open_else(ctx);
+            continue;
+        }
+        if (strcmp(trimmed_line, "Fim condicional") == 0 || strcmp(trimmed_line, "Fim loop") == 0) {
+            close_control(ctx);
+            continue;
         }
         
         if (strlen(trimmed_line) == 0) continue;
@@ -627,36 +2750,12 @@ void generate_riscv_code(FILE *input, FILE *output) {
         if (strstr(trimmed_line, "Comando printf:")) {
             char *start = strchr(trimmed_line, ':') + 1;
             while(isspace(*start)) start++;
-            
-            // Verifica se é string formatada
-            if (start[0] == '"') {
-                char *end_quote = strchr(start + 1, '"');
-                if (end_quote) {
-                    *end_quote = '\0';
-                    strncpy(format_str, start + 1, end_quote - start - 1);
-                    format_str[end_quote - start - 1] = '\0';
-                    
-                    // Adiciona string na seção .rodata
-                    add_code_line("str_%d: .string \"%s\"\n", str_label_count, format_str);
-                    
-                    // Gera chamada para printf
-                    add_code_line("    # Chamada printf\n");
-                    add_code_line("    la a0, str_%d\n", str_label_count);
-                    add_code_line("    li a7, 4\n");  // Código do sistema para print string
-                    add_code_line("    ecall\n");
-                    
-                    str_label_count++;
-                }
-            } 
-            // Se for uma expressão simples (sem string de formato)
-            else {
-                process_expression(start);
-                add_code_line("    # Print de expressão\n");
-                add_code_line("    lw a0, %d(sp)\n", TEMP_RESULT_OFFSET);
-                
-                add_code_line("    li a7, 1\n");  // Código para print_int
-                add_code_line("    ecall\n");
-            }
+            // build_printf separa os argumentos no próprio texto
+            char *statement = ctx->options->cycle_counters ? strdup(trimmed_line) : NULL;
+            int region = begin_statement_region(ctx);
+            build_printf(ctx, start);
+            end_region(ctx, region, "linha %d: %s", ctx->source_line, statement);
+            free(statement);
             continue;
         }
         
@@ -664,41 +2763,9 @@ void generate_riscv_code(FILE *input, FILE *output) {
         if (strstr(trimmed_line, "Comando scanf:")) {
             char *start = strchr(trimmed_line, ':') + 1;
             while(isspace(*start)) start++;
-            
-            // Extrai a variável (formato simplificado: "format", var)
-            char *comma = strchr(start, ',');
-            if (comma) {
-                *comma = '\0';
-                char *var_start = comma + 1;
-                while(isspace(*var_start)) var_start++;
-                
-                Variable *var = find_variable(var_start);
-                if (var) {
-                    add_code_line("    # Chamada scanf\n");
-                    add_code_line("    addi a0, sp, %d\n", var->offset);  // Endereço da variável
-                    
-                    // Determina o tipo de scanf com base no tipo da variável
-                    if (strcmp(var->type, "INT") == 0 || strcmp(var->type, "INT_KW") == 0) {
-                        add_code_line("    li a7, 5\n");  // Código para read_int
-                    } 
-                    else if (strcmp(var->type, "FLOAT") == 0 || strcmp(var->type, "FLOAT_KW") == 0) {
-                        add_code_line("    li a7, 6\n");  // Código para read_float
-                    }
-                    else {
-                        add_code_line("    # ERRO: Tipo não suportado no scanf\n");
-                        continue;
-                    }
-                    
-                    add_code_line("    ecall\n");
-                    
-                    // Para float, precisamos armazenar o resultado
-                    if (strcmp(var->type, "FLOAT") == 0 || strcmp(var->type, "FLOAT_KW") == 0) {
-                        add_code_line("    fsw fa0, %d(sp)\n", var->offset);
-                    }
-                } else {
-                    add_code_line("    # ERRO: Variável '%s' não declarada\n", var_start);
-                }
-            }
+            int region = begin_statement_region(ctx);
+            build_scanf(ctx, start);
+            end_region(ctx, region, "linha %d: %s", ctx->source_line, trimmed_line);
             continue;
         }
         // Ignora linhas vazias e comentários/metadados
@@ -707,70 +2774,534 @@ void generate_riscv_code(FILE *input, FILE *output) {
             strstr(trimmed_line, "Semantica") ||
             strstr(trimmed_line, "Name")) continue;
         
-        // Processa declarações (já tratadas)
-        if (strstr(trimmed_line, "Variavel")) continue;
-        
         // Processa atribuições
         if (strstr(trimmed_line, "Atribuicao:")) {
             char* equal_pos = strchr(trimmed_line, '=');
             if (equal_pos) {
-                // Extrai nome da variável
+                // Nome e expressão ficam no próprio texto da linha
                 char* start = trimmed_line + strlen("Atribuicao: ");
-                char* end = strchr(start, '=');
-                if (end) {
-                    strncpy(var_name, start, end - start);
-                    var_name[end - start] = '\0';
-                    
-                    // Remove espaços do nome
-                    char* trimmed = var_name;
-                    while(isspace(*trimmed)) trimmed++;
-                    char* end_trim = trimmed + strlen(trimmed) - 1;
-                    while(end_trim > trimmed && isspace(*end_trim)) end_trim--;
-                    *(end_trim + 1) = '\0';
-                    
-                    // Extrai expressão
-                    strcpy(expr, equal_pos + 1);
-                    char* expr_end = expr + strlen(expr) - 1;
-                    while(expr_end > expr && isspace(*expr_end)) expr_end--;
-                    *(expr_end + 1) = '\0';
-                    
-                    if (strlen(trimmed) > 0 && strlen(expr) > 0) {
-                        generate_riscv_assignment(trimmed, expr);
-                    }
+                char* expr = equal_pos + 1;
+                char* name_end = equal_pos;
+                while (name_end > start && isspace(name_end[-1])) name_end--;
+                *name_end = '\0';
+                while (isspace(*start)) start++;
+                char* expr_end = expr + strlen(expr);
+                while (expr_end > expr && isspace(expr_end[-1])) expr_end--;
+                *expr_end = '\0';
+
+                if (strlen(start) > 0 && strlen(expr) > 0) {
+                    int region = begin_statement_region(ctx);
+                    build_assignment(ctx, start, expr);
+                    const char *value = expr;
+                    while (isspace((unsigned char)*value)) value++;
+                    end_region(ctx, region, "linha %d: %s = %s", ctx->source_line, start, value);
                 }
             }
             continue;
         }
     }
     
-    generate_riscv_footer();
-    write_output_with_line_numbers(output);
+    // Entrada truncada: fecha o que ficou aberto
+    free(line);
+    while (ctx->control_depth > 0) {
+        close_control(ctx);
+    }
+    end_region(ctx, program_region, "programa");
+    ir_exit(&ctx->ir, ctx->block);
+
+    run_gen_passes(ctx);
+    // As rotinas de apoio guardam valores através de rótulos e chamadas, o
+    // que o escalonador não sabe tratar: entram depois dele
+    runtime_generate_text(ctx->runtime_parts, ctx->target->xlen, emit_runtime_line, ctx);
+    generate_riscv_data_section(ctx);
+
+    int status = 0;
+    if (ctx->options->format == FORMAT_ELF) {
+        status = write_output_elf(ctx, output);
+    } else {
+        write_output_raw(ctx, output);
+    }
+    if (ctx->error_count > 0) {
+        fprintf(ctx->diagnostics, "Geração com %d erro(s)\n", ctx->error_count);
+        status = 1;
+    }
+    return status;
 }
 
-int main(int argc, char **argv) {
-    if (argc != 3) {
-        printf("Uso: %s entrada.txt saida.s\n", argv[0]);
+void init_context(GenContext *ctx, const GenOptions *options) {
+    static const GenOptions default_options = { FORMAT_ASM };
+    memset(ctx, 0, sizeof(GenContext));
+    ir_init(&ctx->ir);
+    ctx->pending_value = -1;
+    ctx->prologue_line = -1;
+    ctx->weight = 1.0;
+    ctx->options = options ? options : &default_options;
+    ctx->target = gen_target(ctx->options);
+    ctx->diagnostics = stderr;
+
+    if (ctx->options->rvc) {
+        // Resultado no primeiro operando: "add a2, a2, a3" vira c.add
+        ctx->r0 = "a2";
+        ctx->r1 = "a3";
+        ctx->r2 = "a4";
+        ctx->result = ctx->r0;
+    } else {
+        ctx->r0 = "t0";
+        ctx->r1 = "t1";
+        ctx->r2 = "t2";
+        ctx->result = ctx->r2;
+    }
+}
+
+void free_context(GenContext *ctx) {
+    free_code_buffer(ctx);
+    free_variables(ctx);
+    free(ctx->control);
+    for (int i = 0; i < ctx->string_count; i++) {
+        free(ctx->strings[i].value);
+    }
+    free(ctx->strings);
+    ir_free(&ctx->ir);
+    free(ctx->use_counts);
+    free(ctx->temp_slots);
+    free_profile(&ctx->profile);
+    free_profile(&ctx->profile_seen);
+    free(ctx->profile_keys);
+    free(ctx->block_weights);
+    free(ctx->var_regs);
+    free(ctx->cycle_labels);
+}
+
+// Trata uma opção de linha de comando do gerador; retorna 1 se a opção foi
+// reconhecida, 0 se não é do gerador e -1 se o valor é inválido
+int parse_gen_option(const char *arg, GenOptions *options) {
+    if (strncmp(arg, "--format=", 9) == 0) {
+        if (strcmp(arg + 9, "asm") == 0) {
+            options->format = FORMAT_ASM;
+        } else if (strcmp(arg + 9, "elf") == 0) {
+            options->format = FORMAT_ELF;
+        } else {
+            fprintf(stderr, "Formato de saída desconhecido: %s (use asm ou elf)\n", arg + 9);
+            return -1;
+        }
         return 1;
     }
-    
-    FILE *input = fopen(argv[1], "r");
+    if (strncmp(arg, "--target=", 9) == 0) {
+        options->target = gen_find_target(arg + 9);
+        if (!options->target) {
+            fprintf(stderr, "Alvo desconhecido: %s (use rv32 ou rv64)\n", arg + 9);
+            return -1;
+        }
+        return 1;
+    }
+    if (strcmp(arg, "--rvc") == 0) {
+        options->rvc = true;
+        return 1;
+    }
+    if (strcmp(arg, "--size-stats") == 0) {
+        options->size_stats = true;
+        return 1;
+    }
+    if (strcmp(arg, "--schedule") == 0 || strncmp(arg, "--schedule=", 11) == 0) {
+        options->schedule = sched_find_model(arg[10] == '=' ? arg + 11 : NULL);
+        if (!options->schedule) {
+            fprintf(stderr, "Modelo de escalonamento desconhecido: %s (use rocket ou u74)\n", arg + 11);
+            return -1;
+        }
+        return 1;
+    }
+    if (strcmp(arg, "--sched-stats") == 0) {
+        options->sched_stats = true;
+        return 1;
+    }
+    if (strcmp(arg, "-O0") == 0 || strcmp(arg, "-O1") == 0 || strcmp(arg, "-O2") == 0) {
+        options->opt_level = arg[2] - '0';
+        options->opt_level_set = true;
+        return 1;
+    }
+    if (strncmp(arg, "--enable-pass=", 14) == 0 || strncmp(arg, "--disable-pass=", 15) == 0 ||
+        strncmp(arg, "--print-after=", 14) == 0) {
+        const char *name = strchr(arg, '=') + 1;
+        int pass = gen_find_pass(name);
+        if (pass < 0) {
+            fprintf(stderr, "Passo desconhecido: %s (use ssa, sccp, eval, regalloc, codegen ou sched)\n", name);
+            return -1;
+        }
+        if (arg[2] == 'p') {
+            options->print_after |= 1u << pass;
+        } else if (arg[2] == 'e') {
+            options->passes_on |= 1u << pass;
+            options->passes_off &= ~(1u << pass);
+        } else if (gen_passes[pass].required) {
+            fprintf(stderr, "O passo %s não pode ser desligado\n", name);
+            return -1;
+        } else {
+            options->passes_off |= 1u << pass;
+            options->passes_on &= ~(1u << pass);
+        }
+        return 1;
+    }
+    if (strcmp(arg, "--time-passes") == 0) {
+        options->time_passes = true;
+        return 1;
+    }
+    if (strcmp(arg, "--no-sccp") == 0) {
+        options->passes_off |= 1u << PASS_SCCP;
+        options->passes_on &= ~(1u << PASS_SCCP);
+        return 1;
+    }
+    if (strcmp(arg, "--sccp-stats") == 0) {
+        options->sccp_stats = true;
+        return 1;
+    }
+    if (strncmp(arg, "--eval-budget=", 14) == 0) {
+        char *end;
+        options->eval_budget = strtol(arg + 14, &end, 10);
+        if (*end != '\0' || options->eval_budget <= 0) {
+            fprintf(stderr, "Limite inválido: %s (use um número de instruções)\n", arg + 14);
+            return -1;
+        }
+        return 1;
+    }
+    if (strcmp(arg, "--eval-stats") == 0) {
+        options->eval_stats = true;
+        return 1;
+    }
+    if (strcmp(arg, "--profile-generate") == 0) {
+        options->profile_generate = true;
+        return 1;
+    }
+    if (strncmp(arg, "--profile-use=", 14) == 0) {
+        options->profile_use = arg + 14;
+        return 1;
+    }
+    if (strcmp(arg, "--cycle-counters") == 0) {
+        options->cycle_counters = true;
+        return 1;
+    }
+    if (strcmp(arg, "--dump-ir") == 0) {
+        options->dump_ir = true;
+        return 1;
+    }
+    if (strcmp(arg, "--buffered-output") == 0) {
+        options->buffered_output = true;
+        return 1;
+    }
+    if (strcmp(arg, "--buffered-input") == 0) {
+        options->buffered_input = true;
+        return 1;
+    }
+    return 0;
+}
+
+// Texto que identifica as opções que mudam a saída (entra na chave do cache)
+void describe_gen_options(const GenOptions *options, char *buffer, size_t size) {
+    // Entram os passos que de fato rodam, não as opções que os ligaram
+    char passes[64] = "";
+    for (int i = 0; i < PASS_COUNT; i++) {
+        if (!gen_pass_enabled(options, i)) continue;
+        if (passes[0]) strcat(passes, ",");
+        strcat(passes, gen_passes[i].name);
+    }
+    // O perfil usado entra pelo conteúdo, não só pelo caminho
+    char profile[32];
+    snprintf(profile, sizeof(profile), "%s%s", options->profile_generate ? "gen" : "-",
+             options->cycle_counters ? ",cycles" : "");
+    if (options->profile_use) {
+        snprintf(profile + strlen(profile), sizeof(profile) - strlen(profile), ",%08x",
+                 profile_file_hash(options->profile_use));
+    }
+    snprintf(buffer, size, "format=%s target=%s rvc=%d passes=%s schedule=%s buffered=%d%d eval_budget=%ld profile=%s",
+             options->format == FORMAT_ELF ? "elf" : "asm", gen_target(options)->name, options->rvc, passes,
+             gen_pass_enabled(options, PASS_SCHED) ? gen_sched_model(options)->name : "off",
+             options->buffered_output, options->buffered_input,
+             gen_pass_enabled(options, PASS_EVAL) ? (options->eval_budget > 0 ? options->eval_budget : EVAL_DEFAULT_BUDGET) : 0L,
+             profile);
+}
+
+// Extensão padrão do arquivo de saída para o formato escolhido
+const char* gen_output_extension(const GenOptions *options) {
+    return options->format == FORMAT_ELF ? ".o" : ".s";
+}
+
+// Gera o .s (ou .o) a partir da saída do sintático já aberta (arquivo, pipe ou memória)
+int generate_riscv_stream(FILE *input, FILE *output, FILE *diagnostics, const GenOptions *options) {
+    GenContext ctx;
+    init_context(&ctx, options);
+    ctx.diagnostics = diagnostics;
+    int status = generate_riscv_code(&ctx, input, output);
+    free_context(&ctx);
+    return status || ferror(output) ? 1 : 0;
+}
+
+// Compila um arquivo do sintático em um .s; retorna 0 em caso de sucesso.
+// Cada chamada usa um contexto próprio, então pode rodar em qualquer thread
+int compile_file(const char *input_path, const char *output_path, const char *listing_path,
+                 const GenOptions *options) {
+    // "-" lê o resultado do sintático direto da entrada padrão (pipe)
+    bool read_stdin = strcmp(input_path, "-") == 0;
+    FILE *input = read_stdin ? stdin : fopen(input_path, "r");
     if (!input) {
-        perror("Erro ao abrir arquivo de entrada");
+        fprintf(stderr, "Erro ao abrir arquivo de entrada %s: %s\n", input_path, strerror(errno));
         return 1;
     }
     
-    FILE *output = fopen(argv[2], "w");
+    FILE *output = fopen(output_path, "wb");
     if (!output) {
-        perror("Erro ao criar arquivo de saída");
-        fclose(input);
+        fprintf(stderr, "Erro ao criar arquivo de saída %s: %s\n", output_path, strerror(errno));
+        if (!read_stdin) fclose(input);
         return 1;
     }
     
-    generate_riscv_code(input, output);
+    GenContext ctx;
+    init_context(&ctx, options);
+    int status = generate_riscv_code(&ctx, input, output);
     
-    fclose(input);
-    fclose(output);
+    if (!read_stdin) fclose(input);
+    if (fclose(output) != 0) status = 1;
+
+    if (listing_path) {
+        FILE *listing = fopen(listing_path, "w");
+        if (!listing) {
+            fprintf(stderr, "Erro ao criar arquivo de listagem %s: %s\n", listing_path, strerror(errno));
+            free_context(&ctx);
+            return 1;
+        }
+        write_output_with_line_numbers(&ctx, listing);
+        fclose(listing);
+    }
+
+    free_context(&ctx);
+    return status;
+}
+
+/* ---------- Modo --batch: vários arquivos em um pool de threads ---------- */
+
+// Fila de cada worker: o dono retira do fim e os outros roubam do início
+typedef struct {
+    pthread_mutex_t lock;
+    int *jobs;
+    int head;
+    int tail;
+} WorkQueue;
+
+typedef struct {
+    BatchJob *jobs;
+    WorkQueue *queues;
+    int worker_count;
+    BatchFunction compile;
+} BatchPool;
+
+typedef struct {
+    BatchPool *pool;
+    int id;
+} BatchWorker;
+
+int queue_pop_tail(WorkQueue *queue) {
+    int job = -1;
+    pthread_mutex_lock(&queue->lock);
+    if (queue->head < queue->tail) {
+        job = queue->jobs[--queue->tail];
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return job;
+}
+
+int queue_steal_head(WorkQueue *queue) {
+    int job = -1;
+    pthread_mutex_lock(&queue->lock);
+    if (queue->head < queue->tail) {
+        job = queue->jobs[queue->head++];
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return job;
+}
+
+void* batch_worker(void *arg) {
+    BatchWorker *worker = arg;
+    BatchPool *pool = worker->pool;
+
+    for (;;) {
+        int job = queue_pop_tail(&pool->queues[worker->id]);
+
+        // Fila própria vazia: rouba das filas dos outros workers
+        for (int i = 1; job == -1 && i < pool->worker_count; i++) {
+            job = queue_steal_head(&pool->queues[(worker->id + i) % pool->worker_count]);
+        }
+        // Nenhum job novo é criado durante o batch, então todas as filas
+        // vazias significam que o trabalho acabou
+        if (job == -1) break;
+
+        BatchJob *current = &pool->jobs[job];
+        current->status = pool->compile(current);
+    }
+    return NULL;
+}
+
+// Troca a extensão do arquivo de entrada pela da saída (".s" ou ".o")
+char* default_output_path(const char *input_path, const char *extension) {
+    const char *slash = strrchr(input_path, '/');
+    const char *dot = strrchr(input_path, '.');
+    size_t base_length = (dot && (!slash || dot > slash)) ? (size_t)(dot - input_path) : strlen(input_path);
+
+    char *path = malloc(base_length + strlen(extension) + 1);
+    memcpy(path, input_path, base_length);
+    strcpy(path + base_length, extension);
+    return path;
+}
+
+// Lê a lista do batch: uma linha por arquivo, "entrada [saida]"
+int read_batch_list(const char *list_path, const char *extension, BatchJob **out_jobs) {
+    FILE *list = fopen(list_path, "r");
+    if (!list) {
+        fprintf(stderr, "Erro ao abrir lista do batch %s: %s\n", list_path, strerror(errno));
+        return -1;
+    }
+
+    BatchJob *jobs = NULL;
+    int count = 0, capacity = 0;
+    char line[4096];
+    char input_path[2048], output_path[2048];
+
+    while (fgets(line, sizeof(line), list)) {
+        int fields = sscanf(line, "%2047s %2047s", input_path, output_path);
+        if (fields < 1 || input_path[0] == '#') continue;
+
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            jobs = realloc(jobs, capacity * sizeof(BatchJob));
+        }
+        jobs[count].input_path = strdup(input_path);
+        jobs[count].output_path = fields == 2 ? strdup(output_path) : default_output_path(input_path, extension);
+        jobs[count].status = 0;
+        count++;
+    }
+
+    fclose(list);
+    *out_jobs = jobs;
+    return count;
+}
+
+// Compila todos os arquivos da lista com "compile", em worker_count threads
+int run_batch(const char *list_path, const char *extension, int worker_count, BatchFunction compile) {
+    BatchJob *jobs = NULL;
+    int job_count = read_batch_list(list_path, extension, &jobs);
+    if (job_count < 0) return 1;
+
+    if (worker_count > job_count) worker_count = job_count;
+    if (worker_count < 1) worker_count = 1;
+
+    // Distribui os jobs em blocos contíguos; o roubo equilibra o resto
+    BatchPool pool = { jobs, calloc(worker_count, sizeof(WorkQueue)), worker_count, compile };
+    int *slots = malloc((job_count ? job_count : 1) * sizeof(int));
+    for (int w = 0; w < worker_count; w++) {
+        WorkQueue *queue = &pool.queues[w];
+        pthread_mutex_init(&queue->lock, NULL);
+        queue->jobs = slots + (long)job_count * w / worker_count;
+        queue->head = 0;
+        queue->tail = (int)((long)job_count * (w + 1) / worker_count - (long)job_count * w / worker_count);
+        for (int j = 0; j < queue->tail; j++) {
+            queue->jobs[j] = (int)((long)job_count * w / worker_count) + j;
+        }
+    }
+
+    pthread_t *threads = malloc(worker_count * sizeof(pthread_t));
+    BatchWorker *workers = malloc(worker_count * sizeof(BatchWorker));
+    for (int w = 1; w < worker_count; w++) {
+        workers[w] = (BatchWorker){ &pool, w };
+        pthread_create(&threads[w], NULL, batch_worker, &workers[w]);
+    }
+    workers[0] = (BatchWorker){ &pool, 0 };
+    batch_worker(&workers[0]);
+    for (int w = 1; w < worker_count; w++) {
+        pthread_join(threads[w], NULL);
+    }
+
+    int failures = 0;
+    for (int j = 0; j < job_count; j++) {
+        if (jobs[j].status != 0) {
+            fprintf(stderr, "Falha ao gerar %s\n", jobs[j].output_path);
+            failures++;
+        }
+        free(jobs[j].input_path);
+        free(jobs[j].output_path);
+    }
+    printf("Batch: %d arquivo(s) gerado(s), %d falha(s), %d thread(s)\n",
+           job_count - failures, failures, worker_count);
+
+    for (int w = 0; w < worker_count; w++) {
+        pthread_mutex_destroy(&pool.queues[w].lock);
+    }
+    free(threads);
+    free(workers);
+    free(slots);
+    free(pool.queues);
+    free(jobs);
+    return failures ? 1 : 0;
+}
+
+#ifndef RISCV_GEN_SEM_MAIN
+GenOptions gen_options = { FORMAT_ASM };
+
+int compile_batch_job(BatchJob *job) {
+    return compile_file(job->input_path, job->output_path, NULL, &gen_options);
+}
+
+int main(int argc, char **argv) {
+    const char *input_path = NULL;
+    const char *output_path = NULL;
+    const char *listing_path = NULL;
+    const char *batch_path = NULL;
+    int jobs = (int)sysconf(_SC_NPROCESSORS_ONLN);
+
+    for (int i = 1; i < argc; i++) {
+        int gen_option = parse_gen_option(argv[i], &gen_options);
+        if (gen_option < 0) return 1;
+        if (gen_option > 0) continue;
+
+        if (strncmp(argv[i], "--listing=", 10) == 0) {
+            listing_path = argv[i] + 10;
+        } else if (strncmp(argv[i], "--batch=", 8) == 0) {
+            batch_path = argv[i] + 8;
+        } else if (strncmp(argv[i], "--jobs=", 7) == 0) {
+            jobs = atoi(argv[i] + 7);
+        } else if (!input_path) {
+            input_path = argv[i];
+        } else if (!output_path) {
+            output_path = argv[i];
+        } else {
+            input_path = NULL;
+            break;
+        }
+    }
+
+    if (batch_path) {
+        return run_batch(batch_path, gen_output_extension(&gen_options), jobs, compile_batch_job);
+    }
+
+    if (!input_path || !output_path) {
+        printf("Uso: %s (entrada.txt | -) saida.s [--listing=saida.lst] [opções]\n", argv[0]);
+        printf("     %s --batch=lista.txt [--jobs=N] [opções]\n", argv[0]);
+        printf("Opções: --format=asm|elf, --target=rv32|rv64 (long de 64 bits no rv64; o elf é só rv32),\n");
+        printf("        --rvc (instruções comprimidas), --size-stats,\n");
+        printf("        --schedule[=rocket|u74] (escalonamento por bloco), --sched-stats\n");
+        printf("        -O0|-O1|-O2 (padrão -O1; -O2 também avalia, põe variáveis em registradores e escalona), --time-passes\n");
+        printf("        --enable-pass=P, --disable-pass=P, --print-after=P (P: ssa, sccp, eval, regalloc, codegen, sched)\n");
+        printf("        --no-sccp (sem propagação de constantes), --sccp-stats, --dump-ir\n");
+        printf("        --eval-budget=N (instruções do IR avaliadas no -O2), --eval-stats\n");
+        printf("        --profile-generate (conta os if/while; o perfil sai na saída de erro)\n");
+        printf("        --profile-use=perfil.txt (layout e registradores guiados pelo perfil)\n");
+        printf("        --cycle-counters (rdcycle/rdinstret em cada comando e if/while; resumo na saída de erro)\n");
+        printf("        --buffered-output (prints com buffer, uma chamada write por bloco)\n");
+        printf("        --buffered-input (scanf lê a entrada em blocos, uma chamada read por bloco)\n");
+        return 1;
+    }
+
+    if (compile_file(input_path, output_path, listing_path, &gen_options) != 0) {
+        return 1;
+    }
     
-    printf("Código RISC-V gerado em %s\n", argv[2]);
+    printf("%s RISC-V gerado em %s\n", gen_options.format == FORMAT_ELF ? "Objeto" : "Código", output_path);
     return 0;
 }
+#endif
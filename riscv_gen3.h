@@ -0,0 +1,86 @@
+#ifndef RISCV_GEN3_H
+#define RISCV_GEN3_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "riscv_sched.h"
+
+// Um arquivo do modo --batch
+typedef struct {
+    char *input_path;
+    char *output_path;
+    int status;
+} BatchJob;
+
+// Compila um job do batch; retorna 0 em caso de sucesso
+typedef int (*BatchFunction)(BatchJob *job);
+
+typedef enum {
+    FORMAT_ASM,     // Texto assembly (.s)
+    FORMAT_ELF      // Objeto ELF32 relocável (.o), montado no próprio gerador (só RV32)
+} OutputFormat;
+
+// Alvo do código gerado (--target=): a largura dos registradores inteiros
+// decide o tamanho do long e as instruções das contas de int
+typedef struct {
+    const char *name;
+    int xlen;                   // 32 ou 64
+    const char *load_long;      // lw no RV32, onde o long tem 32 bits; ld no RV64
+    const char *store_long;
+    const char *word_suffix;    // "w" no RV64: add/sub/mul/div/rem de 32 bits com o sinal estendido
+    bool native_long;           // long vira IR_LONG (64 bits)
+} RiscvTarget;
+
+// Alvo pelo nome; NULL se não existir
+const RiscvTarget* gen_find_target(const char *name);
+
+// Passos do gerador, na ordem em que rodam (ver gen_passes em riscv_gen3.c)
+typedef enum {
+    PASS_SSA,           // IR em SSA (obrigatório)
+    PASS_SCCP,          // Propagação de constantes condicional esparsa
+    PASS_EVAL,          // Avaliação parcial do que não depende da entrada
+    PASS_REGALLOC,      // Variáveis mais usadas em registradores s
+    PASS_CODEGEN,       // IR -> assembly (obrigatório)
+    PASS_SCHED,         // Escalonamento das instruções de cada bloco
+    PASS_COUNT
+} GenPassId;
+
+// Opções que mudam o código gerado
+typedef struct {
+    OutputFormat format;
+    const RiscvTarget *target;  // NULL = rv32
+    bool rvc;           // Modo de tamanho: prefere formas da extensão C
+    bool size_stats;    // Informa o tamanho do .text (só com --format=elf)
+    const SchedModel *schedule;     // Escalonamento por bloco (NULL = desligado)
+    bool sched_stats;   // Informa os ciclos estimados antes e depois
+    int opt_level;      // -O0, -O1 ou -O2; sem opt_level_set vale -O1
+    bool opt_level_set;
+    unsigned passes_on;     // Passos ligados ou desligados à mão (bit 1 << GenPassId)
+    unsigned passes_off;
+    bool time_passes;   // Informa o tempo de cada passo
+    unsigned print_after;   // Passos depois dos quais o IR ou o assembly é listado
+    bool sccp_stats;    // Informa o que a propagação de constantes removeu
+    long eval_budget;   // Limite de instruções do passo eval (0 = padrão)
+    bool eval_stats;    // Informa o que a avaliação parcial fez
+    bool profile_generate;      // Conta cada if/while e escreve o perfil na saída de erro no fim
+    const char *profile_use;    // Perfil lido para o layout e a escolha dos registradores
+    bool cycle_counters;        // Mede comandos e if/while com rdcycle/rdinstret; resumo no fim
+    bool dump_ir;       // Lista o IR em SSA na saída de erro
+    bool buffered_output;   // Prints via rotinas com buffer (uma chamada write por bloco)
+    bool buffered_input;    // scanf via rotinas que leem a entrada em blocos
+} GenOptions;
+
+int parse_gen_option(const char *arg, GenOptions *options);
+void describe_gen_options(const GenOptions *options, char *buffer, size_t size);
+const char* gen_output_extension(const GenOptions *options);
+
+// Gera o código do texto do sintático; os erros do programa saem em
+// diagnostics e fazem a função devolver 1
+int generate_riscv_stream(FILE *input, FILE *output, FILE *diagnostics, const GenOptions *options);
+int compile_file(const char *input_path, const char *output_path, const char *listing_path,
+                 const GenOptions *options);
+char* default_output_path(const char *input_path, const char *extension);
+int read_batch_list(const char *list_path, const char *extension, BatchJob **out_jobs);
+int run_batch(const char *list_path, const char *extension, int worker_count, BatchFunction compile);
+
+#endif
@@ -0,0 +1,790 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include "riscv_ir.h"
+
+static void* ir_alloc(void *pointer, size_t size) {
+    pointer = realloc(pointer, size ? size : 1);
+    if (!pointer) {
+        fprintf(stderr, "Erro: memória insuficiente para a representação intermediária\n");
+        exit(1);
+    }
+    return pointer;
+}
+
+// Garante espaço para mais um elemento num vetor que cresce em dobro
+static void* ir_reserve(void *array, int count, int *capacity, size_t element) {
+    if (count < *capacity) return array;
+    *capacity = *capacity ? *capacity * 2 : 16;
+    return ir_alloc(array, *capacity * element);
+}
+
+void ir_init(IrFunction *fn) {
+    memset(fn, 0, sizeof(IrFunction));
+}
+
+void ir_free(IrFunction *fn) {
+    for (int b = 0; b < fn->block_count; b++) {
+        IrBlock *block = &fn->blocks[b];
+        for (int i = 0; i < block->inst_count; i++) {
+            free(block->insts[i].phi_args);
+            free(block->insts[i].note);
+        }
+        free(block->insts);
+        free(block->preds);
+        free(block->label);
+    }
+    free(fn->blocks);
+    free(fn->layout);
+    free(fn->values);
+    free(fn->pending_note);
+    memset(fn, 0, sizeof(IrFunction));
+}
+
+int ir_new_block(IrFunction *fn, const char *label) {
+    int capacity = fn->block_capacity;
+    fn->blocks = ir_reserve(fn->blocks, fn->block_count, &fn->block_capacity, sizeof(IrBlock));
+    if (fn->block_capacity != capacity) {
+        fn->layout = ir_alloc(fn->layout, fn->block_capacity * sizeof(int));
+    }
+
+    int id = fn->block_count++;
+    IrBlock *block = &fn->blocks[id];
+    memset(block, 0, sizeof(IrBlock));
+    block->idom = -1;
+    if (label) {
+        block->label = strdup(label);
+    } else {
+        char name[32];
+        snprintf(name, sizeof(name), "L_bb_%d", id);
+        block->label = strdup(name);
+    }
+    return id;
+}
+
+void ir_place_block(IrFunction *fn, int block) {
+    fn->layout[fn->layout_count++] = block;
+}
+
+static void reverse_layout(IrFunction *fn, int first, int end) {
+    for (end--; first < end; first++, end--) {
+        int swap = fn->layout[first];
+        fn->layout[first] = fn->layout[end];
+        fn->layout[end] = swap;
+    }
+}
+
+void ir_rotate_layout(IrFunction *fn, int first, int middle, int end) {
+    reverse_layout(fn, first, middle);
+    reverse_layout(fn, middle, end);
+    reverse_layout(fn, first, end);
+}
+
+// O comentário vale para a próxima instrução acrescentada; comentários
+// seguidos sem instrução entre eles ficam juntos, um por linha
+void ir_set_note(IrFunction *fn, const char *format, ...) {
+    char text[256];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+
+    if (!fn->pending_note) {
+        fn->pending_note = strdup(text);
+        return;
+    }
+    size_t length = strlen(fn->pending_note);
+    fn->pending_note = ir_alloc(fn->pending_note, length + strlen(text) + 2);
+    fn->pending_note[length] = '\n';
+    strcpy(fn->pending_note + length + 1, text);
+}
+
+static int new_value(IrFunction *fn, IrType type, int block, int index) {
+    fn->values = ir_reserve(fn->values, fn->value_count, &fn->value_capacity, sizeof(IrValue));
+    IrValue *value = &fn->values[fn->value_count];
+    value->block = block;
+    value->index = index;
+    value->type = type;
+    return fn->value_count++;
+}
+
+static IrInst* add_inst(IrFunction *fn, int block_id, IrOpcode opcode, IrType type, bool defines) {
+    IrBlock *block = &fn->blocks[block_id];
+    block->insts = ir_reserve(block->insts, block->inst_count, &block->inst_capacity, sizeof(IrInst));
+    int index = block->inst_count++;
+
+    IrInst *inst = &block->insts[index];
+    memset(inst, 0, sizeof(IrInst));
+    inst->opcode = opcode;
+    inst->type = type;
+    inst->dest = defines ? new_value(fn, type, block_id, index) : -1;
+    inst->args[0] = inst->args[1] = -1;
+    inst->var = -1;
+    inst->note = fn->pending_note;
+    fn->pending_note = NULL;
+    return inst;
+}
+
+int ir_const(IrFunction *fn, int block, IrType type, int64_t imm) {
+    IrInst *inst = add_inst(fn, block, IR_CONST, type, true);
+    inst->imm = imm;
+    return inst->dest;
+}
+
+int ir_load(IrFunction *fn, int block, IrType type, int var) {
+    IrInst *inst = add_inst(fn, block, IR_LOAD, type, true);
+    inst->var = var;
+    return inst->dest;
+}
+
+void ir_store(IrFunction *fn, int block, int var, int value) {
+    IrInst *inst = add_inst(fn, block, IR_STORE, fn->values[value].type, false);
+    inst->var = var;
+    inst->args[0] = value;
+}
+
+int ir_read(IrFunction *fn, int block, IrType type) {
+    return add_inst(fn, block, IR_READ, type, true)->dest;
+}
+
+bool ir_is_compare(char op) {
+    return op == '=' || op == '!' || op == '<' || op == '>' || op == 'L' || op == 'G';
+}
+
+// Os operandos já chegam com o mesmo tipo; comparações dão um inteiro
+int ir_binary(IrFunction *fn, int block, char op, int left, int right) {
+    IrType type = ir_is_compare(op) ? IR_INT : fn->values[left].type;
+    IrInst *inst = add_inst(fn, block, IR_BINARY, type, true);
+    inst->op = op;
+    inst->args[0] = left;
+    inst->args[1] = right;
+    return inst->dest;
+}
+
+int ir_convert(IrFunction *fn, int block, IrType type, int value) {
+    IrInst *inst = add_inst(fn, block, IR_CONVERT, type, true);
+    inst->args[0] = value;
+    return inst->dest;
+}
+
+void ir_print_value(IrFunction *fn, int block, int value, char format) {
+    IrInst *inst = add_inst(fn, block, IR_PRINT, fn->values[value].type, false);
+    inst->op = format;
+    inst->args[0] = value;
+}
+
+void ir_print_string(IrFunction *fn, int block, int label) {
+    IrInst *inst = add_inst(fn, block, IR_PRINT_STRING, IR_INT, false);
+    inst->imm = label;
+}
+
+void ir_count(IrFunction *fn, int block, int counter) {
+    IrInst *inst = add_inst(fn, block, IR_COUNT, IR_INT, false);
+    inst->imm = counter;
+}
+
+void ir_cycles(IrFunction *fn, int block, int region, char edge) {
+    IrInst *inst = add_inst(fn, block, IR_CYCLES, IR_INT, false);
+    inst->op = edge;
+    inst->imm = region;
+}
+
+void ir_branch(IrFunction *fn, int block, char op, int left, int right, int if_true, int if_false) {
+    IrInst *inst = add_inst(fn, block, IR_BRANCH, fn->values[left].type, false);
+    inst->op = op;
+    inst->args[0] = left;
+    inst->args[1] = right;
+    fn->blocks[block].succ[0] = if_true;
+    fn->blocks[block].succ[1] = if_false;
+    fn->blocks[block].succ_count = 2;
+}
+
+void ir_jump(IrFunction *fn, int block, int target) {
+    add_inst(fn, block, IR_JUMP, IR_INT, false);
+    fn->blocks[block].succ[0] = target;
+    fn->blocks[block].succ_count = 1;
+}
+
+void ir_exit(IrFunction *fn, int block) {
+    add_inst(fn, block, IR_EXIT, IR_INT, false);
+    fn->blocks[block].succ_count = 0;
+}
+
+bool ir_terminated(const IrFunction *fn, int block) {
+    const IrBlock *b = &fn->blocks[block];
+    if (b->inst_count == 0) return false;
+    IrOpcode last = b->insts[b->inst_count - 1].opcode;
+    return last == IR_BRANCH || last == IR_JUMP || last == IR_EXIT;
+}
+
+IrInst* ir_value_def(const IrFunction *fn, int value) {
+    const IrValue *v = &fn->values[value];
+    if (v->block < 0) return NULL;
+    return &fn->blocks[v->block].insts[v->index];
+}
+
+void ir_index_values(IrFunction *fn) {
+    for (int v = 0; v < fn->value_count; v++) {
+        fn->values[v].block = -1;
+        fn->values[v].index = -1;
+    }
+    for (int b = 0; b < fn->block_count; b++) {
+        for (int i = 0; i < fn->blocks[b].inst_count; i++) {
+            int dest = fn->blocks[b].insts[i].dest;
+            if (dest >= 0) {
+                fn->values[dest].block = b;
+                fn->values[dest].index = i;
+            }
+        }
+    }
+}
+
+// Predecessores a partir dos sucessores e blocos alcançáveis a partir da
+// entrada (bloco 0). Depois do SSA os predecessores não são recalculados:
+// a ordem deles é a dos argumentos dos phi
+void ir_compute_cfg(IrFunction *fn) {
+    for (int b = 0; b < fn->block_count; b++) {
+        fn->blocks[b].pred_count = 0;
+        fn->blocks[b].reachable = false;
+    }
+    int *counts = calloc(fn->block_count ? fn->block_count : 1, sizeof(int));
+    for (int b = 0; b < fn->block_count; b++) {
+        for (int k = 0; k < fn->blocks[b].succ_count; k++) {
+            counts[fn->blocks[b].succ[k]]++;
+        }
+    }
+    for (int b = 0; b < fn->block_count; b++) {
+        fn->blocks[b].preds = ir_alloc(fn->blocks[b].preds, counts[b] * sizeof(int));
+    }
+    for (int b = 0; b < fn->block_count; b++) {
+        for (int k = 0; k < fn->blocks[b].succ_count; k++) {
+            IrBlock *succ = &fn->blocks[fn->blocks[b].succ[k]];
+            succ->preds[succ->pred_count++] = b;
+        }
+    }
+    free(counts);
+
+    if (fn->block_count == 0) return;
+    int *stack = malloc(fn->block_count * sizeof(int));
+    int top = 0;
+    stack[top++] = 0;
+    fn->blocks[0].reachable = true;
+    while (top > 0) {
+        IrBlock *block = &fn->blocks[stack[--top]];
+        for (int k = 0; k < block->succ_count; k++) {
+            IrBlock *succ = &fn->blocks[block->succ[k]];
+            if (!succ->reachable) {
+                succ->reachable = true;
+                stack[top++] = block->succ[k];
+            }
+        }
+    }
+    free(stack);
+}
+
+// Pós-ordem dos blocos alcançáveis (busca em profundidade sem recursão)
+static int postorder(const IrFunction *fn, int *order) {
+    int n = fn->block_count;
+    int *next_succ = calloc(n, sizeof(int));
+    bool *seen = calloc(n, sizeof(bool));
+    int *stack = malloc(n * sizeof(int));
+    int top = 0, count = 0;
+
+    stack[top++] = fn->entry;
+    seen[fn->entry] = true;
+    while (top > 0) {
+        int b = stack[top - 1];
+        const IrBlock *block = &fn->blocks[b];
+        if (next_succ[b] < block->succ_count) {
+            int s = block->succ[next_succ[b]++];
+            if (!seen[s]) {
+                seen[s] = true;
+                stack[top++] = s;
+            }
+        } else {
+            order[count++] = b;
+            top--;
+        }
+    }
+    free(next_succ);
+    free(seen);
+    free(stack);
+    return count;
+}
+
+// Dominadores pelo algoritmo iterativo de Cooper, Harvey e Kennedy, sobre
+// a pós-ordem reversa
+void ir_compute_dominators(IrFunction *fn) {
+    int n = fn->block_count;
+    if (n == 0) return;
+    int *order = malloc(n * sizeof(int));
+    int *number = malloc(n * sizeof(int));     // Posição na pós-ordem
+    int count = postorder(fn, order);
+
+    for (int b = 0; b < n; b++) {
+        fn->blocks[b].idom = -1;
+        number[b] = -1;
+    }
+    for (int i = 0; i < count; i++) number[order[i]] = i;
+    fn->blocks[fn->entry].idom = fn->entry;
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int i = count - 2; i >= 0; i--) {      // A entrada é a última
+            int b = order[i];
+            const IrBlock *block = &fn->blocks[b];
+            int new_idom = -1;
+            for (int p = 0; p < block->pred_count; p++) {
+                int pred = block->preds[p];
+                if (number[pred] < 0 || fn->blocks[pred].idom < 0) continue;
+                if (new_idom < 0) {
+                    new_idom = pred;
+                    continue;
+                }
+                int x = pred, y = new_idom;
+                while (x != y) {
+                    while (number[x] < number[y]) x = fn->blocks[x].idom;
+                    while (number[y] < number[x]) y = fn->blocks[y].idom;
+                }
+                new_idom = x;
+            }
+            if (new_idom >= 0 && fn->blocks[b].idom != new_idom) {
+                fn->blocks[b].idom = new_idom;
+                changed = true;
+            }
+        }
+    }
+    fn->blocks[fn->entry].idom = -1;
+    free(order);
+    free(number);
+}
+
+typedef struct {
+    int *items;
+    int count;
+    int capacity;
+} IntList;
+
+static void list_add(IntList *list, int item) {
+    list->items = ir_reserve(list->items, list->count, &list->capacity, sizeof(int));
+    list->items[list->count++] = item;
+}
+
+static void insert_phi(IrFunction *fn, int block_id, int var, IrType type) {
+    IrBlock *block = &fn->blocks[block_id];
+    block->insts = ir_reserve(block->insts, block->inst_count, &block->inst_capacity, sizeof(IrInst));
+    memmove(&block->insts[1], &block->insts[0], block->inst_count * sizeof(IrInst));
+    block->inst_count++;
+
+    IrInst *phi = &block->insts[0];
+    memset(phi, 0, sizeof(IrInst));
+    phi->opcode = IR_PHI;
+    phi->type = type;
+    phi->var = var;
+    phi->args[0] = phi->args[1] = -1;
+    phi->dest = new_value(fn, type, block_id, 0);
+    phi->phi_args = malloc((block->pred_count ? block->pred_count : 1) * sizeof(int));
+    for (int p = 0; p < block->pred_count; p++) phi->phi_args[p] = -1;
+}
+
+// Construção do SSA (Cytron et al.): phi nas fronteiras de dominância
+// iteradas das definições de cada variável e renomeação percorrendo a
+// árvore de dominadores
+void ir_build_ssa(IrFunction *fn, const IrType *var_types, int var_count) {
+    int n = fn->block_count;
+    if (n == 0) return;
+    ir_compute_cfg(fn);
+    ir_compute_dominators(fn);
+
+    // Fronteiras de dominância
+    IntList *frontier = calloc(n, sizeof(IntList));
+    for (int b = 1; b < n; b++) {
+        const IrBlock *block = &fn->blocks[b];
+        if (!block->reachable || block->pred_count < 2) continue;
+        for (int p = 0; p < block->pred_count; p++) {
+            int runner = block->preds[p];
+            if (!fn->blocks[runner].reachable) continue;
+            while (runner >= 0 && runner != block->idom) {
+                IntList *list = &frontier[runner];
+                if (list->count == 0 || list->items[list->count - 1] != b) list_add(list, b);
+                runner = fn->blocks[runner].idom;
+            }
+        }
+    }
+
+    // Blocos que atribuem cada variável
+    IntList *defs = calloc(var_count ? var_count : 1, sizeof(IntList));
+    for (int b = 0; b < n; b++) {
+        if (!fn->blocks[b].reachable) continue;
+        for (int i = 0; i < fn->blocks[b].inst_count; i++) {
+            const IrInst *inst = &fn->blocks[b].insts[i];
+            if (inst->opcode != IR_STORE) continue;
+            IntList *list = &defs[inst->var];
+            if (list->count == 0 || list->items[list->count - 1] != b) list_add(list, b);
+        }
+    }
+
+    // Inserção dos phi (as marcas evitam limpar os vetores a cada variável)
+    int *has_phi = malloc(n * sizeof(int));
+    int *on_work = malloc(n * sizeof(int));
+    int *work = malloc(n * sizeof(int));
+    for (int b = 0; b < n; b++) has_phi[b] = on_work[b] = -1;
+    for (int v = 0; v < var_count; v++) {
+        int top = 0;
+        for (int i = 0; i < defs[v].count; i++) {
+            if (on_work[defs[v].items[i]] == v) continue;
+            on_work[defs[v].items[i]] = v;
+            work[top++] = defs[v].items[i];
+        }
+        while (top > 0) {
+            int x = work[--top];
+            for (int i = 0; i < frontier[x].count; i++) {
+                int y = frontier[x].items[i];
+                if (has_phi[y] == v) continue;
+                has_phi[y] = v;
+                insert_phi(fn, y, v, var_types[v]);
+                if (on_work[y] != v) {
+                    on_work[y] = v;
+                    work[top++] = y;
+                }
+            }
+        }
+        free(defs[v].items);
+    }
+    for (int b = 0; b < n; b++) free(frontier[b].items);
+    free(frontier);
+    free(defs);
+    free(has_phi);
+    free(on_work);
+    free(work);
+
+    // Filhos de cada bloco na árvore de dominadores
+    IntList *children = calloc(n, sizeof(IntList));
+    for (int b = 1; b < n; b++) {
+        if (fn->blocks[b].reachable && fn->blocks[b].idom >= 0) list_add(&children[fn->blocks[b].idom], b);
+    }
+
+    // Renomeação: uma pilha de definições por variável e um registro das
+    // definições empilhadas, desfeito ao sair de cada bloco
+    IntList *current = calloc(var_count ? var_count : 1, sizeof(IntList));
+    IntList pushed = { 0 };
+    int *stack = malloc(n * sizeof(int));
+    int *next_child = calloc(n, sizeof(int));
+    int *mark = malloc(n * sizeof(int));
+    int top = 0;
+
+    stack[top++] = 0;
+    mark[0] = -1;
+    while (top > 0) {
+        int b = stack[top - 1];
+        IrBlock *block = &fn->blocks[b];
+
+        if (mark[b] < 0) {
+            mark[b] = pushed.count;
+            for (int i = 0; i < block->inst_count; i++) {
+                IrInst *inst = &block->insts[i];
+                IntList *defs_of_var = inst->var >= 0 ? &current[inst->var] : NULL;
+                if (inst->opcode == IR_PHI) {
+                    list_add(defs_of_var, inst->dest);
+                    list_add(&pushed, inst->var);
+                } else if (inst->opcode == IR_LOAD) {
+                    inst->args[0] = defs_of_var->count ? defs_of_var->items[defs_of_var->count - 1] : -1;
+                } else if (inst->opcode == IR_STORE) {
+                    list_add(defs_of_var, inst->args[0]);
+                    list_add(&pushed, inst->var);
+                }
+            }
+            for (int k = 0; k < block->succ_count; k++) {
+                IrBlock *succ = &fn->blocks[block->succ[k]];
+                for (int p = 0; p < succ->pred_count; p++) {
+                    if (succ->preds[p] != b) continue;
+                    for (int i = 0; i < succ->inst_count && succ->insts[i].opcode == IR_PHI; i++) {
+                        IntList *defs_of_var = &current[succ->insts[i].var];
+                        succ->insts[i].phi_args[p] = defs_of_var->count ? defs_of_var->items[defs_of_var->count - 1] : -1;
+                    }
+                }
+            }
+        }
+
+        if (next_child[b] < children[b].count) {
+            int child = children[b].items[next_child[b]++];
+            mark[child] = -1;
+            stack[top++] = child;
+            continue;
+        }
+
+        while (pushed.count > mark[b]) {
+            current[pushed.items[--pushed.count]].count--;
+        }
+        top--;
+    }
+
+    for (int v = 0; v < var_count; v++) free(current[v].items);
+    for (int b = 0; b < n; b++) free(children[b].items);
+    free(current);
+    free(children);
+    free(pushed.items);
+    free(stack);
+    free(next_child);
+    free(mark);
+
+    fn->ssa = true;
+    ir_index_values(fn);
+}
+
+// Retira a aresta from -> to dos predecessores de "to" e dos phi dele
+void ir_remove_edge(IrFunction *fn, int from, int to) {
+    IrBlock *block = &fn->blocks[to];
+    for (int p = 0; p < block->pred_count; p++) {
+        if (block->preds[p] != from) continue;
+        for (int i = 0; i < block->inst_count; i++) {
+            IrInst *inst = &block->insts[i];
+            if (inst->opcode != IR_PHI) continue;
+            memmove(&inst->phi_args[p], &inst->phi_args[p + 1], (block->pred_count - p - 1) * sizeof(int));
+        }
+        memmove(&block->preds[p], &block->preds[p + 1], (block->pred_count - p - 1) * sizeof(int));
+        block->pred_count--;
+        return;
+    }
+}
+
+int ir_split_block(IrFunction *fn, int block, int index) {
+    char label[64];
+    snprintf(label, sizeof(label), "%s_cont", fn->blocks[block].label);
+    int tail = ir_new_block(fn, label);
+    IrBlock *head = &fn->blocks[block];
+    IrBlock *rest = &fn->blocks[tail];
+
+    rest->inst_count = rest->inst_capacity = head->inst_count - index;
+    rest->insts = ir_alloc(NULL, rest->inst_count * sizeof(IrInst));
+    memcpy(rest->insts, head->insts + index, rest->inst_count * sizeof(IrInst));
+    head->inst_count = index;
+
+    // Os sucessores passam para a segunda parte, que toma o lugar da
+    // primeira nos predecessores deles (a ordem dos phi não muda)
+    rest->succ[0] = head->succ[0];
+    rest->succ[1] = head->succ[1];
+    rest->succ_count = head->succ_count;
+    for (int k = 0; k < rest->succ_count; k++) {
+        IrBlock *succ = &fn->blocks[rest->succ[k]];
+        for (int p = 0; p < succ->pred_count; p++) {
+            if (succ->preds[p] == block) succ->preds[p] = tail;
+        }
+    }
+    rest->preds = ir_alloc(NULL, sizeof(int));
+    rest->preds[0] = block;
+    rest->pred_count = 1;
+    rest->idom = block;
+    rest->reachable = head->reachable;
+    ir_jump(fn, block, tail);
+
+    for (int l = 0; l < fn->layout_count; l++) {
+        if (fn->layout[l] != block) continue;
+        ir_place_block(fn, tail);
+        ir_rotate_layout(fn, l + 1, fn->layout_count - 1, fn->layout_count);
+        break;
+    }
+    ir_index_values(fn);
+    return tail;
+}
+
+void ir_replace_entry(IrFunction *fn, int entry) {
+    bool placed = false;
+    for (int l = 0; l < fn->layout_count && !placed; l++) {
+        if (fn->layout[l] != entry) continue;
+        ir_rotate_layout(fn, 0, l, l + 1);
+        placed = true;
+    }
+    if (!placed) {
+        ir_place_block(fn, entry);
+        ir_rotate_layout(fn, 0, fn->layout_count - 1, fn->layout_count);
+    }
+
+    // A nova aresta chega aos phi do destino com o valor que está na pilha
+    IrBlock *start = &fn->blocks[entry];
+    for (int k = 0; k < start->succ_count; k++) {
+        IrBlock *succ = &fn->blocks[start->succ[k]];
+        succ->preds = ir_alloc(succ->preds, (succ->pred_count + 1) * sizeof(int));
+        for (int i = 0; i < succ->inst_count; i++) {
+            IrInst *inst = &succ->insts[i];
+            if (inst->opcode != IR_PHI) continue;
+            inst->phi_args = ir_alloc(inst->phi_args, (succ->pred_count + 1) * sizeof(int));
+            inst->phi_args[succ->pred_count] = -1;
+        }
+        succ->preds[succ->pred_count++] = entry;
+    }
+
+    bool *was_reachable = ir_alloc(NULL, fn->block_count * sizeof(bool));
+    int *stack = ir_alloc(NULL, fn->block_count * sizeof(int));
+    for (int b = 0; b < fn->block_count; b++) {
+        was_reachable[b] = fn->blocks[b].reachable;
+        fn->blocks[b].reachable = false;
+    }
+    int top = 0;
+    stack[top++] = entry;
+    start->reachable = true;
+    while (top > 0) {
+        IrBlock *block = &fn->blocks[stack[--top]];
+        for (int k = 0; k < block->succ_count; k++) {
+            IrBlock *succ = &fn->blocks[block->succ[k]];
+            if (!succ->reachable) {
+                succ->reachable = true;
+                stack[top++] = block->succ[k];
+            }
+        }
+    }
+    for (int b = 0; b < fn->block_count; b++) {
+        if (!was_reachable[b] || fn->blocks[b].reachable) continue;
+        for (int k = 0; k < fn->blocks[b].succ_count; k++) {
+            ir_remove_edge(fn, b, fn->blocks[b].succ[k]);
+        }
+    }
+    free(was_reachable);
+    free(stack);
+    fn->entry = entry;
+    ir_compute_dominators(fn);
+    ir_index_values(fn);
+}
+
+// Instruções que podem gerar código: phi e constantes não contam
+int ir_instruction_count(const IrFunction *fn) {
+    int count = 0;
+    for (int b = 0; b < fn->block_count; b++) {
+        if (!fn->blocks[b].reachable) continue;
+        for (int i = 0; i < fn->blocks[b].inst_count; i++) {
+            IrOpcode opcode = fn->blocks[b].insts[i].opcode;
+            if (opcode != IR_PHI && opcode != IR_CONST) count++;
+        }
+    }
+    return count;
+}
+
+static const char* op_text(char op) {
+    switch (op) {
+        case '=': return "==";
+        case '!': return "!=";
+        case 'L': return "<=";
+        case 'G': return ">=";
+        case '+': return "+";
+        case '-': return "-";
+        case '*': return "*";
+        case '/': return "/";
+        case '%': return "%";
+        case '&': return "&";
+        case '|': return "|";
+        case '^': return "^";
+        case '<': return "<";
+        case '>': return ">";
+        default: return "?";
+    }
+}
+
+static void dump_value(FILE *output, int value) {
+    if (value < 0) {
+        fprintf(output, "inicial");
+    } else {
+        fprintf(output, "v%d", value);
+    }
+}
+
+static void dump_var(FILE *output, const char *const *var_names, int var) {
+    if (var_names) {
+        fprintf(output, "%s", var_names[var]);
+    } else {
+        fprintf(output, "var%d", var);
+    }
+}
+
+// Listagem legível do IR, na ordem do layout
+void ir_dump(const IrFunction *fn, const char *const *var_names, FILE *output) {
+    for (int l = 0; l < fn->layout_count; l++) {
+        int b = fn->layout[l];
+        const IrBlock *block = &fn->blocks[b];
+        if (!block->reachable) continue;
+
+        fprintf(output, "%s:", block->label);
+        if (block->pred_count > 0) {
+            fprintf(output, "  ; preds");
+            for (int p = 0; p < block->pred_count; p++) {
+                fprintf(output, " %s", fn->blocks[block->preds[p]].label);
+            }
+        }
+        if (block->idom >= 0) fprintf(output, "; idom %s", fn->blocks[block->idom].label);
+        fprintf(output, "\n");
+
+        for (int i = 0; i < block->inst_count; i++) {
+            const IrInst *inst = &block->insts[i];
+            const char *type = inst->type == IR_FLOAT ? "float" : inst->type == IR_LONG ? "long" : "int";
+            fprintf(output, "    ");
+            if (inst->dest >= 0) fprintf(output, "v%d:%s = ", inst->dest, type);
+            switch (inst->opcode) {
+                case IR_CONST:
+                    if (inst->type == IR_FLOAT) {
+                        int32_t bits = (int32_t)inst->imm;
+                        float value;
+                        memcpy(&value, &bits, sizeof(value));
+                        fprintf(output, "const %g", value);
+                    } else {
+                        fprintf(output, "const %lld", (long long)inst->imm);
+                    }
+                    break;
+                case IR_LOAD:
+                    fprintf(output, "load ");
+                    dump_var(output, var_names, inst->var);
+                    if (fn->ssa) {
+                        fprintf(output, " [");
+                        dump_value(output, inst->args[0]);
+                        fprintf(output, "]");
+                    }
+                    break;
+                case IR_STORE:
+                    fprintf(output, "store ");
+                    dump_var(output, var_names, inst->var);
+                    fprintf(output, ", v%d", inst->args[0]);
+                    break;
+                case IR_READ:
+                    fprintf(output, "read");
+                    break;
+                case IR_BINARY:
+                    fprintf(output, "v%d %s v%d", inst->args[0], op_text(inst->op), inst->args[1]);
+                    break;
+                case IR_CONVERT:
+                    fprintf(output, "convert v%d", inst->args[0]);
+                    break;
+                case IR_PHI:
+                    fprintf(output, "phi ");
+                    dump_var(output, var_names, inst->var);
+                    for (int p = 0; p < block->pred_count; p++) {
+                        fprintf(output, p == 0 ? " " : ", ");
+                        dump_value(output, inst->phi_args[p]);
+                    }
+                    break;
+                case IR_PRINT:
+                    fprintf(output, "print %%%c v%d", inst->op, inst->args[0]);
+                    break;
+                case IR_PRINT_STRING:
+                    fprintf(output, "print str_%d", (int)inst->imm);
+                    break;
+                case IR_COUNT:
+                    fprintf(output, "count %d", (int)inst->imm);
+                    break;
+                case IR_CYCLES:
+                    fprintf(output, "cycles %s %d", inst->op == 's' ? "start" : "end", (int)inst->imm);
+                    break;
+                case IR_BRANCH:
+                    fprintf(output, "branch v%d %s v%d, %s, %s", inst->args[0], op_text(inst->op), inst->args[1],
+                            fn->blocks[block->succ[0]].label, fn->blocks[block->succ[1]].label);
+                    break;
+                case IR_JUMP:
+                    fprintf(output, "jump %s", fn->blocks[block->succ[0]].label);
+                    break;
+                case IR_EXIT:
+                    fprintf(output, "exit");
+                    break;
+            }
+            fprintf(output, "\n");
+        }
+    }
+}
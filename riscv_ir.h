@@ -0,0 +1,193 @@
+#ifndef RISCV_IR_H
+#define RISCV_IR_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Representação intermediária do gerador: grafo de fluxo de controle com
+// blocos básicos de instruções de três endereços. Depois de ir_build_ssa,
+// cada valor tem uma única definição e as junções têm nós phi.
+//
+// As variáveis continuam com o seu lugar na pilha: um IR_LOAD é uma cópia
+// da definição que chega até ele (args[0], preenchido no SSA) e todas as
+// versões de uma variável ocupam o mesmo lugar, então os phi não geram
+// código. Os passes só trocam usos por constantes e removem caminhos, o que
+// mantém essa propriedade.
+
+// IR_LONG só aparece em alvos de 64 bits (--target=rv64); no RV32 o long
+// continua com 32 bits, como IR_INT
+typedef enum {
+    IR_INT,
+    IR_FLOAT,
+    IR_LONG
+} IrType;
+
+typedef enum {
+    IR_CONST,           // dest = imm (int: 32 bits com sinal; float: padrão de bits IEEE-754)
+    IR_LOAD,            // dest = var; args[0] é a definição que chega (-1 = valor inicial)
+    IR_STORE,           // var = args[0]
+    IR_READ,            // dest = valor lido da entrada (scanf)
+    IR_BINARY,          // dest = args[0] op args[1]
+    IR_CONVERT,         // dest = args[0] convertido para o tipo de dest
+    IR_PHI,             // dest = phi de var; phi_args[i] vem de preds[i]
+    IR_PRINT,           // Imprime args[0]; op: 'd' (int), 'f' (float) ou 'c' (caractere)
+    IR_PRINT_STRING,    // Imprime a string de rótulo str_<imm>
+    IR_COUNT,           // Soma 1 ao contador <imm> do perfil (--profile-generate)
+    IR_CYCLES,          // Entrada (op 's') ou saída (op 'e') da região <imm> medida com rdcycle
+    IR_BRANCH,          // args[0] op args[1] ? succ[0] : succ[1]
+    IR_JUMP,            // succ[0]
+    IR_EXIT
+} IrOpcode;
+
+// Operadores (campo op): + - * / % & | ^ e as comparações
+// '=' (==), '!' (!=), '<', '>', 'L' (<=) e 'G' (>=)
+
+typedef struct {
+    IrOpcode opcode;
+    IrType type;        // Tipo do resultado; no desvio e no print, dos operandos
+    char op;
+    int dest;           // Valor definido (-1 = nenhum)
+    int args[2];        // Valores usados (-1 = nenhum)
+    int *phi_args;
+    int var;            // Variável (índice na tabela do gerador)
+    int64_t imm;
+    char *note;         // Comentário emitido antes do código da instrução
+} IrInst;
+
+typedef struct {
+    IrInst *insts;
+    int inst_count;
+    int inst_capacity;
+    int succ[2];
+    int succ_count;
+    int *preds;
+    int pred_count;
+    int idom;           // Dominador imediato (-1 na entrada e nos inalcançáveis)
+    bool reachable;
+    char *label;        // Rótulo no assembly
+} IrBlock;
+
+typedef struct {
+    int block;          // Bloco e posição da instrução que define o valor
+    int index;
+    IrType type;
+} IrValue;
+
+typedef struct {
+    IrBlock *blocks;
+    int block_count;
+    int block_capacity;
+    int entry;          // Bloco de entrada (0, a não ser depois da avaliação parcial)
+    int *layout;        // Ordem dos blocos no código final
+    int layout_count;
+    IrValue *values;
+    int value_count;
+    int value_capacity;
+    char *pending_note;
+    bool ssa;
+} IrFunction;
+
+void ir_init(IrFunction *fn);
+void ir_free(IrFunction *fn);
+
+// Construção: as instruções são acrescentadas ao fim do bloco indicado e as
+// que definem um valor devolvem o seu número
+int ir_new_block(IrFunction *fn, const char *label);
+void ir_place_block(IrFunction *fn, int block);     // Acrescenta o bloco ao layout
+void ir_set_note(IrFunction *fn, const char *format, ...);
+int ir_const(IrFunction *fn, int block, IrType type, int64_t imm);
+int ir_load(IrFunction *fn, int block, IrType type, int var);
+void ir_store(IrFunction *fn, int block, int var, int value);
+int ir_read(IrFunction *fn, int block, IrType type);
+int ir_binary(IrFunction *fn, int block, char op, int left, int right);
+int ir_convert(IrFunction *fn, int block, IrType type, int value);
+void ir_print_value(IrFunction *fn, int block, int value, char format);
+void ir_print_string(IrFunction *fn, int block, int label);
+void ir_count(IrFunction *fn, int block, int counter);
+void ir_cycles(IrFunction *fn, int block, int region, char edge);
+void ir_branch(IrFunction *fn, int block, char op, int left, int right, int if_true, int if_false);
+void ir_jump(IrFunction *fn, int block, int target);
+void ir_exit(IrFunction *fn, int block);
+bool ir_terminated(const IrFunction *fn, int block);
+
+// Troca de lugar, no layout, os trechos [first, middle) e [middle, end)
+void ir_rotate_layout(IrFunction *fn, int first, int middle, int end);
+
+// Análises e transformações
+void ir_compute_cfg(IrFunction *fn);            // Predecessores e alcançabilidade (antes do SSA)
+void ir_compute_dominators(IrFunction *fn);
+void ir_build_ssa(IrFunction *fn, const IrType *var_types, int var_count);
+void ir_index_values(IrFunction *fn);           // Refaz values[] depois de mudanças
+void ir_remove_edge(IrFunction *fn, int from, int to);
+int ir_instruction_count(const IrFunction *fn);
+
+IrInst* ir_value_def(const IrFunction *fn, int value);
+bool ir_is_compare(char op);
+void ir_dump(const IrFunction *fn, const char *const *var_names, FILE *output);
+
+// Uma variável como fica na pilha: o load de char e short estende o sinal
+// do byte ou da meia palavra gravada, e o SCCP e a avaliação parcial
+// precisam ver o mesmo valor truncado que o código gerado
+typedef struct {
+    IrType type;
+    int size;           // Bytes na pilha (1, 2, 4 ou 8); o load estende o sinal
+} IrEvalVar;
+
+// Propagação de constantes condicional esparsa (Wegman-Zadeck)
+typedef struct {
+    int constants;          // Valores que viraram constantes
+    int branches;           // Desvios com um único lado possível
+    int blocks;             // Blocos que nunca executam, removidos
+    int instructions_before;
+    int instructions_after;
+} SccpStats;
+
+void ir_sccp(IrFunction *fn, const IrEvalVar *vars, int var_count, SccpStats *stats);
+
+// Aritmética das instruções com a semântica do RISC-V (divisão por zero,
+// fcvt.w.s saturado): int em 32 bits com sinal, long em 64 e float como
+// padrão de bits; as comparações dão 0 ou 1
+int64_t ir_fold_binary(IrType type, char op, int64_t a, int64_t b);
+int64_t ir_fold_convert(IrType type, IrType from, int64_t value);  // De "from" para "type"
+int64_t ir_fold_load(const IrEvalVar *var, int64_t value);         // O que o load lê depois do store
+
+// Avaliação parcial: interpreta o programa em tempo de compilação, a partir
+// da entrada, até o fim ou até a primeira leitura (IR_READ). As variáveis
+// são lidas da "pilha" como no código gerado, com o tamanho de cada uma
+
+typedef struct {
+    char op;            // Como no IR_PRINT ('d', 'c', 'f'), ou 's': string str_<value>
+    int64_t value;
+} IrEvalPrint;
+
+typedef enum {
+    EVAL_FINISHED,      // Chegou ao IR_EXIT
+    EVAL_INPUT,         // Parou na primeira leitura da entrada
+    EVAL_BUDGET,        // Passou do limite de instruções
+    EVAL_UNDEFINED      // Leu uma variável que nunca recebeu valor
+} IrEvalStatus;
+
+typedef struct {
+    IrEvalStatus status;
+    long steps;             // Instruções interpretadas
+    int resume_block;       // EVAL_INPUT: a leitura onde o programa continua
+    int resume_index;
+    IrEvalPrint *prints;    // O que foi impresso, na ordem
+    int print_count;
+    int print_capacity;
+    int64_t *var_values;    // Estado final das variáveis
+    bool *var_defined;
+} IrEvalResult;
+
+void ir_evaluate(const IrFunction *fn, const IrEvalVar *vars, int var_count, long budget, IrEvalResult *result);
+void ir_eval_free(IrEvalResult *result);
+
+// Divide o bloco antes da instrução indicada; a segunda parte vai para um
+// bloco novo, logo depois no layout, que é devolvido
+int ir_split_block(IrFunction *fn, int block, int index);
+// Faz de um bloco novo a entrada: ele vai para o início do layout e o que
+// deixa de ser alcançável a partir dele sai do programa
+void ir_replace_entry(IrFunction *fn, int entry);
+
+#endif
@@ -0,0 +1,627 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include "riscv_runtime.h"
+
+// Rotinas de saída com buffer: os prints enchem __rt_out_buf e só há uma
+// chamada de sistema (write) quando ele enche, antes de uma leitura e no fim
+// do programa. Depois de qualquer rotina o buffer nunca fica cheio
+// (__rt_out_len < RUNTIME_OUTPUT_BUFFER_SIZE), então cada uma só precisa
+// garantir espaço para o que vai escrever.
+//
+// __rt_flush só usa t0, a0, a1, a2 e a7: quem chama pode guardar valores em
+// t1-t6 durante a chamada.
+//
+// Na entrada é o contrário: __rt_in_buf recebe blocos inteiros (read) e os
+// números são convertidos a partir dele; só há chamada de sistema quando
+// todos os bytes lidos já foram consumidos (__rt_in_pos == __rt_in_len).
+
+// Maior número de bytes que __rt_print_int escreve ("-2147483648"; no RV64,
+// onde a0 pode ter um long, "-9223372036854775808")
+#define RUNTIME_INT_CHARS 11
+#define RUNTIME_LONG_CHARS 20
+
+static void emit_line(RuntimeEmit emit, void *arg, const char *format, ...) {
+    char line[128];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    emit(arg, line);
+}
+
+// Linha de uma rotina para o alvo: o ra tem XLEN bits, então no RV64 o
+// "sw ra"/"lw ra" das rotinas vira "sd ra"/"ld ra" (sempre em 8(sp))
+static void emit_code_line(RuntimeEmit emit, void *arg, int xlen, const char *format, int argument) {
+    char line[128];
+    snprintf(line, sizeof(line), format, argument);
+    if (xlen == 64 && (strncmp(line, "    sw ra,", 10) == 0 || strncmp(line, "    lw ra,", 10) == 0)) {
+        line[5] = 'd';
+    }
+    emit(arg, line);
+}
+
+static const char *const flush_code[] = {
+    "__rt_flush:\n",
+    "    la t0, __rt_out_len\n",
+    "    lw a2, 0(t0)\n",
+    "    beqz a2, __rt_flush_done\n",
+    "    sw zero, 0(t0)\n",
+    "    li a0, 1\n",                  // stdout
+    "    la a1, __rt_out_buf\n",
+    "    li a7, 64\n",                 // write
+    "    ecall\n",
+    "__rt_flush_done:\n",
+    "    ret\n",
+    NULL
+};
+
+// a0 = caractere; com o buffer cheio, o desvio para __rt_flush volta direto
+// para quem chamou
+static const char *const putc_code[] = {
+    "__rt_putc:\n",
+    "    la t0, __rt_out_len\n",
+    "    lw t1, 0(t0)\n",
+    "    la t2, __rt_out_buf\n",
+    "    add t2, t2, t1\n",
+    "    sb a0, 0(t2)\n",
+    "    addi t1, t1, 1\n",
+    "    sw t1, 0(t0)\n",
+    "    li t2, %d\n",
+    "    beq t1, t2, __rt_flush\n",
+    "    ret\n",
+    NULL
+};
+
+// a0 = endereço da string; quando o buffer enche no meio da cópia, esvazia e
+// recomeça do caractere seguinte
+static const char *const puts_code[] = {
+    "__rt_puts:\n",
+    "    la t0, __rt_out_len\n",
+    "    lw t1, 0(t0)\n",
+    "    la t2, __rt_out_buf\n",
+    "    li t3, %d\n",
+    "__rt_puts_loop:\n",
+    "    lbu t4, 0(a0)\n",
+    "    beqz t4, __rt_puts_done\n",
+    "    add a1, t2, t1\n",
+    "    sb t4, 0(a1)\n",
+    "    addi a0, a0, 1\n",
+    "    addi t1, t1, 1\n",
+    "    bne t1, t3, __rt_puts_loop\n",
+    "    sw t1, 0(t0)\n",
+    "    mv t5, a0\n",
+    "    mv t6, ra\n",
+    "    call __rt_flush\n",
+    "    mv ra, t6\n",
+    "    mv a0, t5\n",
+    "    j __rt_puts\n",
+    "__rt_puts_done:\n",
+    "    sw t1, 0(t0)\n",
+    "    ret\n",
+    NULL
+};
+
+// a0 = inteiro; os dígitos saem de trás para frente numa área da pilha e são
+// copiados depois. O módulo é tratado sem sinal, o que cobre -2147483648.
+// A área tem 32 bytes para caber também um long do RV64
+static const char *const print_int_code[] = {
+    "__rt_print_int:\n",
+    "    la t0, __rt_out_len\n",
+    "    lw t1, 0(t0)\n",
+    "    li t2, %d\n",
+    "    blt t1, t2, __rt_print_int_room\n",
+    "    mv t5, a0\n",
+    "    mv t6, ra\n",
+    "    call __rt_flush\n",
+    "    mv ra, t6\n",
+    "    mv a0, t5\n",
+    "    la t0, __rt_out_len\n",
+    "    li t1, 0\n",
+    "__rt_print_int_room:\n",
+    "    la t2, __rt_out_buf\n",
+    "    add t2, t2, t1\n",
+    "    bgez a0, __rt_print_int_abs\n",
+    "    li t3, 45\n",                 // '-'
+    "    sb t3, 0(t2)\n",
+    "    addi t2, t2, 1\n",
+    "    neg a0, a0\n",
+    "__rt_print_int_abs:\n",
+    "    addi sp, sp, -32\n",
+    "    addi t3, sp, 32\n",
+    "    li a1, 10\n",
+    "__rt_print_int_digit:\n",
+    "    remu t4, a0, a1\n",
+    "    divu a0, a0, a1\n",
+    "    addi t4, t4, 48\n",
+    "    addi t3, t3, -1\n",
+    "    sb t4, 0(t3)\n",
+    "    bnez a0, __rt_print_int_digit\n",
+    "    addi a1, sp, 32\n",
+    "__rt_print_int_copy:\n",
+    "    lbu t4, 0(t3)\n",
+    "    sb t4, 0(t2)\n",
+    "    addi t3, t3, 1\n",
+    "    addi t2, t2, 1\n",
+    "    bne t3, a1, __rt_print_int_copy\n",
+    "    addi sp, sp, 32\n",
+    "    la t3, __rt_out_buf\n",
+    "    sub t1, t2, t3\n",
+    "    sw t1, 0(t0)\n",
+    "    ret\n",
+    NULL
+};
+
+// fa0 = float. O formato é o do print_float do ambiente (a menor
+// representação que volta ao mesmo float, com expoente quando precisa), que
+// não cabe numa rotina curta: o buffer é esvaziado e a chamada de sistema
+// escreve o número, então a saída é a mesma de sem --buffered-output.
+// __rt_flush não mexe nos registradores de ponto flutuante
+static const char *const print_float_code[] = {
+    "__rt_print_float:\n",
+    "    addi sp, sp, -16\n",
+    "    sw ra, 8(sp)\n",
+    "    call __rt_flush\n",
+    "    li a7, 2\n",                  // print_float
+    "    ecall\n",
+    "    lw ra, 8(sp)\n",
+    "    addi sp, sp, 16\n",
+    "    ret\n",
+    NULL
+};
+
+// Enche o buffer de entrada; no fim da entrada (ou erro) ele fica vazio.
+// Devolve a0 = bytes disponíveis e t0 = &__rt_in_pos
+static const char *const in_fill_code[] = {
+    "__rt_in_fill:\n",
+    "    li a0, 0\n",                  // stdin
+    "    la a1, __rt_in_buf\n",
+    "    li a2, %d\n",
+    "    li a7, 63\n",                 // read
+    "    ecall\n",
+    "    la t0, __rt_in_pos\n",
+    "    sw zero, 0(t0)\n",
+    "    bgtz a0, __rt_in_fill_done\n",
+    "    li a0, 0\n",
+    "__rt_in_fill_done:\n",
+    "    sw a0, 4(t0)\n",              // __rt_in_len
+    "    ret\n",
+    NULL
+};
+
+// a0 = próximo caractere (-1 no fim da entrada), sem consumi-lo; devolve
+// também t0 = &__rt_in_pos e t1 = posição, então consumir é só
+// "addi t1, t1, 1" + "sw t1, 0(t0)". Usa t6 para guardar o ra
+static const char *const in_peek_code[] = {
+    "__rt_in_peek:\n",
+    "    la t0, __rt_in_pos\n",
+    "    lw t1, 0(t0)\n",
+    "    lw a1, 4(t0)\n",
+    "    bne t1, a1, __rt_in_peek_ready\n",
+    "    mv t6, ra\n",
+    "    call __rt_in_fill\n",
+    "    mv ra, t6\n",
+    "    beqz a0, __rt_in_peek_end\n",
+    "    li t1, 0\n",
+    "__rt_in_peek_ready:\n",
+    "    la a1, __rt_in_buf\n",
+    "    add a1, a1, t1\n",
+    "    lbu a0, 0(a1)\n",
+    "    ret\n",
+    "__rt_in_peek_end:\n",
+    "    li a0, -1\n",
+    "    ret\n",
+    NULL
+};
+
+// Pula espaços em branco e um sinal, como o scanf; devolve t4 = 1 se o
+// número é negativo e, em a0, o primeiro caractere depois deles (como
+// __rt_in_peek). Usa t2 e t5
+static const char *const in_start_code[] = {
+    "__rt_in_start:\n",
+    "    mv t5, ra\n",
+    "    li t4, 0\n",
+    "__rt_in_start_space:\n",
+    "    call __rt_in_peek\n",
+    "    bltz a0, __rt_in_start_done\n",
+    "    li t2, 32\n",
+    "    bgt a0, t2, __rt_in_start_sign\n",
+    "    addi t1, t1, 1\n",
+    "    sw t1, 0(t0)\n",
+    "    j __rt_in_start_space\n",
+    "__rt_in_start_sign:\n",
+    "    li t2, 45\n",                 // '-'
+    "    bne a0, t2, __rt_in_start_plus\n",
+    "    li t4, 1\n",
+    "    j __rt_in_start_skip\n",
+    "__rt_in_start_plus:\n",
+    "    li t2, 43\n",                 // '+'
+    "    bne a0, t2, __rt_in_start_done\n",
+    "__rt_in_start_skip:\n",
+    "    addi t1, t1, 1\n",
+    "    sw t1, 0(t0)\n",
+    "    call __rt_in_peek\n",
+    "__rt_in_start_done:\n",
+    "    mv ra, t5\n",
+    "    ret\n",
+    NULL
+};
+
+// a0 = inteiro lido; para no primeiro caractere que não é dígito, que fica
+// no buffer para a próxima leitura. Sem dígitos (ou no fim da entrada) dá 0
+static const char *const read_int_code[] = {
+    "__rt_read_int:\n",
+    "    addi sp, sp, -16\n",
+    "    sw ra, 8(sp)\n",
+    "    call __rt_in_start\n",
+    "    li t3, 0\n",
+    "    li t5, 10\n",
+    "__rt_read_int_digit:\n",
+    "    addi t2, a0, -48\n",
+    "    bgeu t2, t5, __rt_read_int_done\n",   // Também pega o -1 do fim
+    "    mul t3, t3, t5\n",
+    "    add t3, t3, t2\n",
+    "    addi t1, t1, 1\n",
+    "    sw t1, 0(t0)\n",
+    "    call __rt_in_peek\n",
+    "    j __rt_read_int_digit\n",
+    "__rt_read_int_done:\n",
+    "    mv a0, t3\n",
+    "    beqz t4, __rt_read_int_return\n",
+    "    neg a0, a0\n",
+    "__rt_read_int_return:\n",
+    "    lw ra, 8(sp)\n",
+    "    addi sp, sp, 16\n",
+    "    ret\n",
+    NULL
+};
+
+// fa0 = float lido, no formato [-+]dígitos[.dígitos][(e|E)[-+]dígitos], como
+// o strtof do read_float. Os primeiros 9 dígitos significativos ficam num
+// inteiro (a3, cabe em 32 bits) e o resto só move a vírgula (a5, expoente
+// decimal); no fim o inteiro vira float uma vez e é multiplicado ou dividido
+// por 10^k em pedaços de até 10^10, que são exatos em float. Quando os
+// dígitos cabem em 24 bits e |k| <= 10, há um só arredondamento e o
+// resultado é o do strtof; fora disso (mais de 8 algarismos, |k| > 10) cada
+// passo arredonda de novo e o valor pode ficar a 1 ulp do strtof.
+// Um 'e' sem dígitos depois é consumido e vale expoente 0. Usa a3-a6 e
+// guarda o sinal do expoente em 0(sp)
+static const char *const read_float_code[] = {
+    "__rt_read_float:\n",
+    "    addi sp, sp, -16\n",
+    "    sw ra, 8(sp)\n",
+    "    call __rt_in_start\n",
+    "    li a3, 0\n",                  // Dígitos significativos
+    "    li a4, 0\n",                  // Quantos
+    "    li a5, 0\n",                  // Expoente decimal
+    "    li a6, 9\n",
+    "    li t3, 0\n",                  // 1 depois do ponto
+    "    li t5, 10\n",
+    "__rt_read_float_digit:\n",
+    "    addi t2, a0, -48\n",
+    "    bgeu t2, t5, __rt_read_float_dot\n",
+    "    bnez a3, __rt_read_float_keep\n",
+    "    beqz t2, __rt_read_float_scale_digit\n",   // Zero à esquerda
+    "__rt_read_float_keep:\n",
+    "    bgeu a4, a6, __rt_read_float_drop\n",
+    "    mul a3, a3, t5\n",
+    "    add a3, a3, t2\n",
+    "    addi a4, a4, 1\n",
+    "__rt_read_float_scale_digit:\n",
+    "    sub a5, a5, t3\n",
+    "    j __rt_read_float_next\n",
+    "__rt_read_float_drop:\n",
+    "    addi a5, a5, 1\n",            // Dígito a mais na parte inteira
+    "    sub a5, a5, t3\n",
+    "    j __rt_read_float_next\n",
+    "__rt_read_float_dot:\n",
+    "    li t2, 46\n",                 // '.'
+    "    bne a0, t2, __rt_read_float_exp\n",
+    "    bnez t3, __rt_read_float_scale\n",
+    "    li t3, 1\n",
+    "__rt_read_float_next:\n",
+    "    addi t1, t1, 1\n",
+    "    sw t1, 0(t0)\n",
+    "    call __rt_in_peek\n",
+    "    j __rt_read_float_digit\n",
+    "__rt_read_float_exp:\n",
+    "    ori t2, a0, 32\n",
+    "    addi t2, t2, -101\n",         // 'e' ou 'E'
+    "    bnez t2, __rt_read_float_scale\n",
+    "    addi t1, t1, 1\n",
+    "    sw t1, 0(t0)\n",
+    "    call __rt_in_peek\n",
+    "    sw zero, 0(sp)\n",
+    "    li t2, 43\n",                 // '+'
+    "    beq a0, t2, __rt_read_float_exp_sign\n",
+    "    li t2, 45\n",                 // '-'
+    "    bne a0, t2, __rt_read_float_exp_start\n",
+    "    li t2, 1\n",
+    "    sw t2, 0(sp)\n",
+    "__rt_read_float_exp_sign:\n",
+    "    addi t1, t1, 1\n",
+    "    sw t1, 0(t0)\n",
+    "    call __rt_in_peek\n",
+    "__rt_read_float_exp_start:\n",
+    "    li a6, 0\n",
+    "    li t3, 100000\n",             // Acima disso o valor já é 0 ou infinito
+    "__rt_read_float_exp_digit:\n",
+    "    addi t2, a0, -48\n",
+    "    bgeu t2, t5, __rt_read_float_exp_done\n",
+    "    bge a6, t3, __rt_read_float_exp_skip\n",
+    "    mul a6, a6, t5\n",
+    "    add a6, a6, t2\n",
+    "__rt_read_float_exp_skip:\n",
+    "    addi t1, t1, 1\n",
+    "    sw t1, 0(t0)\n",
+    "    call __rt_in_peek\n",
+    "    j __rt_read_float_exp_digit\n",
+    "__rt_read_float_exp_done:\n",
+    "    lw t2, 0(sp)\n",
+    "    beqz t2, __rt_read_float_exp_add\n",
+    "    neg a6, a6\n",
+    "__rt_read_float_exp_add:\n",
+    "    add a5, a5, a6\n",
+    "__rt_read_float_scale:\n",
+    "    fcvt.s.w fa0, a3\n",
+    "    fcvt.s.w ft1, t5\n",
+    "    beqz a3, __rt_read_float_sign\n",
+    "__rt_read_float_chunk:\n",
+    "    beqz a5, __rt_read_float_sign\n",
+    "    mv t2, a5\n",                 // k = min(|a5|, 10)
+    "    bgez t2, __rt_read_float_chunk_abs\n",
+    "    neg t2, t2\n",
+    "__rt_read_float_chunk_abs:\n",
+    "    ble t2, t5, __rt_read_float_chunk_power\n",
+    "    mv t2, t5\n",
+    "__rt_read_float_chunk_power:\n",
+    "    li t3, 1\n",
+    "    fcvt.s.w ft2, t3\n",
+    "    mv t3, t2\n",
+    "__rt_read_float_power:\n",
+    "    fmul.s ft2, ft2, ft1\n",
+    "    addi t3, t3, -1\n",
+    "    bnez t3, __rt_read_float_power\n",
+    "    bltz a5, __rt_read_float_divide\n",
+    "    fmul.s fa0, fa0, ft2\n",
+    "    sub a5, a5, t2\n",
+    "    j __rt_read_float_chunk\n",
+    "__rt_read_float_divide:\n",
+    "    fdiv.s fa0, fa0, ft2\n",
+    "    add a5, a5, t2\n",
+    "    j __rt_read_float_chunk\n",
+    "__rt_read_float_sign:\n",
+    "    beqz t4, __rt_read_float_return\n",
+    "    fneg.s fa0, fa0\n",
+    "__rt_read_float_return:\n",
+    "    lw ra, 8(sp)\n",
+    "    addi sp, sp, 16\n",
+    "    ret\n",
+    NULL
+};
+
+// a1 = string terminada em zero, escrita no fd 2. Só usa t3, a0, a2 e a7
+static const char *const err_puts_code[] = {
+    "__rt_err_puts:\n",
+    "    mv a2, a1\n",
+    "__rt_err_puts_length:\n",
+    "    lbu t3, 0(a2)\n",
+    "    addi a2, a2, 1\n",
+    "    bnez t3, __rt_err_puts_length\n",
+    "    addi a2, a2, -1\n",
+    "    sub a2, a2, a1\n",
+    "    li a0, 2\n",                  // stderr
+    "    li a7, 64\n",                 // write
+    "    ecall\n",
+    "    ret\n",
+    NULL
+};
+
+// a0 = parte baixa, a1 = parte alta de um número sem sinal; escreve os
+// dígitos e um espaço no fd 2. Sem divisão de 64 bits no RV32, cada divisão
+// por 10 é feita em pedaços de 16 bits, com o resto levado de um para o
+// outro. Só usa t3-t5, a0-a2 e a7
+static const char *const err_number_code[] = {
+    "__rt_err_number:\n",
+    "    addi sp, sp, -32\n",
+    "    addi a2, sp, 31\n",
+    "    li t3, 32\n",                 // ' '
+    "    sb t3, 0(a2)\n",
+    "    li t3, 10\n",
+    "__rt_err_number_digit:\n",
+    "    remu t4, a1, t3\n",
+    "    divu a1, a1, t3\n",
+    "    slli t4, t4, 16\n",
+    "    srli t5, a0, 16\n",
+    "    or t4, t4, t5\n",
+    "    divu t5, t4, t3\n",
+    "    remu t4, t4, t3\n",
+    "    slli t4, t4, 16\n",
+    "    slli a0, a0, 16\n",
+    "    srli a0, a0, 16\n",
+    "    or t4, t4, a0\n",
+    "    slli t5, t5, 16\n",
+    "    divu a0, t4, t3\n",
+    "    remu t4, t4, t3\n",
+    "    or a0, a0, t5\n",
+    "    addi t4, t4, 48\n",
+    "    addi a2, a2, -1\n",
+    "    sb t4, 0(a2)\n",
+    "    or t4, a0, a1\n",
+    "    bnez t4, __rt_err_number_digit\n",
+    "    mv a1, a2\n",
+    "    addi a2, sp, 32\n",
+    "    sub a2, a2, a1\n",
+    "    li a0, 2\n",
+    "    li a7, 64\n",
+    "    ecall\n",
+    "    addi sp, sp, 32\n",
+    "    ret\n",
+    NULL
+};
+
+// A mesma rotina no RV64: junta a1:a0 num registrador (a parte baixa chega
+// com o sinal estendido do lw) e divide direto
+static const char *const err_number64_code[] = {
+    "__rt_err_number:\n",
+    "    slli a0, a0, 32\n",
+    "    srli a0, a0, 32\n",
+    "    slli a1, a1, 32\n",
+    "    or a0, a0, a1\n",
+    "    addi sp, sp, -32\n",
+    "    addi a2, sp, 31\n",
+    "    li t3, 32\n",                 // ' '
+    "    sb t3, 0(a2)\n",
+    "    li t3, 10\n",
+    "__rt_err_number_digit:\n",
+    "    remu t4, a0, t3\n",
+    "    divu a0, a0, t3\n",
+    "    addi t4, t4, 48\n",
+    "    addi a2, a2, -1\n",
+    "    sb t4, 0(a2)\n",
+    "    bnez a0, __rt_err_number_digit\n",
+    "    mv a1, a2\n",
+    "    addi a2, sp, 32\n",
+    "    sub a2, a2, a1\n",
+    "    li a0, 2\n",
+    "    li a7, 64\n",
+    "    ecall\n",
+    "    addi sp, sp, 32\n",
+    "    ret\n",
+    NULL
+};
+
+// Perfil do --profile-generate: o gerador põe na .rodata __rt_prof_keys,
+// com o endereço da chave de cada if/while (terminada em '\n') e um zero no
+// fim, e na .bss __rt_prof_counts, com dois contadores por chave. Cada linha
+// sai como "<execuções> <vezes verdadeira> <chave>" no fd 2
+static const char *const profile_dump_code[] = {
+    "__rt_profile_dump:\n",
+    "    mv t6, ra\n",
+    "    la t0, __rt_prof_keys\n",
+    "    la t1, __rt_prof_counts\n",
+    "__rt_profile_dump_entry:\n",
+    "    lw a1, 0(t0)\n",
+    "    beqz a1, __rt_profile_dump_done\n",
+    "    lw a0, 0(t1)\n",
+    "    li a1, 0\n",
+    "    call __rt_err_number\n",
+    "    lw a0, 4(t1)\n",
+    "    li a1, 0\n",
+    "    call __rt_err_number\n",
+    "    lw a1, 0(t0)\n",
+    "    call __rt_err_puts\n",
+    "    addi t0, t0, 4\n",
+    "    addi t1, t1, 8\n",
+    "    j __rt_profile_dump_entry\n",
+    "__rt_profile_dump_done:\n",
+    "    mv ra, t6\n",
+    "    ret\n",
+    NULL
+};
+
+// Resumo do --cycle-counters: __rt_cycle_labels (.rodata) tem o cabeçalho,
+// a descrição de cada região e um zero no fim; __rt_cycle_table (.bss) tem
+// uma entrada de 32 bytes por região (ver riscv_runtime.h). Cada
+// linha sai como "<execuções> <ciclos> <instruções> <região>" no fd 2
+static const char *const cycles_dump_code[] = {
+    "__rt_cycles_dump:\n",
+    "    mv t6, ra\n",
+    "    la t0, __rt_cycle_labels\n",
+    "    la t1, __rt_cycle_table\n",
+    "    lw a1, 0(t0)\n",
+    "    call __rt_err_puts\n",
+    "__rt_cycles_dump_entry:\n",
+    "    lw a1, 4(t0)\n",
+    "    beqz a1, __rt_cycles_dump_done\n",
+    "    lw a0, 24(t1)\n",
+    "    li a1, 0\n",
+    "    call __rt_err_number\n",
+    "    lw a0, 8(t1)\n",
+    "    lw a1, 12(t1)\n",
+    "    call __rt_err_number\n",
+    "    lw a0, 16(t1)\n",
+    "    lw a1, 20(t1)\n",
+    "    call __rt_err_number\n",
+    "    lw a1, 4(t0)\n",
+    "    call __rt_err_puts\n",
+    "    addi t0, t0, 4\n",
+    "    addi t1, t1, 32\n",
+    "    j __rt_cycles_dump_entry\n",
+    "__rt_cycles_dump_done:\n",
+    "    mv ra, t6\n",
+    "    ret\n",
+    NULL
+};
+
+// Uma rotina pode ter uma entrada por XLEN; as outras servem aos dois
+typedef struct {
+    RuntimeRoutine routine;
+    unsigned depends;
+    const char *const *code;
+    int argument;       // Valor do "%d" da rotina, se houver
+    int xlen;           // Só para esse alvo (0 = todos)
+} RuntimeEntry;
+
+static const RuntimeEntry runtime_entries[] = {
+    { RUNTIME_FLUSH, 0, flush_code, 0, 0 },
+    { RUNTIME_PUTC, RUNTIME_FLUSH, putc_code, RUNTIME_OUTPUT_BUFFER_SIZE, 0 },
+    { RUNTIME_PUTS, RUNTIME_FLUSH, puts_code, RUNTIME_OUTPUT_BUFFER_SIZE, 0 },
+    { RUNTIME_PRINT_INT, RUNTIME_FLUSH, print_int_code, RUNTIME_OUTPUT_BUFFER_SIZE - RUNTIME_INT_CHARS, 32 },
+    { RUNTIME_PRINT_INT, RUNTIME_FLUSH, print_int_code, RUNTIME_OUTPUT_BUFFER_SIZE - RUNTIME_LONG_CHARS, 64 },
+    { RUNTIME_PRINT_FLOAT, RUNTIME_FLUSH, print_float_code, 0, 0 },
+    { RUNTIME_IN_FILL, 0, in_fill_code, RUNTIME_INPUT_BUFFER_SIZE, 0 },
+    { RUNTIME_IN_PEEK, RUNTIME_IN_FILL, in_peek_code, 0, 0 },
+    { RUNTIME_IN_START, RUNTIME_IN_PEEK, in_start_code, 0, 0 },
+    { RUNTIME_READ_INT, RUNTIME_IN_START | RUNTIME_IN_PEEK, read_int_code, 0, 0 },
+    { RUNTIME_READ_FLOAT, RUNTIME_IN_START | RUNTIME_IN_PEEK, read_float_code, 0, 0 },
+    { RUNTIME_ERR_PUTS, 0, err_puts_code, 0, 0 },
+    { RUNTIME_ERR_NUMBER, 0, err_number_code, 0, 32 },
+    { RUNTIME_ERR_NUMBER, 0, err_number64_code, 0, 64 },
+    { RUNTIME_PROFILE_DUMP, RUNTIME_ERR_PUTS | RUNTIME_ERR_NUMBER, profile_dump_code, 0, 0 },
+    { RUNTIME_CYCLES_DUMP, RUNTIME_ERR_PUTS | RUNTIME_ERR_NUMBER, cycles_dump_code, 0, 0 },
+};
+
+#define RUNTIME_ENTRY_COUNT (int)(sizeof(runtime_entries) / sizeof(runtime_entries[0]))
+
+unsigned runtime_closure(unsigned routines) {
+    // As dependências apontam sempre para entradas anteriores da tabela
+    for (int i = RUNTIME_ENTRY_COUNT - 1; i >= 0; i--) {
+        if (routines & runtime_entries[i].routine) routines |= runtime_entries[i].depends;
+    }
+    return routines;
+}
+
+void runtime_generate_text(unsigned routines, int xlen, RuntimeEmit emit, void *arg) {
+    routines = runtime_closure(routines);
+    if (!routines) return;
+
+    emit(arg, "\n");
+    emit(arg, "    # Rotinas de entrada e saída com buffer\n");
+    for (int i = 0; i < RUNTIME_ENTRY_COUNT; i++) {
+        const RuntimeEntry *entry = &runtime_entries[i];
+        if (!(routines & entry->routine) || (entry->xlen && entry->xlen != xlen)) continue;
+        for (int j = 0; entry->code[j]; j++) {
+            emit_code_line(emit, arg, xlen, entry->code[j], entry->argument);
+        }
+    }
+}
+
+void runtime_generate_bss(unsigned routines, RuntimeEmit emit, void *arg) {
+    routines = runtime_closure(routines);
+    if (!routines) return;
+
+    emit(arg, ".section .bss\n");
+    emit(arg, ".align 2\n");
+    if (routines & RUNTIME_OUTPUT_ROUTINES) {
+        emit(arg, "__rt_out_len: .zero 4\n");
+        emit_line(emit, arg, "__rt_out_buf: .zero %d\n", RUNTIME_OUTPUT_BUFFER_SIZE);
+    }
+    if (routines & RUNTIME_INPUT_ROUTINES) {
+        // __rt_in_len fica logo depois de __rt_in_pos (lido com 4(t0))
+        emit(arg, ".align 2\n");
+        emit(arg, "__rt_in_pos: .zero 4\n");
+        emit(arg, "__rt_in_len: .zero 4\n");
+        emit_line(emit, arg, "__rt_in_buf: .zero %d\n", RUNTIME_INPUT_BUFFER_SIZE);
+    }
+}
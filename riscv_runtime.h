@@ -0,0 +1,48 @@
+#ifndef RISCV_RUNTIME_H
+#define RISCV_RUNTIME_H
+
+// Rotinas de apoio emitidas no fim do .s, só quando o programa as usa.
+// Seguem a convenção de chamada: podem mudar t0-t6, a0-a7, ft0-ft11 e fa0-fa7,
+// que o gerador nunca deixa com valores vivos através de uma chamada
+typedef enum {
+    RUNTIME_FLUSH       = 1 << 0,   // __rt_flush: escreve o buffer de saída (write)
+    RUNTIME_PUTC        = 1 << 1,   // __rt_putc: caractere em a0
+    RUNTIME_PUTS        = 1 << 2,   // __rt_puts: string terminada em zero, endereço em a0
+    RUNTIME_PRINT_INT   = 1 << 3,   // __rt_print_int: inteiro em a0
+    RUNTIME_PRINT_FLOAT = 1 << 4,   // __rt_print_float: float em fa0
+    RUNTIME_IN_FILL     = 1 << 5,   // __rt_in_fill: enche o buffer de entrada (read)
+    RUNTIME_IN_PEEK     = 1 << 6,   // __rt_in_peek: próximo caractere, sem consumir
+    RUNTIME_IN_START    = 1 << 7,   // __rt_in_start: pula espaços e o sinal
+    RUNTIME_READ_INT    = 1 << 8,   // __rt_read_int: inteiro lido em a0
+    RUNTIME_READ_FLOAT  = 1 << 9,   // __rt_read_float: float lido em fa0
+    RUNTIME_ERR_PUTS    = 1 << 10,  // __rt_err_puts: string em a1 na saída de erro
+    RUNTIME_ERR_NUMBER  = 1 << 11,  // __rt_err_number: número de 64 bits (a1:a0) e um espaço na saída de erro
+    RUNTIME_PROFILE_DUMP = 1 << 12, // __rt_profile_dump: contadores do perfil na saída de erro
+    RUNTIME_CYCLES_DUMP = 1 << 13   // __rt_cycles_dump: resumo das regiões medidas com rdcycle
+} RuntimeRoutine;
+
+#define RUNTIME_OUTPUT_ROUTINES (RUNTIME_FLUSH | RUNTIME_PUTC | RUNTIME_PUTS | RUNTIME_PRINT_INT | RUNTIME_PRINT_FLOAT)
+#define RUNTIME_INPUT_ROUTINES (RUNTIME_IN_FILL | RUNTIME_IN_PEEK | RUNTIME_IN_START | RUNTIME_READ_INT | RUNTIME_READ_FLOAT)
+
+// Entrada de __rt_cycle_table (--cycle-counters), uma por região medida:
+// rdcycle e rdinstret lidos na entrada da região, os totais de 64 bits dos
+// ciclos e das instruções e o número de execuções
+#define RUNTIME_CYCLE_START 0
+#define RUNTIME_CYCLE_CYCLES 8
+#define RUNTIME_CYCLE_INSTRET 16
+#define RUNTIME_CYCLE_EXECUTIONS 24
+#define RUNTIME_CYCLE_ENTRY_SIZE 32
+
+#define RUNTIME_OUTPUT_BUFFER_SIZE 4096
+#define RUNTIME_INPUT_BUFFER_SIZE 4096
+
+// Recebe cada linha (com o '\n') do código das rotinas
+typedef void (*RuntimeEmit)(void *arg, const char *line);
+
+// Acrescenta as rotinas de que as pedidas dependem
+unsigned runtime_closure(unsigned routines);
+// xlen: 32 ou 64, a largura dos registradores inteiros do alvo
+void runtime_generate_text(unsigned routines, int xlen, RuntimeEmit emit, void *arg);
+void runtime_generate_bss(unsigned routines, RuntimeEmit emit, void *arg);
+
+#endif
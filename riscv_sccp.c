@@ -0,0 +1,431 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "riscv_ir.h"
+
+// Propagação de constantes condicional esparsa (Wegman e Zadeck). Cada
+// valor SSA começa indefinido e só desce no reticulado (indefinido ->
+// constante -> variável); as arestas do CFG só viram executáveis quando o
+// desvio de origem pode de fato tomá-las, então um valor constante em todos
+// os caminhos que executam continua constante através dos phi, e o lado de
+// um desvio que nunca é tomado não contamina o resto do programa.
+
+typedef enum {
+    LATTICE_UNDEFINED,
+    LATTICE_CONSTANT,
+    LATTICE_VARIABLE
+} LatticeState;
+
+typedef struct {
+    LatticeState state;
+    int64_t value;      // Float: padrão de bits
+} LatticeCell;
+
+typedef struct {
+    int block;
+    int index;
+} UseSite;
+
+typedef struct {
+    IrFunction *fn;
+    const IrEvalVar *vars;      // Tamanho de cada variável na pilha
+    int var_count;
+    LatticeCell *cells;
+    int *use_start;             // Usos de cada valor em uses[use_start[v] .. use_start[v+1])
+    UseSite *uses;
+    bool *edge_executable;      // Aresta (b, k) em b * 2 + k
+    bool *block_visited;
+    int *edge_work;             // Pares (origem, índice do sucessor); origem -1 = entrada
+    int edge_top;
+    int edge_capacity;
+    int *value_work;
+    int value_top;
+    int value_capacity;
+} Sccp;
+
+static float as_float(int32_t bits) {
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static int32_t float_bits(float value) {
+    int32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static void push_edge(Sccp *sccp, int from, int k) {
+    if (sccp->edge_top + 2 > sccp->edge_capacity) {
+        sccp->edge_capacity = sccp->edge_capacity ? sccp->edge_capacity * 2 : 64;
+        sccp->edge_work = realloc(sccp->edge_work, sccp->edge_capacity * sizeof(int));
+    }
+    sccp->edge_work[sccp->edge_top++] = from;
+    sccp->edge_work[sccp->edge_top++] = k;
+}
+
+static void set_cell(Sccp *sccp, int value, LatticeState state, int64_t constant) {
+    LatticeCell *cell = &sccp->cells[value];
+    if (cell->state == LATTICE_CONSTANT && state == LATTICE_CONSTANT) {
+        if (cell->value == constant) return;
+        state = LATTICE_VARIABLE;       // Duas constantes diferentes
+    }
+    if (state <= cell->state) return;
+    cell->state = state;
+    cell->value = constant;
+
+    if (sccp->value_top == sccp->value_capacity) {
+        sccp->value_capacity = sccp->value_capacity ? sccp->value_capacity * 2 : 64;
+        sccp->value_work = realloc(sccp->value_work, sccp->value_capacity * sizeof(int));
+    }
+    sccp->value_work[sccp->value_top++] = value;
+}
+
+static LatticeCell cell_of(const Sccp *sccp, int value) {
+    if (value < 0) {
+        // Valor inicial de uma variável: o conteúdo da pilha é desconhecido
+        LatticeCell unknown = { LATTICE_VARIABLE, 0 };
+        return unknown;
+    }
+    return sccp->cells[value];
+}
+
+// Aritmética inteira de 32 bits com a semântica do RISC-V (divisão por
+// zero dá -1 e o resto é o dividendo; INT_MIN / -1 não transborda)
+static int32_t fold_int(char op, int32_t a, int32_t b) {
+    uint32_t ua = (uint32_t)a, ub = (uint32_t)b;
+    switch (op) {
+        case '+': return (int32_t)(ua + ub);
+        case '-': return (int32_t)(ua - ub);
+        case '*': return (int32_t)(ua * ub);
+        case '/':
+            if (b == 0) return -1;
+            if (a == INT32_MIN && b == -1) return INT32_MIN;
+            return a / b;
+        case '%':
+            if (b == 0) return a;
+            if (a == INT32_MIN && b == -1) return 0;
+            return a % b;
+        case '&': return a & b;
+        case '|': return a | b;
+        case '^': return a ^ b;
+        case '=': return a == b;
+        case '!': return a != b;
+        case '<': return a < b;
+        case '>': return a > b;
+        case 'L': return a <= b;
+        case 'G': return a >= b;
+        default: return 0;
+    }
+}
+
+// O mesmo em 64 bits, como add/mul/div do RV64
+static int64_t fold_long(char op, int64_t a, int64_t b) {
+    uint64_t ua = (uint64_t)a, ub = (uint64_t)b;
+    switch (op) {
+        case '+': return (int64_t)(ua + ub);
+        case '-': return (int64_t)(ua - ub);
+        case '*': return (int64_t)(ua * ub);
+        case '/':
+            if (b == 0) return -1;
+            if (a == INT64_MIN && b == -1) return INT64_MIN;
+            return a / b;
+        case '%':
+            if (b == 0) return a;
+            if (a == INT64_MIN && b == -1) return 0;
+            return a % b;
+        case '&': return a & b;
+        case '|': return a | b;
+        case '^': return a ^ b;
+        case '=': return a == b;
+        case '!': return a != b;
+        case '<': return a < b;
+        case '>': return a > b;
+        case 'L': return a <= b;
+        case 'G': return a >= b;
+        default: return 0;
+    }
+}
+
+// Precisão simples, como fadd.s/fsub.s/... com arredondamento ao par
+static int32_t fold_float(char op, float a, float b) {
+    switch (op) {
+        case '+': return float_bits(a + b);
+        case '-': return float_bits(a - b);
+        case '*': return float_bits(a * b);
+        case '/': return float_bits(a / b);
+        case '=': return a == b;
+        case '!': return !(a == b);
+        case '<': return a < b;
+        case '>': return b < a;
+        case 'L': return a <= b;
+        case 'G': return b <= a;
+        default: return 0;
+    }
+}
+
+// fcvt.w.s com rtz: trunca e satura; NaN dá o maior inteiro
+static int32_t float_to_int(float value) {
+    if (value != value || value >= 2147483648.0f) return INT32_MAX;
+    if (value < -2147483648.0f) return INT32_MIN;
+    return (int32_t)value;
+}
+
+// fcvt.l.s com rtz
+static int64_t float_to_long(float value) {
+    if (value != value || value >= 9223372036854775808.0f) return INT64_MAX;
+    if (value < -9223372036854775808.0f) return INT64_MIN;
+    return (int64_t)value;
+}
+
+int64_t ir_fold_binary(IrType type, char op, int64_t a, int64_t b) {
+    if (type == IR_FLOAT) return fold_float(op, as_float((int32_t)a), as_float((int32_t)b));
+    if (type == IR_LONG) return fold_long(op, a, b);
+    return fold_int(op, (int32_t)a, (int32_t)b);
+}
+
+// int -> long só estende o sinal, que já está no valor; long -> int fica
+// com os 32 bits de baixo, como o sext.w
+int64_t ir_fold_convert(IrType type, IrType from, int64_t value) {
+    if (type == IR_FLOAT) {
+        return float_bits(from == IR_LONG ? (float)value : (float)(int32_t)value);
+    }
+    if (from == IR_FLOAT) {
+        return type == IR_LONG ? float_to_long(as_float((int32_t)value)) : float_to_int(as_float((int32_t)value));
+    }
+    return type == IR_LONG ? value : (int32_t)value;
+}
+
+// sb/sh guardam só os bits de baixo e o lb/lh estende o sinal deles
+int64_t ir_fold_load(const IrEvalVar *var, int64_t value) {
+    if (var->type == IR_FLOAT) return value;
+    if (var->size == 1) return (int8_t)value;
+    if (var->size == 2) return (int16_t)value;
+    if (var->size == 4) return (int32_t)value;
+    return value;
+}
+
+static bool is_edge_executable(const Sccp *sccp, int from, int to) {
+    const IrBlock *block = &sccp->fn->blocks[from];
+    for (int k = 0; k < block->succ_count; k++) {
+        if (block->succ[k] == to && sccp->edge_executable[from * 2 + k]) return true;
+    }
+    return false;
+}
+
+static void visit_phi(Sccp *sccp, int block_id, const IrInst *inst) {
+    const IrBlock *block = &sccp->fn->blocks[block_id];
+    LatticeState state = LATTICE_UNDEFINED;
+    int64_t value = 0;
+    for (int p = 0; p < block->pred_count; p++) {
+        if (!is_edge_executable(sccp, block->preds[p], block_id)) continue;
+        LatticeCell arg = cell_of(sccp, inst->phi_args[p]);
+        if (arg.state == LATTICE_UNDEFINED) continue;
+        if (arg.state == LATTICE_VARIABLE || (state == LATTICE_CONSTANT && arg.value != value)) {
+            state = LATTICE_VARIABLE;
+            break;
+        }
+        state = LATTICE_CONSTANT;
+        value = arg.value;
+    }
+    if (state != LATTICE_UNDEFINED) set_cell(sccp, inst->dest, state, value);
+}
+
+static void visit_inst(Sccp *sccp, int block_id, const IrInst *inst) {
+    LatticeCell a = inst->args[0] >= 0 ? cell_of(sccp, inst->args[0]) : (LatticeCell){ LATTICE_VARIABLE, 0 };
+    LatticeCell b = inst->args[1] >= 0 ? cell_of(sccp, inst->args[1]) : (LatticeCell){ LATTICE_VARIABLE, 0 };
+
+    switch (inst->opcode) {
+        case IR_CONST:
+            set_cell(sccp, inst->dest, LATTICE_CONSTANT, inst->imm);
+            break;
+        case IR_LOAD:
+            // Cópia da definição que chega (ou do conteúdo inicial da pilha)
+            a = cell_of(sccp, inst->args[0]);
+            if (a.state == LATTICE_CONSTANT && inst->var < sccp->var_count) {
+                a.value = ir_fold_load(&sccp->vars[inst->var], a.value);
+            }
+            if (a.state != LATTICE_UNDEFINED) set_cell(sccp, inst->dest, a.state, a.value);
+            break;
+        case IR_READ:
+            set_cell(sccp, inst->dest, LATTICE_VARIABLE, 0);
+            break;
+        case IR_BINARY:
+            if (a.state == LATTICE_VARIABLE || b.state == LATTICE_VARIABLE) {
+                set_cell(sccp, inst->dest, LATTICE_VARIABLE, 0);
+            } else if (a.state == LATTICE_CONSTANT && b.state == LATTICE_CONSTANT) {
+                int64_t result = ir_fold_binary(sccp->fn->values[inst->args[0]].type, inst->op, a.value, b.value);
+                set_cell(sccp, inst->dest, LATTICE_CONSTANT, result);
+            }
+            break;
+        case IR_CONVERT:
+            if (a.state == LATTICE_CONSTANT) {
+                set_cell(sccp, inst->dest, LATTICE_CONSTANT, ir_fold_convert(inst->type, sccp->fn->values[inst->args[0]].type, a.value));
+            } else if (a.state == LATTICE_VARIABLE) {
+                set_cell(sccp, inst->dest, LATTICE_VARIABLE, 0);
+            }
+            break;
+        case IR_BRANCH:
+            if (a.state == LATTICE_CONSTANT && b.state == LATTICE_CONSTANT) {
+                int64_t taken = ir_fold_binary(inst->type, inst->op, a.value, b.value);
+                push_edge(sccp, block_id, taken ? 0 : 1);
+            } else if (a.state == LATTICE_VARIABLE || b.state == LATTICE_VARIABLE) {
+                push_edge(sccp, block_id, 0);
+                push_edge(sccp, block_id, 1);
+            }
+            break;
+        case IR_JUMP:
+            push_edge(sccp, block_id, 0);
+            break;
+        default:
+            break;
+    }
+}
+
+static void build_uses(Sccp *sccp) {
+    IrFunction *fn = sccp->fn;
+    sccp->use_start = calloc(fn->value_count + 1, sizeof(int));
+
+    // Contagem, soma prefixada e preenchimento
+    for (int pass = 0; pass < 2; pass++) {
+        int *fill = pass ? calloc(fn->value_count + 1, sizeof(int)) : NULL;
+        for (int bi = 0; bi < fn->block_count; bi++) {
+            const IrBlock *block = &fn->blocks[bi];
+            for (int i = 0; i < block->inst_count; i++) {
+                const IrInst *inst = &block->insts[i];
+                int count = inst->opcode == IR_PHI ? block->pred_count : 2;
+                for (int k = 0; k < count; k++) {
+                    int value = inst->opcode == IR_PHI ? inst->phi_args[k] : inst->args[k];
+                    if (value < 0) continue;
+                    if (pass == 0) {
+                        sccp->use_start[value + 1]++;
+                    } else {
+                        UseSite *site = &sccp->uses[sccp->use_start[value] + fill[value]++];
+                        site->block = bi;
+                        site->index = i;
+                    }
+                }
+            }
+        }
+        if (pass == 0) {
+            for (int v = 0; v < fn->value_count; v++) sccp->use_start[v + 1] += sccp->use_start[v];
+            sccp->uses = malloc((sccp->use_start[fn->value_count] + 1) * sizeof(UseSite));
+        }
+        free(fill);
+    }
+}
+
+// Reescreve o IR com o resultado: valores constantes viram IR_CONST, desvios
+// com um só lado executável viram saltos e os blocos que nunca executam saem
+static void apply_results(Sccp *sccp, SccpStats *stats) {
+    IrFunction *fn = sccp->fn;
+    for (int bi = 0; bi < fn->block_count; bi++) {
+        IrBlock *block = &fn->blocks[bi];
+        if (!block->reachable || sccp->block_visited[bi]) continue;
+        for (int k = 0; k < block->succ_count; k++) {
+            ir_remove_edge(fn, bi, block->succ[k]);
+        }
+        block->reachable = false;
+        stats->blocks++;
+    }
+
+    for (int bi = 0; bi < fn->block_count; bi++) {
+        IrBlock *block = &fn->blocks[bi];
+        if (!block->reachable) continue;
+        for (int i = 0; i < block->inst_count; i++) {
+            IrInst *inst = &block->insts[i];
+            if (inst->dest >= 0 && inst->opcode != IR_CONST && sccp->cells[inst->dest].state == LATTICE_CONSTANT) {
+                free(inst->phi_args);
+                inst->phi_args = NULL;
+                inst->opcode = IR_CONST;
+                inst->imm = sccp->cells[inst->dest].value;
+                inst->args[0] = inst->args[1] = -1;
+                stats->constants++;
+            }
+        }
+
+        IrInst *last = block->inst_count ? &block->insts[block->inst_count - 1] : NULL;
+        if (last && last->opcode == IR_BRANCH) {
+            bool taken[2] = { sccp->edge_executable[bi * 2], sccp->edge_executable[bi * 2 + 1] };
+            if (taken[0] != taken[1]) {
+                int keep = taken[0] ? 0 : 1;
+                int target = block->succ[keep];
+                ir_remove_edge(fn, bi, block->succ[1 - keep]);
+                last->opcode = IR_JUMP;
+                last->args[0] = last->args[1] = -1;
+                block->succ[0] = target;
+                block->succ_count = 1;
+                stats->branches++;
+            }
+        }
+    }
+}
+
+void ir_sccp(IrFunction *fn, const IrEvalVar *vars, int var_count, SccpStats *stats) {
+    memset(stats, 0, sizeof(SccpStats));
+    stats->instructions_before = ir_instruction_count(fn);
+    if (fn->block_count == 0) return;
+
+    Sccp sccp;
+    memset(&sccp, 0, sizeof(sccp));
+    sccp.fn = fn;
+    sccp.vars = vars;
+    sccp.var_count = var_count;
+    sccp.cells = calloc(fn->value_count ? fn->value_count : 1, sizeof(LatticeCell));
+    sccp.edge_executable = calloc(fn->block_count * 2, sizeof(bool));
+    sccp.block_visited = calloc(fn->block_count, sizeof(bool));
+    build_uses(&sccp);
+
+    push_edge(&sccp, -1, 0);
+    while (sccp.edge_top > 0 || sccp.value_top > 0) {
+        if (sccp.edge_top > 0) {
+            int k = sccp.edge_work[--sccp.edge_top];
+            int from = sccp.edge_work[--sccp.edge_top];
+            int to = 0;
+            if (from >= 0) {
+                if (sccp.edge_executable[from * 2 + k]) continue;
+                sccp.edge_executable[from * 2 + k] = true;
+                to = fn->blocks[from].succ[k];
+            }
+
+            // Os phi mudam a cada nova aresta; o resto do bloco só é visto
+            // na primeira vez (depois, pelos usos dos valores que mudarem)
+            IrBlock *block = &fn->blocks[to];
+            for (int i = 0; i < block->inst_count && block->insts[i].opcode == IR_PHI; i++) {
+                visit_phi(&sccp, to, &block->insts[i]);
+            }
+            if (!sccp.block_visited[to]) {
+                sccp.block_visited[to] = true;
+                for (int i = 0; i < block->inst_count; i++) {
+                    if (block->insts[i].opcode != IR_PHI) visit_inst(&sccp, to, &block->insts[i]);
+                }
+            }
+            continue;
+        }
+
+        int value = sccp.value_work[--sccp.value_top];
+        for (int u = sccp.use_start[value]; u < sccp.use_start[value + 1]; u++) {
+            const UseSite *site = &sccp.uses[u];
+            if (!sccp.block_visited[site->block]) continue;
+            const IrInst *inst = &fn->blocks[site->block].insts[site->index];
+            if (inst->opcode == IR_PHI) {
+                visit_phi(&sccp, site->block, inst);
+            } else {
+                visit_inst(&sccp, site->block, inst);
+            }
+        }
+    }
+
+    apply_results(&sccp, stats);
+    ir_index_values(fn);
+    stats->instructions_after = ir_instruction_count(fn);
+
+    free(sccp.cells);
+    free(sccp.use_start);
+    free(sccp.uses);
+    free(sccp.edge_executable);
+    free(sccp.block_visited);
+    free(sccp.edge_work);
+    free(sccp.value_work);
+}
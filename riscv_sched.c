@@ -0,0 +1,787 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdint.h>
+#include "riscv_sched.h"
+
+// O gerador guarda todo valor na pilha entre um comando e outro: os
+// registradores de trabalho nunca levam valores através de um rótulo,
+// desvio ou ecall. Dentro de um bloco, então, cada definição de t0-t6
+// (a1-a5 no --rvc) e ft0-ft7 pode ir para qualquer registrador livre do
+// conjunto, o que desfaz as falsas dependências da reutilização de t0/t1/t2.
+// O bloco é escalonado sobre os valores e os registradores são alocados de
+// novo na ordem final; se faltar registrador, o bloco fica como estava
+
+#define MAX_BLOCK_INSTRUCTIONS 64   // Janela do escalonador (custo quadrático)
+#define MAX_BLOCK_CAPACITY (2 * MAX_BLOCK_INSTRUCTIONS)
+#define MAX_SCHED_OPERANDS 4
+#define MAX_OPERAND_LENGTH 64
+#define REG_NONE -1
+#define FP_REG(n) (32 + (n))
+#define NO_EDGE -1
+
+typedef enum {
+    CLASS_ALU,
+    CLASS_LOAD,
+    CLASS_STORE,
+    CLASS_MUL,
+    CLASS_DIV,
+    CLASS_FP_ALU,
+    CLASS_FP_MUL,
+    CLASS_FP_DIV,
+    CLASS_FP_MOVE,
+    CLASS_FP_COMPARE,
+    CLASS_BRANCH        // Fecha o bloco
+} OpClass;
+
+typedef struct {
+    const char *name;
+    const char *operands;   // d = destino, s = fonte, m = imm(base), - = outro
+    OpClass op_class;
+    int width;              // Bytes acessados pelos loads e stores
+} SchedOpcode;
+
+// Só as instruções que o gerador emite; qualquer outra vira barreira
+static const SchedOpcode sched_opcodes[] = {
+    { "li",      "d-",  CLASS_ALU },
+    { "la",      "d-",  CLASS_ALU },
+    { "mv",      "ds",  CLASS_ALU },
+    { "neg",     "ds",  CLASS_ALU },
+    { "not",     "ds",  CLASS_ALU },
+    { "seqz",    "ds",  CLASS_ALU },
+    { "snez",    "ds",  CLASS_ALU },
+    { "sltz",    "ds",  CLASS_ALU },
+    { "sgtz",    "ds",  CLASS_ALU },
+    { "add",     "dss", CLASS_ALU },
+    { "sub",     "dss", CLASS_ALU },
+    { "and",     "dss", CLASS_ALU },
+    { "or",      "dss", CLASS_ALU },
+    { "xor",     "dss", CLASS_ALU },
+    { "sll",     "dss", CLASS_ALU },
+    { "srl",     "dss", CLASS_ALU },
+    { "sra",     "dss", CLASS_ALU },
+    { "slt",     "dss", CLASS_ALU },
+    { "sltu",    "dss", CLASS_ALU },
+    { "sgt",     "dss", CLASS_ALU },
+    { "sgtu",    "dss", CLASS_ALU },
+    { "addi",    "ds-", CLASS_ALU },
+    { "andi",    "ds-", CLASS_ALU },
+    { "ori",     "ds-", CLASS_ALU },
+    { "xori",    "ds-", CLASS_ALU },
+    { "slli",    "ds-", CLASS_ALU },
+    { "srli",    "ds-", CLASS_ALU },
+    { "srai",    "ds-", CLASS_ALU },
+    { "slti",    "ds-", CLASS_ALU },
+    { "sltiu",   "ds-", CLASS_ALU },
+    { "sext.w",  "ds",  CLASS_ALU },            // Formas do RV64
+    { "negw",    "ds",  CLASS_ALU },
+    { "addw",    "dss", CLASS_ALU },
+    { "subw",    "dss", CLASS_ALU },
+    { "sllw",    "dss", CLASS_ALU },
+    { "srlw",    "dss", CLASS_ALU },
+    { "sraw",    "dss", CLASS_ALU },
+    { "addiw",   "ds-", CLASS_ALU },
+    { "slliw",   "ds-", CLASS_ALU },
+    { "srliw",   "ds-", CLASS_ALU },
+    { "sraiw",   "ds-", CLASS_ALU },
+    { "mul",     "dss", CLASS_MUL },
+    { "mulh",    "dss", CLASS_MUL },
+    { "mulhu",   "dss", CLASS_MUL },
+    { "div",     "dss", CLASS_DIV },
+    { "divu",    "dss", CLASS_DIV },
+    { "rem",     "dss", CLASS_DIV },
+    { "remu",    "dss", CLASS_DIV },
+    { "mulw",    "dss", CLASS_MUL },
+    { "divw",    "dss", CLASS_DIV },
+    { "divuw",   "dss", CLASS_DIV },
+    { "remw",    "dss", CLASS_DIV },
+    { "remuw",   "dss", CLASS_DIV },
+    { "lb",      "dm",  CLASS_LOAD, 1 },
+    { "lbu",     "dm",  CLASS_LOAD, 1 },
+    { "lh",      "dm",  CLASS_LOAD, 2 },
+    { "lhu",     "dm",  CLASS_LOAD, 2 },
+    { "lw",      "dm",  CLASS_LOAD, 4 },
+    { "lwu",     "dm",  CLASS_LOAD, 4 },
+    { "ld",      "dm",  CLASS_LOAD, 8 },
+    { "flw",     "dm",  CLASS_LOAD, 4 },
+    { "fld",     "dm",  CLASS_LOAD, 8 },
+    { "sb",      "sm",  CLASS_STORE, 1 },
+    { "sh",      "sm",  CLASS_STORE, 2 },
+    { "sw",      "sm",  CLASS_STORE, 4 },
+    { "sd",      "sm",  CLASS_STORE, 8 },
+    { "fsw",     "sm",  CLASS_STORE, 4 },
+    { "fsd",     "sm",  CLASS_STORE, 8 },
+    { "fadd.s",  "dss", CLASS_FP_ALU },
+    { "fsub.s",  "dss", CLASS_FP_ALU },
+    { "fmul.s",  "dss", CLASS_FP_MUL },
+    { "fdiv.s",  "dss", CLASS_FP_DIV },
+    { "fsqrt.s", "ds",  CLASS_FP_DIV },
+    { "fadd.d",  "dss", CLASS_FP_ALU },
+    { "fsub.d",  "dss", CLASS_FP_ALU },
+    { "fmul.d",  "dss", CLASS_FP_MUL },
+    { "fdiv.d",  "dss", CLASS_FP_DIV },
+    { "fsqrt.d", "ds",  CLASS_FP_DIV },
+    { "fmv.s",   "ds",  CLASS_FP_MOVE },
+    { "fmv.d",   "ds",  CLASS_FP_MOVE },
+    { "fneg.s",  "ds",  CLASS_FP_MOVE },
+    { "fabs.s",  "ds",  CLASS_FP_MOVE },
+    { "fmv.w.x", "ds",  CLASS_FP_MOVE },
+    { "fmv.x.w", "ds",  CLASS_FP_MOVE },
+    { "fcvt.s.w", "ds", CLASS_FP_ALU },
+    { "fcvt.w.s", "ds", CLASS_FP_ALU },
+    { "fcvt.s.l", "ds", CLASS_FP_ALU },
+    { "fcvt.l.s", "ds", CLASS_FP_ALU },
+    { "fcvt.d.s", "ds", CLASS_FP_ALU },
+    { "fcvt.s.d", "ds", CLASS_FP_ALU },
+    { "fcvt.d.w", "ds", CLASS_FP_ALU },
+    { "fcvt.w.d", "ds", CLASS_FP_ALU },
+    { "feq.s",   "dss", CLASS_FP_COMPARE },
+    { "flt.s",   "dss", CLASS_FP_COMPARE },
+    { "fle.s",   "dss", CLASS_FP_COMPARE },
+    { "feq.d",   "dss", CLASS_FP_COMPARE },
+    { "flt.d",   "dss", CLASS_FP_COMPARE },
+    { "fle.d",   "dss", CLASS_FP_COMPARE },
+    { "beq",     "ss-", CLASS_BRANCH },
+    { "bne",     "ss-", CLASS_BRANCH },
+    { "blt",     "ss-", CLASS_BRANCH },
+    { "bge",     "ss-", CLASS_BRANCH },
+    { "bltu",    "ss-", CLASS_BRANCH },
+    { "bgeu",    "ss-", CLASS_BRANCH },
+    { "ble",     "ss-", CLASS_BRANCH },
+    { "bgt",     "ss-", CLASS_BRANCH },
+    { "beqz",    "s-",  CLASS_BRANCH },
+    { "bnez",    "s-",  CLASS_BRANCH },
+    { "blez",    "s-",  CLASS_BRANCH },
+    { "bgez",    "s-",  CLASS_BRANCH },
+    { "bltz",    "s-",  CLASS_BRANCH },
+    { "bgtz",    "s-",  CLASS_BRANCH },
+    { "j",       "-",   CLASS_BRANCH },
+};
+
+// Latências aproximadas de dois núcleos em ordem conhecidos
+static const SchedModel sched_models[] = {
+    //  nome     alu load mul div fp_alu fp_mul fp_div fp_move fp_compare
+    { "rocket",  1,  3,   4,  33,  4,     4,     20,    2,      2 },
+    { "u74",     1,  3,   3,  20,  5,     5,     23,    2,      4 },
+};
+
+static const char *const int_register_names[32] = {
+    "zero", "ra", "sp", "gp", "tp", "t0", "t1", "t2",
+    "s0", "s1", "a0", "a1", "a2", "a3", "a4", "a5",
+    "a6", "a7", "s2", "s3", "s4", "s5", "s6", "s7",
+    "s8", "s9", "s10", "s11", "t3", "t4", "t5", "t6"
+};
+
+static const char *const fp_register_names[32] = {
+    "ft0", "ft1", "ft2", "ft3", "ft4", "ft5", "ft6", "ft7",
+    "fs0", "fs1", "fa0", "fa1", "fa2", "fa3", "fa4", "fa5",
+    "fa6", "fa7", "fs2", "fs3", "fs4", "fs5", "fs6", "fs7",
+    "fs8", "fs9", "fs10", "fs11", "ft8", "ft9", "ft10", "ft11"
+};
+
+// Registradores que podem receber valores renomeados, em ordem de preferência
+static const int int_pool[] = { 5, 6, 7, 28, 29, 30, 31 };            // t0-t6
+static const int compact_pool[] = { 12, 13, 14, 15, 11 };             // a2-a5, a1
+static const int fp_pool[] = { FP_REG(0), FP_REG(1), FP_REG(2), FP_REG(3),
+                               FP_REG(4), FP_REG(5), FP_REG(6), FP_REG(7) };   // ft0-ft7
+
+typedef struct {
+    int line;
+    int first_comment;          // Comentários soltos antes da instrução vão junto com ela
+    const SchedOpcode *opcode;
+    int mnemonic_start;         // Recuo original da linha
+    char operands[MAX_SCHED_OPERANDS][MAX_OPERAND_LENGTH];  // Texto (em "m", só o deslocamento)
+    int operand_count;
+    int regs[MAX_SCHED_OPERANDS];       // Registrador dos operandos d/s/m (REG_NONE = nenhum)
+    int values[MAX_SCHED_OPERANDS];     // Valor renomeado (-1 = registrador fixo)
+    const char *comment;        // "# ..." no fim da linha, ou NULL
+    int comment_length;
+    int memory;                 // Operando de memória (-1 = nenhum)
+    int32_t offset;
+    bool offset_known;
+    int latency;
+    int height;                 // Caminho crítico até o fim do bloco
+    int preds_left;
+    int earliest;
+    int issue;
+    bool scheduled;
+} SchedNode;
+
+typedef struct {
+    int cls;                    // 0 = inteiro, 1 = ponto flutuante
+    int uses;
+    int remaining;              // Usos ainda não escalonados
+    int reg;
+} SchedValue;
+
+typedef struct {
+    const char *const *lines;
+    int count;
+    const SchedModel *model;
+    const int *pools[2];
+    int pool_sizes[2];
+    uint64_t pool_mask;
+    char **out;
+    int out_count;
+    SchedStats *stats;
+
+    SchedNode nodes[MAX_BLOCK_CAPACITY];
+    int node_count;
+    signed char latency[MAX_BLOCK_CAPACITY][MAX_BLOCK_CAPACITY];   // Aresta i -> j (NO_EDGE = nenhuma)
+    SchedValue values[MAX_BLOCK_CAPACITY * MAX_SCHED_OPERANDS];
+    int value_count;
+    int order[MAX_BLOCK_CAPACITY];
+} Scheduler;
+
+const SchedModel* sched_find_model(const char *name) {
+    if (!name) return &sched_models[0];
+    for (size_t i = 0; i < sizeof(sched_models) / sizeof(sched_models[0]); i++) {
+        if (strcmp(name, sched_models[i].name) == 0) return &sched_models[i];
+    }
+    return NULL;
+}
+
+static int parse_register(const char *text) {
+    for (int i = 0; i < 32; i++) {
+        if (strcmp(text, int_register_names[i]) == 0) return i;
+        if (strcmp(text, fp_register_names[i]) == 0) return FP_REG(i);
+    }
+    if (strcmp(text, "fp") == 0) return 8;
+    return REG_NONE;
+}
+
+static const char* register_name(int reg) {
+    return reg >= 32 ? fp_register_names[reg - 32] : int_register_names[reg];
+}
+
+static bool is_pool_register(const Scheduler *sched, int reg) {
+    return reg != REG_NONE && (sched->pool_mask >> reg) & 1;
+}
+
+static int op_latency(const SchedModel *model, OpClass op_class) {
+    switch (op_class) {
+        case CLASS_LOAD:       return model->load;
+        case CLASS_MUL:        return model->mul;
+        case CLASS_DIV:        return model->div;
+        case CLASS_FP_ALU:     return model->fp_alu;
+        case CLASS_FP_MUL:     return model->fp_mul;
+        case CLASS_FP_DIV:     return model->fp_div;
+        case CLASS_FP_MOVE:    return model->fp_move;
+        case CLASS_FP_COMPARE: return model->fp_compare;
+        default:               return model->alu;
+    }
+}
+
+static char* trim(char *text) {
+    while (isspace((unsigned char)*text)) text++;
+    char *end = text + strlen(text);
+    while (end > text && isspace((unsigned char)end[-1])) end--;
+    *end = '\0';
+    return text;
+}
+
+static bool is_comment_line(const char *line) {
+    while (isspace((unsigned char)*line)) line++;
+    return *line == '#' || *line == '\0';
+}
+
+// Lê uma linha de instrução; false se for rótulo, diretiva, ecall ou algo
+// que o escalonador não conhece (essas linhas separam os blocos)
+static bool parse_node(Scheduler *sched, const char *line, SchedNode *node) {
+    char buffer[256];
+    if (strlen(line) >= sizeof(buffer) || strchr(line, '"')) return false;
+    strcpy(buffer, line);
+
+    memset(node, 0, sizeof(*node));
+    node->memory = -1;
+    char *hash = strchr(buffer, '#');
+    if (hash) {
+        node->comment = line + (hash - buffer);
+        node->comment_length = (int)strcspn(node->comment, "\n");
+        *hash = '\0';
+    }
+
+    char *text = buffer;
+    while (isspace((unsigned char)*text)) text++;
+    node->mnemonic_start = (int)(text - buffer);
+    char *mnemonic = text;
+    while (*text && !isspace((unsigned char)*text)) text++;
+    if (*text) *text++ = '\0';
+    if (mnemonic[0] == '\0' || mnemonic[0] == '.' || strchr(mnemonic, ':')) return false;
+
+    for (size_t i = 0; i < sizeof(sched_opcodes) / sizeof(sched_opcodes[0]); i++) {
+        if (strcmp(mnemonic, sched_opcodes[i].name) == 0) {
+            node->opcode = &sched_opcodes[i];
+            break;
+        }
+    }
+    if (!node->opcode) return false;
+
+    const char *signature = node->opcode->operands;
+    text = trim(text);
+    while (*text) {
+        if (node->operand_count == MAX_SCHED_OPERANDS) return false;
+        char *comma = strchr(text, ',');
+        if (comma) *comma = '\0';
+        char *operand = trim(text);
+        text = comma ? comma + 1 : text + strlen(text);
+
+        int k = node->operand_count++;
+        char kind = k < (int)strlen(signature) ? signature[k] : '-';
+        node->regs[k] = REG_NONE;
+        node->values[k] = -1;
+        if (kind == 'm') {
+            char *open = strchr(operand, '(');
+            char *close = open ? strchr(open, ')') : NULL;
+            if (!open || !close || close[1] != '\0') return false;
+            *open = '\0';
+            *close = '\0';
+            node->regs[k] = parse_register(trim(open + 1));
+            if (node->regs[k] == REG_NONE) return false;
+            char *offset = trim(operand);
+            char *end;
+            node->offset = (int32_t)strtol(offset, &end, 0);
+            node->offset_known = *end == '\0';
+            node->memory = k;
+            operand = offset;
+        } else if (kind == 'd' || kind == 's') {
+            node->regs[k] = parse_register(operand);
+            if (node->regs[k] == REG_NONE) return false;
+            if (node->regs[k] == 0) node->regs[k] = REG_NONE;     // zero não cria dependência
+        }
+        if (strlen(operand) >= MAX_OPERAND_LENGTH) return false;
+        strcpy(node->operands[k], operand);
+    }
+    if (node->operand_count < (int)strlen(signature)) return false;
+
+    node->latency = op_latency(sched->model, node->opcode->op_class);
+    return true;
+}
+
+static bool is_destination(const SchedNode *node, int k) {
+    return k < (int)strlen(node->opcode->operands) && node->opcode->operands[k] == 'd';
+}
+
+static bool is_store(const SchedNode *node) {
+    return node->opcode->op_class == CLASS_STORE;
+}
+
+// Nenhum registrador renomeável está vivo depois da linha "from"? (um
+// bloco só é cortado no limite da janela em um ponto assim)
+static bool pool_dead_from(Scheduler *sched, int from) {
+    uint64_t defined = 0;
+    for (int i = from; i < sched->count && i < from + MAX_BLOCK_INSTRUCTIONS; i++) {
+        if (is_comment_line(sched->lines[i])) continue;
+        SchedNode node;
+        if (!parse_node(sched, sched->lines[i], &node)) return true;
+        for (int k = 0; k < node.operand_count; k++) {
+            int reg = node.regs[k];
+            if (!is_pool_register(sched, reg) || is_destination(&node, k)) continue;
+            if (!((defined >> reg) & 1)) return false;
+        }
+        for (int k = 0; k < node.operand_count; k++) {
+            if (is_destination(&node, k) && is_pool_register(sched, node.regs[k])) defined |= 1ULL << node.regs[k];
+        }
+        if (node.opcode->op_class == CLASS_BRANCH) return true;
+    }
+    return false;
+}
+
+static void add_edge(Scheduler *sched, int from, int to, int latency) {
+    if (sched->latency[from][to] < latency) sched->latency[from][to] = (signed char)latency;
+}
+
+// Numera os valores dos registradores renomeáveis; false se algum é lido
+// antes de ser definido no bloco (aí o bloco mantém os registradores)
+static bool number_values(Scheduler *sched) {
+    int current[64];
+    for (int r = 0; r < 64; r++) current[r] = -1;
+    sched->value_count = 0;
+
+    for (int i = 0; i < sched->node_count; i++) {
+        SchedNode *node = &sched->nodes[i];
+        for (int k = 0; k < node->operand_count; k++) {
+            int reg = node->regs[k];
+            if (!is_pool_register(sched, reg) || is_destination(node, k)) continue;
+            if (current[reg] < 0) return false;
+            node->values[k] = current[reg];
+            sched->values[current[reg]].uses++;
+        }
+        for (int k = 0; k < node->operand_count; k++) {
+            int reg = node->regs[k];
+            if (!is_destination(node, k) || !is_pool_register(sched, reg)) continue;
+            SchedValue *value = &sched->values[sched->value_count];
+            memset(value, 0, sizeof(*value));
+            value->cls = reg >= 32;
+            node->values[k] = current[reg] = sched->value_count++;
+        }
+    }
+    for (int v = 0; v < sched->value_count; v++) sched->values[v].remaining = sched->values[v].uses;
+    return true;
+}
+
+// Dependências: RAW pelos valores (ou registradores, se não houver
+// renomeação), WAR/WAW nos registradores fixos e acessos à pilha que se
+// sobrepõem, quando um deles é store
+static void build_dependences(Scheduler *sched, bool renamed) {
+    int n = sched->node_count;
+    for (int i = 0; i < n; i++) memset(sched->latency[i], NO_EDGE, n);
+
+    for (int j = 0; j < n; j++) {
+        SchedNode *b = &sched->nodes[j];
+        for (int i = j - 1; i >= 0; i--) {
+            SchedNode *a = &sched->nodes[i];
+
+            for (int ka = 0; ka < a->operand_count; ka++) {
+                int reg = a->regs[ka];
+                if (reg == REG_NONE) continue;
+                for (int kb = 0; kb < b->operand_count; kb++) {
+                    if (b->regs[kb] != reg) continue;
+                    bool a_writes = is_destination(a, ka), b_writes = is_destination(b, kb);
+                    if (renamed && is_pool_register(sched, reg)) {
+                        // Só a leitura do valor definido em "a" importa
+                        if (a_writes && !b_writes && a->values[ka] == b->values[kb]) add_edge(sched, i, j, a->latency);
+                    } else if (a_writes && !b_writes) {
+                        add_edge(sched, i, j, a->latency);
+                    } else if (a_writes || b_writes) {
+                        add_edge(sched, i, j, 1);
+                    }
+                }
+            }
+
+            if (a->memory >= 0 && b->memory >= 0 && (is_store(a) || is_store(b))) {
+                int base_a = a->values[a->memory] >= 0 ? 64 + a->values[a->memory] : a->regs[a->memory];
+                int base_b = b->values[b->memory] >= 0 ? 64 + b->values[b->memory] : b->regs[b->memory];
+                bool disjoint = base_a == base_b && a->offset_known && b->offset_known &&
+                                (a->offset + a->opcode->width <= b->offset || b->offset + b->opcode->width <= a->offset);
+                if (!disjoint) add_edge(sched, i, j, 1);
+            }
+        }
+    }
+
+    for (int i = n - 1; i >= 0; i--) {
+        int height = sched->nodes[i].latency;
+        for (int j = i + 1; j < n; j++) {
+            if (sched->latency[i][j] != NO_EDGE && sched->latency[i][j] + sched->nodes[j].height > height) {
+                height = sched->latency[i][j] + sched->nodes[j].height;
+            }
+        }
+        sched->nodes[i].height = height;
+    }
+}
+
+// Ciclos do bloco numa ordem: cada instrução sai um ciclo depois da
+// anterior ou quando os operandos ficam prontos
+static long block_cycles(Scheduler *sched, const int *order) {
+    int n = sched->node_count;
+    int issue[MAX_BLOCK_CAPACITY];
+    int position[MAX_BLOCK_CAPACITY];
+    for (int p = 0; p < n; p++) position[order[p]] = p;
+
+    int cycle = -1;
+    for (int p = 0; p < n; p++) {
+        int j = order[p];
+        int ready = cycle + 1;
+        for (int i = 0; i < n; i++) {
+            if (sched->latency[i][j] == NO_EDGE || position[i] > p) continue;
+            if (issue[i] + sched->latency[i][j] > ready) ready = issue[i] + sched->latency[i][j];
+        }
+        issue[j] = cycle = ready;
+    }
+    return cycle + 1;
+}
+
+// Valores que "node" mata (último uso) e cria, por banco
+static void pressure_delta(Scheduler *sched, const SchedNode *node, int freed[2], int created[2]) {
+    freed[0] = freed[1] = created[0] = created[1] = 0;
+    for (int k = 0; k < node->operand_count; k++) {
+        int v = node->values[k];
+        if (v < 0) continue;
+        if (is_destination(node, k)) {
+            created[sched->values[v].cls]++;
+            continue;
+        }
+        // Conta cada valor uma vez, mesmo lido em dois operandos
+        bool repeated = false;
+        int reads = 0;
+        for (int q = 0; q < node->operand_count; q++) {
+            if (node->values[q] != v || is_destination(node, q)) continue;
+            if (q < k) repeated = true;
+            reads++;
+        }
+        if (!repeated && sched->values[v].remaining == reads) freed[sched->values[v].cls]++;
+    }
+}
+
+static bool fits_pressure(Scheduler *sched, const SchedNode *node, const int live[2]) {
+    int freed[2], created[2];
+    pressure_delta(sched, node, freed, created);
+    for (int c = 0; c < 2; c++) {
+        if (created[c] && live[c] - freed[c] + created[c] > sched->pool_sizes[c]) return false;
+    }
+    return true;
+}
+
+// Escalonamento de listas: a cada passo, entre as instruções prontas, a que
+// sai mais cedo; no empate, a de maior caminho crítico. O desvio que fecha
+// o bloco fica sempre por último
+static void list_schedule(Scheduler *sched, bool renamed) {
+    int n = sched->node_count;
+    int live[2] = { 0, 0 };
+    for (int j = 0; j < n; j++) {
+        SchedNode *node = &sched->nodes[j];
+        node->scheduled = false;
+        node->earliest = 0;
+        node->preds_left = 0;
+        for (int i = 0; i < j; i++) {
+            if (sched->latency[i][j] != NO_EDGE) node->preds_left++;
+        }
+    }
+
+    int cycle = 0;
+    for (int step = 0; step < n; step++) {
+        int best = -1, best_ready = 0, fallback = -1;
+        for (int j = 0; j < n; j++) {
+            SchedNode *node = &sched->nodes[j];
+            if (node->scheduled || node->preds_left > 0) continue;
+            if (node->opcode->op_class == CLASS_BRANCH && step < n - 1) continue;
+            if (fallback < 0) fallback = j;
+            if (renamed && !fits_pressure(sched, node, live)) continue;
+
+            int ready = node->earliest > cycle ? node->earliest : cycle;
+            if (best < 0 || ready < best_ready ||
+                (ready == best_ready && node->height > sched->nodes[best].height)) {
+                best = j;
+                best_ready = ready;
+            }
+        }
+        if (best < 0) {
+            // Sem folga de registradores: segue a ordem original (a alocação
+            // pode falhar, e o bloco volta a ser o original)
+            best = fallback;
+            best_ready = sched->nodes[best].earliest > cycle ? sched->nodes[best].earliest : cycle;
+        }
+
+        SchedNode *chosen = &sched->nodes[best];
+        if (renamed) {
+            int freed[2], created[2];
+            pressure_delta(sched, chosen, freed, created);
+            for (int c = 0; c < 2; c++) live[c] += created[c] - freed[c];
+            for (int k = 0; k < chosen->operand_count; k++) {
+                int v = chosen->values[k];
+                if (v < 0) continue;
+                if (!is_destination(chosen, k)) sched->values[v].remaining--;
+                else if (sched->values[v].uses == 0) live[sched->values[v].cls]--;
+            }
+        }
+        chosen->scheduled = true;
+        chosen->issue = best_ready;
+        cycle = best_ready + 1;
+        sched->order[step] = best;
+        for (int j = best + 1; j < n; j++) {
+            if (sched->latency[best][j] == NO_EDGE) continue;
+            SchedNode *succ = &sched->nodes[j];
+            succ->preds_left--;
+            if (chosen->issue + sched->latency[best][j] > succ->earliest) {
+                succ->earliest = chosen->issue + sched->latency[best][j];
+            }
+        }
+    }
+}
+
+// Escolhe os registradores na ordem final; o destino prefere o registrador
+// que a primeira fonte acabou de liberar ("add a2, a2, a3" continua
+// comprimível). Retorna false se algum valor ficar sem registrador
+static bool allocate_registers(Scheduler *sched, int new_regs[][MAX_SCHED_OPERANDS]) {
+    bool in_use[64] = { false };
+    for (int v = 0; v < sched->value_count; v++) sched->values[v].remaining = sched->values[v].uses;
+
+    for (int p = 0; p < sched->node_count; p++) {
+        int index = sched->order[p];
+        SchedNode *node = &sched->nodes[index];
+        int released = REG_NONE;
+
+        for (int k = 0; k < node->operand_count; k++) {
+            int v = node->values[k];
+            new_regs[index][k] = node->regs[k];
+            if (v < 0 || is_destination(node, k)) continue;
+            new_regs[index][k] = sched->values[v].reg;
+            if (--sched->values[v].remaining == 0) {
+                in_use[sched->values[v].reg] = false;
+                if (released == REG_NONE) released = sched->values[v].reg;
+            }
+        }
+        for (int k = 0; k < node->operand_count; k++) {
+            int v = node->values[k];
+            if (v < 0 || !is_destination(node, k)) continue;
+            SchedValue *value = &sched->values[v];
+            int reg = REG_NONE;
+            if (released != REG_NONE && (released >= 32) == value->cls && !in_use[released]) {
+                reg = released;
+            } else {
+                for (int i = 0; i < sched->pool_sizes[value->cls]; i++) {
+                    if (!in_use[sched->pools[value->cls][i]]) {
+                        reg = sched->pools[value->cls][i];
+                        break;
+                    }
+                }
+            }
+            if (reg == REG_NONE) return false;
+            value->reg = reg;
+            new_regs[index][k] = reg;
+            in_use[reg] = value->uses > 0;
+        }
+    }
+    return true;
+}
+
+static void emit_line(Scheduler *sched, const char *line) {
+    sched->out[sched->out_count++] = strdup(line);
+}
+
+// Reescreve a instrução com os novos registradores (sem mudança, a linha
+// original é mantida como estava)
+static void emit_node(Scheduler *sched, const SchedNode *node, const int *regs) {
+    const char *line = sched->lines[node->line];
+    bool changed = false;
+    for (int k = 0; k < node->operand_count; k++) {
+        if (regs[k] != node->regs[k]) changed = true;
+    }
+    if (!changed) {
+        emit_line(sched, line);
+        return;
+    }
+
+    char text[512];
+    int length = snprintf(text, sizeof(text), "%.*s%s", node->mnemonic_start, line, node->opcode->name);
+    for (int k = 0; k < node->operand_count; k++) {
+        const char *separator = k == 0 ? " " : ", ";
+        if (k == node->memory) {
+            length += snprintf(text + length, sizeof(text) - length, "%s%s(%s)", separator,
+                               node->operands[k], register_name(regs[k]));
+        } else {
+            length += snprintf(text + length, sizeof(text) - length, "%s%s", separator,
+                               regs[k] != REG_NONE ? register_name(regs[k]) : node->operands[k]);
+        }
+    }
+    if (node->comment) {
+        length += snprintf(text + length, sizeof(text) - length, "  %.*s", node->comment_length, node->comment);
+    }
+    snprintf(text + length, sizeof(text) - length, "\n");
+    emit_line(sched, text);
+}
+
+// Escalona o bloco acumulado e escreve as linhas de [block_start, end)
+static void flush_block(Scheduler *sched, int block_start, int end, bool allow_rename) {
+    int n = sched->node_count;
+    if (n == 0) {
+        for (int i = block_start; i < end; i++) emit_line(sched, sched->lines[i]);
+        return;
+    }
+
+    // A ordem original ocupa o vetor todo, e as cópias para sched->order
+    // usam o tamanho do destino: nenhuma depende de n caber no bloco
+    int original[MAX_BLOCK_CAPACITY];
+    for (int i = 0; i < MAX_BLOCK_CAPACITY; i++) original[i] = i;
+
+    bool renamed = allow_rename && number_values(sched);
+    if (!renamed) {
+        for (int i = 0; i < n; i++) {
+            for (int k = 0; k < MAX_SCHED_OPERANDS; k++) sched->nodes[i].values[k] = -1;
+        }
+        sched->value_count = 0;
+    }
+    build_dependences(sched, renamed);
+    long before = block_cycles(sched, original);
+    list_schedule(sched, renamed);
+
+    int new_regs[MAX_BLOCK_CAPACITY][MAX_SCHED_OPERANDS];
+    if (renamed && !allocate_registers(sched, new_regs)) {
+        memcpy(sched->order, original, sizeof(sched->order));
+        renamed = false;
+    }
+    if (!renamed) {
+        for (int i = 0; i < n; i++) memcpy(new_regs[i], sched->nodes[i].regs, sizeof(new_regs[i]));
+    }
+    long after = block_cycles(sched, sched->order);
+    if (after > before) {
+        // A heurística não garante ganho: fica com a ordem original
+        memcpy(sched->order, original, sizeof(sched->order));
+        for (int i = 0; i < n; i++) memcpy(new_regs[i], sched->nodes[i].regs, sizeof(new_regs[i]));
+        after = before;
+    }
+
+    for (int p = 0; p < n; p++) {
+        const SchedNode *node = &sched->nodes[sched->order[p]];
+        for (int i = node->first_comment; i < node->line; i++) emit_line(sched, sched->lines[i]);
+        emit_node(sched, node, new_regs[sched->order[p]]);
+    }
+    for (int i = sched->nodes[n - 1].line + 1; i < end; i++) emit_line(sched, sched->lines[i]);
+
+    if (sched->stats) {
+        sched->stats->blocks++;
+        sched->stats->instructions += n;
+        sched->stats->cycles_before += before;
+        sched->stats->cycles_after += after;
+    }
+    sched->node_count = 0;
+}
+
+char** schedule_code(const char *const *lines, int count, const SchedOptions *options, SchedStats *stats) {
+    Scheduler *sched = calloc(1, sizeof(Scheduler));
+    sched->lines = lines;
+    sched->count = count;
+    sched->model = options->model ? options->model : sched_find_model(NULL);
+    sched->pools[0] = options->compact ? compact_pool : int_pool;
+    sched->pool_sizes[0] = options->compact ? (int)(sizeof(compact_pool) / sizeof(int)) : (int)(sizeof(int_pool) / sizeof(int));
+    sched->pools[1] = fp_pool;
+    sched->pool_sizes[1] = (int)(sizeof(fp_pool) / sizeof(int));
+    for (int c = 0; c < 2; c++) {
+        for (int i = 0; i < sched->pool_sizes[c]; i++) sched->pool_mask |= 1ULL << sched->pools[c][i];
+    }
+    sched->out = malloc((count ? count : 1) * sizeof(char *));
+    sched->stats = stats;
+    if (stats) memset(stats, 0, sizeof(*stats));
+
+    int block_start = 0;
+    for (int i = 0; i < count; i++) {
+        if (is_comment_line(lines[i])) continue;
+
+        SchedNode *node = &sched->nodes[sched->node_count];
+        if (!parse_node(sched, lines[i], node)) {
+            // Barreira: fecha o bloco e passa a linha adiante
+            flush_block(sched, block_start, i, true);
+            emit_line(sched, lines[i]);
+            if (stats) {
+                stats->cycles_before++;
+                stats->cycles_after++;
+            }
+            block_start = i + 1;
+            continue;
+        }
+        node->line = i;
+        node->first_comment = sched->node_count ? sched->nodes[sched->node_count - 1].line + 1 : block_start;
+        sched->node_count++;
+
+        if (node->opcode->op_class == CLASS_BRANCH) {
+            flush_block(sched, block_start, i + 1, true);
+            block_start = i + 1;
+        } else if (sched->node_count >= MAX_BLOCK_INSTRUCTIONS &&
+                   (sched->node_count == MAX_BLOCK_CAPACITY || pool_dead_from(sched, i + 1))) {
+            // Janela cheia: só renomeia se nenhum valor atravessa o corte
+            flush_block(sched, block_start, i + 1, sched->node_count < MAX_BLOCK_CAPACITY);
+            block_start = i + 1;
+        }
+    }
+    flush_block(sched, block_start, count, true);
+
+    char **out = sched->out;
+    free(sched);
+    return out;
+}
+
+void schedule_free(char **lines, int count) {
+    for (int i = 0; i < count; i++) free(lines[i]);
+    free(lines);
+}
@@ -0,0 +1,44 @@
+#ifndef RISCV_SCHED_H
+#define RISCV_SCHED_H
+
+#include <stdbool.h>
+
+// Escalonador de listas por bloco básico: reordena as instruções geradas
+// para esconder a latência de loads, multiplicações, divisões e operações
+// de ponto flutuante em processadores em ordem
+
+// Latências (em ciclos) de um processador em ordem que emite uma
+// instrução por ciclo
+typedef struct {
+    const char *name;
+    int alu;
+    int load;
+    int mul;
+    int div;
+    int fp_alu;         // fadd/fsub/fcvt
+    int fp_mul;
+    int fp_div;         // fdiv/fsqrt
+    int fp_move;        // fmv entre bancos de registradores
+    int fp_compare;     // feq/flt/fle
+} SchedModel;
+
+typedef struct {
+    const SchedModel *model;
+    bool compact;       // Renomeia para a1-a5 (modo --rvc), não para t0-t6
+} SchedOptions;
+
+typedef struct {
+    int blocks;
+    int instructions;
+    long cycles_before;     // Estimativa pelo modelo, na ordem original
+    long cycles_after;
+} SchedStats;
+
+// Modelo pelo nome (NULL = modelo padrão); NULL se não existir
+const SchedModel* sched_find_model(const char *name);
+
+// Devolve as linhas reordenadas (sempre "count" linhas, alocadas com malloc)
+char** schedule_code(const char *const *lines, int count, const SchedOptions *options, SchedStats *stats);
+void schedule_free(char **lines, int count);
+
+#endif
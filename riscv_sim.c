@@ -0,0 +1,926 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <elf.h>
+#include "riscv_sim.h"
+
+// Endereço de retorno inicial: um "ret" de main encerra o programa com a0
+#define SIM_EXIT_ADDRESS 0
+
+static int sim_error(SimMachine *m, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    vsnprintf(m->error, sizeof(m->error), format, args);
+    va_end(args);
+    return 1;
+}
+
+void sim_init(SimMachine *m, const char *input, size_t input_length) {
+    memset(m, 0, sizeof(SimMachine));
+    m->memory = calloc(SIM_MEMORY_SIZE, 1);
+    m->input = malloc(input_length + 1);
+    if (!m->memory || !m->input) {
+        fprintf(stderr, "Erro: memória insuficiente para o simulador\n");
+        exit(1);
+    }
+    if (input_length) memcpy(m->input, input, input_length);
+    m->input[input_length] = '\0';
+    m->input_length = input_length;
+    m->max_steps = SIM_DEFAULT_MAX_STEPS;
+    m->xlen = 32;
+}
+
+void sim_free(SimMachine *m) {
+    free(m->memory);
+    free(m->input);
+    free(m->output);
+    free(m->error_output);
+    m->memory = NULL;
+    m->input = NULL;
+    m->output = NULL;
+    m->error_output = NULL;
+}
+
+static void append_text(char **text, size_t *text_length, size_t *capacity, const char *data, size_t length) {
+    if (*text_length + length + 1 > *capacity) {
+        *capacity = (*text_length + length + 1) * 2;
+        *text = realloc(*text, *capacity);
+        if (!*text) {
+            fprintf(stderr, "Erro: memória insuficiente para o simulador\n");
+            exit(1);
+        }
+    }
+    memcpy(*text + *text_length, data, length);
+    *text_length += length;
+    (*text)[*text_length] = '\0';
+}
+
+static void append_output(SimMachine *m, const char *data, size_t length) {
+    append_text(&m->output, &m->output_length, &m->output_capacity, data, length);
+}
+
+/* ---------- Ligação ---------- */
+
+static uint32_t read_word(const SimMachine *m, uint32_t address) {
+    const unsigned char *p = m->memory + address;
+    return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static void write_word(SimMachine *m, uint32_t address, uint32_t value) {
+    unsigned char *p = m->memory + address;
+    p[0] = value;
+    p[1] = value >> 8;
+    p[2] = value >> 16;
+    p[3] = value >> 24;
+}
+
+static int symbol_address(SimMachine *m, const AsmProgram *program, const uint32_t *base, int symbol,
+                          uint32_t *address) {
+    const AsmSymbol *entry = &program->symbols[symbol];
+    if (entry->section < 0) return sim_error(m, "símbolo indefinido: %s", entry->name);
+    *address = base[entry->section] + entry->value;
+    return 0;
+}
+
+static uint32_t branch_immediate(int32_t offset) {
+    uint32_t imm = (uint32_t)offset;
+    return ((imm >> 12) & 1) << 31 | ((imm >> 5) & 0x3f) << 25 | ((imm >> 1) & 0xf) << 8 | ((imm >> 11) & 1) << 7;
+}
+
+static uint32_t jump_immediate(int32_t offset) {
+    uint32_t imm = (uint32_t)offset;
+    return ((imm >> 20) & 1) << 31 | ((imm >> 1) & 0x3ff) << 21 | ((imm >> 11) & 1) << 20 | ((imm >> 12) & 0xff) << 12;
+}
+
+// Divide um deslocamento pc-relativo em auipc (hi) + addi/jalr (lo)
+static void split_pcrel(int32_t offset, uint32_t *hi, int32_t *lo) {
+    *hi = ((uint32_t)offset + 0x800) >> 12;
+    *lo = offset - (int32_t)(*hi << 12);
+}
+
+// Valor (S + A - P) do R_RISCV_PCREL_HI20 que está no auipc de "address"
+static int pcrel_hi_offset(SimMachine *m, const AsmProgram *program, const uint32_t *base, int section,
+                           uint32_t address, int32_t *offset) {
+    const AsmSection *sec = &program->sections[section];
+    for (int i = 0; i < sec->reloc_count; i++) {
+        const AsmReloc *reloc = &sec->relocs[i];
+        if (reloc->type != R_RISCV_PCREL_HI20 || base[section] + reloc->offset != address) continue;
+        uint32_t target = 0;
+        if (symbol_address(m, program, base, reloc->symbol, &target) != 0) return 1;
+        *offset = (int32_t)(target + reloc->addend - address);
+        return 0;
+    }
+    return sim_error(m, "R_RISCV_PCREL_LO12_I sem o auipc correspondente");
+}
+
+static int apply_reloc(SimMachine *m, const AsmProgram *program, const uint32_t *base, int section,
+                       const AsmReloc *reloc) {
+    uint32_t place = base[section] + reloc->offset;
+    uint32_t target = 0;
+    if (symbol_address(m, program, base, reloc->symbol, &target) != 0) return 1;
+    target += reloc->addend;
+    int32_t offset = (int32_t)(target - place);
+    uint32_t word = read_word(m, place);
+    uint32_t hi;
+    int32_t lo;
+
+    switch (reloc->type) {
+        case R_RISCV_32:
+            write_word(m, place, target);
+            break;
+        case R_RISCV_BRANCH:
+            write_word(m, place, (word & 0x01fff07f) | branch_immediate(offset));
+            break;
+        case R_RISCV_JAL:
+            write_word(m, place, (word & 0xfff) | jump_immediate(offset));
+            break;
+        case R_RISCV_CALL_PLT:
+            split_pcrel(offset, &hi, &lo);
+            write_word(m, place, (word & 0xfff) | hi << 12);
+            write_word(m, place + 4, (read_word(m, place + 4) & 0xfffff) | (uint32_t)lo << 20);
+            break;
+        case R_RISCV_PCREL_HI20:
+            split_pcrel(offset, &hi, &lo);
+            write_word(m, place, (word & 0xfff) | hi << 12);
+            break;
+        case R_RISCV_PCREL_LO12_I:
+            // O símbolo é o rótulo do auipc; o deslocamento vem da relocação dele
+            if (pcrel_hi_offset(m, program, base, program->symbols[reloc->symbol].section,
+                                target - reloc->addend, &offset) != 0) return 1;
+            split_pcrel(offset, &hi, &lo);
+            write_word(m, place, (word & 0xfffff) | (uint32_t)lo << 20);
+            break;
+        default:
+            return sim_error(m, "relocação %u não suportada", reloc->type);
+    }
+    return 0;
+}
+
+int sim_load(SimMachine *m, const AsmProgram *program) {
+    uint32_t base[SECTION_COUNT];
+    uint32_t address = SIM_TEXT_BASE;
+    for (int s = 0; s < SECTION_COUNT; s++) {
+        uint32_t align = program->sections[s].align > 4 ? program->sections[s].align : 4;
+        address = (address + align - 1) & ~(align - 1);
+        base[s] = address;
+        address += program->sections[s].size;
+    }
+    // Sobra ao menos 1 MiB para a pilha
+    if (address > SIM_MEMORY_SIZE - (1 << 20)) return sim_error(m, "programa grande demais para o simulador");
+
+    for (int s = 0; s < SECTION_COUNT; s++) {
+        if (s != SECTION_BSS && program->sections[s].size) {
+            memcpy(m->memory + base[s], program->sections[s].data, program->sections[s].size);
+        }
+    }
+    for (int s = 0; s < SECTION_COUNT; s++) {
+        for (int i = 0; i < program->sections[s].reloc_count; i++) {
+            if (apply_reloc(m, program, base, s, &program->sections[s].relocs[i]) != 0) return 1;
+        }
+    }
+
+    for (int i = 0; i < program->symbol_count; i++) {
+        const AsmSymbol *symbol = &program->symbols[i];
+        if (strcmp(symbol->name, "main") == 0 && symbol->section == SECTION_TEXT) {
+            m->pc = base[SECTION_TEXT] + symbol->value;
+            m->text_end = base[SECTION_TEXT] + program->sections[SECTION_TEXT].size;
+            m->x[1] = SIM_EXIT_ADDRESS;
+            m->x[2] = SIM_MEMORY_SIZE - 16;
+            return 0;
+        }
+    }
+    return sim_error(m, "o programa não define main");
+}
+
+int sim_load_assembly(SimMachine *m, const char *text, size_t length) {
+    // Uma cópia com as linhas separadas em strings próprias
+    char *copy = malloc(length + 1);
+    int line_capacity = 1;
+    for (size_t i = 0; i < length; i++) {
+        if (text[i] == '\n') line_capacity++;
+    }
+    const char **lines = malloc(line_capacity * sizeof(char *));
+    if (!copy || !lines) {
+        fprintf(stderr, "Erro: memória insuficiente para o simulador\n");
+        exit(1);
+    }
+    memcpy(copy, text, length);
+    copy[length] = '\0';
+
+    int line_count = 0;
+    for (char *line = copy; *line; ) {
+        char *end = strchr(line, '\n');
+        lines[line_count++] = line;
+        if (!end) break;
+        *end = '\0';
+        line = end + 1;
+    }
+
+    AsmProgram program;
+    AsmOptions options = { false, m->xlen };
+    int status = asm_assemble(&program, lines, line_count, &options);
+    if (status != 0) {
+        sim_error(m, "%s", program.error);
+    } else {
+        status = sim_load(m, &program);
+    }
+    asm_free(&program);
+    free(lines);
+    free(copy);
+    return status;
+}
+
+/* ---------- Instruções comprimidas ---------- */
+
+static uint32_t encode_r(uint32_t opcode, int rd, int funct3, int rs1, int rs2, int funct7) {
+    return opcode | rd << 7 | funct3 << 12 | rs1 << 15 | rs2 << 20 | (uint32_t)funct7 << 25;
+}
+
+static uint32_t encode_i(uint32_t opcode, int rd, int funct3, int rs1, int32_t imm) {
+    return opcode | rd << 7 | funct3 << 12 | rs1 << 15 | (uint32_t)imm << 20;
+}
+
+static uint32_t encode_s(uint32_t opcode, int funct3, int rs1, int rs2, int32_t imm) {
+    return opcode | ((uint32_t)imm & 0x1f) << 7 | funct3 << 12 | rs1 << 15 | rs2 << 20 | ((uint32_t)imm >> 5) << 25;
+}
+
+static int32_t sign_extend(uint32_t value, int bits) {
+    return (int32_t)(value << (32 - bits)) >> (32 - bits);
+}
+
+#define BITS(value, high, low) (((value) >> (low)) & ((1u << ((high) - (low) + 1)) - 1))
+
+// Expande uma instrução de 16 bits para a equivalente de 32; 0 = inválida.
+// No RV64 os códigos de c.flw/c.fsw/c.jal são de c.ld/c.sd/c.addiw e os
+// deslocamentos têm 6 bits
+static uint32_t expand_compressed(uint32_t c, bool rv64) {
+    int funct3 = BITS(c, 15, 13);
+    int rd = BITS(c, 11, 7);
+    int rs2 = BITS(c, 6, 2);
+    int rd_short = 8 + BITS(c, 4, 2);       // rd'/rs2'
+    int rs1_short = 8 + BITS(c, 9, 7);      // rs1'/rd'
+    int32_t imm6 = sign_extend(BITS(c, 12, 12) << 5 | BITS(c, 6, 2), 6);
+    uint32_t offset_w = BITS(c, 12, 10) << 3 | BITS(c, 6, 6) << 2 | BITS(c, 5, 5) << 6;
+    uint32_t offset_d = BITS(c, 12, 10) << 3 | BITS(c, 6, 5) << 6;
+    int shamt = BITS(c, 6, 2) | (rv64 ? BITS(c, 12, 12) << 5 : 0);
+
+    if (rv64) {
+        switch (BITS(c, 1, 0) << 3 | funct3) {
+            case 003: return encode_i(0x03, rd_short, 3, rs1_short, offset_d);     // c.ld
+            case 007: return encode_s(0x23, 3, rs1_short, rd_short, offset_d);     // c.sd
+            case 011: return rd ? encode_i(0x1b, rd, 0, rd, imm6) : 0;             // c.addiw
+            case 023:                                                               // c.ldsp
+                return rd ? encode_i(0x03, rd, 3, 2, BITS(c, 12, 12) << 5 | BITS(c, 6, 5) << 3 | BITS(c, 4, 2) << 6) : 0;
+            case 027: return encode_s(0x23, 3, 2, rs2, BITS(c, 12, 10) << 3 | BITS(c, 9, 7) << 6);    // c.sdsp
+            case 014:
+                if (BITS(c, 11, 10) == 3 && BITS(c, 12, 12)) {                     // c.subw / c.addw
+                    int which = BITS(c, 6, 5);
+                    if (which > 1) return 0;
+                    return encode_r(0x3b, rs1_short, 0, rs1_short, rd_short, which == 0 ? 0x20 : 0);
+                }
+                break;
+        }
+    }
+
+    switch (BITS(c, 1, 0) << 3 | funct3) {
+        case 000: {     // c.addi4spn
+            uint32_t imm = BITS(c, 12, 11) << 4 | BITS(c, 10, 7) << 6 | BITS(c, 6, 6) << 2 | BITS(c, 5, 5) << 3;
+            return imm ? encode_i(0x13, rd_short, 0, 2, imm) : 0;
+        }
+        case 002: return encode_i(0x03, rd_short, 2, rs1_short, offset_w);         // c.lw
+        case 003: return encode_i(0x07, rd_short, 2, rs1_short, offset_w);         // c.flw
+        case 006: return encode_s(0x23, 2, rs1_short, rd_short, offset_w);         // c.sw
+        case 007: return encode_s(0x27, 2, rs1_short, rd_short, offset_w);         // c.fsw
+
+        case 010: return encode_i(0x13, rd, 0, rd, imm6);                          // c.addi / c.nop
+        case 011:       // c.jal
+        case 015: {     // c.j
+            int32_t offset = sign_extend(BITS(c, 12, 12) << 11 | BITS(c, 11, 11) << 4 | BITS(c, 10, 9) << 8 |
+                                         BITS(c, 8, 8) << 10 | BITS(c, 7, 7) << 6 | BITS(c, 6, 6) << 7 |
+                                         BITS(c, 5, 3) << 1 | BITS(c, 2, 2) << 5, 12);
+            return 0x6f | (funct3 == 1 ? 1 : 0) << 7 | jump_immediate(offset);
+        }
+        case 012: return encode_i(0x13, rd, 0, 0, imm6);                           // c.li
+        case 013:
+            if (rd == 2) {      // c.addi16sp
+                int32_t imm = sign_extend(BITS(c, 12, 12) << 9 | BITS(c, 6, 6) << 4 | BITS(c, 5, 5) << 6 |
+                                          BITS(c, 4, 3) << 7 | BITS(c, 2, 2) << 5, 10);
+                return imm ? encode_i(0x13, 2, 0, 2, imm) : 0;
+            }
+            return imm6 ? (0x37 | rd << 7 | ((uint32_t)imm6 << 12)) : 0;           // c.lui
+        case 014: {
+            switch (BITS(c, 11, 10)) {
+                case 0: return encode_i(0x13, rs1_short, 5, rs1_short, shamt);              // c.srli
+                case 1: return encode_i(0x13, rs1_short, 5, rs1_short, shamt | 0x400);      // c.srai
+                case 2: return encode_i(0x13, rs1_short, 7, rs1_short, imm6);               // c.andi
+                default: {
+                    static const int funct3s[4] = { 0, 4, 6, 7 };   // sub, xor, or, and
+                    int which = BITS(c, 6, 5);
+                    if (BITS(c, 12, 12)) return 0;
+                    return encode_r(0x33, rs1_short, funct3s[which], rs1_short, rd_short, which == 0 ? 0x20 : 0);
+                }
+            }
+        }
+        case 016:       // c.beqz
+        case 017: {     // c.bnez
+            int32_t offset = sign_extend(BITS(c, 12, 12) << 8 | BITS(c, 11, 10) << 3 | BITS(c, 6, 5) << 6 |
+                                         BITS(c, 4, 3) << 1 | BITS(c, 2, 2) << 5, 9);
+            return 0x63 | (funct3 & 1) << 12 | rs1_short << 15 | branch_immediate(offset);
+        }
+
+        case 020: return encode_i(0x13, rd, 1, rd, shamt);                         // c.slli
+        case 022:       // c.lwsp
+        case 023:       // c.flwsp
+            return encode_i(funct3 == 2 ? 0x03 : 0x07, rd, 2, 2,
+                            BITS(c, 12, 12) << 5 | BITS(c, 6, 4) << 2 | BITS(c, 3, 2) << 6);
+        case 024:
+            if (!BITS(c, 12, 12)) {
+                return rs2 ? encode_r(0x33, rd, 0, 0, rs2, 0)                      // c.mv
+                           : encode_i(0x67, 0, 0, rd, 0);                          // c.jr
+            }
+            if (!rs2) return rd ? encode_i(0x67, 1, 0, rd, 0) : 0x00100073;       // c.jalr / c.ebreak
+            return encode_r(0x33, rd, 0, rd, rs2, 0);                              // c.add
+        case 026:       // c.swsp
+        case 027:       // c.fswsp
+            return encode_s(funct3 == 6 ? 0x23 : 0x27, 2, 2, rs2, BITS(c, 12, 9) << 2 | BITS(c, 8, 7) << 6);
+    }
+    return 0;
+}
+
+/* ---------- Execução ---------- */
+
+static float bits_to_float(uint32_t bits) {
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static uint32_t float_to_bits(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static bool check_access(SimMachine *m, uint32_t address, int size) {
+    if (address < SIM_TEXT_BASE || address > (uint32_t)(SIM_MEMORY_SIZE - size)) {
+        sim_error(m, "acesso fora da memória em 0x%08x (pc 0x%08x)", address, m->pc);
+        return false;
+    }
+    return true;
+}
+
+static bool load(SimMachine *m, uint32_t address, int size, uint64_t *value) {
+    if (!check_access(m, address, size)) return false;
+    const unsigned char *p = m->memory + address;
+    *value = 0;
+    for (int i = size - 1; i >= 0; i--) {
+        *value = *value << 8 | p[i];
+    }
+    m->stats.loads++;
+    return true;
+}
+
+static bool store(SimMachine *m, uint32_t address, int size, uint64_t value) {
+    if (!check_access(m, address, size)) return false;
+    for (int i = 0; i < size; i++) {
+        m->memory[address + i] = value >> (8 * i);
+    }
+    m->stats.stores++;
+    return true;
+}
+
+// Arredonda conforme o campo rm da instrução (7 = dinâmico: mais próximo, par)
+static float round_mode(float value, int rm) {
+    switch (rm) {
+        case 1: return truncf(value);
+        case 2: return floorf(value);
+        case 3: return ceilf(value);
+        case 4: return roundf(value);
+        default: return rintf(value);
+    }
+}
+
+// fcvt.w.s / fcvt.wu.s com a saturação do RISC-V
+static uint32_t float_to_int(float value, int rm, bool is_unsigned) {
+    if (isnan(value)) return is_unsigned ? 0xffffffffu : 0x7fffffffu;
+    double rounded = round_mode(value, rm);
+    if (is_unsigned) {
+        if (rounded <= 0.0) return 0;
+        if (rounded >= 4294967296.0) return 0xffffffffu;
+        return (uint32_t)rounded;
+    }
+    if (rounded >= 2147483648.0) return 0x7fffffffu;
+    if (rounded < -2147483648.0) return 0x80000000u;
+    return (uint32_t)(int32_t)rounded;
+}
+
+// fcvt.l.s / fcvt.lu.s do RV64, com a mesma saturação
+static uint64_t float_to_long(float value, int rm, bool is_unsigned) {
+    if (isnan(value)) return is_unsigned ? UINT64_MAX : (uint64_t)INT64_MAX;
+    double rounded = round_mode(value, rm);
+    if (is_unsigned) {
+        if (rounded <= 0.0) return 0;
+        if (rounded >= 18446744073709551616.0) return UINT64_MAX;
+        return (uint64_t)rounded;
+    }
+    if (rounded >= 9223372036854775808.0) return (uint64_t)INT64_MAX;
+    if (rounded < -9223372036854775808.0) return (uint64_t)INT64_MIN;
+    return (uint64_t)(int64_t)rounded;
+}
+
+// Valor de 32 bits num registrador: no RV64 (e no RV32, com x[] de 64 bits)
+// ele fica com o sinal estendido
+static uint64_t sign_extend_word(uint64_t value) {
+    return (uint64_t)(int64_t)(int32_t)(uint32_t)value;
+}
+
+// Como o print_float do RARS: a menor representação que volta ao mesmo
+// float, sempre com parte fracionária
+static void format_float(float value, char *buffer, size_t size) {
+    if (isnan(value)) {
+        snprintf(buffer, size, "NaN");
+        return;
+    }
+    if (isinf(value)) {
+        snprintf(buffer, size, value < 0 ? "-Infinity" : "Infinity");
+        return;
+    }
+    for (int precision = 1; precision <= 9; precision++) {
+        snprintf(buffer, size, "%.*g", precision, value);
+        if (strtof(buffer, NULL) == value) break;
+    }
+    if (!strpbrk(buffer, ".eninf")) {
+        strncat(buffer, ".0", size - strlen(buffer) - 1);
+    }
+}
+
+static const char* skip_input_space(SimMachine *m) {
+    while (m->input_pos < m->input_length && (unsigned char)m->input[m->input_pos] <= ' ') {
+        m->input_pos++;
+    }
+    return m->input + m->input_pos;
+}
+
+static int system_call(SimMachine *m, bool *finished) {
+    uint64_t *x = m->x;
+    uint32_t address = (uint32_t)x[11];
+    char buffer[64];
+    const char *start;
+    char *end;
+    m->stats.ecalls++;
+
+    switch (x[17]) {
+        case 1:     // print_int
+            if (m->xlen == 64) snprintf(buffer, sizeof(buffer), "%lld", (long long)(int64_t)x[10]);
+            else snprintf(buffer, sizeof(buffer), "%d", (int32_t)x[10]);
+            append_output(m, buffer, strlen(buffer));
+            break;
+        case 2:     // print_float
+            format_float(bits_to_float(m->f[10]), buffer, sizeof(buffer));
+            append_output(m, buffer, strlen(buffer));
+            break;
+        case 4:     // print_string
+            for (address = (uint32_t)x[10]; ; address++) {
+                if (!check_access(m, address, 1)) return 1;
+                if (!m->memory[address]) break;
+                append_output(m, (const char *)m->memory + address, 1);
+            }
+            break;
+        case 5:     // read_int
+            start = skip_input_space(m);
+            x[10] = (uint64_t)strtoll(start, &end, 10);
+            if (m->xlen == 32) x[10] = sign_extend_word(x[10]);
+            m->input_pos += end - start;
+            break;
+        case 6:     // read_float
+            start = skip_input_space(m);
+            m->f[10] = float_to_bits(strtof(start, &end));
+            m->input_pos += end - start;
+            break;
+        case 11:    // print_char
+            buffer[0] = (char)x[10];
+            append_output(m, buffer, 1);
+            break;
+        case 63: {  // read(fd, buf, len)
+            size_t count = m->input_length - m->input_pos;
+            if (count > x[12]) count = x[12];
+            if (x[10] != 0) count = 0;
+            if (count && !check_access(m, address, (int)count)) return 1;
+            memcpy(m->memory + address, m->input + m->input_pos, count);
+            m->input_pos += count;
+            x[10] = count;
+            break;
+        }
+        case 64:    // write(fd, buf, len)
+            if (x[12] && !check_access(m, address, (int)x[12])) return 1;
+            if (x[10] == 1) {
+                append_output(m, (const char *)m->memory + address, x[12]);
+            } else if (x[10] == 2) {
+                append_text(&m->error_output, &m->error_length, &m->error_capacity,
+                            (const char *)m->memory + address, x[12]);
+            }
+            x[10] = x[12];
+            break;
+        case 10:    // exit
+            m->exit_code = 0;
+            *finished = true;
+            break;
+        case 93:    // exit(a0)
+            m->exit_code = (int32_t)x[10];
+            *finished = true;
+            break;
+        default:
+            return sim_error(m, "chamada de sistema desconhecida: a7 = %u (pc 0x%08x)", (uint32_t)x[17], m->pc);
+    }
+    return 0;
+}
+
+static int execute_fp(SimMachine *m, uint32_t inst, int rd, int funct3, int rs1, int rs2, int funct7) {
+    uint64_t *x = m->x;
+    uint32_t *f = m->f;
+    float a = bits_to_float(f[rs1]);
+    float b = bits_to_float(f[rs2]);
+
+    switch (funct7) {
+        case 0x00: f[rd] = float_to_bits(a + b); break;
+        case 0x04: f[rd] = float_to_bits(a - b); break;
+        case 0x08: f[rd] = float_to_bits(a * b); break;
+        case 0x0c: f[rd] = float_to_bits(a / b); break;
+        case 0x2c: f[rd] = float_to_bits(sqrtf(a)); break;
+        case 0x10: {    // fsgnj / fsgnjn / fsgnjx
+            uint32_t sign = f[rs2] & 0x80000000u;
+            if (funct3 == 1) sign ^= 0x80000000u;
+            if (funct3 == 2) sign = (f[rs1] ^ f[rs2]) & 0x80000000u;
+            f[rd] = (f[rs1] & 0x7fffffffu) | sign;
+            break;
+        }
+        case 0x14: f[rd] = float_to_bits(funct3 == 0 ? fminf(a, b) : fmaxf(a, b)); break;
+        case 0x50:      // fle / flt / feq
+            if (rd) x[rd] = funct3 == 0 ? a <= b : funct3 == 1 ? a < b : a == b;
+            break;
+        case 0x60:      // fcvt.w.s / fcvt.wu.s / fcvt.l.s / fcvt.lu.s
+            if (rs2 > 1 && m->xlen != 64) return sim_error(m, "instrução não suportada 0x%08x (pc 0x%08x)", inst, m->pc);
+            if (rd) {
+                x[rd] = rs2 > 1 ? float_to_long(a, funct3, rs2 == 3) : sign_extend_word(float_to_int(a, funct3, rs2 == 1));
+            }
+            break;
+        case 0x68:      // fcvt.s.w / fcvt.s.wu / fcvt.s.l / fcvt.s.lu
+            if (rs2 > 1 && m->xlen != 64) return sim_error(m, "instrução não suportada 0x%08x (pc 0x%08x)", inst, m->pc);
+            switch (rs2) {
+                case 0: f[rd] = float_to_bits((float)(int32_t)x[rs1]); break;
+                case 1: f[rd] = float_to_bits((float)(uint32_t)x[rs1]); break;
+                case 2: f[rd] = float_to_bits((float)(int64_t)x[rs1]); break;
+                default: f[rd] = float_to_bits((float)x[rs1]); break;
+            }
+            break;
+        case 0x70:      // fmv.x.w
+            if (funct3 != 0) return sim_error(m, "instrução não suportada 0x%08x (pc 0x%08x)", inst, m->pc);
+            if (rd) x[rd] = sign_extend_word(f[rs1]);
+            break;
+        case 0x78:      // fmv.w.x
+            f[rd] = (uint32_t)x[rs1];
+            break;
+        default:
+            return sim_error(m, "instrução não suportada 0x%08x (pc 0x%08x)", inst, m->pc);
+    }
+    return 0;
+}
+
+static uint32_t multiply_divide(int funct3, uint32_t a, uint32_t b) {
+    int32_t sa = (int32_t)a, sb = (int32_t)b;
+    switch (funct3) {
+        case 0: return a * b;
+        case 1: return (uint32_t)(((int64_t)sa * sb) >> 32);
+        case 2: return (uint32_t)(((int64_t)sa * (uint64_t)b) >> 32);
+        case 3: return (uint32_t)(((uint64_t)a * b) >> 32);
+        case 4: return b == 0 ? 0xffffffffu : (sa == INT32_MIN && sb == -1) ? a : (uint32_t)(sa / sb);
+        case 5: return b == 0 ? 0xffffffffu : a / b;
+        case 6: return b == 0 ? a : (sa == INT32_MIN && sb == -1) ? 0 : (uint32_t)(sa % sb);
+        default: return b == 0 ? a : a % b;
+    }
+}
+
+// A extensão M com registradores de 64 bits (RV64)
+static uint64_t multiply_divide64(int funct3, uint64_t a, uint64_t b) {
+    int64_t sa = (int64_t)a, sb = (int64_t)b;
+    switch (funct3) {
+        case 0: return a * b;
+        case 1: return (uint64_t)(((__int128)sa * sb) >> 64);
+        case 2: return (uint64_t)(((__int128)sa * (unsigned __int128)b) >> 64);
+        case 3: return (uint64_t)(((unsigned __int128)a * b) >> 64);
+        case 4: return b == 0 ? UINT64_MAX : (sa == INT64_MIN && sb == -1) ? a : (uint64_t)(sa / sb);
+        case 5: return b == 0 ? UINT64_MAX : a / b;
+        case 6: return b == 0 ? a : (sa == INT64_MIN && sb == -1) ? 0 : (uint64_t)(sa % sb);
+        default: return b == 0 ? a : a % b;
+    }
+}
+
+// Com xlen 32 os registradores guardam os valores com o sinal estendido
+// (como um RV64 executando só instruções de 32 bits): soma, lógicas e
+// comparações saem iguais, e só os deslocamentos à direita e a extensão M
+// precisam olhar para os 32 bits de baixo
+int sim_run(SimMachine *m) {
+    uint64_t *x = m->x;
+    bool rv64 = m->xlen == 64;
+    int shift_mask = rv64 ? 63 : 31;
+    bool finished = false;
+
+    while (!finished) {
+        if (m->pc == SIM_EXIT_ADDRESS) {
+            // main voltou com ret
+            m->exit_code = (int32_t)x[10];
+            break;
+        }
+        if (m->stats.instructions >= m->max_steps) {
+            return sim_error(m, "limite de %ld instruções atingido", m->max_steps);
+        }
+        if (m->pc < SIM_TEXT_BASE || m->pc + 2 > m->text_end || (m->pc & 1)) {
+            return sim_error(m, "pc fora do código: 0x%08x", m->pc);
+        }
+
+        uint32_t inst = m->memory[m->pc] | m->memory[m->pc + 1] << 8;
+        uint32_t length = 2;
+        if ((inst & 3) == 3) {
+            if (m->pc + 4 > m->text_end) return sim_error(m, "pc fora do código: 0x%08x", m->pc);
+            inst = read_word(m, m->pc);
+            length = 4;
+        } else {
+            inst = expand_compressed(inst, rv64);
+            if (!inst) return sim_error(m, "instrução comprimida inválida (pc 0x%08x)", m->pc);
+        }
+        m->stats.instructions++;
+
+        uint32_t opcode = inst & 0x7f;
+        int rd = BITS(inst, 11, 7);
+        int funct3 = BITS(inst, 14, 12);
+        int rs1 = BITS(inst, 19, 15);
+        int rs2 = BITS(inst, 24, 20);
+        int funct7 = BITS(inst, 31, 25);
+        int32_t imm_i = (int32_t)inst >> 20;
+        int32_t imm_s = (int32_t)(((uint32_t)((int32_t)inst >> 25) << 5) | rd);
+        uint32_t next = m->pc + length;
+        uint64_t value = 0;
+
+        switch (opcode) {
+            case 0x37: value = sign_extend_word(inst & 0xfffff000u); break;            // lui
+            case 0x17: value = m->pc + sign_extend_word(inst & 0xfffff000u); break;    // auipc
+            case 0x6f: {                                                // jal
+                int32_t offset = sign_extend(BITS(inst, 31, 31) << 20 | BITS(inst, 19, 12) << 12 |
+                                             BITS(inst, 20, 20) << 11 | BITS(inst, 30, 21) << 1, 21);
+                value = next;
+                next = m->pc + offset;
+                break;
+            }
+            case 0x67:                                                  // jalr
+                value = next;
+                next = (uint32_t)(x[rs1] + imm_i) & ~1u;
+                break;
+            case 0x63: {                                                // desvios
+                int32_t offset = sign_extend(BITS(inst, 31, 31) << 12 | BITS(inst, 7, 7) << 11 |
+                                             BITS(inst, 30, 25) << 5 | BITS(inst, 11, 8) << 1, 13);
+                uint64_t a = x[rs1], b = x[rs2];
+                bool taken;
+                switch (funct3) {
+                    case 0: taken = a == b; break;
+                    case 1: taken = a != b; break;
+                    case 4: taken = (int64_t)a < (int64_t)b; break;
+                    case 5: taken = (int64_t)a >= (int64_t)b; break;
+                    case 6: taken = a < b; break;
+                    case 7: taken = a >= b; break;
+                    default: return sim_error(m, "instrução inválida 0x%08x (pc 0x%08x)", inst, m->pc);
+                }
+                if (taken) next = m->pc + offset;
+                rd = 0;
+                break;
+            }
+            case 0x03: {                                                // loads
+                static const int sizes[8] = { 1, 2, 4, 8, 1, 2, 4, 0 };
+                if (!sizes[funct3] || (!rv64 && (funct3 == 3 || funct3 == 6))) {
+                    return sim_error(m, "instrução inválida 0x%08x (pc 0x%08x)", inst, m->pc);
+                }
+                if (!load(m, (uint32_t)(x[rs1] + imm_i), sizes[funct3], &value)) return 1;
+                if (funct3 == 0) value = (uint64_t)(int8_t)value;
+                if (funct3 == 1) value = (uint64_t)(int16_t)value;
+                if (funct3 == 2) value = sign_extend_word(value);
+                break;
+            }
+            case 0x23: {                                                // stores
+                int size = funct3 < 3 ? 1 << funct3 : (funct3 == 3 && rv64 ? 8 : 0);
+                if (!size) return sim_error(m, "instrução inválida 0x%08x (pc 0x%08x)", inst, m->pc);
+                if (!store(m, (uint32_t)(x[rs1] + imm_s), size, x[rs2])) return 1;
+                rd = 0;
+                break;
+            }
+            case 0x07:                                                  // flw
+                if (funct3 != 2) return sim_error(m, "instrução não suportada 0x%08x (pc 0x%08x)", inst, m->pc);
+                if (!load(m, (uint32_t)(x[rs1] + imm_i), 4, &value)) return 1;
+                m->f[rd] = (uint32_t)value;
+                rd = 0;
+                break;
+            case 0x27:                                                  // fsw
+                if (funct3 != 2) return sim_error(m, "instrução não suportada 0x%08x (pc 0x%08x)", inst, m->pc);
+                if (!store(m, (uint32_t)(x[rs1] + imm_s), 4, m->f[rs2])) return 1;
+                rd = 0;
+                break;
+            case 0x13: {                                                // op-imm
+                uint64_t a = x[rs1];
+                uint64_t imm = (uint64_t)(int64_t)imm_i;
+                int shamt = imm_i & shift_mask;
+                switch (funct3) {
+                    case 0: value = a + imm; break;
+                    case 1: value = a << shamt; break;
+                    case 2: value = (int64_t)a < imm_i; break;
+                    case 3: value = a < imm; break;
+                    case 4: value = a ^ imm; break;
+                    case 5:
+                        if (imm_i & 0x400) value = (uint64_t)((int64_t)a >> shamt);
+                        else value = rv64 ? a >> shamt : (uint32_t)a >> shamt;
+                        break;
+                    case 6: value = a | imm; break;
+                    case 7: value = a & imm; break;
+                }
+                break;
+            }
+            case 0x33: {                                                // op
+                uint64_t a = x[rs1], b = x[rs2];
+                int shamt = b & shift_mask;
+                if (funct7 == 1) {
+                    value = rv64 ? multiply_divide64(funct3, a, b) : multiply_divide(funct3, (uint32_t)a, (uint32_t)b);
+                    break;
+                }
+                switch (funct3) {
+                    case 0: value = funct7 == 0x20 ? a - b : a + b; break;
+                    case 1: value = a << shamt; break;
+                    case 2: value = (int64_t)a < (int64_t)b; break;
+                    case 3: value = a < b; break;
+                    case 4: value = a ^ b; break;
+                    case 5:
+                        if (funct7 == 0x20) value = (uint64_t)((int64_t)a >> shamt);
+                        else value = rv64 ? a >> shamt : (uint32_t)a >> shamt;
+                        break;
+                    case 6: value = a | b; break;
+                    case 7: value = a & b; break;
+                }
+                break;
+            }
+            case 0x1b:                                                  // op-imm-32 (RV64)
+            case 0x3b: {                                                // op-32 (RV64)
+                if (!rv64) return sim_error(m, "instrução não suportada 0x%08x (pc 0x%08x)", inst, m->pc);
+                uint32_t a = (uint32_t)x[rs1];
+                uint32_t b = opcode == 0x1b ? (uint32_t)imm_i : (uint32_t)x[rs2];
+                bool arithmetic = opcode == 0x1b ? (imm_i & 0x400) != 0 : funct7 == 0x20;
+                if (opcode == 0x3b && funct7 == 1) {
+                    if (funct3 >= 1 && funct3 <= 3) return sim_error(m, "instrução inválida 0x%08x (pc 0x%08x)", inst, m->pc);
+                    value = sign_extend_word(multiply_divide(funct3, a, b));
+                    break;
+                }
+                switch (funct3) {
+                    case 0: value = opcode == 0x3b && funct7 == 0x20 ? a - b : a + b; break;
+                    case 1: value = a << (b & 31); break;
+                    case 5: value = arithmetic ? (uint32_t)((int32_t)a >> (b & 31)) : a >> (b & 31); break;
+                    default: return sim_error(m, "instrução inválida 0x%08x (pc 0x%08x)", inst, m->pc);
+                }
+                value = sign_extend_word(value);
+                break;
+            }
+            case 0x53:                                                  // ponto flutuante
+                if (execute_fp(m, inst, rd, funct3, rs1, rs2, funct7) != 0) return 1;
+                rd = 0;
+                break;
+            case 0x0f:                                                  // fence
+                rd = 0;
+                break;
+            case 0x73:
+                if (inst == 0x00000073) {                               // ecall
+                    if (system_call(m, &finished) != 0) return 1;
+                    rd = 0;
+                } else if (funct3 != 0 && funct3 != 4) {
+                    // csrr*: só os contadores, que leem as instruções executadas
+                    // (no RV64 inteiros; no RV32 em duas metades)
+                    uint32_t csr = (uint32_t)imm_i & 0xfff;
+                    uint64_t count = (uint64_t)m->stats.instructions;
+                    if (csr == 0xc00 || csr == 0xc01 || csr == 0xc02) value = rv64 ? count : (uint32_t)count;
+                    else if (!rv64 && (csr == 0xc80 || csr == 0xc81 || csr == 0xc82)) value = (uint32_t)(count >> 32);
+                    else return sim_error(m, "CSR 0x%03x não suportado (pc 0x%08x)", csr, m->pc);
+                } else {
+                    return sim_error(m, "instrução não suportada 0x%08x (pc 0x%08x)", inst, m->pc);
+                }
+                break;
+            default:
+                return sim_error(m, "instrução não suportada 0x%08x (pc 0x%08x)", inst, m->pc);
+        }
+
+        if (rd) x[rd] = rv64 ? value : sign_extend_word(value);
+        m->pc = next;
+    }
+    return 0;
+}
+
+// Lê o arquivo inteiro, terminado em '\0'
+char* sim_read_file(const char *path, size_t *length) {
+    FILE *input = fopen(path, "rb");
+    if (!input) return NULL;
+    char *data = NULL;
+    size_t size = 0, capacity = 0, n;
+    do {
+        if (size + 65536 > capacity) {
+            capacity = capacity ? capacity * 2 : 65536;
+            data = realloc(data, capacity + 1);
+        }
+        n = fread(data + size, 1, capacity - size, input);
+        size += n;
+    } while (n > 0);
+    fclose(input);
+    data[size] = '\0';
+    *length = size;
+    return data;
+}
+
+#ifndef RISCV_SIM_SEM_MAIN
+int main(int argc, char **argv) {
+    const char *program_path = NULL;
+    const char *input_path = NULL;
+    const char *error_path = NULL;
+    bool show_stats = false;
+    long max_steps = SIM_DEFAULT_MAX_STEPS;
+    int xlen = 32;
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--input=", 8) == 0) {
+            input_path = argv[i] + 8;
+        } else if (strncmp(argv[i], "--stderr=", 9) == 0) {
+            error_path = argv[i] + 9;
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            show_stats = true;
+        } else if (strncmp(argv[i], "--max-steps=", 12) == 0) {
+            max_steps = atol(argv[i] + 12);
+        } else if (strcmp(argv[i], "--target=rv32") == 0 || strcmp(argv[i], "--target=rv64") == 0) {
+            xlen = argv[i][11] == '6' ? 64 : 32;
+        } else if (!program_path) {
+            program_path = argv[i];
+        } else {
+            program_path = NULL;
+            break;
+        }
+    }
+    if (!program_path) {
+        printf("Uso: %s programa.s [--input=entrada.txt] [--stderr=saida.txt] [--stats] [--max-steps=N] "
+               "[--target=rv32|rv64]\n", argv[0]);
+        return 1;
+    }
+
+    size_t text_length, input_length = 0;
+    char *text = sim_read_file(program_path, &text_length);
+    if (!text) {
+        fprintf(stderr, "Erro ao abrir %s\n", program_path);
+        return 1;
+    }
+    char *input = NULL;
+    if (input_path) {
+        input = sim_read_file(input_path, &input_length);
+        if (!input) {
+            fprintf(stderr, "Erro ao abrir %s\n", input_path);
+            free(text);
+            return 1;
+        }
+    }
+
+    SimMachine machine;
+    sim_init(&machine, input, input_length);
+    machine.max_steps = max_steps;
+    machine.xlen = xlen;
+    int status = sim_load_assembly(&machine, text, text_length);
+    if (status == 0) status = sim_run(&machine);
+
+    if (machine.output_length) fwrite(machine.output, 1, machine.output_length, stdout);
+    // A saída de erro do programa (o perfil de --profile-generate) vai para
+    // o arquivo de --stderr, se houver
+    bool error_file_failed = false;
+    if (error_path) {
+        FILE *errors = fopen(error_path, "w");
+        if (!errors) {
+            fprintf(stderr, "Erro ao criar %s\n", error_path);
+            error_file_failed = true;
+        } else {
+            fwrite(machine.error_output ? machine.error_output : "", 1, machine.error_length, errors);
+            fclose(errors);
+        }
+    } else if (machine.error_length) {
+        fwrite(machine.error_output, 1, machine.error_length, stderr);
+    }
+    if (status != 0) {
+        fprintf(stderr, "%s: %s\n", program_path, machine.error);
+    }
+    if (show_stats) {
+        fprintf(stderr, "Instruções: %ld, loads: %ld, stores: %ld, ecalls: %ld\n", machine.stats.instructions,
+                machine.stats.loads, machine.stats.stores, machine.stats.ecalls);
+    }
+    int exit_code = status != 0 || error_file_failed ? 1 : machine.exit_code;
+    sim_free(&machine);
+    free(text);
+    free(input);
+    return exit_code;
+}
+#endif
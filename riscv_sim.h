@@ -0,0 +1,64 @@
+#ifndef RISCV_SIM_H
+#define RISCV_SIM_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "riscv_asm.h"
+
+// Simulador RV32IMFC (ou RV64IMFC, com xlen 64) para os programas gerados:
+// monta o .s com o montador embutido, liga as seções em endereços fixos e
+// executa a partir de main, contando instruções e acessos à memória. As
+// chamadas de sistema seguem o RARS (serviço em a7), mais read (63), write
+// (64) e exit (93). Nos dois casos a memória fica abaixo de 4 MiB
+
+#define SIM_MEMORY_SIZE (4 << 20)
+#define SIM_TEXT_BASE 0x1000
+#define SIM_DEFAULT_MAX_STEPS 100000000L
+
+typedef struct {
+    long instructions;      // Instruções executadas (as comprimidas contam uma)
+    long loads;
+    long stores;
+    long ecalls;
+} SimStats;
+
+typedef struct {
+    uint64_t x[32];         // No RV32, com o sinal dos 32 bits estendido
+    uint32_t f[32];         // Registradores float, como padrão de bits
+    uint32_t pc;
+    uint32_t text_end;
+    unsigned char *memory;
+    char *input;            // Entrada do programa (terminada em '\0')
+    size_t input_length;
+    size_t input_pos;
+    char *output;           // Tudo o que o programa escreveu na saída padrão
+    size_t output_length;
+    size_t output_capacity;
+    char *error_output;     // O que foi escrito no fd 2 (o perfil do --profile-generate)
+    size_t error_length;
+    size_t error_capacity;
+    long max_steps;
+    int xlen;               // 32 (padrão de sim_init) ou 64
+    int exit_code;
+    SimStats stats;
+    char error[256];
+} SimMachine;
+
+// Prepara a máquina com a entrada do programa (pode ser NULL)
+void sim_init(SimMachine *m, const char *input, size_t input_length);
+void sim_free(SimMachine *m);
+
+// Liga o programa montado na memória; 0 em caso de sucesso
+int sim_load(SimMachine *m, const AsmProgram *program);
+
+// Monta o texto de um .s e o liga; os erros de montagem vão para m->error
+int sim_load_assembly(SimMachine *m, const char *text, size_t length);
+
+// Executa até o exit; 0 se o programa terminou, 1 com a mensagem em m->error
+int sim_run(SimMachine *m);
+
+// Lê um arquivo inteiro, terminado em '\0' (NULL em caso de erro)
+char* sim_read_file(const char *path, size_t *length);
+
+#endif
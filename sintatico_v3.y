@@ -1,21 +1,10 @@
 /* Verificando a sintaxe de programas segundo nossa GLC-exemplo */
 /* considerando notacao polonesa para expressoes */
-%{
-#include <stdio.h> 
-#include <stdlib.h>
-#include <string.h>
-
-#define MAX_LINE 1024
-
-int yylex(void);
-void yyerror(const char *s);
-
-extern FILE *yyin;
-extern FILE *yyout;
+%code requires {
+#include <stdio.h>
 
-char* currentType;
-int semanticError1 = 0;
-int semanticError2 = 0;
+typedef void* yyscan_t;
+struct SimdScanner;
 
 struct node {
 	char* name; 
@@ -32,18 +21,64 @@ struct symbolTable {
 };
 typedef struct symbolTable symbolTable;
 
-node* firstNode;
-symbolTable ST;
+// Todo o estado semântico de uma análise; cada programa analisado usa o seu
+// próprio contexto, então várias análises podem rodar ao mesmo tempo
+typedef struct ParserContext {
+	FILE *out;              // Onde a saída para o gerador é escrita
+	char* currentType;
+	int semanticError1;
+	int semanticError2;
+	int lexicalError;
+	struct SimdScanner* fastScanner;   // Léxico de lexico_simd.c; NULL = o do flex
+	int sourceLine;         // Última linha do fonte anunciada ao gerador ("Linha N")
+	node* firstNode;
+	symbolTable ST;
+} ParserContext;
+}
+
+%code provides {
+void initParserContext(ParserContext* ctx, FILE* out);
+void freeParserContext(ParserContext* ctx);
+char* formatSource(FILE* input, size_t* length);
+int parseSource(ParserContext* ctx, const char* source, size_t length);
+int parseRawSource(ParserContext* ctx, const char* source, size_t length);
+void print_table(ParserContext* ctx, symbolTable* table);
+}
+
+%{
+#include <stdio.h> 
+#include <stdlib.h>
+#include <string.h>
 
-void insert(symbolTable* table, char* name);
+#define MAX_LINE 1024
+%}
 
-int search(symbolTable* table, char* name);
+%code {
+#include "lexico_simd.h"
+
+int flexLex(YYSTYPE* yylval_param, yyscan_t yyscanner);
+int yylex(YYSTYPE* yylval_param, YYLTYPE* yylloc_param, yyscan_t yyscanner, ParserContext* ctx);
+int yylex_init_extra(ParserContext* extra, yyscan_t* scanner);
+int yylex_destroy(yyscan_t scanner);
+int yyget_lineno(yyscan_t scanner);
+void yyset_lineno(int line, yyscan_t scanner);
+struct yy_buffer_state* yy_scan_bytes(const char* bytes, int length, yyscan_t scanner);
 
-void print_table(symbolTable* table);
+void yyerror(YYLTYPE* location, yyscan_t scanner, ParserContext* ctx, const char *s);
+void printSourceLine(ParserContext* ctx, int line);
+
+void insert(ParserContext* ctx, symbolTable* table, char* name);
+
+int search(symbolTable* table, char* name);
 
 int isNotUsedVariable(symbolTable* table);
+}
+
+%define api.pure full
+%locations
+%parse-param { yyscan_t scanner } { ParserContext* ctx }
+%lex-param { yyscan_t scanner } { ParserContext* ctx }
 
-%}
 %union {
     char *str;
     int num;
@@ -51,7 +86,13 @@ int isNotUsedVariable(symbolTable* table);
 %token <str> INT FLOAT ID STRING CHAR
 %token <str> OPERADOR
 %token <str> PRINT_KW SCAN_KW IF_KW ELSE_KW WHILE_KW
-%type <str> exp cond print_args scan_args cmd
+%token E_LOGICO OU_LOGICO
+%type <str> exp cond print_args print_vals scan_args cmd
+
+// precedências dos operadores lógicos das condições (|| < && < !)
+%left OU_LOGICO
+%left E_LOGICO
+%right '!'
 
 // precedências dos operadores aritmeticos
 %left '+' '-'
@@ -112,107 +153,146 @@ programa:	'{' lista_cmds '}'	{;}
 		|   lista_declaracoes  {;} 
 		|   lista_declaracoes '{' '}'	{;}
 		|   lista_declaracoes '{' lista_cmds '}'{
-												printf("Sintaxe correta!\n");
-												if(semanticError1) {
-													printf("ERROR: Variavel nao declarada!\n");
-												} else if(semanticError2) {
-													printf("ERROR: Variavel ja declarada!\n");
-												} else if(isNotUsedVariable(&ST)) {
-													printf("WARNING: Variavel declarada nao usada!\n");
+												fprintf(ctx->out, "Sintaxe correta!\n");
+												if(ctx->semanticError1) {
+													fprintf(ctx->out, "ERROR: Variavel nao declarada!\n");
+												} else if(ctx->semanticError2) {
+													fprintf(ctx->out, "ERROR: Variavel ja declarada!\n");
+												} else if(isNotUsedVariable(&ctx->ST)) {
+													fprintf(ctx->out, "WARNING: Variavel declarada nao usada!\n");
 												} else {
-													printf("Semantica correta!\n");
+													fprintf(ctx->out, "Semantica correta!\n");
 												}
 												};
 
+/* As listas são recursivas à esquerda: cada item é reduzido assim que
+   termina, então a pilha do bison só cresce com o aninhamento, não com o
+   tamanho do programa. Só a pilha fica limitada: a tabela de símbolos e o
+   IR do gerador continuam crescendo com o programa */
 lista_declaracoes: declaracao 
-		|		   declaracao lista_declaracoes
+		|		   lista_declaracoes declaracao
+;
+declaracao:         CHAR_KW {ctx->currentType = "CHAR";} lista_ids {;} 
+		|           DOUBLE_KW {ctx->currentType = "DOUBLE";} lista_ids {;} 
+		|           FLOAT_KW {ctx->currentType = "FLOAT";} lista_ids	{;} 
+		|           INT_KW {ctx->currentType = "INT";} lista_ids	{;} 
+		|           LONG_KW {ctx->currentType = "LONG";} lista_ids {;} 
+		|           SHORT_KW {ctx->currentType = "SHORT";} lista_ids {;} 
 ;
-declaracao:         CHAR_KW {currentType = "CHAR";} lista_ids {;} 
-		|           DOUBLE_KW {currentType = "DOUBLE";} lista_ids {;} 
-		|           FLOAT_KW {currentType = "FLOAT";} lista_ids	{;} 
-		|           INT_KW {currentType = "INT";} lista_ids	{;} 
-		|           LONG_KW {currentType = "LONG";} lista_ids {;} 
-		|           SHORT_KW {currentType = "SHORT";} lista_ids {;} 
+lista_ids:			ids ';'				{;}
 ;
-lista_ids:			ID ';'				{
-										if(!search(&ST, $1)) {
-											insert(&ST, $1);
+ids:				ID					{
+										if(!search(&ctx->ST, $1)) {
+											insert(ctx, &ctx->ST, $1);
 										} else {
-											semanticError2 = 1;
+											ctx->semanticError2 = 1;
+											free($1);
 										}
 										}
 
-		|			ID ',' lista_ids	{
-										if(!search(&ST, $1)) {
-											insert(&ST, $1);
+		|			ids ',' ID			{
+										if(!search(&ctx->ST, $3)) {
+											insert(ctx, &ctx->ST, $3);
 										} else {
-											semanticError2 = 1;
+											ctx->semanticError2 = 1;
+											free($3);
 										}
 										}
+;
 
 lista_cmds:	cmd							{;}
-		|   cmd lista_cmds			{;}
+		|   lista_cmds cmd			{;}
 ;
 
 cmd:    ID '=' exp ';'  {
-							if(!search(&ST, $1)) {
-								semanticError1 = 1;
+							if(!search(&ctx->ST, $1)) {
+								ctx->semanticError1 = 1;
 							}
-							printf("Atribuicao: %s = %s\n", $1, $3);
-							free($3);
+							printSourceLine(ctx, @1.first_line);
+							fprintf(ctx->out, "Atribuicao: %s = %s\n", $1, $3);
+							free($1); free($3);
 						}
-        | IF_KW '(' cond ')' '{' lista_cmds '}' {
-            printf("Condicional if: %s\n", $3);
-            free($3);
-        }
-        | IF_KW '(' cond ')' '{' lista_cmds '}' ELSE_KW '{' lista_cmds '}' {
-            printf("Condicional if-else: %s\n", $3);
+        | IF_KW '(' cond ')' {
+            /* O cabeçalho sai antes do corpo, que é impresso durante o
+               reconhecimento de lista_cmds; o gerador usa os marcadores
+               de fim para montar os blocos */
+            printSourceLine(ctx, @1.first_line);
+            fprintf(ctx->out, "Condicional if: %s\n", $3);
             free($3);
+        } '{' lista_cmds '}' senao {
+            printSourceLine(ctx, @$.last_line);
+            fprintf(ctx->out, "Fim condicional\n");
         }
-        | WHILE_KW '(' cond ')' '{' lista_cmds '}' {
-            printf("Loop while: %s\n", $3);
+        | WHILE_KW '(' cond ')' {
+            printSourceLine(ctx, @1.first_line);
+            fprintf(ctx->out, "Loop while: %s\n", $3);
             free($3);
+        } '{' lista_cmds '}' {
+            printSourceLine(ctx, @$.last_line);
+            fprintf(ctx->out, "Fim loop\n");
         }
         | PRINT_KW '(' print_args ')' ';' {
-            printf("Comando printf: %s\n", $3);
+            printSourceLine(ctx, @1.first_line);
+            fprintf(ctx->out, "Comando printf: %s\n", $3);
             free($3);
         }
         | SCAN_KW '(' scan_args ')' ';' {
-            printf("Comando scanf: %s\n", $3);
+            printSourceLine(ctx, @1.first_line);
+            fprintf(ctx->out, "Comando scanf: %s\n", $3);
             free($3);
         }
 ;
 
 
-print_args: STRING          { $$ = strdup($1); }
-          | STRING ',' exp  { 
+senao:	/* vazio */
+		|	ELSE_KW { fprintf(ctx->out, "Senao\n"); } '{' lista_cmds '}'
+;
+
+print_args: STRING          { $$ = $1; }
+          | STRING ',' print_vals  { 
+                int size = snprintf(NULL, 0, "%s, %s", $1, $3) + 1;
+                $$ = malloc(size);
+                snprintf($$, size, "%s, %s", $1, $3);
+                free($1); free($3);
+            }
+          | exp             { $$ = $1; }
+;
+
+/* Argumentos do formato, na ordem; o gerador casa cada um com um % */
+print_vals: exp             { $$ = $1; }
+          | print_vals ',' exp  {
                 int size = snprintf(NULL, 0, "%s, %s", $1, $3) + 1;
                 $$ = malloc(size);
                 snprintf($$, size, "%s, %s", $1, $3);
-                free($3);
+                free($1); free($3);
             }
-          | exp             { $$ = strdup($1); }
 ;
 
 scan_args: STRING ',' '&' ID { 
-                if(!search(&ST, $4)) {
-                    semanticError1 = 1;
+                if(!search(&ctx->ST, $4)) {
+                    ctx->semanticError1 = 1;
                 }
                 int size = snprintf(NULL, 0, "%s, %s", $1, $4) + 1;
                 $$ = malloc(size);
                 snprintf($$, size, "%s, %s", $1, $4);
+                free($1); free($4);
             }
 ;
 
 exp:	  INT		{ $$ = $1; }
 		| FLOAT	{ $$ = $1; }
 		| ID		{ 
-					if(!search(&ST, $1)) {
-						semanticError1 = 1;
+					if(!search(&ctx->ST, $1)) {
+						ctx->semanticError1 = 1;
 					}		
 					$$ = $1;
 					}
-		| SCAN_KW '(' ')'	{printf("scanf\n");}
+		| SCAN_KW '(' ')'	{
+					fprintf(ctx->out, "scanf\n");
+					/* SCAN_KW não tem texto; o gerador reconhece o marcador
+					   e lê um int da entrada no meio da expressão */
+					$$ = strdup("scanf()");
+					}
     	| exp '+' exp		{ int size = snprintf(NULL, 0, "(%s + %s)", $1, $3) + 1;
           					$$ = malloc(size);
           					snprintf($$, size, "(%s + %s)", $1, $3);
@@ -235,33 +315,78 @@ exp:	  INT		{ $$ = $1; }
           					free($1); free($3);}
 		| '(' exp ')'     	{ $$ = $2; }
 ;
+/* && e || saem como no fonte; o gerador separa pelos de fora dos
+   parênteses (|| antes de &&) e o ! leva a condição entre parênteses */
 cond:   exp OPERADOR exp {
             int size = snprintf(NULL, 0, "%s %s %s", $1, $2, $3) + 1;
             $$ = malloc(size);
             snprintf($$, size, "%s %s %s", $1, $2, $3);
+            free($1); free($2); free($3);
         }
+		| cond OU_LOGICO cond	{ int size = snprintf(NULL, 0, "%s || %s", $1, $3) + 1;
+          					$$ = malloc(size);
+          					snprintf($$, size, "%s || %s", $1, $3);
+          					free($1); free($3);}
+		| cond E_LOGICO cond	{ int size = snprintf(NULL, 0, "%s && %s", $1, $3) + 1;
+          					$$ = malloc(size);
+          					snprintf($$, size, "%s && %s", $1, $3);
+          					free($1); free($3);}
+		| '!' cond			{ int size = snprintf(NULL, 0, "!(%s)", $2) + 1;
+          					$$ = malloc(size);
+          					snprintf($$, size, "!(%s)", $2);
+          					free($2);}
+		| '(' cond ')'		{ int size = snprintf(NULL, 0, "(%s)", $2) + 1;
+          					$$ = malloc(size);
+          					snprintf($$, size, "(%s)", $2);
+          					free($2);}
 ;
 
 %%
 
-void initSymbolTable(symbolTable* table) {
-	firstNode = (node*) malloc(sizeof(node));
+void initSymbolTable(ParserContext* ctx, symbolTable* table) {
+	ctx->firstNode = (node*) malloc(sizeof(node));
     
-    firstNode->name = "-1";
-    firstNode->type = "-1";
-    firstNode->used = -1;
-	firstNode->address = -1;
-    firstNode->next = NULL;
-
-    ST.size = 0;
-    ST.head = firstNode;
+    ctx->firstNode->name = "-1";
+    ctx->firstNode->type = "-1";
+    ctx->firstNode->used = -1;
+	ctx->firstNode->address = -1;
+    ctx->firstNode->next = NULL;
+
+    table->size = 0;
+    table->head = ctx->firstNode;
+}
+
+void initParserContext(ParserContext* ctx, FILE* out) {
+	ctx->out = out;
+	ctx->currentType = "";
+	ctx->semanticError1 = 0;
+	ctx->semanticError2 = 0;
+	ctx->lexicalError = 0;
+	ctx->fastScanner = NULL;
+	ctx->sourceLine = 0;
+	initSymbolTable(ctx, &ctx->ST);
+}
+
+void freeParserContext(ParserContext* ctx) {
+	node* n = ctx->ST.head;
+	while(n != NULL) {
+		node* next = n->next;
+		if(n != ctx->firstNode) {
+			free(n->name);
+			free(n->type);
+		}
+		free(n);
+		n = next;
+	}
+	ctx->ST.head = NULL;
+	ctx->firstNode = NULL;
 }
 
 // insere um simbolo na tabela
-void insert(symbolTable* table, char* name) {
+void insert(ParserContext* ctx, symbolTable* table, char* name) {
     node* n = (node*) malloc(sizeof(node));
     n->name = name;
-    n->type = strdup(currentType);
+    n->type = strdup(ctx->currentType);
     n->used = 0;
     n->address = table->size; 
     n->next = table->head;
@@ -270,13 +395,13 @@ void insert(symbolTable* table, char* name) {
     table->size++;
 
     //printf("Atribuicao: %s = 0;\n", n->name);  
-    printf("Variavel %s %s criada!\n", n->type, n->name);
+    fprintf(ctx->out, "Variavel %s %s criada!\n", n->type, n->name);
 }
 
 
 // retorna 1 se achar o simbolo
 int search(symbolTable* table, char* symbolName) {
-	for(node* n = table->head; n->name != "-1"; n = n->next) {
+	for(node* n = table->head; n->next != NULL; n = n->next) {
 		if(strcmp(n->name, symbolName) == 0) {
 			n->used = 1;
 			return 1;
@@ -287,16 +412,16 @@ int search(symbolTable* table, char* symbolName) {
 
 
 // printa todos os simbolos da tabela
-void print_table(symbolTable* table) {
-	printf("Name\tType\tUsed\tAddress\n");
-	for(node* n = table->head; n->name != "-1"; n = n->next) {
-		printf("%s\t\t%s\t\t%d\t\t%d\n", n->name, n->type, n->used, n->address * 4 );
+void print_table(ParserContext* ctx, symbolTable* table) {
+	fprintf(ctx->out, "Name\tType\tUsed\tAddress\n");
+	for(node* n = table->head; n->next != NULL; n = n->next) {
+		fprintf(ctx->out, "%s\t\t%s\t\t%d\t\t%d\n", n->name, n->type, n->used, n->address * 4 );
 	}
 }
 
 // retorna 1 se alguma variavel declarada nao for usada e 0 caso todas as variaveis decleradas sao usadas
 int isNotUsedVariable(symbolTable* table) {
-	for(node* n = table->head; n->name != "-1"; n = n->next) {
+	for(node* n = table->head; n->next != NULL; n = n->next) {
 		if(n->used == 0) {
 			return 1;
 		}
@@ -306,7 +431,7 @@ int isNotUsedVariable(symbolTable* table) {
 
 // retorna o endereco de memória da variável ou -1, caso a variavel não tenha sido declarada
 int getVariableAddress(symbolTable* table, char* symbolName) {
-	for(node* n = table->head; n->name != "-1"; n = n->next) {
+	for(node* n = table->head; n->next != NULL; n = n->next) {
 		if(strcmp(n->name, symbolName) == 0) {
 			return n->address;
 		}
@@ -314,62 +439,152 @@ int getVariableAddress(symbolTable* table, char* symbolName) {
 	return -1;
 }
 
+// Remove comentarios de linha unica, devolvendo o texto em memoria (sem
+// arquivo temporario); as quebras de linha ficam, para o lexico contar as
+// linhas do fonte
+char* formatSource(FILE* input, size_t* length) {
+	char* buffer = NULL;
+	size_t size = 0;
+	FILE* output = open_memstream(&buffer, &size);
+	if (output == NULL) {
+		perror("Erro ao formatar a entrada");
+		return NULL;
+	}
 
-int main(int argc, char **argv) {
-	currentType = "";
-	
-	if(argc > 0) {
-		FILE *output = fopen("input_formatado.txt", "w");
-		if (output == NULL) {
-			perror("Erro ao abrir o arquivo de saída");
-			return 1;
+	char line[MAX_LINE];
+	int isFirstLine = 1;
+	int endedLine = 0;
+
+	// Ler linha a linha da entrada
+	while (fgets(line, sizeof(line), input)) {
+		// Um pedaço de linha maior que MAX_LINE continua a mesma linha
+		int separator = endedLine ? '\n' : ' ';
+		endedLine = strchr(line, '\n') != NULL;
+
+		// Remover comentarios de linha unica
+		int em_string = -1;
+		for (int i = 0; line[i] != '\0'; i++) {
+			if (line[i] == '"' && (i == 0 || line[i - 1] != '\\')) {
+				em_string *= -1; // alterna o estado da string
+			}
+
+			if (em_string == -1 && line[i] == '/' && line[i + 1] == '/') {
+				line[i] = '\0'; // trunca a linha no início do comentário
+				break;
+			}
 		}
 
-		char line[MAX_LINE];
-		int isFirstLine = 1;
+		// Remove o \n do final da linha, se existir
+		line[strcspn(line, "\r\n")] = '\0';
 
-		// Ler linha a linha da entrada padrão
-		while (fgets(line, sizeof(line), stdin)) {
+		// Se não for a primeira linha, separa da anterior
+		if (!isFirstLine) {
+			fputc(separator, output);
+		}
 
-			// Remover comentarios de linha unica
-			int em_string = -1;
-			for (int i = 0; line[i] != '\0'; i++) {
-				if (line[i] == '"' && (i == 0 || line[i - 1] != '\\')) {
-					em_string *= -1; // alterna o estado da string
-				}
+		// Escreve a linha na saída
+		fputs(line, output);
 
-				if (em_string == -1 && line[i] == '/' && line[i + 1] == '/') {
-					line[i] = '\0'; // trunca a linha no início do comentário
-					break;
-				}
-			}
+		isFirstLine = 0;
+	}
 
-			// Remove o \n do final da linha, se existir
-			line[strcspn(line, "\r\n")] = '\0';
+	fclose(output);
+	*length = size;
+	return buffer;
+}
 
-			// Se não for a primeira linha, escreve um espaço antes
-			if (!isFirstLine) {
-				fputc(' ', output);
-			}
+// Analisa um programa já formatado; retorna 0 se não houve erro léxico/sintático
+int parseSource(ParserContext* ctx, const char* source, size_t length) {
+	yyscan_t scanner;
+	if (yylex_init_extra(ctx, &scanner) != 0) {
+		perror("Erro ao criar o analisador lexico");
+		return 1;
+	}
+
+	yy_scan_bytes(source, (int) length, scanner);
+	// yy_scan_bytes não inicia a contagem de linhas do buffer novo
+	yyset_lineno(1, scanner);
+	int result = yyparse(scanner, ctx);
+	yylex_destroy(scanner);
+
+	return result != 0 || ctx->lexicalError;
+}
+
+// Analisa o fonte como está no arquivo, com o léxico de lexico_simd.c: ele
+// mesmo pula as quebras de linha e os comentários, sem formatSource
+int parseRawSource(ParserContext* ctx, const char* source, size_t length) {
+	ctx->fastScanner = simd_scanner_create(ctx, source, length, SCANNER_AUTO);
+	int result = yyparse(NULL, ctx);
+	simd_scanner_destroy(ctx->fastScanner);
+	ctx->fastScanner = NULL;
+
+	return result != 0 || ctx->lexicalError;
+}
 
-			// Escreve a linha no arquivo de saída
-			fputs(line, output);
+// A posição de cada token é só a linha, que vai ao gerador nos marcadores "Linha N"
+int yylex(YYSTYPE* yylval_param, YYLTYPE* yylloc_param, yyscan_t yyscanner, ParserContext* ctx) {
+	int token;
+	if (ctx->fastScanner) {
+		token = simd_scanner_next(ctx->fastScanner, yylval_param);
+		yylloc_param->first_line = simd_scanner_line(ctx->fastScanner);
+	} else {
+		token = flexLex(yylval_param, yyscanner);
+		yylloc_param->first_line = yyget_lineno(yyscanner);
+	}
+	yylloc_param->last_line = yylloc_param->first_line;
+	return token;
+}
+
+// Antes de um comando, diz ao gerador a linha do fonte dele (só quando muda)
+void printSourceLine(ParserContext* ctx, int line) {
+	if (line != ctx->sourceLine) {
+		fprintf(ctx->out, "Linha %d\n", line);
+		ctx->sourceLine = line;
+	}
+}
 
-			isFirstLine = 0;
+#ifndef SINTATICO_SEM_MAIN
+// Lê a entrada inteira, sem formatar
+char* readRawSource(FILE* input, size_t* length) {
+	char* buffer = NULL;
+	size_t size = 0, capacity = 0, n;
+	do {
+		if (size + 65536 > capacity) {
+			capacity = capacity ? capacity * 2 : 65536;
+			buffer = realloc(buffer, capacity);
 		}
+		n = fread(buffer + size, 1, capacity - size, input);
+		size += n;
+	} while (n > 0);
+	*length = size;
+	return buffer;
+}
+
+int main(int argc, char **argv) {
+	// --scanner=simd usa o léxico de lexico_simd.c no lugar do flex
+	int useSimdScanner = argc > 1 && strcmp(argv[1], "--scanner=simd") == 0;
 
-		fclose(output);
+	size_t length = 0;
+	char* source = useSimdScanner ? readRawSource(stdin, &length) : formatSource(stdin, &length);
+	if (source == NULL) {
+		return 1;
 	}
 
-	yyin = fopen("input_formatado.txt","rt");
+	ParserContext ctx;
+	initParserContext(&ctx, stdout);
+	if (useSimdScanner) {
+		parseRawSource(&ctx, source, length);
+	} else {
+		parseSource(&ctx, source, length);
+	}
+	print_table(&ctx, &ctx.ST);
 
-	initSymbolTable(&ST);
-	yyparse();
-    fclose(yyin);
-	print_table(&ST);
+	freeParserContext(&ctx);
+	free(source);
 	return 0;
 }
+#endif
 
-void yyerror(const char *s) {
-    printf("Problema com a analise sintatica: %s\n", s);
-}
\ No newline at end of file
+void yyerror(YYLTYPE* location, yyscan_t scanner, ParserContext* ctx, const char *s) {
+    fprintf(ctx->out, "Problema com a analise sintatica: %s\n", s);
+}